@@ -0,0 +1,480 @@
+/****************************************************************************
+ * examples/bchbench/bchbench_main.c
+ *
+ *   Copyright (C) 2014 Gregory Nutt. All rights reserved.
+ *   Author: Gregory Nutt <gnutt@nuttx.org>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name NuttX nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <sys/types.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <time.h>
+#include <errno.h>
+
+#include <nuttx/fs/fs.h>
+#include <nuttx/fs/ramdisk.h>
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+/* Configuration ************************************************************/
+
+#ifndef CONFIG_EXAMPLES_BCHBENCH_RAMDEVNO
+#  define CONFIG_EXAMPLES_BCHBENCH_RAMDEVNO 1
+#endif
+
+#ifndef CONFIG_EXAMPLES_BCHBENCH_NSECTORS
+#  define CONFIG_EXAMPLES_BCHBENCH_NSECTORS 512
+#endif
+
+#ifndef CONFIG_EXAMPLES_BCHBENCH_SECTORSIZE
+#  define CONFIG_EXAMPLES_BCHBENCH_SECTORSIZE 512
+#endif
+
+#ifndef CONFIG_BCH_NSECTORS
+#  define CONFIG_BCH_NSECTORS 4
+#endif
+
+#define BCHBENCH_STR(m)  #m
+#define BCHBENCH_XSTR(m) BCHBENCH_STR(m)
+
+#define BCHBENCH_RAMDEV  "/dev/ram" BCHBENCH_XSTR(CONFIG_EXAMPLES_BCHBENCH_RAMDEVNO)
+#define BCHBENCH_BLKDEV  "/dev/bchbenchblk"
+#define BCHBENCH_CHRDEV  "/dev/bchbench"
+
+#define BCHBENCH_DISKSIZE \
+  (CONFIG_EXAMPLES_BCHBENCH_NSECTORS * CONFIG_EXAMPLES_BCHBENCH_SECTORSIZE)
+
+#define BCHBENCH_MINSIZE 64     /* Smallest I/O size */
+#define BCHBENCH_MAXSIZE 65536  /* Largest I/O size */
+
+/****************************************************************************
+ * Private Types
+ ****************************************************************************/
+
+/* The RAM disk is wrapped in this block driver that counts the reads and
+ * writes that reach it.
+ */
+
+struct bchbench_dev_s
+{
+  FAR struct inode *lower;      /* The RAM disk */
+  unsigned long nreads;         /* Number of read calls */
+  unsigned long nrdsectors;     /* Number of sectors read */
+  unsigned long nwrites;        /* Number of write calls */
+  unsigned long nwrsectors;     /* Number of sectors written */
+};
+
+/****************************************************************************
+ * Private Function Prototypes
+ ****************************************************************************/
+
+static int     bchbench_open(FAR struct inode *inode);
+static int     bchbench_close(FAR struct inode *inode);
+static ssize_t bchbench_read(FAR struct inode *inode,
+                             FAR unsigned char *buffer, size_t start_sector,
+                             unsigned int nsectors);
+static ssize_t bchbench_write(FAR struct inode *inode,
+                              FAR const unsigned char *buffer,
+                              size_t start_sector, unsigned int nsectors);
+static int     bchbench_geometry(FAR struct inode *inode,
+                                 FAR struct geometry *geometry);
+static int     bchbench_ioctl(FAR struct inode *inode, int cmd,
+                              unsigned long arg);
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+static const struct block_operations g_bops =
+{
+  bchbench_open,     /* open     */
+  bchbench_close,    /* close    */
+  bchbench_read,     /* read     */
+  bchbench_write,    /* write    */
+  bchbench_geometry, /* geometry */
+  bchbench_ioctl     /* ioctl    */
+};
+
+static struct bchbench_dev_s g_dev;
+static bool g_registered;
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: bchbench_now
+ *
+ * Description:
+ *   Return the current time in milliseconds.  The clock only advances once
+ *   per system tick, so only whole passes over the device are timed.
+ *
+ ****************************************************************************/
+
+static unsigned long bchbench_now(void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_REALTIME, &ts);
+  return (unsigned long)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+/****************************************************************************
+ * Name: bchbench_open, bchbench_close, bchbench_read, bchbench_write,
+ *       bchbench_geometry, and bchbench_ioctl
+ *
+ * Description:
+ *   The block driver methods of the counting wrapper.  Reads and writes
+ *   are counted, all operations are passed on to the RAM disk.
+ *
+ ****************************************************************************/
+
+static int bchbench_open(FAR struct inode *inode)
+{
+  FAR struct inode *lower = g_dev.lower;
+  return lower->u.i_bops->open ? lower->u.i_bops->open(lower) : OK;
+}
+
+static int bchbench_close(FAR struct inode *inode)
+{
+  FAR struct inode *lower = g_dev.lower;
+  return lower->u.i_bops->close ? lower->u.i_bops->close(lower) : OK;
+}
+
+static ssize_t bchbench_read(FAR struct inode *inode,
+                             FAR unsigned char *buffer, size_t start_sector,
+                             unsigned int nsectors)
+{
+  FAR struct inode *lower = g_dev.lower;
+  ssize_t ret;
+
+  ret = lower->u.i_bops->read(lower, buffer, start_sector, nsectors);
+  if (ret > 0)
+    {
+      g_dev.nreads++;
+      g_dev.nrdsectors += ret;
+    }
+
+  return ret;
+}
+
+static ssize_t bchbench_write(FAR struct inode *inode,
+                              FAR const unsigned char *buffer,
+                              size_t start_sector, unsigned int nsectors)
+{
+  FAR struct inode *lower = g_dev.lower;
+  ssize_t ret;
+
+  ret = lower->u.i_bops->write(lower, buffer, start_sector, nsectors);
+  if (ret > 0)
+    {
+      g_dev.nwrites++;
+      g_dev.nwrsectors += ret;
+    }
+
+  return ret;
+}
+
+static int bchbench_geometry(FAR struct inode *inode,
+                             FAR struct geometry *geometry)
+{
+  FAR struct inode *lower = g_dev.lower;
+  return lower->u.i_bops->geometry(lower, geometry);
+}
+
+static int bchbench_ioctl(FAR struct inode *inode, int cmd,
+                          unsigned long arg)
+{
+  FAR struct inode *lower = g_dev.lower;
+  return lower->u.i_bops->ioctl ? lower->u.i_bops->ioctl(lower, cmd, arg) :
+                                  -ENOTTY;
+}
+
+/****************************************************************************
+ * Name: bchbench_reset
+ *
+ * Description:
+ *   Clear the read and write counts.
+ *
+ ****************************************************************************/
+
+static void bchbench_reset(void)
+{
+  g_dev.nreads     = 0;
+  g_dev.nrdsectors = 0;
+  g_dev.nwrites    = 0;
+  g_dev.nwrsectors = 0;
+}
+
+/****************************************************************************
+ * Name: bchbench_setup
+ *
+ * Description:
+ *   Create the RAM disk, wrap it in the counting block driver, and export
+ *   that as a character device.  None of these can be removed again, so
+ *   this is only done the first time the benchmark runs.
+ *
+ ****************************************************************************/
+
+static int bchbench_setup(void)
+{
+  FAR uint8_t *disk;
+  int ret;
+
+  if (g_registered)
+    {
+      return OK;
+    }
+
+  disk = (FAR uint8_t *)malloc(BCHBENCH_DISKSIZE);
+  if (disk == NULL)
+    {
+      printf("bchbench: Failed to allocate a RAM disk of %d bytes\n",
+             BCHBENCH_DISKSIZE);
+      return -ENOMEM;
+    }
+
+  memset(disk, 0, BCHBENCH_DISKSIZE);
+  ret = ramdisk_register(CONFIG_EXAMPLES_BCHBENCH_RAMDEVNO, disk,
+                         CONFIG_EXAMPLES_BCHBENCH_NSECTORS,
+                         CONFIG_EXAMPLES_BCHBENCH_SECTORSIZE, true);
+  if (ret < 0)
+    {
+      printf("bchbench: ramdisk_register failed: %d\n", ret);
+      free(disk);
+      return ret;
+    }
+
+  ret = open_blockdriver(BCHBENCH_RAMDEV, 0, &g_dev.lower);
+  if (ret < 0)
+    {
+      printf("bchbench: open_blockdriver failed: %d\n", ret);
+      return ret;
+    }
+
+  ret = register_blockdriver(BCHBENCH_BLKDEV, &g_bops, 0666, &g_dev);
+  if (ret < 0)
+    {
+      printf("bchbench: register_blockdriver failed: %d\n", ret);
+      (void)close_blockdriver(g_dev.lower);
+      return ret;
+    }
+
+  ret = bchdev_register(BCHBENCH_BLKDEV, BCHBENCH_CHRDEV, false);
+  if (ret < 0)
+    {
+      printf("bchbench: bchdev_register failed: %d\n", ret);
+      return ret;
+    }
+
+  g_registered = true;
+  return OK;
+}
+
+/****************************************************************************
+ * Name: bchbench_pattern
+ *
+ * Description:
+ *   Fill 'buffer' with the contents expected at device offset 'offset'.
+ *
+ ****************************************************************************/
+
+static void bchbench_pattern(FAR uint8_t *buffer, size_t offset,
+                             size_t iosize, size_t len)
+{
+  size_t i;
+
+  for (i = 0; i < len; i++)
+    {
+      buffer[i] = (uint8_t)((offset + i) / 7 + iosize);
+    }
+}
+
+/****************************************************************************
+ * Name: bchbench_run
+ *
+ * Description:
+ *   Write the whole device and then read it back with I/O requests of
+ *   'iosize' bytes.  The write pass includes the close() that writes back
+ *   the sector cache; its reads are those needed to merge partial sectors.
+ *
+ ****************************************************************************/
+
+static int bchbench_run(FAR uint8_t *buffer, FAR uint8_t *expected,
+                        size_t iosize)
+{
+  unsigned long wtime;
+  unsigned long rtime;
+  unsigned long wreads;
+  unsigned long wwrites;
+  unsigned long wsectors;
+  size_t offset;
+  int fd;
+
+  /* Write the device */
+
+  fd = open(BCHBENCH_CHRDEV, O_WRONLY);
+  if (fd < 0)
+    {
+      printf("bchbench: open %s failed: %d\n", BCHBENCH_CHRDEV, errno);
+      return -1;
+    }
+
+  bchbench_reset();
+  wtime = bchbench_now();
+
+  for (offset = 0; offset < BCHBENCH_DISKSIZE; offset += iosize)
+    {
+      bchbench_pattern(buffer, offset, iosize, iosize);
+      if (write(fd, buffer, iosize) != iosize)
+        {
+          printf("bchbench: write failed: %d\n", errno);
+          (void)close(fd);
+          return -1;
+        }
+    }
+
+  if (close(fd) < 0)
+    {
+      printf("bchbench: close failed: %d\n", errno);
+      return -1;
+    }
+
+  wtime    = bchbench_now() - wtime;
+  wreads   = g_dev.nreads;
+  wwrites  = g_dev.nwrites;
+  wsectors = g_dev.nwrsectors;
+
+  /* Then read it back */
+
+  fd = open(BCHBENCH_CHRDEV, O_RDONLY);
+  if (fd < 0)
+    {
+      printf("bchbench: open %s failed: %d\n", BCHBENCH_CHRDEV, errno);
+      return -1;
+    }
+
+  bchbench_reset();
+  rtime = bchbench_now();
+
+  for (offset = 0; offset < BCHBENCH_DISKSIZE; offset += iosize)
+    {
+      if (read(fd, buffer, iosize) != iosize)
+        {
+          printf("bchbench: read failed: %d\n", errno);
+          (void)close(fd);
+          return -1;
+        }
+
+      bchbench_pattern(expected, offset, iosize, iosize);
+      if (memcmp(buffer, expected, iosize) != 0)
+        {
+          printf("bchbench: ERROR: Bad data at offset %lu\n",
+                 (unsigned long)offset);
+          (void)close(fd);
+          return -1;
+        }
+    }
+
+  rtime = bchbench_now() - rtime;
+  (void)close(fd);
+
+  printf("%8lu %8lu %8lu %8lu %8lu %8lu %8lu %8lu\n", (unsigned long)iosize,
+         wwrites, wsectors, wreads, wtime,
+         g_dev.nreads, g_dev.nrdsectors, rtime);
+  return 0;
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * bchbench_main
+ ****************************************************************************/
+
+#ifdef CONFIG_BUILD_KERNEL
+int main(int argc, FAR char *argv[])
+#else
+int bchbench_main(int argc, char *argv[])
+#endif
+{
+  FAR uint8_t *buffer;
+  FAR uint8_t *expected;
+  size_t iosize;
+  int ret;
+
+  ret = bchbench_setup();
+  if (ret < 0)
+    {
+      return 1;
+    }
+
+  buffer   = (FAR uint8_t *)malloc(BCHBENCH_MAXSIZE);
+  expected = (FAR uint8_t *)malloc(BCHBENCH_MAXSIZE);
+  if (buffer == NULL || expected == NULL)
+    {
+      printf("bchbench: Failed to allocate I/O buffers\n");
+      free(buffer);
+      free(expected);
+      return 1;
+    }
+
+  printf("BCH_NSECTORS=%d device=%d bytes\n\n",
+         CONFIG_BCH_NSECTORS, BCHBENCH_DISKSIZE);
+  printf("%8s %35s %26s\n", "", "Write pass", "Read pass");
+  printf("%8s %8s %8s %8s %8s %8s %8s %8s\n", "I/O size",
+         "writes", "sectors", "reads", "msec", "reads", "sectors", "msec");
+
+  for (iosize = BCHBENCH_MINSIZE;
+       iosize <= BCHBENCH_MAXSIZE && iosize <= BCHBENCH_DISKSIZE && ret == 0;
+       iosize <<= 2)
+    {
+      ret = bchbench_run(buffer, expected, iosize);
+    }
+
+  free(buffer);
+  free(expected);
+  return ret == 0 ? 0 : 1;
+}
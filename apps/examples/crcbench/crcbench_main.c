@@ -0,0 +1,298 @@
+/****************************************************************************
+ * examples/crcbench/crcbench_main.c
+ *
+ *   Copyright (C) 2014 Gregory Nutt. All rights reserved.
+ *   Author: Gregory Nutt <gnutt@nuttx.org>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name NuttX nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <sys/types.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <time.h>
+#include <crc16.h>
+#include <crc32.h>
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+/* Configuration ************************************************************/
+
+#ifndef CONFIG_EXAMPLES_CRCBENCH_MAXSIZE
+#  define CONFIG_EXAMPLES_CRCBENCH_MAXSIZE 4096
+#endif
+
+#ifndef CONFIG_EXAMPLES_CRCBENCH_NBYTES
+#  define CONFIG_EXAMPLES_CRCBENCH_NBYTES 1048576
+#endif
+
+/* The smallest size measured */
+
+#define CRCBENCH_MINSIZE 16
+
+/* The CRC functions are verified for all lengths and split points up to
+ * this size.
+ */
+
+#define CRCBENCH_VERIFYSIZE 40
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+static volatile uint32_t g_result;
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: crcbench_now
+ *
+ * Description:
+ *   Return the current time in microseconds.
+ *
+ ****************************************************************************/
+
+static unsigned long crcbench_now(void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_REALTIME, &ts);
+  return (unsigned long)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+/****************************************************************************
+ * Name: crcbench_rate
+ *
+ * Description:
+ *   Convert 'nreps' CRCs of 'size' bytes in 'elapsed' microseconds to a
+ *   throughput in KB/s.
+ *
+ ****************************************************************************/
+
+static unsigned long crcbench_rate(size_t size, unsigned long nreps,
+                                   unsigned long elapsed)
+{
+  if (elapsed == 0)
+    {
+      elapsed = 1;
+    }
+
+  return (unsigned long)(((uint64_t)size * nreps * 1000000 / 1024) /
+                         elapsed);
+}
+
+/****************************************************************************
+ * Name: crcbench_ref32 and crcbench_ref16
+ *
+ * Description:
+ *   Bit-at-a-time reference versions of crc32part() and crc16part().
+ *
+ ****************************************************************************/
+
+static uint32_t crcbench_ref32(FAR const uint8_t *src, size_t len,
+                               uint32_t crc)
+{
+  int bit;
+
+  while (len-- > 0)
+    {
+      crc ^= *src++;
+      for (bit = 0; bit < 8; bit++)
+        {
+          crc = (crc & 1) != 0 ? (crc >> 1) ^ 0xedb88320 : crc >> 1;
+        }
+    }
+
+  return crc;
+}
+
+static uint16_t crcbench_ref16(FAR const uint8_t *src, size_t len,
+                               uint16_t crc)
+{
+  uint16_t msb;
+  int bit;
+
+  for (; len > 0; len--, src++)
+    {
+      for (bit = 7; bit >= 0; bit--)
+        {
+          msb = crc & 0x8000;
+          crc = (uint16_t)(crc << 1) | ((*src >> bit) & 1);
+          if (msb != 0)
+            {
+              crc ^= 0x1021;
+            }
+        }
+    }
+
+  return crc;
+}
+
+/****************************************************************************
+ * Name: crcbench_verify
+ *
+ * Description:
+ *   Check the CRC functions against the reference versions for all lengths
+ *   up to CRCBENCH_VERIFYSIZE, each split into two parts at every position
+ *   and recombined.  Returns the number of errors.
+ *
+ ****************************************************************************/
+
+static int crcbench_verify(FAR const uint8_t *buffer)
+{
+  uint32_t crc32val;
+  uint16_t crc16val;
+  size_t len;
+  size_t split;
+  int errors = 0;
+
+  for (len = 0; len <= CRCBENCH_VERIFYSIZE; len++)
+    {
+      crc32val = crcbench_ref32(buffer, len, 0x12345678);
+      crc16val = crcbench_ref16(buffer, len, 0x1234);
+
+      if (crc32part(buffer, len, 0x12345678) != crc32val ||
+          crc16part(buffer, len, 0x1234) != crc16val)
+        {
+          printf("crcbench: ERROR: Bad CRC, len=%lu\n", (unsigned long)len);
+          errors++;
+        }
+
+      for (split = 0; split <= len; split++)
+        {
+          if (crc32combine(crc32part(buffer, split, 0x12345678),
+                           crc32(&buffer[split], len - split),
+                           len - split) != crc32val ||
+              crc16combine(crc16part(buffer, split, 0x1234),
+                           crc16(&buffer[split], len - split),
+                           len - split) != crc16val)
+            {
+              printf("crcbench: ERROR: Bad combined CRC, "
+                     "len=%lu split=%lu\n",
+                     (unsigned long)len, (unsigned long)split);
+              errors++;
+            }
+        }
+    }
+
+  return errors;
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: crcbench_main
+ ****************************************************************************/
+
+#ifdef CONFIG_BUILD_KERNEL
+int main(int argc, FAR char *argv[])
+#else
+int crcbench_main(int argc, char *argv[])
+#endif
+{
+  FAR uint8_t *buffer;
+  unsigned long nreps;
+  unsigned long start;
+  unsigned long rate16;
+  unsigned long rate32;
+  unsigned long i;
+  size_t size;
+  int errors;
+
+  buffer = (FAR uint8_t *)malloc(CONFIG_EXAMPLES_CRCBENCH_MAXSIZE +
+                                 CRCBENCH_VERIFYSIZE);
+  if (buffer == NULL)
+    {
+      printf("crcbench: ERROR: Failed to allocate buffer\n");
+      return 1;
+    }
+
+  for (i = 0;
+       i < CONFIG_EXAMPLES_CRCBENCH_MAXSIZE + CRCBENCH_VERIFYSIZE;
+       i++)
+    {
+      buffer[i] = (uint8_t)rand();
+    }
+
+  errors = crcbench_verify(buffer);
+  if (errors > 0)
+    {
+      goto errout;
+    }
+
+  printf("crcbench: throughput in KB/s, %lu bytes per measurement\n",
+         (unsigned long)CONFIG_EXAMPLES_CRCBENCH_NBYTES);
+  printf("%6s %10s %10s\n", "Size", "crc16", "crc32");
+
+  for (size = CRCBENCH_MINSIZE;
+       size <= CONFIG_EXAMPLES_CRCBENCH_MAXSIZE;
+       size <<= 2)
+    {
+      nreps = CONFIG_EXAMPLES_CRCBENCH_NBYTES / size;
+      if (nreps < 1)
+        {
+          nreps = 1;
+        }
+
+      start = crcbench_now();
+      for (i = 0; i < nreps; i++)
+        {
+          g_result = crc16(buffer, size);
+        }
+
+      rate16 = crcbench_rate(size, nreps, crcbench_now() - start);
+
+      start = crcbench_now();
+      for (i = 0; i < nreps; i++)
+        {
+          g_result = crc32(buffer, size);
+        }
+
+      rate32 = crcbench_rate(size, nreps, crcbench_now() - start);
+
+      printf("%6lu %10lu %10lu\n", (unsigned long)size, rate16, rate32);
+    }
+
+errout:
+  free(buffer);
+  return errors > 0 ? 1 : 0;
+}
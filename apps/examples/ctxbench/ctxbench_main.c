@@ -0,0 +1,339 @@
+/****************************************************************************
+ * examples/ctxbench/ctxbench_main.c
+ *
+ *   Copyright (C) 2014 Gregory Nutt. All rights reserved.
+ *   Author: Gregory Nutt <gnutt@nuttx.org>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name NuttX nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <sys/types.h>
+#include <stdio.h>
+#include <pthread.h>
+#include <semaphore.h>
+#include <sched.h>
+#include <time.h>
+#include <errno.h>
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+/* Configuration ************************************************************/
+
+#ifndef CONFIG_EXAMPLES_CTXBENCH_NSWITCHES
+#  define CONFIG_EXAMPLES_CTXBENCH_NSWITCHES 100000
+#endif
+
+#ifndef CONFIG_EXAMPLES_CTXBENCH_MAXTHREADS
+#  define CONFIG_EXAMPLES_CTXBENCH_MAXTHREADS 16
+#endif
+
+#ifndef CONFIG_EXAMPLES_CTXBENCH_PRIORITY
+#  define CONFIG_EXAMPLES_CTXBENCH_PRIORITY 100
+#endif
+
+#ifndef CONFIG_EXAMPLES_CTXBENCH_STACKSIZE
+#  define CONFIG_EXAMPLES_CTXBENCH_STACKSIZE 1024
+#endif
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+static sem_t g_start;
+static sem_t g_ping;
+static sem_t g_pong;
+static volatile unsigned long g_nswitches;
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: ctxbench_now
+ *
+ * Description:
+ *   Return the current time in microseconds.
+ *
+ ****************************************************************************/
+
+static unsigned long ctxbench_now(void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_REALTIME, &ts);
+  return (unsigned long)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+/****************************************************************************
+ * Name: ctxbench_wait
+ ****************************************************************************/
+
+static void ctxbench_wait(FAR sem_t *sem)
+{
+  while (sem_wait(sem) < 0 && errno == EINTR);
+}
+
+/****************************************************************************
+ * Name: ctxbench_setprio
+ *
+ * Description:
+ *   Set the priority of the calling thread.
+ *
+ ****************************************************************************/
+
+static void ctxbench_setprio(int priority)
+{
+  struct sched_param param;
+
+  param.sched_priority = priority;
+  (void)sched_setparam(0, &param);
+}
+
+/****************************************************************************
+ * Name: ctxbench_start
+ *
+ * Description:
+ *   Start a SCHED_FIFO thread at the benchmark priority.
+ *
+ ****************************************************************************/
+
+static int ctxbench_start(FAR pthread_t *thread,
+                          FAR void *(*entry)(FAR void *))
+{
+  struct sched_param param;
+  pthread_attr_t attr;
+  int ret;
+
+  pthread_attr_init(&attr);
+  pthread_attr_setstacksize(&attr, CONFIG_EXAMPLES_CTXBENCH_STACKSIZE);
+  pthread_attr_setschedpolicy(&attr, SCHED_FIFO);
+  param.sched_priority = CONFIG_EXAMPLES_CTXBENCH_PRIORITY;
+  pthread_attr_setschedparam(&attr, &param);
+
+  ret = pthread_create(thread, &attr, entry, NULL);
+  if (ret != 0)
+    {
+      fprintf(stderr, "ERROR: pthread_create failed: %d\n", ret);
+    }
+
+  return ret;
+}
+
+/****************************************************************************
+ * Name: ctxbench_partner
+ *
+ * Description:
+ *   Answer each ping with a pong.
+ *
+ ****************************************************************************/
+
+static FAR void *ctxbench_partner(FAR void *arg)
+{
+  unsigned long i;
+
+  for (i = 0; i < CONFIG_EXAMPLES_CTXBENCH_NSWITCHES / 2; i++)
+    {
+      ctxbench_wait(&g_ping);
+      sem_post(&g_pong);
+    }
+
+  return NULL;
+}
+
+/****************************************************************************
+ * Name: ctxbench_yielder
+ *
+ * Description:
+ *   Yield to the other threads of the same priority until the total
+ *   number of switches has been made.
+ *
+ ****************************************************************************/
+
+static FAR void *ctxbench_yielder(FAR void *arg)
+{
+  ctxbench_wait(&g_start);
+
+  while (g_nswitches < CONFIG_EXAMPLES_CTXBENCH_NSWITCHES)
+    {
+      g_nswitches++;
+      sched_yield();
+    }
+
+  return NULL;
+}
+
+/****************************************************************************
+ * Name: ctxbench_semaphore
+ *
+ * Description:
+ *   Measure the time for a semaphore post to wake a higher priority thread
+ *   and for that thread to block again.  Returns nanoseconds per switch.
+ *
+ ****************************************************************************/
+
+static unsigned long ctxbench_semaphore(void)
+{
+  pthread_t partner;
+  unsigned long start;
+  unsigned long elapsed;
+  unsigned long i;
+
+  sem_init(&g_ping, 0, 0);
+  sem_init(&g_pong, 0, 0);
+
+  /* Run this thread just below the partner */
+
+  ctxbench_setprio(CONFIG_EXAMPLES_CTXBENCH_PRIORITY - 1);
+  if (ctxbench_start(&partner, ctxbench_partner) != 0)
+    {
+      return 0;
+    }
+
+  start = ctxbench_now();
+  for (i = 0; i < CONFIG_EXAMPLES_CTXBENCH_NSWITCHES / 2; i++)
+    {
+      sem_post(&g_ping);
+      ctxbench_wait(&g_pong);
+    }
+
+  elapsed = ctxbench_now() - start;
+  pthread_join(partner, NULL);
+
+  sem_destroy(&g_ping);
+  sem_destroy(&g_pong);
+
+  return elapsed / (CONFIG_EXAMPLES_CTXBENCH_NSWITCHES / 1000);
+}
+
+/****************************************************************************
+ * Name: ctxbench_yield
+ *
+ * Description:
+ *   Measure the time for sched_yield() to switch among 'nthreads' threads
+ *   of the same priority.  Each yield moves the running thread behind all
+ *   of the others in the ready-to-run list.  Returns nanoseconds per
+ *   switch.
+ *
+ ****************************************************************************/
+
+static unsigned long ctxbench_yield(int nthreads)
+{
+  pthread_t threads[CONFIG_EXAMPLES_CTXBENCH_MAXTHREADS];
+  unsigned long start;
+  unsigned long elapsed;
+  int nstarted;
+  int i;
+
+  sem_init(&g_start, 0, 0);
+  g_nswitches = 0;
+
+  /* Run above the threads until all of them have been started */
+
+  ctxbench_setprio(CONFIG_EXAMPLES_CTXBENCH_PRIORITY + 1);
+  for (nstarted = 0; nstarted < nthreads; nstarted++)
+    {
+      if (ctxbench_start(&threads[nstarted], ctxbench_yielder) != 0)
+        {
+          break;
+        }
+    }
+
+  for (i = 0; i < nstarted; i++)
+    {
+      sem_post(&g_start);
+    }
+
+  /* Dropping below the threads lets them run.  This thread resumes when
+   * all of them have finished.
+   */
+
+  start = ctxbench_now();
+  ctxbench_setprio(CONFIG_EXAMPLES_CTXBENCH_PRIORITY - 1);
+  elapsed = ctxbench_now() - start;
+
+  for (i = 0; i < nstarted; i++)
+    {
+      pthread_join(threads[i], NULL);
+    }
+
+  sem_destroy(&g_start);
+  return nstarted < nthreads ? 0 :
+         elapsed / (CONFIG_EXAMPLES_CTXBENCH_NSWITCHES / 1000);
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * ctxbench_main
+ ****************************************************************************/
+
+#ifdef CONFIG_BUILD_KERNEL
+int main(int argc, FAR char *argv[])
+#else
+int ctxbench_main(int argc, char *argv[])
+#endif
+{
+  struct sched_param param;
+  int nthreads;
+
+  (void)sched_getparam(0, &param);
+
+#ifdef CONFIG_SCHED_PRIOBITMAP
+  printf("Ready-to-run list: priority indexed\n");
+#else
+  printf("Ready-to-run list: linear search\n");
+#endif
+  printf("%d switches per measurement\n\n",
+         CONFIG_EXAMPLES_CTXBENCH_NSWITCHES);
+
+  printf("semaphore wake/block:     %6lu nsec/switch\n",
+         ctxbench_semaphore());
+
+  for (nthreads = 2;
+       nthreads <= CONFIG_EXAMPLES_CTXBENCH_MAXTHREADS;
+       nthreads <<= 1)
+    {
+      printf("sched_yield, %3d threads: %6lu nsec/switch\n",
+             nthreads, ctxbench_yield(nthreads));
+    }
+
+  ctxbench_setprio(param.sched_priority);
+  return 0;
+}
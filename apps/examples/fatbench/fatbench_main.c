@@ -0,0 +1,736 @@
+/****************************************************************************
+ * examples/fatbench/fatbench_main.c
+ *
+ *   Copyright (C) 2014 Gregory Nutt. All rights reserved.
+ *   Author: Gregory Nutt <gnutt@nuttx.org>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name NuttX nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <sys/types.h>
+#include <sys/ioctl.h>
+#include <sys/mount.h>
+#include <sys/stat.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <dirent.h>
+#include <time.h>
+#include <errno.h>
+
+#include <nuttx/fs/fs.h>
+#include <nuttx/fs/mkfatfs.h>
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+/* Configuration ************************************************************/
+
+#ifndef CONFIG_EXAMPLES_FATBENCH_DEVPATH
+#  define CONFIG_EXAMPLES_FATBENCH_DEVPATH "/dev/ram0"
+#endif
+
+#ifndef CONFIG_EXAMPLES_FATBENCH_MOUNTPT
+#  define CONFIG_EXAMPLES_FATBENCH_MOUNTPT "/mnt/fatbench"
+#endif
+
+#ifndef CONFIG_EXAMPLES_FATBENCH_NFILES
+#  define CONFIG_EXAMPLES_FATBENCH_NFILES 32
+#endif
+
+#ifndef CONFIG_EXAMPLES_FATBENCH_FILESIZE
+#  define CONFIG_EXAMPLES_FATBENCH_FILESIZE 262144
+#endif
+
+#ifndef CONFIG_FAT_NSECTORCACHE
+#  define CONFIG_FAT_NSECTORCACHE 4
+#endif
+
+#ifndef CONFIG_FAT_NCLUSTERRUNS
+#  define CONFIG_FAT_NCLUSTERRUNS 4
+#endif
+
+#define FATBENCH_BLKDEV  "/dev/fatbench"
+
+#define MOUNTPT          CONFIG_EXAMPLES_FATBENCH_MOUNTPT
+#define FATBENCH_DIR     MOUNTPT "/dir"
+#define FATBENCH_LOG     MOUNTPT "/log.txt"
+#define FATBENCH_BIG     MOUNTPT "/big.bin"
+#define FATBENCH_STREAM  MOUNTPT "/stream.bin"
+
+#define FATBENCH_BLOCK   512   /* Size of the writes to the large file */
+#define FATBENCH_RECORD  64    /* Size of the log records */
+#define FATBENCH_NRECORDS 1000 /* Number of log records */
+#define FATBENCH_LISTRATE 50   /* Records between directory listings */
+#define FATBENCH_SYNCRATE 10   /* Records between fsync() */
+#define FATBENCH_LOGRATE  8    /* Large file blocks between log records */
+#define FATBENCH_NREADS   1000 /* Number of random reads */
+#define FATBENCH_READSIZE 16   /* Size of each random read */
+#define FATBENCH_CHUNK    4096 /* Size of the writes to the streamed file */
+
+/****************************************************************************
+ * Private Types
+ ****************************************************************************/
+
+/* The block device is wrapped in this block driver that counts the reads
+ * and writes that reach it.  The file system is created and mounted on
+ * the wrapper.
+ */
+
+struct fatbench_dev_s
+{
+  FAR struct inode *lower;      /* The block device */
+  unsigned long nreads;         /* Number of read calls */
+  unsigned long nrdsectors;     /* Number of sectors read */
+  unsigned long nwrites;        /* Number of write calls */
+  unsigned long nwrsectors;     /* Number of sectors written */
+};
+
+/****************************************************************************
+ * Private Function Prototypes
+ ****************************************************************************/
+
+static int     fatbench_open(FAR struct inode *inode);
+static int     fatbench_close(FAR struct inode *inode);
+static ssize_t fatbench_read(FAR struct inode *inode,
+                             FAR unsigned char *buffer, size_t start_sector,
+                             unsigned int nsectors);
+static ssize_t fatbench_write(FAR struct inode *inode,
+                              FAR const unsigned char *buffer,
+                              size_t start_sector, unsigned int nsectors);
+static int     fatbench_geometry(FAR struct inode *inode,
+                                 FAR struct geometry *geometry);
+static int     fatbench_ioctl(FAR struct inode *inode, int cmd,
+                              unsigned long arg);
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+static const struct block_operations g_bops =
+{
+  fatbench_open,     /* open     */
+  fatbench_close,    /* close    */
+  fatbench_read,     /* read     */
+  fatbench_write,    /* write    */
+  fatbench_geometry, /* geometry */
+  fatbench_ioctl     /* ioctl    */
+};
+
+static struct fatbench_dev_s g_dev;
+
+static uint8_t g_buffer[FATBENCH_BLOCK];
+static uint8_t g_chunk[FATBENCH_CHUNK];
+static uint32_t g_seed = 1;
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: fatbench_now
+ *
+ * Description:
+ *   Return the current time in microseconds.
+ *
+ ****************************************************************************/
+
+static unsigned long fatbench_now(void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_REALTIME, &ts);
+  return (unsigned long)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+/****************************************************************************
+ * Name: fatbench_open, fatbench_close, fatbench_read, fatbench_write,
+ *       fatbench_geometry, and fatbench_ioctl
+ *
+ * Description:
+ *   The block driver methods of the counting wrapper.  Reads and writes
+ *   are counted, all operations are passed on to the block device.
+ *
+ ****************************************************************************/
+
+static int fatbench_open(FAR struct inode *inode)
+{
+  FAR struct inode *lower = g_dev.lower;
+  return lower->u.i_bops->open ? lower->u.i_bops->open(lower) : OK;
+}
+
+static int fatbench_close(FAR struct inode *inode)
+{
+  FAR struct inode *lower = g_dev.lower;
+  return lower->u.i_bops->close ? lower->u.i_bops->close(lower) : OK;
+}
+
+static ssize_t fatbench_read(FAR struct inode *inode,
+                             FAR unsigned char *buffer, size_t start_sector,
+                             unsigned int nsectors)
+{
+  FAR struct inode *lower = g_dev.lower;
+  ssize_t ret;
+
+  ret = lower->u.i_bops->read(lower, buffer, start_sector, nsectors);
+  if (ret > 0)
+    {
+      g_dev.nreads++;
+      g_dev.nrdsectors += ret;
+    }
+
+  return ret;
+}
+
+static ssize_t fatbench_write(FAR struct inode *inode,
+                              FAR const unsigned char *buffer,
+                              size_t start_sector, unsigned int nsectors)
+{
+  FAR struct inode *lower = g_dev.lower;
+  ssize_t ret;
+
+  ret = lower->u.i_bops->write(lower, buffer, start_sector, nsectors);
+  if (ret > 0)
+    {
+      g_dev.nwrites++;
+      g_dev.nwrsectors += ret;
+    }
+
+  return ret;
+}
+
+static int fatbench_geometry(FAR struct inode *inode,
+                             FAR struct geometry *geometry)
+{
+  FAR struct inode *lower = g_dev.lower;
+  return lower->u.i_bops->geometry(lower, geometry);
+}
+
+static int fatbench_ioctl(FAR struct inode *inode, int cmd,
+                          unsigned long arg)
+{
+  FAR struct inode *lower = g_dev.lower;
+  return lower->u.i_bops->ioctl ? lower->u.i_bops->ioctl(lower, cmd, arg) :
+                                  -ENOTTY;
+}
+
+/****************************************************************************
+ * Name: fatbench_setup
+ *
+ * Description:
+ *   Open the block device and register the counting wrapper around it.
+ *
+ ****************************************************************************/
+
+static int fatbench_setup(void)
+{
+  int ret;
+
+  ret = open_blockdriver(CONFIG_EXAMPLES_FATBENCH_DEVPATH, 0, &g_dev.lower);
+  if (ret < 0)
+    {
+      printf("fatbench: open_blockdriver %s failed: %d\n",
+             CONFIG_EXAMPLES_FATBENCH_DEVPATH, ret);
+      return ret;
+    }
+
+  ret = register_blockdriver(FATBENCH_BLKDEV, &g_bops, 0666, &g_dev);
+  if (ret < 0)
+    {
+      printf("fatbench: register_blockdriver failed: %d\n", ret);
+      (void)close_blockdriver(g_dev.lower);
+      return ret;
+    }
+
+  return OK;
+}
+
+/****************************************************************************
+ * Name: fatbench_teardown
+ *
+ * Description:
+ *   Remove the counting wrapper and close the block device.
+ *
+ ****************************************************************************/
+
+static void fatbench_teardown(void)
+{
+  (void)unregister_blockdriver(FATBENCH_BLKDEV);
+  (void)close_blockdriver(g_dev.lower);
+  g_dev.lower = NULL;
+}
+
+/****************************************************************************
+ * Name: fatbench_reset
+ *
+ * Description:
+ *   Clear the read and write counts.
+ *
+ ****************************************************************************/
+
+static void fatbench_reset(void)
+{
+  g_dev.nreads     = 0;
+  g_dev.nrdsectors = 0;
+  g_dev.nwrites    = 0;
+  g_dev.nwrsectors = 0;
+}
+
+/****************************************************************************
+ * Name: fatbench_rand
+ ****************************************************************************/
+
+static uint32_t fatbench_rand(void)
+{
+  g_seed = g_seed * 1103515245 + 12345;
+  return g_seed >> 8;
+}
+
+/****************************************************************************
+ * Name: fatbench_report
+ *
+ * Description:
+ *   Print the block device reads and writes and the time of one phase.
+ *   The time is only as precise as the system clock; the counts show the
+ *   effect of the sector and cluster run caches even where the time does
+ *   not.
+ *
+ ****************************************************************************/
+
+static void fatbench_report(FAR const char *name, unsigned long elapsed)
+{
+  printf("%-28s %7lu %8lu %7lu %8lu %10lu\n", name,
+         g_dev.nreads, g_dev.nrdsectors, g_dev.nwrites, g_dev.nwrsectors,
+         elapsed);
+}
+
+/****************************************************************************
+ * Name: fatbench_listdir
+ *
+ * Description:
+ *   Read all entries of the directory and return their number.
+ *
+ ****************************************************************************/
+
+static int fatbench_listdir(void)
+{
+  FAR DIR *dir;
+  int nentries = 0;
+
+  dir = opendir(FATBENCH_DIR);
+  if (dir == NULL)
+    {
+      printf("fatbench: opendir failed: %d\n", errno);
+      return -1;
+    }
+
+  while (readdir(dir) != NULL)
+    {
+      nentries++;
+    }
+
+  (void)closedir(dir);
+  return nentries;
+}
+
+/****************************************************************************
+ * Name: fatbench_append
+ *
+ * Description:
+ *   Append one record to the log file.
+ *
+ ****************************************************************************/
+
+static int fatbench_append(int fd, int recno, bool sync)
+{
+  char record[FATBENCH_RECORD];
+
+  memset(record, ' ', FATBENCH_RECORD);
+  snprintf(record, FATBENCH_RECORD, "record %d", recno);
+  record[FATBENCH_RECORD - 1] = '\n';
+
+  if (write(fd, record, FATBENCH_RECORD) != FATBENCH_RECORD)
+    {
+      printf("fatbench: write failed: %d\n", errno);
+      return -1;
+    }
+
+  return sync ? fsync(fd) : 0;
+}
+
+/****************************************************************************
+ * Name: fatbench_makedir
+ ****************************************************************************/
+
+static int fatbench_makedir(void)
+{
+  unsigned long start;
+  char path[64];
+  int fd;
+  int i;
+
+  if (mkdir(FATBENCH_DIR, 0777) < 0)
+    {
+      printf("fatbench: mkdir failed: %d\n", errno);
+      return -1;
+    }
+
+  fatbench_reset();
+  start = fatbench_now();
+  for (i = 0; i < CONFIG_EXAMPLES_FATBENCH_NFILES; i++)
+    {
+      snprintf(path, sizeof(path), FATBENCH_DIR "/file%03d.txt", i);
+      fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0666);
+      if (fd < 0)
+        {
+          printf("fatbench: open %s failed: %d\n", path, errno);
+          return -1;
+        }
+
+      (void)write(fd, path, strlen(path));
+      (void)close(fd);
+    }
+
+  fatbench_report("create files", fatbench_now() - start);
+  return 0;
+}
+
+/****************************************************************************
+ * Name: fatbench_logging
+ *
+ * Description:
+ *   Append records to the log file while the directory is listed.  With a
+ *   single cached sector, the FAT, directory, and log sectors replace each
+ *   other in the cache.
+ *
+ ****************************************************************************/
+
+static int fatbench_logging(void)
+{
+  unsigned long start;
+  int ret = 0;
+  int fd;
+  int i;
+
+  fd = open(FATBENCH_LOG, O_WRONLY | O_CREAT | O_APPEND, 0666);
+  if (fd < 0)
+    {
+      printf("fatbench: open %s failed: %d\n", FATBENCH_LOG, errno);
+      return -1;
+    }
+
+  fatbench_reset();
+  start = fatbench_now();
+  for (i = 0; i < FATBENCH_NRECORDS && ret == 0; i++)
+    {
+      ret = fatbench_append(fd, i, (i % FATBENCH_SYNCRATE) == 0);
+      if (ret == 0 && (i % FATBENCH_LISTRATE) == 0 &&
+          fatbench_listdir() != CONFIG_EXAMPLES_FATBENCH_NFILES)
+        {
+          printf("fatbench: ERROR: Wrong number of directory entries\n");
+          ret = -1;
+        }
+    }
+
+  (void)close(fd);
+  fatbench_report("append log + list directory", fatbench_now() - start);
+  return ret;
+}
+
+/****************************************************************************
+ * Name: fatbench_bigfile
+ *
+ * Description:
+ *   Write the large file.  Log records are appended at the same time so
+ *   that the cluster chain of the large file is fragmented.
+ *
+ ****************************************************************************/
+
+static int fatbench_bigfile(void)
+{
+  unsigned long start;
+  int logfd;
+  int fd;
+  int ret = 0;
+  int i;
+
+  fd = open(FATBENCH_BIG, O_WRONLY | O_CREAT | O_TRUNC, 0666);
+  if (fd < 0)
+    {
+      printf("fatbench: open %s failed: %d\n", FATBENCH_BIG, errno);
+      return -1;
+    }
+
+  logfd = open(FATBENCH_LOG, O_WRONLY | O_APPEND);
+  if (logfd < 0)
+    {
+      printf("fatbench: open %s failed: %d\n", FATBENCH_LOG, errno);
+      (void)close(fd);
+      return -1;
+    }
+
+  fatbench_reset();
+  start = fatbench_now();
+  for (i = 0;
+       i < CONFIG_EXAMPLES_FATBENCH_FILESIZE / FATBENCH_BLOCK && ret == 0;
+       i++)
+    {
+      /* Each block holds its block number */
+
+      memset(g_buffer, i & 0xff, FATBENCH_BLOCK);
+      if (write(fd, g_buffer, FATBENCH_BLOCK) != FATBENCH_BLOCK)
+        {
+          printf("fatbench: write failed: %d\n", errno);
+          ret = -1;
+        }
+      else if ((i % FATBENCH_LOGRATE) == 0)
+        {
+          ret = fatbench_append(logfd, i, true);
+        }
+    }
+
+  (void)close(logfd);
+  (void)close(fd);
+  fatbench_report("write large file", fatbench_now() - start);
+  return ret;
+}
+
+/****************************************************************************
+ * Name: fatbench_seekread
+ *
+ * Description:
+ *   Read from random positions of the large file.
+ *
+ ****************************************************************************/
+
+static int fatbench_seekread(void)
+{
+  unsigned long start;
+  off_t block;
+  int nblocks = CONFIG_EXAMPLES_FATBENCH_FILESIZE / FATBENCH_BLOCK;
+  int ret = 0;
+  int fd;
+  int i;
+  int j;
+
+  fd = open(FATBENCH_BIG, O_RDONLY);
+  if (fd < 0)
+    {
+      printf("fatbench: open %s failed: %d\n", FATBENCH_BIG, errno);
+      return -1;
+    }
+
+  fatbench_reset();
+  start = fatbench_now();
+  for (i = 0; i < FATBENCH_NREADS && ret == 0; i++)
+    {
+      block = fatbench_rand() % nblocks;
+      if (lseek(fd, block * FATBENCH_BLOCK + 1, SEEK_SET) < 0 ||
+          read(fd, g_buffer, FATBENCH_READSIZE) != FATBENCH_READSIZE)
+        {
+          printf("fatbench: lseek/read failed: %d\n", errno);
+          ret = -1;
+          break;
+        }
+
+      for (j = 0; j < FATBENCH_READSIZE; j++)
+        {
+          if (g_buffer[j] != (block & 0xff))
+            {
+              printf("fatbench: ERROR: Bad data in block %ld\n",
+                     (long)block);
+              ret = -1;
+              break;
+            }
+        }
+    }
+
+  (void)close(fd);
+  fatbench_report("random lseek + read", fatbench_now() - start);
+  return ret;
+}
+
+/****************************************************************************
+ * Name: fatbench_stream
+ *
+ * Description:
+ *   Write a file in large chunks while log records are appended.  If
+ *   'prealloc' is true, the clusters of the file are reserved first with
+ *   FIOC_FALLOCATE so that the file stays contiguous and each chunk goes
+ *   to the block driver in a single transfer.
+ *
+ ****************************************************************************/
+
+static int fatbench_stream(bool prealloc)
+{
+  unsigned long start;
+  off_t length = CONFIG_EXAMPLES_FATBENCH_FILESIZE;
+  int logfd;
+  int fd;
+  int ret = 0;
+  int i;
+
+  fd = open(FATBENCH_STREAM, O_WRONLY | O_CREAT | O_TRUNC, 0666);
+  if (fd < 0)
+    {
+      printf("fatbench: open %s failed: %d\n", FATBENCH_STREAM, errno);
+      return -1;
+    }
+
+  logfd = open(FATBENCH_LOG, O_WRONLY | O_APPEND);
+  if (logfd < 0)
+    {
+      printf("fatbench: open %s failed: %d\n", FATBENCH_LOG, errno);
+      (void)close(fd);
+      return -1;
+    }
+
+  memset(g_chunk, 0xa5, FATBENCH_CHUNK);
+
+  fatbench_reset();
+  start = fatbench_now();
+  if (prealloc &&
+      ioctl(fd, FIOC_FALLOCATE, (unsigned long)((uintptr_t)&length)) < 0)
+    {
+      printf("fatbench: FIOC_FALLOCATE failed: %d\n", errno);
+      ret = -1;
+    }
+
+  for (i = 0;
+       i < CONFIG_EXAMPLES_FATBENCH_FILESIZE / FATBENCH_CHUNK && ret == 0;
+       i++)
+    {
+      if (write(fd, g_chunk, FATBENCH_CHUNK) != FATBENCH_CHUNK)
+        {
+          printf("fatbench: write failed: %d\n", errno);
+          ret = -1;
+        }
+      else
+        {
+          ret = fatbench_append(logfd, i, false);
+        }
+    }
+
+  (void)close(logfd);
+  (void)close(fd);
+  fatbench_report(prealloc ? "stream write (fallocate)" : "stream write",
+                  fatbench_now() - start);
+
+  (void)unlink(FATBENCH_STREAM);
+  return ret;
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * fatbench_main
+ ****************************************************************************/
+
+#ifdef CONFIG_BUILD_KERNEL
+int main(int argc, FAR char *argv[])
+#else
+int fatbench_main(int argc, char *argv[])
+#endif
+{
+  struct fat_format_s fmt = FAT_FORMAT_INITIALIZER;
+  int ret;
+
+  printf("FAT_NSECTORCACHE=%d FAT_NCLUSTERRUNS=%d\n\n",
+         CONFIG_FAT_NSECTORCACHE, CONFIG_FAT_NCLUSTERRUNS);
+
+  /* Start with an empty file system */
+
+  ret = fatbench_setup();
+  if (ret < 0)
+    {
+      return 1;
+    }
+
+  ret = mkfatfs(FATBENCH_BLKDEV, &fmt);
+  if (ret < 0)
+    {
+      printf("fatbench: mkfatfs %s failed: %d\n",
+             CONFIG_EXAMPLES_FATBENCH_DEVPATH, errno);
+      fatbench_teardown();
+      return 1;
+    }
+
+  ret = mount(FATBENCH_BLKDEV, MOUNTPT, "vfat", 0, NULL);
+  if (ret < 0)
+    {
+      printf("fatbench: mount failed: %d\n", errno);
+      fatbench_teardown();
+      return 1;
+    }
+
+  printf("%-28s %7s %8s %7s %8s %10s\n", "", "reads", "sectors",
+         "writes", "sectors", "usec");
+
+  ret = fatbench_makedir();
+  if (ret == 0)
+    {
+      ret = fatbench_logging();
+    }
+
+  if (ret == 0)
+    {
+      ret = fatbench_bigfile();
+    }
+
+  if (ret == 0)
+    {
+      ret = fatbench_seekread();
+    }
+
+  if (ret == 0)
+    {
+      ret = fatbench_stream(false);
+    }
+
+  if (ret == 0)
+    {
+      ret = fatbench_stream(true);
+    }
+
+  (void)umount(MOUNTPT);
+  fatbench_teardown();
+  return ret == 0 ? 0 : 1;
+}
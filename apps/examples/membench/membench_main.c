@@ -0,0 +1,392 @@
+/****************************************************************************
+ * examples/membench/membench_main.c
+ *
+ *   Copyright (C) 2014 Gregory Nutt. All rights reserved.
+ *   Author: Gregory Nutt <gnutt@nuttx.org>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name NuttX nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <sys/types.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+/* Configuration ************************************************************/
+
+#ifndef CONFIG_EXAMPLES_MEMBENCH_MAXSIZE
+#  define CONFIG_EXAMPLES_MEMBENCH_MAXSIZE 4096
+#endif
+
+#ifndef CONFIG_EXAMPLES_MEMBENCH_NBYTES
+#  define CONFIG_EXAMPLES_MEMBENCH_NBYTES 1048576
+#endif
+
+/* Room for the misalignment offsets and the overlapping memmove() */
+
+#define MEMBENCH_SLACK   16
+#define MEMBENCH_BUFSIZE (CONFIG_EXAMPLES_MEMBENCH_MAXSIZE + MEMBENCH_SLACK)
+
+/* Minimum number of repetitions of each operation */
+
+#define MEMBENCH_MINREPS 16
+
+/* The functions are verified for all sizes up to this and for source and
+ * destination offsets up to 7 and 3 bytes.
+ */
+
+#if CONFIG_EXAMPLES_MEMBENCH_MAXSIZE < 64
+#  define MEMBENCH_VERIFYSIZE CONFIG_EXAMPLES_MEMBENCH_MAXSIZE
+#else
+#  define MEMBENCH_VERIFYSIZE 64
+#endif
+
+/****************************************************************************
+ * Private Types
+ ****************************************************************************/
+
+/* One source/destination alignment case */
+
+struct membench_align_s
+{
+  FAR const char *name;  /* Description of the case */
+  uint8_t srcoff;        /* Source offset from an aligned address */
+  uint8_t destoff;       /* Destination offset from an aligned address */
+};
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+static const struct membench_align_s g_align[] =
+{
+  { "aligned", 0, 0 },
+  { "src+1",   1, 0 },
+  { "src+3",   3, 1 },
+};
+
+#define NALIGN ((int)(sizeof(g_align) / sizeof(struct membench_align_s)))
+
+/* The functions are called through pointers so that the compiler cannot
+ * replace them with its own built-in versions.
+ */
+
+static FAR void *(*volatile g_memcpy)(FAR void *, FAR const void *, size_t) =
+  memcpy;
+static FAR void *(*volatile g_memmove)(FAR void *, FAR const void *, size_t) =
+  memmove;
+static int (*volatile g_memcmp)(FAR const void *, FAR const void *, size_t) =
+  memcmp;
+
+static volatile int g_result;
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: membench_now
+ *
+ * Description:
+ *   Return the current time in microseconds.
+ *
+ ****************************************************************************/
+
+static unsigned long membench_now(void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_REALTIME, &ts);
+  return (unsigned long)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+/****************************************************************************
+ * Name: membench_rate
+ *
+ * Description:
+ *   Convert 'nreps' operations on 'size' bytes in 'elapsed' microseconds to
+ *   a throughput in KB/s.
+ *
+ ****************************************************************************/
+
+static unsigned long membench_rate(size_t size, unsigned long nreps,
+                                   unsigned long elapsed)
+{
+  if (elapsed == 0)
+    {
+      elapsed = 1;
+    }
+
+  return (unsigned long)(((uint64_t)size * nreps * 1000000 / 1024) /
+                         elapsed);
+}
+
+/****************************************************************************
+ * Name: membench_memcpy, membench_memmove, membench_memcmp
+ *
+ * Description:
+ *   Repeat the operation 'nreps' times and return the throughput in KB/s.
+ *
+ ****************************************************************************/
+
+static unsigned long membench_memcpy(FAR uint8_t *dest,
+                                     FAR const uint8_t *src, size_t size,
+                                     unsigned long nreps)
+{
+  unsigned long start = membench_now();
+  unsigned long i;
+
+  for (i = 0; i < nreps; i++)
+    {
+      g_memcpy(dest, src, size);
+    }
+
+  return membench_rate(size, nreps, membench_now() - start);
+}
+
+static unsigned long membench_memmove(FAR uint8_t *dest,
+                                      FAR const uint8_t *src, size_t size,
+                                      unsigned long nreps)
+{
+  unsigned long start = membench_now();
+  unsigned long i;
+
+  for (i = 0; i < nreps; i++)
+    {
+      g_memmove(dest, src, size);
+    }
+
+  return membench_rate(size, nreps, membench_now() - start);
+}
+
+static unsigned long membench_memcmp(FAR const uint8_t *s1,
+                                     FAR const uint8_t *s2, size_t size,
+                                     unsigned long nreps)
+{
+  unsigned long start = membench_now();
+  unsigned long i;
+
+  for (i = 0; i < nreps; i++)
+    {
+      g_result = g_memcmp(s1, s2, size);
+    }
+
+  return membench_rate(size, nreps, membench_now() - start);
+}
+
+/****************************************************************************
+ * Name: membench_verify
+ *
+ * Description:
+ *   Check memcpy(), memmove(), and memcmp() results for the given size and
+ *   offsets against simple byte loops.  Returns the number of errors.
+ *
+ ****************************************************************************/
+
+static int membench_verify(FAR uint8_t *buf1, FAR uint8_t *buf2,
+                           size_t size, int srcoff, int destoff)
+{
+  FAR uint8_t *src = buf1 + srcoff;
+  FAR uint8_t *dest = buf2 + destoff;
+  int errors = 0;
+  int result;
+  size_t i;
+
+  for (i = 0; i < MEMBENCH_BUFSIZE; i++)
+    {
+      buf1[i] = (uint8_t)(i * 7 + 1);
+      buf2[i] = 0;
+    }
+
+  g_memcpy(dest, src, size);
+  for (i = 0; i < size; i++)
+    {
+      if (dest[i] != src[i])
+        {
+          errors++;
+          break;
+        }
+    }
+
+  if (buf2[destoff + size] != 0 || (destoff > 0 && buf2[destoff - 1] != 0))
+    {
+      errors++;
+    }
+
+  /* A difference in the last byte must be found with the correct sign */
+
+  if (size > 0)
+    {
+      result = g_memcmp(dest, src, size);
+      dest[size - 1]--;
+      if (result != 0 || g_memcmp(dest, src, size) >= 0 ||
+          g_memcmp(src, dest, size) <= 0)
+        {
+          errors++;
+        }
+    }
+
+  /* Overlapping move up by one byte.  Each byte takes the value of the
+   * byte below it.
+   */
+
+  g_memmove(src + 1, src, size);
+  for (i = 0; i < size; i++)
+    {
+      if (src[i + 1] != (uint8_t)((srcoff + i) * 7 + 1))
+        {
+          errors++;
+          break;
+        }
+    }
+
+  if (errors > 0)
+    {
+      printf("membench: ERROR: size=%lu src+%d dest+%d\n",
+             (unsigned long)size, srcoff, destoff);
+    }
+
+  return errors;
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: membench_main
+ ****************************************************************************/
+
+#ifdef CONFIG_BUILD_KERNEL
+int main(int argc, FAR char *argv[])
+#else
+int membench_main(int argc, char *argv[])
+#endif
+{
+  FAR uint8_t *buf1;
+  FAR uint8_t *buf2;
+  FAR const struct membench_align_s *align;
+  unsigned long nreps;
+  unsigned long cpy;
+  unsigned long move;
+  unsigned long cmp;
+  size_t size;
+  int errors = 0;
+  int srcoff;
+  int destoff;
+  int i;
+
+  /* malloc() returns memory that is aligned for any native type */
+
+  buf1 = (FAR uint8_t *)malloc(MEMBENCH_BUFSIZE);
+  buf2 = (FAR uint8_t *)malloc(MEMBENCH_BUFSIZE);
+  if (buf1 == NULL || buf2 == NULL)
+    {
+      printf("membench: ERROR: Failed to allocate buffers\n");
+      free(buf1);
+      free(buf2);
+      return 1;
+    }
+
+  /* First make sure that the functions work at all */
+
+  for (size = 0; size <= MEMBENCH_VERIFYSIZE; size++)
+    {
+      for (srcoff = 0; srcoff < 8; srcoff++)
+        {
+          for (destoff = 0; destoff < 4; destoff++)
+            {
+              errors += membench_verify(buf1, buf2, size, srcoff, destoff);
+            }
+        }
+    }
+
+  if (errors > 0)
+    {
+      goto errout;
+    }
+
+  memset(buf1, 0x5a, MEMBENCH_BUFSIZE);
+  memset(buf2, 0x5a, MEMBENCH_BUFSIZE);
+
+  printf("membench: throughput in KB/s, %lu bytes per measurement\n",
+         (unsigned long)CONFIG_EXAMPLES_MEMBENCH_NBYTES);
+  printf("%6s %-8s %10s %10s %10s %10s\n",
+         "Size", "Align", "memcpy", "memmove", "overlap", "memcmp");
+
+  for (size = 1; size <= CONFIG_EXAMPLES_MEMBENCH_MAXSIZE; size <<= 1)
+    {
+      nreps = CONFIG_EXAMPLES_MEMBENCH_NBYTES / size;
+      if (nreps < MEMBENCH_MINREPS)
+        {
+          nreps = MEMBENCH_MINREPS;
+        }
+
+      for (i = 0; i < NALIGN; i++)
+        {
+          align = &g_align[i];
+
+          cpy  = membench_memcpy(buf2 + align->destoff,
+                                 buf1 + align->srcoff, size, nreps);
+          move = membench_memmove(buf2 + align->destoff,
+                                  buf1 + align->srcoff, size, nreps);
+          cmp  = membench_memcmp(buf2 + align->destoff,
+                                 buf1 + align->srcoff, size, nreps);
+
+          printf("%6lu %-8s %10lu %10lu ",
+                 (unsigned long)size, align->name, cpy, move);
+
+          /* The overlapping move shifts the buffer up by a few bytes, which
+           * must be done from the top down.
+           */
+
+          move = membench_memmove(buf1 + align->srcoff + 4,
+                                  buf1 + align->srcoff, size, nreps);
+
+          printf("%10lu %10lu\n", move, cmp);
+        }
+    }
+
+errout:
+  free(buf1);
+  free(buf2);
+  return errors > 0 ? 1 : 0;
+}
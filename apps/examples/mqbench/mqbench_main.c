@@ -0,0 +1,350 @@
+/****************************************************************************
+ * examples/mqbench/mqbench_main.c
+ *
+ *   Copyright (C) 2014 Gregory Nutt. All rights reserved.
+ *   Author: Gregory Nutt <gnutt@nuttx.org>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name NuttX nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <sys/types.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <limits.h>
+#include <fcntl.h>
+#include <mqueue.h>
+#include <time.h>
+#include <errno.h>
+
+#ifdef CONFIG_MQ_ZEROCOPY
+#  include <nuttx/mqueue.h>
+#  include <nuttx/mm/mempool.h>
+#endif
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+/* Configuration ************************************************************/
+
+#ifndef CONFIG_EXAMPLES_MQBENCH_NMSGS
+#  define CONFIG_EXAMPLES_MQBENCH_NMSGS 10000
+#endif
+
+#ifndef CONFIG_EXAMPLES_MQBENCH_MAXSIZE
+#  define CONFIG_EXAMPLES_MQBENCH_MAXSIZE 4096
+#endif
+
+#ifndef CONFIG_EXAMPLES_MQBENCH_QDEPTH
+#  define CONFIG_EXAMPLES_MQBENCH_QDEPTH 32
+#endif
+
+#ifndef CONFIG_MQ_MAXMSGSIZE
+#  define CONFIG_MQ_MAXMSGSIZE 32
+#endif
+
+#define MQBENCH_NAME    "mqbench"
+#define MQBENCH_MINSIZE 16
+
+/* The pool blocks also hold a small message header */
+
+#define MQBENCH_BLOCKSIZE (CONFIG_EXAMPLES_MQBENCH_MAXSIZE + 32)
+#define MQBENCH_NBLOCKS   4
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+static uint8_t g_sendbuf[CONFIG_MQ_MAXMSGSIZE];
+static uint8_t g_recvbuf[CONFIG_MQ_MAXMSGSIZE];
+static uint32_t g_seed = 1;
+
+#ifdef CONFIG_MQ_ZEROCOPY
+static struct mempool_s g_pool;
+#endif
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: mqbench_now
+ *
+ * Description:
+ *   Return the current time in microseconds.
+ *
+ ****************************************************************************/
+
+static unsigned long mqbench_now(void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_REALTIME, &ts);
+  return (unsigned long)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+/****************************************************************************
+ * Name: mqbench_rand
+ ****************************************************************************/
+
+static uint32_t mqbench_rand(void)
+{
+  g_seed = g_seed * 1103515245 + 12345;
+  return g_seed >> 8;
+}
+
+/****************************************************************************
+ * Name: mqbench_open
+ ****************************************************************************/
+
+static mqd_t mqbench_open(int maxmsg, int msgsize)
+{
+  struct mq_attr attr;
+  mqd_t mqd;
+
+  attr.mq_maxmsg  = maxmsg;
+  attr.mq_msgsize = msgsize;
+  attr.mq_flags   = 0;
+
+  mqd = mq_open(MQBENCH_NAME, O_RDWR | O_CREAT, 0666, &attr);
+  if (mqd == (mqd_t)-1)
+    {
+      printf("mqbench: mq_open failed: %d\n", errno);
+    }
+
+  return mqd;
+}
+
+/****************************************************************************
+ * Name: mqbench_close
+ ****************************************************************************/
+
+static void mqbench_close(mqd_t mqd)
+{
+  (void)mq_close(mqd);
+  (void)mq_unlink(MQBENCH_NAME);
+}
+
+/****************************************************************************
+ * Name: mqbench_copy
+ *
+ * Description:
+ *   Return the nanoseconds taken by one mq_send()/mq_receive() pair.
+ *
+ ****************************************************************************/
+
+static unsigned long mqbench_copy(size_t msgsize)
+{
+  unsigned long start;
+  unsigned long elapsed;
+  mqd_t mqd;
+  int i;
+
+  mqd = mqbench_open(1, msgsize);
+  if (mqd == (mqd_t)-1)
+    {
+      return 0;
+    }
+
+  start = mqbench_now();
+  for (i = 0; i < CONFIG_EXAMPLES_MQBENCH_NMSGS; i++)
+    {
+      (void)mq_send(mqd, (FAR const char *)g_sendbuf, msgsize, 0);
+      (void)mq_receive(mqd, (FAR char *)g_recvbuf, msgsize, NULL);
+    }
+
+  elapsed = mqbench_now() - start;
+  mqbench_close(mqd);
+
+  return (unsigned long)((uint64_t)elapsed * 1000 /
+                         CONFIG_EXAMPLES_MQBENCH_NMSGS);
+}
+
+/****************************************************************************
+ * Name: mqbench_zerocopy
+ *
+ * Description:
+ *   Return the nanoseconds taken to allocate, send, receive, and free one
+ *   buffer of a zero-copy message queue.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_MQ_ZEROCOPY
+static unsigned long mqbench_zerocopy(size_t msgsize)
+{
+  unsigned long start;
+  unsigned long elapsed;
+  FAR void *buf;
+  mqd_t mqd;
+  int i;
+
+  mqd = mqbench_open(1, MQBENCH_MINSIZE);
+  if (mqd == (mqd_t)-1)
+    {
+      return 0;
+    }
+
+  if (mq_setpool(mqd, &g_pool) < 0)
+    {
+      printf("mqbench: mq_setpool failed: %d\n", errno);
+      mqbench_close(mqd);
+      return 0;
+    }
+
+  start = mqbench_now();
+  for (i = 0; i < CONFIG_EXAMPLES_MQBENCH_NMSGS; i++)
+    {
+      buf = mq_bufalloc(mqd);
+      (void)mq_sendbuf(mqd, buf, msgsize, 0);
+      (void)mq_receivebuf(mqd, &buf, NULL);
+      mq_buffree(mqd, buf);
+    }
+
+  elapsed = mqbench_now() - start;
+  mqbench_close(mqd);
+
+  return (unsigned long)((uint64_t)elapsed * 1000 /
+                         CONFIG_EXAMPLES_MQBENCH_NMSGS);
+}
+#endif
+
+/****************************************************************************
+ * Name: mqbench_priority
+ *
+ * Description:
+ *   Keep QDEPTH-1 messages of random priority queued and return the
+ *   nanoseconds taken to send one more message of random priority and to
+ *   receive the message at the head of the queue.
+ *
+ ****************************************************************************/
+
+static unsigned long mqbench_priority(void)
+{
+  unsigned long start;
+  unsigned long elapsed;
+  mqd_t mqd;
+  int i;
+
+  mqd = mqbench_open(CONFIG_EXAMPLES_MQBENCH_QDEPTH, MQBENCH_MINSIZE);
+  if (mqd == (mqd_t)-1)
+    {
+      return 0;
+    }
+
+  for (i = 0; i < CONFIG_EXAMPLES_MQBENCH_QDEPTH - 1; i++)
+    {
+      (void)mq_send(mqd, (FAR const char *)g_sendbuf, MQBENCH_MINSIZE,
+                    mqbench_rand() % (MQ_PRIO_MAX + 1));
+    }
+
+  start = mqbench_now();
+  for (i = 0; i < CONFIG_EXAMPLES_MQBENCH_NMSGS; i++)
+    {
+      (void)mq_send(mqd, (FAR const char *)g_sendbuf, MQBENCH_MINSIZE,
+                    mqbench_rand() % (MQ_PRIO_MAX + 1));
+      (void)mq_receive(mqd, (FAR char *)g_recvbuf, MQBENCH_MINSIZE, NULL);
+    }
+
+  elapsed = mqbench_now() - start;
+  mqbench_close(mqd);
+
+  return (unsigned long)((uint64_t)elapsed * 1000 /
+                         CONFIG_EXAMPLES_MQBENCH_NMSGS);
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * mqbench_main
+ ****************************************************************************/
+
+#ifdef CONFIG_BUILD_KERNEL
+int main(int argc, FAR char *argv[])
+#else
+int mqbench_main(int argc, char *argv[])
+#endif
+{
+  size_t msgsize;
+
+#ifdef CONFIG_MQ_ZEROCOPY
+  if (mempool_initialize(&g_pool, "mqbench", NULL, MQBENCH_BLOCKSIZE,
+                         MQBENCH_NBLOCKS, false) < 0)
+    {
+      printf("mqbench: mempool_initialize failed\n");
+      return 1;
+    }
+#endif
+
+  printf("%d messages per measurement\n\n", CONFIG_EXAMPLES_MQBENCH_NMSGS);
+  printf("%8s %12s %12s\n", "size", "copy", "zero-copy");
+  printf("%8s %12s %12s\n", "(bytes)", "(nsec)", "(nsec)");
+
+  for (msgsize = MQBENCH_MINSIZE;
+       msgsize <= CONFIG_EXAMPLES_MQBENCH_MAXSIZE;
+       msgsize <<= 2)
+    {
+      printf("%8lu ", (unsigned long)msgsize);
+
+      if (msgsize <= CONFIG_MQ_MAXMSGSIZE)
+        {
+          printf("%12lu ", mqbench_copy(msgsize));
+        }
+      else
+        {
+          printf("%12s ", "-");
+        }
+
+#ifdef CONFIG_MQ_ZEROCOPY
+      printf("%12lu\n", mqbench_zerocopy(msgsize));
+#else
+      printf("%12s\n", "-");
+#endif
+    }
+
+#ifdef CONFIG_MQ_PRIOINDEX
+  printf("\nPriority insertion (indexed), ");
+#else
+  printf("\nPriority insertion (list search), ");
+#endif
+  printf("%d messages queued: %lu nsec per send/receive\n",
+         CONFIG_EXAMPLES_MQBENCH_QDEPTH, mqbench_priority());
+
+#ifdef CONFIG_MQ_ZEROCOPY
+  mempool_release(&g_pool);
+#endif
+  return 0;
+}
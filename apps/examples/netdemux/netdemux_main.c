@@ -0,0 +1,330 @@
+/****************************************************************************
+ * examples/netdemux/netdemux_main.c
+ *
+ *   Copyright (C) 2014 Gregory Nutt. All rights reserved.
+ *   Author: Gregory Nutt <gnutt@nuttx.org>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name NuttX nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <sys/socket.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <time.h>
+
+#include <netinet/in.h>
+
+#include <nuttx/net/netconfig.h>
+#include <nuttx/net/net.h>
+#include <nuttx/net/netdev.h>
+#include <nuttx/net/ip.h>
+#include <nuttx/net/udp.h>
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+/* Configuration ************************************************************/
+
+#ifndef CONFIG_EXAMPLES_NETDEMUX_MAXSOCKETS
+#  define CONFIG_EXAMPLES_NETDEMUX_MAXSOCKETS 8
+#endif
+
+#ifndef CONFIG_EXAMPLES_NETDEMUX_NPACKETS
+#  define CONFIG_EXAMPLES_NETDEMUX_NPACKETS 20000
+#endif
+
+#ifndef CONFIG_EXAMPLES_NETDEMUX_BASEPORT
+#  define CONFIG_EXAMPLES_NETDEMUX_BASEPORT 7400
+#endif
+
+/* The injected datagrams travel from 10.0.0.1:9999 to 10.0.0.2 */
+
+#define NETDEMUX_SRCADDR  HTONL(0x0a000001)
+#define NETDEMUX_DESTADDR HTONL(0x0a000002)
+#define NETDEMUX_SRCPORT  9999
+
+#define NETDEMUX_PAYLOAD  32
+#define NETDEMUX_PKTLEN   (IPUDP_HDRLEN + NETDEMUX_PAYLOAD)
+
+#define BUF ((FAR struct udp_iphdr_s *)&g_dev.d_buf[NET_LL_HDRLEN])
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+/* A dummy network device that "receives" the injected datagrams.  It is
+ * never registered and never transmits.
+ */
+
+static struct net_driver_s g_dev;
+
+#ifdef CONFIG_NET_MULTIBUFFER
+static uint8_t g_pktbuf[CONFIG_NET_BUFSIZE + CONFIG_NET_GUARDSIZE];
+#endif
+
+static int g_sockfd[CONFIG_EXAMPLES_NETDEMUX_MAXSOCKETS];
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: netdemux_mkpacket
+ *
+ * Description:
+ *   Build a UDP datagram addressed to 'portno' in the dummy device buffer.
+ *   The UDP checksum is left as zero so that it is not verified.
+ *
+ ****************************************************************************/
+
+static void netdemux_mkpacket(uint16_t portno)
+{
+  FAR struct udp_iphdr_s *pbuf = BUF;
+  in_addr_t addr;
+
+  memset(pbuf, 0, NETDEMUX_PKTLEN);
+
+  pbuf->vhl       = 0x45;
+  pbuf->len[0]    = NETDEMUX_PKTLEN >> 8;
+  pbuf->len[1]    = NETDEMUX_PKTLEN & 0xff;
+  pbuf->ttl       = IP_TTL;
+  pbuf->proto     = IP_PROTO_UDP;
+
+  addr            = NETDEMUX_SRCADDR;
+  memcpy(pbuf->srcipaddr, &addr, sizeof(in_addr_t));
+  addr            = NETDEMUX_DESTADDR;
+  memcpy(pbuf->destipaddr, &addr, sizeof(in_addr_t));
+
+  pbuf->ipchksum  = 0;
+  pbuf->ipchksum  = ~(ip_chksum(&g_dev));
+
+  pbuf->srcport   = HTONS(NETDEMUX_SRCPORT);
+  pbuf->destport  = htons(portno);
+  pbuf->udplen    = HTONS(UDP_HDRLEN + NETDEMUX_PAYLOAD);
+  pbuf->udpchksum = 0;
+}
+
+/****************************************************************************
+ * Name: netdemux_measure
+ *
+ * Description:
+ *   Inject CONFIG_EXAMPLES_NETDEMUX_NPACKETS datagrams addressed to
+ *   'portno' and return the average time per datagram in nanoseconds.
+ *
+ ****************************************************************************/
+
+static unsigned long netdemux_measure(uint16_t portno)
+{
+  struct timespec start;
+  struct timespec end;
+  unsigned long elapsed;
+  net_lock_t flags;
+  int i;
+
+  netdemux_mkpacket(portno);
+
+  clock_gettime(CLOCK_REALTIME, &start);
+  for (i = 0; i < CONFIG_EXAMPLES_NETDEMUX_NPACKETS; i++)
+    {
+      /* devif_input() truncates d_len, so it must be restored each time.
+       * The network must be locked just as in a network driver.
+       */
+
+      g_dev.d_len = NET_LL_HDRLEN + NETDEMUX_PKTLEN;
+
+      flags = net_lock();
+      (void)devif_input(&g_dev);
+      net_unlock(flags);
+    }
+
+  clock_gettime(CLOCK_REALTIME, &end);
+
+  /* Elapsed time in microseconds */
+
+  elapsed = (unsigned long)(end.tv_sec - start.tv_sec) * 1000000;
+  if (end.tv_nsec >= start.tv_nsec)
+    {
+      elapsed += (end.tv_nsec - start.tv_nsec) / 1000;
+    }
+  else
+    {
+      elapsed -= (start.tv_nsec - end.tv_nsec) / 1000;
+    }
+
+  /* Convert to nanoseconds per datagram without overflowing */
+
+  return (elapsed / CONFIG_EXAMPLES_NETDEMUX_NPACKETS) * 1000 +
+         ((elapsed % CONFIG_EXAMPLES_NETDEMUX_NPACKETS) * 1000) /
+          CONFIG_EXAMPLES_NETDEMUX_NPACKETS;
+}
+
+/****************************************************************************
+ * Name: netdemux_drain
+ *
+ * Description:
+ *   Discard any datagrams retained in the read-ahead buffers of the socket
+ *   so that the measurements do not exhaust the shared I/O buffers.
+ *
+ ****************************************************************************/
+
+static void netdemux_drain(int sockfd)
+{
+  uint8_t buffer[NETDEMUX_PAYLOAD];
+  ssize_t nrecvd;
+
+  do
+    {
+      nrecvd = recv(sockfd, buffer, NETDEMUX_PAYLOAD, 0);
+    }
+  while (nrecvd > 0);
+}
+
+/****************************************************************************
+ * Name: netdemux_open
+ *
+ * Description:
+ *   Open one more UDP socket bound to the next port number.
+ *
+ ****************************************************************************/
+
+static int netdemux_open(int index)
+{
+  struct sockaddr_in addr;
+  int sockfd;
+
+  sockfd = socket(PF_INET, SOCK_DGRAM, 0);
+  if (sockfd < 0)
+    {
+      printf("netdemux: socket() failed: %d\n", errno);
+      return -1;
+    }
+
+  addr.sin_family      = AF_INET;
+  addr.sin_port        = htons(CONFIG_EXAMPLES_NETDEMUX_BASEPORT + index);
+  addr.sin_addr.s_addr = HTONL(INADDR_ANY);
+
+  if (bind(sockfd, (FAR struct sockaddr *)&addr, sizeof(addr)) < 0)
+    {
+      printf("netdemux: bind() failed: %d\n", errno);
+      close(sockfd);
+      return -1;
+    }
+
+  /* The read-ahead buffers are drained without waiting */
+
+  (void)fcntl(sockfd, F_SETFL, O_NONBLOCK);
+
+  g_sockfd[index] = sockfd;
+  return OK;
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: netdemux_main
+ ****************************************************************************/
+
+#ifdef CONFIG_BUILD_KERNEL
+int main(int argc, FAR char *argv[])
+#else
+int netdemux_main(int argc, char *argv[])
+#endif
+{
+  unsigned long hit;
+  unsigned long miss;
+  int nsockets = 0;
+  int target;
+  int i;
+
+  /* Set up the dummy network device */
+
+#ifdef CONFIG_NET_MULTIBUFFER
+  g_dev.d_buf = g_pktbuf;
+#endif
+  g_dev.d_ipaddr = NETDEMUX_DESTADDR;
+
+  printf("netdemux: %d datagrams per measurement\n",
+         CONFIG_EXAMPLES_NETDEMUX_NPACKETS);
+  printf("%8s %12s %12s\n", "Sockets", "Hit ns/pkt", "Miss ns/pkt");
+
+  for (target = 1;
+       nsockets < CONFIG_EXAMPLES_NETDEMUX_MAXSOCKETS;
+       target <<= 1)
+    {
+      if (target > CONFIG_EXAMPLES_NETDEMUX_MAXSOCKETS)
+        {
+          target = CONFIG_EXAMPLES_NETDEMUX_MAXSOCKETS;
+        }
+
+      /* Open sockets until there are 'target' of them */
+
+      while (nsockets < target)
+        {
+          if (netdemux_open(nsockets) < 0)
+            {
+              goto errout;
+            }
+
+          nsockets++;
+        }
+
+      /* "Hit" sends to the socket opened last.  "Miss" sends to a port with
+       * no socket so that every candidate connection is examined.
+       */
+
+      hit  = netdemux_measure(CONFIG_EXAMPLES_NETDEMUX_BASEPORT +
+                              nsockets - 1);
+      netdemux_drain(g_sockfd[nsockets - 1]);
+      miss = netdemux_measure(CONFIG_EXAMPLES_NETDEMUX_BASEPORT +
+                              CONFIG_EXAMPLES_NETDEMUX_MAXSOCKETS);
+
+      printf("%8d %12lu %12lu\n", nsockets, hit, miss);
+    }
+
+errout:
+  for (i = 0; i < nsockets; i++)
+    {
+      close(g_sockfd[i]);
+    }
+
+  return nsockets < CONFIG_EXAMPLES_NETDEMUX_MAXSOCKETS ? 1 : 0;
+}
@@ -143,6 +143,10 @@ void sem_test(void);
 
 void semtimed_test(void);
 
+/* semstress.c **************************************************************/
+
+void semstress_test(void);
+
 /* cond.c *******************************************************************/
 
 void cond_test(void);
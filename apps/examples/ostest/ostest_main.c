@@ -391,6 +391,10 @@ static int user_main(int argc, char *argv[])
       semtimed_test();
       check_test_memory_usage();
 
+      printf("\nuser_main: semaphore wait list stress test\n");
+      semstress_test();
+      check_test_memory_usage();
+
 #ifdef CONFIG_FS_NAMED_SEMAPHORES
       printf("\nuser_main: Named semaphore test\n");
       nsem_test();
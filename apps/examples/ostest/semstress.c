@@ -0,0 +1,330 @@
+/***********************************************************************
+ * apps/examples/ostest/semstress.c
+ *
+ *   Copyright (C) 2014 Gregory Nutt. All rights reserved.
+ *   Author: Gregory Nutt <gnutt@nuttx.org>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name NuttX nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ***********************************************************************/
+
+/***********************************************************************
+ * Included Files
+ ***********************************************************************/
+
+#include <stdint.h>
+#include <stdio.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <semaphore.h>
+#include <time.h>
+#include <sched.h>
+#include <errno.h>
+
+#include "ostest.h"
+
+/***********************************************************************
+ * Preprocessor Definitions
+ ***********************************************************************/
+
+#ifndef NULL
+# define NULL (void*)0
+#endif
+
+/* Number of threads blocked on the shared semaphore, number of threads
+ * blocked on unrelated semaphores, number of round trips between clock
+ * reads, and the shortest time in microseconds over which round trips are
+ * timed.  The clock only advances once per system tick, so the round trips
+ * are repeated until many ticks have passed.
+ */
+
+#define SEMSTRESS_NWAITERS    6
+#define SEMSTRESS_NBYSTANDERS 8
+#define SEMSTRESS_NLOOPS      10000
+#define SEMSTRESS_MINTIME     500000
+
+/***********************************************************************
+ * Private Data
+ ***********************************************************************/
+
+static sem_t g_shared;
+static sem_t g_ping;
+static sem_t g_pong;
+static sem_t g_bystander[SEMSTRESS_NBYSTANDERS];
+
+/* Priorities of the waiters in the order that they were awakened */
+
+static int g_wakeorder[SEMSTRESS_NWAITERS];
+static volatile int g_nawake;
+static volatile int g_timedout;
+static volatile int g_stop;
+
+/***********************************************************************
+ * Private Functions
+ ***********************************************************************/
+
+static void *waiter_func(void *parameter)
+{
+  int priority = (int)((intptr_t)parameter);
+
+  while (sem_wait(&g_shared) < 0)
+    {
+      if (errno != EINTR)
+        {
+          printf("semstress_test: ERROR: sem_wait failed: %d\n", errno);
+          return NULL;
+        }
+    }
+
+  g_wakeorder[g_nawake++] = priority;
+  return NULL;
+}
+
+static void *timedwaiter_func(void *parameter)
+{
+  struct timespec abstime;
+
+  /* Wait in the middle of the wait list, then time out */
+
+  (void)clock_gettime(CLOCK_REALTIME, &abstime);
+  abstime.tv_nsec += 100 * 1000 * 1000;
+  if (abstime.tv_nsec >= 1000 * 1000 * 1000)
+    {
+      abstime.tv_sec++;
+      abstime.tv_nsec -= 1000 * 1000 * 1000;
+    }
+
+  if (sem_timedwait(&g_shared, &abstime) < 0 && errno == ETIMEDOUT)
+    {
+      g_timedout = 1;
+    }
+
+  return NULL;
+}
+
+static void *bystander_func(void *parameter)
+{
+  int ndx = (int)((intptr_t)parameter);
+
+  while (sem_wait(&g_bystander[ndx]) < 0 && errno == EINTR);
+  return NULL;
+}
+
+static void *partner_func(void *parameter)
+{
+  for (;;)
+    {
+      while (sem_wait(&g_ping) < 0 && errno == EINTR);
+      if (g_stop)
+        {
+          break;
+        }
+
+      sem_post(&g_pong);
+    }
+
+  return NULL;
+}
+
+static int start_thread(pthread_t *thread, int priority,
+                        void *(*entry)(void *), void *arg)
+{
+  struct sched_param sparam;
+  pthread_attr_t attr;
+  int status;
+
+  pthread_attr_init(&attr);
+  sparam.sched_priority = priority;
+  pthread_attr_setschedparam(&attr, &sparam);
+
+  status = pthread_create(thread, &attr, entry, arg);
+  if (status != 0)
+    {
+      printf("semstress_test: ERROR: pthread_create failed: %d\n", status);
+    }
+
+  return status;
+}
+
+/* Time semaphore round trips with a higher priority partner thread for
+ * at least SEMSTRESS_MINTIME microseconds.  Returns the average round trip
+ * time in nanoseconds.
+ */
+
+static unsigned long pingpong(int priority)
+{
+  struct timespec before;
+  struct timespec after;
+  unsigned long elapsed;
+  unsigned long ntrips;
+  pthread_t partner;
+  int i;
+
+  sem_init(&g_ping, 0, 0);
+  sem_init(&g_pong, 0, 0);
+  g_stop = 0;
+
+  if (start_thread(&partner, priority, partner_func, NULL) != 0)
+    {
+      return 0;
+    }
+
+  ntrips = 0;
+  (void)clock_gettime(CLOCK_REALTIME, &before);
+  do
+    {
+      for (i = 0; i < SEMSTRESS_NLOOPS; i++)
+        {
+          sem_post(&g_ping);
+          while (sem_wait(&g_pong) < 0 && errno == EINTR);
+        }
+
+      ntrips += SEMSTRESS_NLOOPS;
+      (void)clock_gettime(CLOCK_REALTIME, &after);
+      elapsed = (after.tv_sec - before.tv_sec) * 1000000 +
+                (after.tv_nsec - before.tv_nsec) / 1000;
+    }
+  while (elapsed < SEMSTRESS_MINTIME);
+
+  g_stop = 1;
+  sem_post(&g_ping);
+  pthread_join(partner, NULL);
+
+  sem_destroy(&g_ping);
+  sem_destroy(&g_pong);
+
+  return (unsigned long)((uint64_t)elapsed * 1000 / ntrips);
+}
+
+/***********************************************************************
+ * Public Functions
+ ***********************************************************************/
+
+void semstress_test(void)
+{
+  static const int order[SEMSTRESS_NWAITERS] = { 2, 5, 0, 4, 1, 3 };
+  pthread_t waiters[SEMSTRESS_NWAITERS];
+  pthread_t bystanders[SEMSTRESS_NBYSTANDERS];
+  pthread_t timedwaiter;
+  struct sched_param sparam;
+  unsigned long idle;
+  unsigned long busy;
+  int mypriority;
+  int value;
+  int i;
+
+  sched_getparam(0, &sparam);
+  mypriority = sparam.sched_priority;
+  if (mypriority + SEMSTRESS_NWAITERS + 1 > sched_get_priority_max(SCHED_FIFO))
+    {
+      printf("semstress_test: ERROR: priority %d is too high\n", mypriority);
+      return;
+    }
+
+  /* Start the waiters in scrambled priority order.  Each has a higher
+   * priority than this thread so it blocks on the semaphore at once.
+   */
+
+  printf("semstress_test: Starting %d waiters\n", SEMSTRESS_NWAITERS);
+  sem_init(&g_shared, 0, 0);
+  g_nawake   = 0;
+  g_timedout = 0;
+
+  for (i = 0; i < SEMSTRESS_NWAITERS; i++)
+    {
+      int priority = mypriority + 1 + order[i];
+      (void)start_thread(&waiters[i], priority, waiter_func,
+                         (void *)((intptr_t)priority));
+    }
+
+  /* Add a waiter in the middle of the list and let it time out */
+
+  (void)start_thread(&timedwaiter, mypriority + 1 + SEMSTRESS_NWAITERS / 2,
+                     timedwaiter_func, NULL);
+  pthread_join(timedwaiter, NULL);
+
+  sem_getvalue(&g_shared, &value);
+  if (!g_timedout || value != -SEMSTRESS_NWAITERS)
+    {
+      printf("semstress_test: ERROR: timedout=%d value=%d\n",
+             g_timedout, value);
+    }
+
+  /* Each post must wake the highest priority waiter */
+
+  for (i = 0; i < SEMSTRESS_NWAITERS; i++)
+    {
+      sem_post(&g_shared);
+    }
+
+  for (i = 0; i < SEMSTRESS_NWAITERS; i++)
+    {
+      pthread_join(waiters[i], NULL);
+    }
+
+  for (i = 0; i < SEMSTRESS_NWAITERS; i++)
+    {
+      if (g_wakeorder[i] != mypriority + SEMSTRESS_NWAITERS - i)
+        {
+          printf("semstress_test: ERROR: wake %d priority %d\n",
+                 i, g_wakeorder[i]);
+          break;
+        }
+    }
+
+  if (i == SEMSTRESS_NWAITERS && g_nawake == SEMSTRESS_NWAITERS)
+    {
+      printf("semstress_test: Priority order PASS\n");
+    }
+
+  sem_destroy(&g_shared);
+
+  /* Post latency should not depend on tasks blocked on other semaphores */
+
+  idle = pingpong(mypriority + 1);
+
+  for (i = 0; i < SEMSTRESS_NBYSTANDERS; i++)
+    {
+      sem_init(&g_bystander[i], 0, 0);
+      (void)start_thread(&bystanders[i], mypriority + 1, bystander_func,
+                         (void *)((intptr_t)i));
+    }
+
+  busy = pingpong(mypriority + 1);
+
+  for (i = 0; i < SEMSTRESS_NBYSTANDERS; i++)
+    {
+      sem_post(&g_bystander[i]);
+      pthread_join(bystanders[i], NULL);
+      sem_destroy(&g_bystander[i]);
+    }
+
+  printf("semstress_test: Round trip nsec: %lu idle, "
+         "%lu with %d blocked tasks\n",
+         idle, busy, SEMSTRESS_NBYSTANDERS);
+}
@@ -0,0 +1,392 @@
+/****************************************************************************
+ * examples/pibench/pibench_main.c
+ *
+ *   Copyright (C) 2014 Gregory Nutt. All rights reserved.
+ *   Author: Gregory Nutt <gnutt@nuttx.org>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name NuttX nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <sched.h>
+#include <semaphore.h>
+#include <pthread.h>
+#include <time.h>
+#include <errno.h>
+
+#include <nuttx/semaphore.h>
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+/* Configuration ************************************************************/
+
+#ifndef CONFIG_EXAMPLES_PIBENCH_NLOOPS
+#  define CONFIG_EXAMPLES_PIBENCH_NLOOPS 10000
+#endif
+
+#ifndef CONFIG_SEM_PREALLOCHOLDERS
+#  define CONFIG_SEM_PREALLOCHOLDERS 0
+#endif
+
+/* The largest number of other holders of the counting semaphore.  The
+ * main thread is also a holder so no more than CONFIG_SEM_PREALLOCHOLDERS
+ * other holders can be recorded.
+ */
+
+#define PIBENCH_MAXHOLDERS 8
+
+/* Priorities.  The main thread runs above the helper threads so that the
+ * helper threads only run when the main thread blocks.
+ */
+
+#define PIBENCH_HIGH_PRIORITY (SCHED_PRIORITY_DEFAULT + 10)
+#define PIBENCH_LOW_PRIORITY  (SCHED_PRIORITY_DEFAULT - 10)
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+static sem_t g_mutex;        /* The semaphore being measured */
+static sem_t g_counting;     /* Counting semaphore with several holders */
+static sem_t g_go;           /* Main -> helper:  Proceed */
+static sem_t g_ready;        /* Helper -> main:  Done */
+static volatile bool g_stop;
+static volatile int g_nboosts;
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: pibench_now
+ *
+ * Description:
+ *   Return the current time in microseconds.
+ *
+ ****************************************************************************/
+
+static unsigned long pibench_now(void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_REALTIME, &ts);
+  return (unsigned long)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+/****************************************************************************
+ * Name: pibench_create
+ ****************************************************************************/
+
+static int pibench_create(FAR pthread_t *thread, int priority,
+                          pthread_startroutine_t entry)
+{
+  struct sched_param param;
+  pthread_attr_t attr;
+  int ret;
+
+  (void)pthread_attr_init(&attr);
+  (void)pthread_attr_setschedpolicy(&attr, SCHED_FIFO);
+  param.sched_priority = priority;
+  (void)pthread_attr_setschedparam(&attr, &param);
+
+  ret = pthread_create(thread, &attr, entry, NULL);
+  (void)pthread_attr_destroy(&attr);
+  return ret;
+}
+
+/****************************************************************************
+ * Name: pibench_report
+ ****************************************************************************/
+
+static void pibench_report(FAR const char *name, unsigned long elapsed)
+{
+  printf("%-28s %8lu nsec\n", name,
+         (unsigned long)((uint64_t)elapsed * 1000 /
+                         CONFIG_EXAMPLES_PIBENCH_NLOOPS));
+}
+
+/****************************************************************************
+ * Name: pibench_holder
+ *
+ * Description:
+ *   Take one count on the counting semaphore and keep it until the main
+ *   thread says to proceed.
+ *
+ ****************************************************************************/
+
+static FAR void *pibench_holder(FAR void *arg)
+{
+  (void)sem_wait(&g_counting);
+  (void)sem_post(&g_ready);
+  (void)sem_wait(&g_go);
+  (void)sem_post(&g_counting);
+  return NULL;
+}
+
+/****************************************************************************
+ * Name: pibench_lowprio
+ *
+ * Description:
+ *   Take the mutex each time that the main thread says to proceed.  The
+ *   main thread then blocks on the mutex, boosting the priority of this
+ *   thread until it releases the mutex.
+ *
+ ****************************************************************************/
+
+static FAR void *pibench_lowprio(FAR void *arg)
+{
+  struct sched_param param;
+
+  for (;;)
+    {
+      (void)sem_wait(&g_go);
+      if (g_stop)
+        {
+          break;
+        }
+
+      (void)sem_wait(&g_mutex);
+      (void)sem_post(&g_ready);
+
+      /* We only get here after the main thread has blocked on the mutex */
+
+      if (sched_getparam(0, &param) == 0 &&
+          param.sched_priority == PIBENCH_HIGH_PRIORITY)
+        {
+          g_nboosts++;
+        }
+
+      (void)sem_post(&g_mutex);
+    }
+
+  return NULL;
+}
+
+/****************************************************************************
+ * Name: pibench_uncontended
+ ****************************************************************************/
+
+static void pibench_uncontended(void)
+{
+  unsigned long start;
+  int i;
+
+  (void)sem_init(&g_mutex, 0, 1);
+
+  start = pibench_now();
+  for (i = 0; i < CONFIG_EXAMPLES_PIBENCH_NLOOPS; i++)
+    {
+      (void)sem_wait(&g_mutex);
+      (void)sem_post(&g_mutex);
+    }
+
+  pibench_report("mutex wait/post", pibench_now() - start);
+  (void)sem_destroy(&g_mutex);
+}
+
+/****************************************************************************
+ * Name: pibench_holders
+ ****************************************************************************/
+
+static void pibench_holders(int nholders)
+{
+  pthread_t holders[PIBENCH_MAXHOLDERS];
+  unsigned long start;
+  char name[32];
+  int nstarted;
+  int ret;
+  int i;
+
+  (void)sem_init(&g_counting, 0, nholders + 1);
+  (void)sem_init(&g_go, 0, 0);
+  (void)sem_init(&g_ready, 0, 0);
+
+  /* Start the other holders and wait until each holds its count */
+
+  for (nstarted = 0; nstarted < nholders; nstarted++)
+    {
+      ret = pibench_create(&holders[nstarted], PIBENCH_LOW_PRIORITY,
+                           pibench_holder);
+      if (ret != 0)
+        {
+          printf("pibench: pthread_create failed: %d\n", ret);
+          break;
+        }
+
+      (void)sem_wait(&g_ready);
+    }
+
+  if (nstarted == nholders)
+    {
+      start = pibench_now();
+      for (i = 0; i < CONFIG_EXAMPLES_PIBENCH_NLOOPS; i++)
+        {
+          (void)sem_wait(&g_counting);
+          (void)sem_post(&g_counting);
+        }
+
+      snprintf(name, sizeof(name), "counting, %d other holders",
+               nholders);
+      pibench_report(name, pibench_now() - start);
+    }
+
+  for (i = 0; i < nstarted; i++)
+    {
+      (void)sem_post(&g_go);
+    }
+
+  for (i = 0; i < nstarted; i++)
+    {
+      (void)pthread_join(holders[i], NULL);
+    }
+
+  (void)sem_destroy(&g_ready);
+  (void)sem_destroy(&g_go);
+  (void)sem_destroy(&g_counting);
+}
+
+/****************************************************************************
+ * Name: pibench_contended
+ ****************************************************************************/
+
+static void pibench_contended(void)
+{
+  pthread_t lowprio;
+  unsigned long start;
+  int ret;
+  int i;
+
+  (void)sem_init(&g_mutex, 0, 1);
+  (void)sem_init(&g_go, 0, 0);
+  (void)sem_init(&g_ready, 0, 0);
+
+  g_stop    = false;
+  g_nboosts = 0;
+
+  ret = pibench_create(&lowprio, PIBENCH_LOW_PRIORITY, pibench_lowprio);
+  if (ret != 0)
+    {
+      printf("pibench: pthread_create failed: %d\n", ret);
+      goto errout;
+    }
+
+  /* Each loop lets the low priority thread take the mutex, then blocks
+   * on the mutex (boosting the low priority thread) until the low
+   * priority thread gives it up (restoring its priority).
+   */
+
+  start = pibench_now();
+  for (i = 0; i < CONFIG_EXAMPLES_PIBENCH_NLOOPS; i++)
+    {
+      (void)sem_post(&g_go);
+      (void)sem_wait(&g_ready);
+      (void)sem_wait(&g_mutex);
+      (void)sem_post(&g_mutex);
+    }
+
+  pibench_report("contended round trip", pibench_now() - start);
+
+  if (g_nboosts != CONFIG_EXAMPLES_PIBENCH_NLOOPS)
+    {
+      printf("pibench: ERROR: Holder boosted %d of %d times\n",
+             g_nboosts, CONFIG_EXAMPLES_PIBENCH_NLOOPS);
+    }
+
+  g_stop = true;
+  (void)sem_post(&g_go);
+  (void)pthread_join(lowprio, NULL);
+
+errout:
+  (void)sem_destroy(&g_ready);
+  (void)sem_destroy(&g_go);
+  (void)sem_destroy(&g_mutex);
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * pibench_main
+ ****************************************************************************/
+
+#ifdef CONFIG_BUILD_KERNEL
+int main(int argc, FAR char *argv[])
+#else
+int pibench_main(int argc, char *argv[])
+#endif
+{
+  struct semholder_stats_s stats;
+  struct sched_param param;
+  int nholders;
+  int ret;
+
+  /* Run above all of the helper threads */
+
+  param.sched_priority = PIBENCH_HIGH_PRIORITY;
+  ret = sched_setscheduler(0, SCHED_FIFO, &param);
+  if (ret < 0)
+    {
+      printf("pibench: sched_setscheduler failed: %d\n", errno);
+      return 1;
+    }
+
+  printf("%d loops per measurement\n\n", CONFIG_EXAMPLES_PIBENCH_NLOOPS);
+
+  pibench_uncontended();
+
+  /* Holders beyond the size of the pool could not be recorded */
+
+  for (nholders = 0;
+       nholders <= PIBENCH_MAXHOLDERS &&
+       nholders <= CONFIG_SEM_PREALLOCHOLDERS;
+       nholders = nholders ? 2 * nholders : 1)
+    {
+      pibench_holders(nholders);
+    }
+
+  pibench_contended();
+
+  sem_holderstats(&stats);
+  printf("\nHolder pool: %u entries, %u free, %u minimum free, "
+         "%lu failures\n",
+         stats.npool, stats.nfree, stats.minfree,
+         (unsigned long)stats.nfails);
+  return 0;
+}
@@ -0,0 +1,611 @@
+/****************************************************************************
+ * examples/smartbench/smartbench_main.c
+ *
+ *   Copyright (C) 2014 Gregory Nutt. All rights reserved.
+ *   Author: Gregory Nutt <gnutt@nuttx.org>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name NuttX nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <sys/types.h>
+#include <sys/mount.h>
+#include <sys/statfs.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <time.h>
+#include <errno.h>
+
+#include <nuttx/fs/ioctl.h>
+#include <nuttx/fs/mksmartfs.h>
+#include <nuttx/mtd/mtd.h>
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+/* Configuration ************************************************************/
+
+#ifndef CONFIG_EXAMPLES_SMARTBENCH_NEBLOCKS
+#  define CONFIG_EXAMPLES_SMARTBENCH_NEBLOCKS 256
+#endif
+
+#ifndef CONFIG_EXAMPLES_SMARTBENCH_NFILES
+#  define CONFIG_EXAMPLES_SMARTBENCH_NFILES 32
+#endif
+
+#ifndef CONFIG_EXAMPLES_SMARTBENCH_FILESIZE
+#  define CONFIG_EXAMPLES_SMARTBENCH_FILESIZE 4096
+#endif
+
+#ifndef CONFIG_EXAMPLES_SMARTBENCH_MOUNTPT
+#  define CONFIG_EXAMPLES_SMARTBENCH_MOUNTPT "/mnt/smartbench"
+#endif
+
+#ifndef CONFIG_EXAMPLES_SMARTBENCH_MINOR
+#  define CONFIG_EXAMPLES_SMARTBENCH_MINOR 8
+#endif
+
+/* This must exactly match the default configuration in drivers/mtd/rammtd.c */
+
+#ifndef CONFIG_RAMMTD_BLOCKSIZE
+#  define CONFIG_RAMMTD_BLOCKSIZE 512
+#endif
+
+#ifndef CONFIG_RAMMTD_ERASESIZE
+#  define CONFIG_RAMMTD_ERASESIZE 4096
+#endif
+
+#ifndef CONFIG_RAMMTD_ERASESTATE
+#  define CONFIG_RAMMTD_ERASESTATE 0xff
+#endif
+
+#define SMARTBENCH_FLASHSIZE \
+  (CONFIG_RAMMTD_ERASESIZE * CONFIG_EXAMPLES_SMARTBENCH_NEBLOCKS)
+
+#define SMARTBENCH_IOSIZE    256
+
+/****************************************************************************
+ * Private Types
+ ****************************************************************************/
+
+/* The RAM MTD device is wrapped in this MTD device that counts the reads
+ * made by the SMART driver.
+ */
+
+struct smartbench_mtd_s
+{
+  struct mtd_dev_s mtd;         /* Must be first */
+  FAR struct mtd_dev_s *lower;  /* The RAM MTD device */
+  unsigned long nreads;         /* Number of read and bread calls */
+  unsigned long nbytes;         /* Number of bytes read */
+};
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+static struct smartbench_mtd_s g_mtd;
+static FAR uint8_t *g_flash;
+static int g_minor = CONFIG_EXAMPLES_SMARTBENCH_MINOR;
+static uint8_t g_buffer[SMARTBENCH_IOSIZE];
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: smartbench_now
+ *
+ * Description:
+ *   Return the current time in microseconds.
+ *
+ ****************************************************************************/
+
+static unsigned long smartbench_now(void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_REALTIME, &ts);
+  return (unsigned long)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+/****************************************************************************
+ * Name: smartbench_erase, smartbench_bread, smartbench_bwrite,
+ *       smartbench_read, smartbench_write, and smartbench_ioctl
+ *
+ * Description:
+ *   The MTD methods of the counting wrapper.  Reads are counted, all other
+ *   operations are simply passed on to the RAM MTD device.
+ *
+ ****************************************************************************/
+
+static int smartbench_erase(FAR struct mtd_dev_s *dev, off_t startblock,
+                            size_t nblocks)
+{
+  FAR struct smartbench_mtd_s *priv = (FAR struct smartbench_mtd_s *)dev;
+  return MTD_ERASE(priv->lower, startblock, nblocks);
+}
+
+static ssize_t smartbench_bread(FAR struct mtd_dev_s *dev, off_t startblock,
+                                size_t nblocks, FAR uint8_t *buffer)
+{
+  FAR struct smartbench_mtd_s *priv = (FAR struct smartbench_mtd_s *)dev;
+  ssize_t ret;
+
+  ret = MTD_BREAD(priv->lower, startblock, nblocks, buffer);
+  if (ret > 0)
+    {
+      priv->nreads++;
+      priv->nbytes += ret * CONFIG_RAMMTD_BLOCKSIZE;
+    }
+
+  return ret;
+}
+
+static ssize_t smartbench_bwrite(FAR struct mtd_dev_s *dev, off_t startblock,
+                                 size_t nblocks, FAR const uint8_t *buffer)
+{
+  FAR struct smartbench_mtd_s *priv = (FAR struct smartbench_mtd_s *)dev;
+  return MTD_BWRITE(priv->lower, startblock, nblocks, buffer);
+}
+
+static ssize_t smartbench_read(FAR struct mtd_dev_s *dev, off_t offset,
+                               size_t nbytes, FAR uint8_t *buffer)
+{
+  FAR struct smartbench_mtd_s *priv = (FAR struct smartbench_mtd_s *)dev;
+  ssize_t ret;
+
+  ret = MTD_READ(priv->lower, offset, nbytes, buffer);
+  if (ret > 0)
+    {
+      priv->nreads++;
+      priv->nbytes += ret;
+    }
+
+  return ret;
+}
+
+#ifdef CONFIG_MTD_BYTE_WRITE
+static ssize_t smartbench_write(FAR struct mtd_dev_s *dev, off_t offset,
+                                size_t nbytes, FAR const uint8_t *buffer)
+{
+  FAR struct smartbench_mtd_s *priv = (FAR struct smartbench_mtd_s *)dev;
+  return priv->lower->write(priv->lower, offset, nbytes, buffer);
+}
+#endif
+
+static int smartbench_ioctl(FAR struct mtd_dev_s *dev, int cmd,
+                            unsigned long arg)
+{
+  FAR struct smartbench_mtd_s *priv = (FAR struct smartbench_mtd_s *)dev;
+  return MTD_IOCTL(priv->lower, cmd, arg);
+}
+
+/****************************************************************************
+ * Name: smartbench_setup
+ *
+ * Description:
+ *   Create the RAM MTD device and its counting wrapper.  MTD devices cannot
+ *   be destroyed, so this is only done the first time the benchmark runs.
+ *
+ ****************************************************************************/
+
+static int smartbench_setup(void)
+{
+  FAR struct mtd_dev_s *lower;
+
+  if (g_flash != NULL)
+    {
+      return OK;
+    }
+
+  g_flash = (FAR uint8_t *)malloc(SMARTBENCH_FLASHSIZE);
+  if (g_flash == NULL)
+    {
+      printf("smartbench: Failed to allocate %d bytes of simulated FLASH\n",
+             SMARTBENCH_FLASHSIZE);
+      return -ENOMEM;
+    }
+
+  lower = rammtd_initialize(g_flash, SMARTBENCH_FLASHSIZE);
+  if (lower == NULL)
+    {
+      printf("smartbench: rammtd_initialize failed\n");
+      free(g_flash);
+      g_flash = NULL;
+      return -ENODEV;
+    }
+
+  g_mtd.mtd.erase  = smartbench_erase;
+  g_mtd.mtd.bread  = smartbench_bread;
+  g_mtd.mtd.bwrite = smartbench_bwrite;
+  g_mtd.mtd.read   = smartbench_read;
+#ifdef CONFIG_MTD_BYTE_WRITE
+  g_mtd.mtd.write  = lower->write != NULL ? smartbench_write : NULL;
+#endif
+  g_mtd.mtd.ioctl  = smartbench_ioctl;
+  g_mtd.lower      = lower;
+  return OK;
+}
+
+/****************************************************************************
+ * Name: smartbench_devname
+ *
+ * Description:
+ *   Return the path of the block driver registered for SMART minor 'minor'.
+ *
+ ****************************************************************************/
+
+static void smartbench_devname(FAR char *devname, size_t len, int minor)
+{
+#ifdef CONFIG_SMARTFS_MULTI_ROOT_DIRS
+  snprintf(devname, len, "/dev/smart%dd1", minor);
+#else
+  snprintf(devname, len, "/dev/smart%d", minor);
+#endif
+}
+
+/****************************************************************************
+ * Name: smartbench_pattern
+ *
+ * Description:
+ *   Fill g_buffer with the contents expected at 'offset' of version 'gen'
+ *   of file 'fileno'.
+ *
+ ****************************************************************************/
+
+static void smartbench_pattern(int fileno, int gen, size_t offset)
+{
+  size_t i;
+
+  for (i = 0; i < SMARTBENCH_IOSIZE; i++)
+    {
+      g_buffer[i] = (uint8_t)((offset + i) / 3 + fileno * 7 + gen * 31);
+    }
+}
+
+/****************************************************************************
+ * Name: smartbench_filename
+ ****************************************************************************/
+
+static void smartbench_filename(FAR char *path, size_t len, int fileno)
+{
+  snprintf(path, len, CONFIG_EXAMPLES_SMARTBENCH_MOUNTPT "/file%03d",
+           fileno);
+}
+
+/****************************************************************************
+ * Name: smartbench_writefile
+ ****************************************************************************/
+
+static int smartbench_writefile(int fileno, int gen)
+{
+  char path[64];
+  size_t offset;
+  int fd;
+
+  smartbench_filename(path, sizeof(path), fileno);
+  fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0666);
+  if (fd < 0)
+    {
+      printf("smartbench: open %s failed: %d\n", path, errno);
+      return -1;
+    }
+
+  for (offset = 0; offset < CONFIG_EXAMPLES_SMARTBENCH_FILESIZE;
+       offset += SMARTBENCH_IOSIZE)
+    {
+      smartbench_pattern(fileno, gen, offset);
+      if (write(fd, g_buffer, SMARTBENCH_IOSIZE) != SMARTBENCH_IOSIZE)
+        {
+          printf("smartbench: write %s failed: %d\n", path, errno);
+          (void)close(fd);
+          return -1;
+        }
+    }
+
+  (void)close(fd);
+  return 0;
+}
+
+/****************************************************************************
+ * Name: smartbench_populate
+ *
+ * Description:
+ *   Write all files, then rewrite every other file and delete every fourth
+ *   one so that the device holds released sectors as well as live ones.
+ *   Returns the size of the sector pool in bytes.
+ *
+ ****************************************************************************/
+
+static ssize_t smartbench_populate(void)
+{
+  struct statfs buf;
+  char path[64];
+  int fileno;
+
+  for (fileno = 0; fileno < CONFIG_EXAMPLES_SMARTBENCH_NFILES; fileno++)
+    {
+      if (smartbench_writefile(fileno, 0) < 0)
+        {
+          return -1;
+        }
+    }
+
+  for (fileno = 0; fileno < CONFIG_EXAMPLES_SMARTBENCH_NFILES; fileno += 2)
+    {
+      if (smartbench_writefile(fileno, 1) < 0)
+        {
+          return -1;
+        }
+    }
+
+  for (fileno = 3; fileno < CONFIG_EXAMPLES_SMARTBENCH_NFILES; fileno += 4)
+    {
+      smartbench_filename(path, sizeof(path), fileno);
+      if (unlink(path) < 0)
+        {
+          printf("smartbench: unlink %s failed: %d\n", path, errno);
+          return -1;
+        }
+    }
+
+  if (statfs(CONFIG_EXAMPLES_SMARTBENCH_MOUNTPT, &buf) < 0)
+    {
+      printf("smartbench: statfs failed: %d\n", errno);
+      return -1;
+    }
+
+  return (ssize_t)buf.f_blocks * buf.f_bsize;
+}
+
+/****************************************************************************
+ * Name: smartbench_verify
+ *
+ * Description:
+ *   Mount the SMART device 'minor' and check the contents of all files.
+ *
+ ****************************************************************************/
+
+static int smartbench_verify(int minor)
+{
+  char devname[32];
+  char path[64];
+  size_t offset;
+  int fileno;
+  int ret = 0;
+  int fd;
+
+  smartbench_devname(devname, sizeof(devname), minor);
+  if (mount(devname, CONFIG_EXAMPLES_SMARTBENCH_MOUNTPT, "smartfs", 0,
+            NULL) < 0)
+    {
+      printf("smartbench: mount %s failed: %d\n", devname, errno);
+      return -1;
+    }
+
+  for (fileno = 0;
+       fileno < CONFIG_EXAMPLES_SMARTBENCH_NFILES && ret == 0;
+       fileno++)
+    {
+      smartbench_filename(path, sizeof(path), fileno);
+      fd = open(path, O_RDONLY);
+
+      if ((fileno & 3) == 3)
+        {
+          if (fd >= 0)
+            {
+              printf("smartbench: ERROR: %s was not deleted\n", path);
+              (void)close(fd);
+              ret = -1;
+            }
+
+          continue;
+        }
+
+      if (fd < 0)
+        {
+          printf("smartbench: open %s failed: %d\n", path, errno);
+          ret = -1;
+          break;
+        }
+
+      for (offset = 0; offset < CONFIG_EXAMPLES_SMARTBENCH_FILESIZE;
+           offset += SMARTBENCH_IOSIZE)
+        {
+          uint8_t data[SMARTBENCH_IOSIZE];
+
+          if (read(fd, data, SMARTBENCH_IOSIZE) != SMARTBENCH_IOSIZE)
+            {
+              printf("smartbench: read %s failed: %d\n", path, errno);
+              ret = -1;
+              break;
+            }
+
+          smartbench_pattern(fileno, (fileno & 1) == 0 ? 1 : 0, offset);
+          if (memcmp(data, g_buffer, SMARTBENCH_IOSIZE) != 0)
+            {
+              printf("smartbench: ERROR: Bad data in %s at offset %lu\n",
+                     path, (unsigned long)offset);
+              ret = -1;
+              break;
+            }
+        }
+
+      (void)close(fd);
+    }
+
+  (void)umount(CONFIG_EXAMPLES_SMARTBENCH_MOUNTPT);
+  return ret;
+}
+
+/****************************************************************************
+ * Name: smartbench_measure
+ *
+ * Description:
+ *   Bind a new SMART device to the MTD device, which rebuilds the sector
+ *   map from the FLASH contents, and report the time and the reads that
+ *   took.  Then check that the files are intact.
+ *
+ ****************************************************************************/
+
+static int smartbench_measure(FAR const char *what)
+{
+  unsigned long start;
+  unsigned long elapsed;
+  int minor = g_minor++;
+  int ret;
+
+  g_mtd.nreads = 0;
+  g_mtd.nbytes = 0;
+
+  start   = smartbench_now();
+  ret     = smart_initialize(minor, &g_mtd.mtd, NULL);
+  elapsed = smartbench_now() - start;
+
+  if (ret < 0)
+    {
+      printf("smartbench: smart_initialize failed: %d\n", ret);
+      return ret;
+    }
+
+  printf("%-24s %10lu %10lu %10lu\n", what, elapsed, g_mtd.nreads,
+         g_mtd.nbytes);
+
+  return smartbench_verify(minor);
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * smartbench_main
+ ****************************************************************************/
+
+#ifdef CONFIG_BUILD_KERNEL
+int main(int argc, FAR char *argv[])
+#else
+int smartbench_main(int argc, char *argv[])
+#endif
+{
+  char devname[32];
+  ssize_t poolsize;
+  int minor;
+  int ret;
+
+  ret = smartbench_setup();
+  if (ret < 0)
+    {
+      return 1;
+    }
+
+  /* Create and populate a new file system */
+
+  MTD_IOCTL(&g_mtd.mtd, MTDIOC_BULKERASE, 0);
+
+  minor = g_minor++;
+  ret = smart_initialize(minor, &g_mtd.mtd, NULL);
+  if (ret < 0)
+    {
+      printf("smartbench: smart_initialize failed: %d\n", ret);
+      return 1;
+    }
+
+  smartbench_devname(devname, sizeof(devname), minor);
+#ifdef CONFIG_SMARTFS_MULTI_ROOT_DIRS
+  ret = mksmartfs(devname, 1);
+#else
+  ret = mksmartfs(devname);
+#endif
+  if (ret < 0)
+    {
+      printf("smartbench: mksmartfs %s failed: %d\n", devname, errno);
+      return 1;
+    }
+
+  if (mount(devname, CONFIG_EXAMPLES_SMARTBENCH_MOUNTPT, "smartfs", 0,
+            NULL) < 0)
+    {
+      printf("smartbench: mount %s failed: %d\n", devname, errno);
+      return 1;
+    }
+
+  poolsize = smartbench_populate();
+  (void)umount(CONFIG_EXAMPLES_SMARTBENCH_MOUNTPT);
+  if (poolsize < 0)
+    {
+      return 1;
+    }
+
+  printf("FLASH=%d bytes files=%d x %d bytes\n\n", SMARTBENCH_FLASHSIZE,
+         CONFIG_EXAMPLES_SMARTBENCH_NFILES,
+         CONFIG_EXAMPLES_SMARTBENCH_FILESIZE);
+  printf("%-24s %10s %10s %10s\n", "Mount", "usec", "reads", "bytes");
+
+#ifdef CONFIG_MTD_SMART_CHECKPOINT
+  /* The map is loaded from the last checkpoint and the sectors of the erase
+   * blocks recorded in the journal since then are scanned.
+   */
+
+  ret = smartbench_measure("checkpoint + journal");
+
+  /* The checkpoint areas follow the sector pool at the end of the device.
+   * Without them, the whole device is scanned.  That scan writes a new
+   * checkpoint with an empty journal.
+   */
+
+  if (ret == 0 && poolsize < SMARTBENCH_FLASHSIZE)
+    {
+      memset(g_flash + poolsize, CONFIG_RAMMTD_ERASESTATE,
+             SMARTBENCH_FLASHSIZE - poolsize);
+      ret = smartbench_measure("full scan");
+    }
+
+  if (ret == 0)
+    {
+      ret = smartbench_measure("checkpoint");
+    }
+#else
+  ret = smartbench_measure("full scan");
+#endif
+
+  return ret == 0 ? 0 : 1;
+}
@@ -0,0 +1,266 @@
+/****************************************************************************
+ * examples/sporadic/sporadic_main.c
+ *
+ *   Copyright (C) 2014 Gregory Nutt. All rights reserved.
+ *   Author: Gregory Nutt <gnutt@nuttx.org>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name NuttX nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <sys/types.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <unistd.h>
+#include <sched.h>
+#include <pthread.h>
+#include <errno.h>
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+/* Configuration ************************************************************/
+
+#ifndef CONFIG_EXAMPLES_SPORADIC_BUDGET
+#  define CONFIG_EXAMPLES_SPORADIC_BUDGET 20
+#endif
+
+#ifndef CONFIG_EXAMPLES_SPORADIC_PERIOD
+#  define CONFIG_EXAMPLES_SPORADIC_PERIOD 100
+#endif
+
+#ifndef CONFIG_EXAMPLES_SPORADIC_NSECONDS
+#  define CONFIG_EXAMPLES_SPORADIC_NSECONDS 10
+#endif
+
+/* Priorities.  The main thread must run above both test threads in order
+ * to take its measurements.
+ */
+
+#define SPORADIC_MAIN_PRIORITY    (SCHED_PRIORITY_MAX - 1)
+#define SPORADIC_CONTROL_PRIORITY (SCHED_PRIORITY_DEFAULT)
+#define SPORADIC_HIGH_PRIORITY    (SCHED_PRIORITY_DEFAULT + 10)
+#define SPORADIC_LOW_PRIORITY     (SCHED_PRIORITY_DEFAULT - 10)
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+static volatile bool g_stop;
+static volatile unsigned long g_nflood;
+static volatile unsigned long g_ncontrol;
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: sporadic_msec2ts
+ ****************************************************************************/
+
+static void sporadic_msec2ts(unsigned int msec, FAR struct timespec *ts)
+{
+  ts->tv_sec  = msec / 1000;
+  ts->tv_nsec = (long)(msec % 1000) * 1000000;
+}
+
+/****************************************************************************
+ * Name: sporadic_flood
+ *
+ * Description:
+ *   Simulates a thread that is flooded with work:  It never blocks.
+ *
+ ****************************************************************************/
+
+static FAR void *sporadic_flood(FAR void *arg)
+{
+  while (!g_stop)
+    {
+      g_nflood++;
+    }
+
+  return NULL;
+}
+
+/****************************************************************************
+ * Name: sporadic_control
+ *
+ * Description:
+ *   Simulates a control loop that uses all of the CPU left to it.
+ *
+ ****************************************************************************/
+
+static FAR void *sporadic_control(FAR void *arg)
+{
+  while (!g_stop)
+    {
+      g_ncontrol++;
+    }
+
+  return NULL;
+}
+
+/****************************************************************************
+ * Name: sporadic_create
+ ****************************************************************************/
+
+static int sporadic_create(FAR pthread_t *thread, int priority,
+                           pthread_startroutine_t entry)
+{
+  struct sched_param param;
+  pthread_attr_t attr;
+  int ret;
+
+  (void)pthread_attr_init(&attr);
+  (void)pthread_attr_setschedpolicy(&attr, SCHED_FIFO);
+  param.sched_priority = priority;
+  (void)pthread_attr_setschedparam(&attr, &param);
+
+  ret = pthread_create(thread, &attr, entry, NULL);
+  (void)pthread_attr_destroy(&attr);
+  return ret;
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * sporadic_main
+ ****************************************************************************/
+
+#ifdef CONFIG_BUILD_KERNEL
+int main(int argc, FAR char *argv[])
+#else
+int sporadic_main(int argc, char *argv[])
+#endif
+{
+  struct sched_param param;
+  pthread_t flood;
+  pthread_t control;
+  unsigned long nflood;
+  unsigned long ncontrol;
+  unsigned long total;
+  unsigned long share;
+  int policy;
+  int ret;
+  int i;
+
+  /* Run above both test threads */
+
+  param.sched_priority = SPORADIC_MAIN_PRIORITY;
+  ret = sched_setscheduler(0, SCHED_FIFO, &param);
+  if (ret < 0)
+    {
+      printf("sporadic: sched_setscheduler failed: %d\n", errno);
+      return 1;
+    }
+
+  g_stop     = false;
+  g_nflood   = 0;
+  g_ncontrol = 0;
+
+  ret = sporadic_create(&control, SPORADIC_CONTROL_PRIORITY,
+                        sporadic_control);
+  if (ret != 0)
+    {
+      printf("sporadic: pthread_create failed: %d\n", ret);
+      return 1;
+    }
+
+  ret = sporadic_create(&flood, SPORADIC_HIGH_PRIORITY, sporadic_flood);
+  if (ret != 0)
+    {
+      printf("sporadic: pthread_create failed: %d\n", ret);
+      g_stop = true;
+      (void)pthread_join(control, NULL);
+      return 1;
+    }
+
+  /* Make the flood thread a sporadic server */
+
+  param.sched_priority        = SPORADIC_HIGH_PRIORITY;
+  param.sched_ss_low_priority = SPORADIC_LOW_PRIORITY;
+  param.sched_ss_max_repl     = CONFIG_SCHED_SPORADIC_MAXREPL;
+  sporadic_msec2ts(CONFIG_EXAMPLES_SPORADIC_PERIOD,
+                   &param.sched_ss_repl_period);
+  sporadic_msec2ts(CONFIG_EXAMPLES_SPORADIC_BUDGET,
+                   &param.sched_ss_init_budget);
+
+  ret = pthread_setschedparam(flood, SCHED_SPORADIC, &param);
+  if (ret == 0)
+    {
+      ret = pthread_getschedparam(flood, &policy, &param);
+    }
+
+  if (ret != 0 || policy != SCHED_SPORADIC)
+    {
+      printf("sporadic: Failed to select SCHED_SPORADIC: %d\n", ret);
+      g_stop = true;
+      (void)pthread_join(flood, NULL);
+      (void)pthread_join(control, NULL);
+      return 1;
+    }
+
+  printf("budget %d msec, period %d msec: expected share %d%%\n\n",
+         CONFIG_EXAMPLES_SPORADIC_BUDGET, CONFIG_EXAMPLES_SPORADIC_PERIOD,
+         100 * CONFIG_EXAMPLES_SPORADIC_BUDGET /
+         CONFIG_EXAMPLES_SPORADIC_PERIOD);
+  printf("%4s %12s %12s %8s\n", "sec", "flood", "control", "share");
+
+  /* Sample the loop counts of both threads once per second.  Both threads
+   * execute the same loop so the ratio of the counts is the ratio of the
+   * CPU time that they received.
+   */
+
+  for (i = 1; i <= CONFIG_EXAMPLES_SPORADIC_NSECONDS; i++)
+    {
+      g_nflood   = 0;
+      g_ncontrol = 0;
+      sleep(1);
+
+      nflood   = g_nflood;
+      ncontrol = g_ncontrol;
+      total    = nflood + ncontrol;
+      share    = total >= 100 ? nflood / (total / 100) : 0;
+
+      printf("%4d %12lu %12lu %7lu%%\n", i, nflood, ncontrol, share);
+    }
+
+  g_stop = true;
+  (void)pthread_join(flood, NULL);
+  (void)pthread_join(control, NULL);
+  return 0;
+}
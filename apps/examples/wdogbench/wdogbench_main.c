@@ -0,0 +1,362 @@
+/****************************************************************************
+ * examples/wdogbench/wdogbench_main.c
+ *
+ *   Copyright (C) 2014 Gregory Nutt. All rights reserved.
+ *   Author: Gregory Nutt <gnutt@nuttx.org>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name NuttX nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <sys/types.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <sched.h>
+#include <time.h>
+
+#include <nuttx/wdog.h>
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+/* Configuration ************************************************************/
+
+#ifndef CONFIG_EXAMPLES_WDOGBENCH_MAXWDOGS
+#  define CONFIG_EXAMPLES_WDOGBENCH_MAXWDOGS 1000
+#endif
+
+#ifndef CONFIG_EXAMPLES_WDOGBENCH_NOPS
+#  define CONFIG_EXAMPLES_WDOGBENCH_NOPS 100000
+#endif
+
+#ifndef CONFIG_EXAMPLES_WDOGBENCH_DURATION
+#  define CONFIG_EXAMPLES_WDOGBENCH_DURATION 2
+#endif
+
+/* Watchdogs timed by the start/cancel measurement must never expire while
+ * it runs.
+ */
+
+#define WDOGBENCH_LONGDELAY 10000
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+static struct wdog_s g_wdogs[CONFIG_EXAMPLES_WDOGBENCH_MAXWDOGS];
+static int g_delays[CONFIG_EXAMPLES_WDOGBENCH_MAXWDOGS];
+static volatile unsigned long g_nexpired;
+static volatile unsigned long g_count;
+static volatile bool g_stop;
+static uint32_t g_seed = 1;
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: wdogbench_now
+ *
+ * Description:
+ *   Return the current time in microseconds.
+ *
+ ****************************************************************************/
+
+static unsigned long wdogbench_now(void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_REALTIME, &ts);
+  return (unsigned long)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+/****************************************************************************
+ * Name: wdogbench_rand
+ ****************************************************************************/
+
+static uint32_t wdogbench_rand(void)
+{
+  g_seed = g_seed * 1103515245 + 12345;
+  return g_seed >> 8;
+}
+
+/****************************************************************************
+ * Name: wdogbench_dummy
+ *
+ * Description:
+ *   The function of the watchdogs that are not expected to expire.
+ *
+ ****************************************************************************/
+
+static void wdogbench_dummy(int argc, uint32_t arg1)
+{
+}
+
+/****************************************************************************
+ * Name: wdogbench_rearm
+ *
+ * Description:
+ *   Count the expiration and restart the watchdog.
+ *
+ ****************************************************************************/
+
+static void wdogbench_rearm(int argc, uint32_t arg1)
+{
+  g_nexpired++;
+  if (!g_stop)
+    {
+      (void)wd_start(&g_wdogs[arg1], g_delays[arg1],
+                     (wdentry_t)wdogbench_rearm, 1, arg1);
+    }
+}
+
+/****************************************************************************
+ * Name: wdogbench_busy
+ *
+ * Description:
+ *   Spin for the configured duration and return the number of loops made
+ *   per second.  Time taken by the watchdogs reduces the result.
+ *
+ ****************************************************************************/
+
+static uint64_t wdogbench_busy(void)
+{
+  unsigned long start = wdogbench_now();
+  unsigned long elapsed;
+  uint64_t nloops = 0;
+  int i;
+
+  do
+    {
+      for (i = 0; i < 1000; i++)
+        {
+          g_count++;
+        }
+
+      nloops++;
+      elapsed = wdogbench_now() - start;
+    }
+  while (elapsed < CONFIG_EXAMPLES_WDOGBENCH_DURATION * 1000000UL);
+
+  return nloops * 1000000 / elapsed;
+}
+
+/****************************************************************************
+ * Name: wdogbench_startcancel
+ *
+ * Description:
+ *   Measure wd_start() and wd_cancel() with 'nwdogs' active watchdogs.
+ *   Half of the watchdogs stay active in the background; the other half is
+ *   repeatedly started and cancelled.  Returns nanoseconds per call.
+ *
+ ****************************************************************************/
+
+static void wdogbench_startcancel(int nwdogs, FAR unsigned long *startns,
+                                  FAR unsigned long *cancelns)
+{
+  unsigned long starttime = 0;
+  unsigned long canceltime = 0;
+  unsigned long nops = 0;
+  unsigned long t0;
+  int nbatch = nwdogs / 2;
+  int first = nwdogs - nbatch;
+  int i;
+  int j;
+
+  for (i = 0; i < nwdogs; i++)
+    {
+      g_delays[i] = WDOGBENCH_LONGDELAY +
+                    wdogbench_rand() % WDOGBENCH_LONGDELAY;
+    }
+
+  for (i = 0; i < first; i++)
+    {
+      (void)wd_start(&g_wdogs[i], g_delays[i], (wdentry_t)wdogbench_dummy, 0);
+    }
+
+  /* The clock is coarse, but the error of each interval is random and
+   * averages out over many intervals.
+   */
+
+  while (nops < CONFIG_EXAMPLES_WDOGBENCH_NOPS)
+    {
+      t0 = wdogbench_now();
+      for (i = first; i < nwdogs; i++)
+        {
+          (void)wd_start(&g_wdogs[i], g_delays[i],
+                         (wdentry_t)wdogbench_dummy, 0);
+        }
+
+      starttime += wdogbench_now() - t0;
+
+      /* Cancel in a different order than the watchdogs were started */
+
+      t0 = wdogbench_now();
+      for (i = 0, j = 0; i < nbatch; i++)
+        {
+          (void)wd_cancel(&g_wdogs[first + j]);
+          j += 7;
+          while (j >= nbatch)
+            {
+              j -= nbatch;
+            }
+        }
+
+      canceltime += wdogbench_now() - t0;
+      nops += nbatch;
+    }
+
+  for (i = 0; i < nwdogs; i++)
+    {
+      (void)wd_cancel(&g_wdogs[i]);
+    }
+
+  *startns  = (unsigned long)((uint64_t)starttime * 1000 / nops);
+  *cancelns = (unsigned long)((uint64_t)canceltime * 1000 / nops);
+}
+
+/****************************************************************************
+ * Name: wdogbench_expire
+ *
+ * Description:
+ *   Let 'nwdogs' watchdogs expire and restart themselves every 1 to 8
+ *   ticks and measure how much CPU time that takes away from a busy loop.
+ *   Returns nanoseconds per expiration (including the restart).
+ *
+ ****************************************************************************/
+
+static unsigned long wdogbench_expire(int nwdogs, uint64_t idlerate,
+                                      FAR unsigned long *nexpired)
+{
+  uint64_t busyrate;
+  uint64_t stolen;
+  int i;
+
+  g_stop     = false;
+  g_nexpired = 0;
+
+  for (i = 0; i < nwdogs; i++)
+    {
+      g_delays[i] = 1 + (i & 7);
+      (void)wd_start(&g_wdogs[i], g_delays[i],
+                     (wdentry_t)wdogbench_rearm, 1, (uint32_t)i);
+    }
+
+  busyrate  = wdogbench_busy();
+  *nexpired = g_nexpired;
+
+  g_stop = true;
+  for (i = 0; i < nwdogs; i++)
+    {
+      (void)wd_cancel(&g_wdogs[i]);
+    }
+
+  if (busyrate >= idlerate || *nexpired == 0)
+    {
+      return 0;
+    }
+
+  /* Nanoseconds lost during the measurement divided by the expirations */
+
+  stolen = (idlerate - busyrate) * 1000000000ULL / idlerate *
+           CONFIG_EXAMPLES_WDOGBENCH_DURATION;
+  return (unsigned long)(stolen / *nexpired);
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * wdogbench_main
+ ****************************************************************************/
+
+#ifdef CONFIG_BUILD_KERNEL
+int main(int argc, FAR char *argv[])
+#else
+int wdogbench_main(int argc, char *argv[])
+#endif
+{
+  struct sched_param saved;
+  struct sched_param param;
+  unsigned long startns;
+  unsigned long cancelns;
+  unsigned long expirens;
+  unsigned long nexpired;
+  uint64_t idlerate;
+  int nwdogs;
+  int i;
+
+  for (i = 0; i < CONFIG_EXAMPLES_WDOGBENCH_MAXWDOGS; i++)
+    {
+      wd_static(&g_wdogs[i]);
+    }
+
+  /* Run above everything except the interrupt handlers */
+
+  (void)sched_getparam(0, &saved);
+  param.sched_priority = SCHED_PRIORITY_MAX - 1;
+  (void)sched_setparam(0, &param);
+
+#ifdef CONFIG_WDOG_TIMERWHEEL
+  printf("Active watchdogs: timer wheel\n");
+#else
+  printf("Active watchdogs: sorted list\n");
+#endif
+  printf("%d start/cancel calls per measurement, %d sec per expiration "
+         "measurement\n\n", CONFIG_EXAMPLES_WDOGBENCH_NOPS,
+         CONFIG_EXAMPLES_WDOGBENCH_DURATION);
+
+  idlerate = wdogbench_busy();
+
+  printf("%8s %12s %12s %12s %10s\n",
+         "nwdogs", "start", "cancel", "expire", "expired");
+  printf("%8s %12s %12s %12s\n", "", "(nsec)", "(nsec)", "(nsec)");
+
+  for (nwdogs = 10, i = 0;
+       nwdogs <= CONFIG_EXAMPLES_WDOGBENCH_MAXWDOGS;
+       nwdogs = (i++ & 1) ? nwdogs * 10 / 3 : nwdogs * 3)
+    {
+      wdogbench_startcancel(nwdogs, &startns, &cancelns);
+      expirens = wdogbench_expire(nwdogs, idlerate, &nexpired);
+
+      printf("%8d %12lu %12lu %12lu %10lu\n",
+             nwdogs, startns, cancelns, expirens, nexpired);
+    }
+
+  (void)sched_setparam(0, &saved);
+  return 0;
+}
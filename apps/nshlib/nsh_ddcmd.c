@@ -140,7 +140,7 @@ struct dd_s
   int  (*infread)(struct dd_s *dd);
   void (*infclose)(struct dd_s *dd);
   int  (*outfwrite)(struct dd_s *dd);
-  void (*outfclose)(struct dd_s *dd);
+  int  (*outfclose)(struct dd_s *dd);
 #endif
 };
 
@@ -167,9 +167,21 @@ static const char g_dd[] = "dd";
  ****************************************************************************/
 
 #ifndef CONFIG_DISABLE_MOUNTPOINT
-static void dd_outfcloseblk(struct dd_s *dd)
+static int dd_outfcloseblk(struct dd_s *dd)
 {
-  (void)bchlib_teardown(DD_OUTHANDLE);
+  /* Sectors are written back to the device when the BCH state is torn
+   * down, so this is where a write error is reported.
+   */
+
+  int ret = bchlib_teardown(DD_OUTHANDLE);
+  if (ret < 0)
+    {
+      FAR struct nsh_vtbl_s *vtbl = dd->vtbl;
+      nsh_output(vtbl, g_fmtcmdfailed, g_dd, "bchlib_teardown", NSH_ERRNO_OF(-ret));
+      return ERROR;
+    }
+
+  return OK;
 }
 #endif
 
@@ -177,9 +189,16 @@ static void dd_outfcloseblk(struct dd_s *dd)
  * Name: dd_outfclosech
  ****************************************************************************/
 
-static void dd_outfclosech(struct dd_s *dd)
+static int dd_outfclosech(struct dd_s *dd)
 {
-  (void)close(DD_OUTFD);
+  if (close(DD_OUTFD) < 0)
+    {
+      FAR struct nsh_vtbl_s *vtbl = dd->vtbl;
+      nsh_output(vtbl, g_fmtcmdfailed, g_dd, "close", NSH_ERRNO);
+      return ERROR;
+    }
+
+  return OK;
 }
 
 /****************************************************************************
@@ -621,7 +640,10 @@ int cmd_dd(FAR struct nsh_vtbl_s *vtbl, int argc, char **argv)
   ret = OK;
 
 errout_with_outf:
-  DD_OUTCLOSE(&dd);
+  if (DD_OUTCLOSE(&dd) < 0)
+    {
+      ret = ERROR;
+    }
 
 errout_with_inf:
   DD_INCLOSE(&dd);
@@ -63,6 +63,12 @@
 #  define HAVE_CPULOAD 1
 #endif
 
+#undef HAVE_CPUTIME
+#if defined(CONFIG_SCHED_CPUTIME) && defined(CONFIG_FS_PROCFS) && \
+   !defined(CONFIG_FS_PROCFS_EXCLUDE_PROCESS)
+#  define HAVE_CPUTIME 1
+#endif
+
 /****************************************************************************
  * Private Types
  ****************************************************************************/
@@ -120,7 +126,7 @@ static const char *g_ttypenames[4] =
  * Name: readfile
  ****************************************************************************/
 
-#ifdef HAVE_CPULOAD
+#if defined(HAVE_CPULOAD) || defined(HAVE_CPUTIME)
 static int readfile(FAR const char *filename, FAR char *buffer, size_t buflen)
 {
   FAR char *bufptr;
@@ -224,6 +230,26 @@ static int loadavg(pid_t pid, FAR char *buffer, size_t buflen)
 }
 #endif
 
+/****************************************************************************
+ * Name: cputime
+ ****************************************************************************/
+
+#ifdef HAVE_CPUTIME
+static int cputime(pid_t pid, FAR char *buffer, size_t buflen)
+{
+  char path[24];
+
+  /* Form the full path to the 'cputime' pseudo-file */
+
+  snprintf(path, sizeof(path), CONFIG_NSH_PROC_MOUNTPOUNT "/%d/cputime",
+           (int)pid);
+
+  /* Read the 'cputime' pseudo-file into the user buffer */
+
+  return readfile(path, buffer, buflen);
+}
+#endif
+
 /****************************************************************************
  * Name: ps_task
  ****************************************************************************/
@@ -234,6 +260,16 @@ static void ps_task(FAR struct tcb_s *tcb, FAR void *arg)
   struct nsh_vtbl_s *vtbl = (struct nsh_vtbl_s*)arg;
 #ifdef HAVE_CPULOAD
   char buffer[8];
+#endif
+#ifdef HAVE_CPUTIME
+  char timebuf[48];
+  unsigned long sec;
+  unsigned long usec;
+  unsigned long maxrun;
+  unsigned long nvcsw;
+  unsigned long nivcsw;
+#endif
+#if defined(HAVE_CPULOAD) || defined(HAVE_CPUTIME)
   int ret;
 #endif
 #if CONFIG_MAX_TASK_ARGS > 2
@@ -264,6 +300,23 @@ static void ps_task(FAR struct tcb_s *tcb, FAR void *arg)
   nsh_output(vtbl, "%-6s ", buffer);
 #endif
 
+#ifdef HAVE_CPUTIME
+  /* Get the execution time, the longest run and the context switches */
+
+  ret = cputime(tcb->pid, timebuf, sizeof(timebuf));
+  if (ret < 0 ||
+      sscanf(timebuf, "%lu.%lu %lu %lu %lu",
+             &sec, &usec, &maxrun, &nvcsw, &nivcsw) != 5)
+    {
+      nsh_output(vtbl, "%10s %8s %6s %6s ", "", "", "", "");
+    }
+  else
+    {
+      nsh_output(vtbl, "%6lu.%03lu %8lu %6lu %6lu ",
+                 sec, usec / 1000, maxrun, nvcsw, nivcsw);
+    }
+#endif
+
   /* Show task name and arguments */
 
 #if CONFIG_TASK_NAME_SIZE > 0
@@ -339,11 +392,14 @@ int cmd_exec(FAR struct nsh_vtbl_s *vtbl, int argc, char **argv)
 #ifndef CONFIG_NSH_DISABLE_PS
 int cmd_ps(FAR struct nsh_vtbl_s *vtbl, int argc, char **argv)
 {
+  nsh_output(vtbl, "PID   PRI SCHD TYPE   NP STATE    ");
 #ifdef HAVE_CPULOAD
-  nsh_output(vtbl, "PID   PRI SCHD TYPE   NP STATE    CPU    NAME\n");
-#else
-  nsh_output(vtbl, "PID   PRI SCHD TYPE   NP STATE    NAME\n");
+  nsh_output(vtbl, "CPU    ");
+#endif
+#ifdef HAVE_CPUTIME
+  nsh_output(vtbl, "TIME       MAXRUN   VCSW   ICSW   ");
 #endif
+  nsh_output(vtbl, "NAME\n");
   sched_foreach(ps_task, vtbl);
   return OK;
 }
@@ -52,24 +52,62 @@
  * Pre-processor Definitions
  ****************************************************************************/
 
+/* Configuration ************************************************************/
+
+#ifndef CONFIG_BCH_NSECTORS
+#  define CONFIG_BCH_NSECTORS 4
+#endif
+
+#if CONFIG_BCH_NSECTORS < 1
+#  undef  CONFIG_BCH_NSECTORS
+#  define CONFIG_BCH_NSECTORS 1
+#endif
+
+/* Helpers ******************************************************************/
+
 #define bchlib_semgive(d) sem_post(&(d)->sem)  /* To match bchlib_semtake */
 #define MAX_OPENCNT     (255)                  /* Limit of uint8_t */
 
+/* True if sector 's' is held in the sector cache */
+
+#define BCH_CACHED(b,s) \
+  ((s) >= (b)->sector && (s) - (b)->sector < (b)->ncached)
+
+/* True if any of the 'n' sectors beginning with 's' is held in the cache */
+
+#define BCH_OVERLAP(b,s,n) \
+  ((b)->ncached > 0 && (s) < (b)->sector + (b)->ncached && \
+   (b)->sector < (s) + (n))
+
+/* The location of cached sector 's' in the sector cache */
+
+#define BCH_SECTBUFFER(b,s) (&(b)->buffer[((s) - (b)->sector) * (b)->sectsize])
+
 /****************************************************************************
  * Public Types
  ****************************************************************************/
 
+/* The sector cache holds up to CONFIG_BCH_NSECTORS consecutive sectors of
+ * the device beginning with 'sector'.  When a sector that is not cached is
+ * accessed right after the preceding sector, the following sectors are
+ * read ahead with the same transfer.  Modified sectors are written back
+ * together, in one transfer, when the cache is refilled or flushed.
+ */
+
 struct bchlib_s
 {
   struct inode *inode; /* I-node of the block driver */
   sem_t    sem;        /* For atomic accesses to this structure */
   size_t   nsectors;   /* Number of sectors supported by the device */
-  size_t   sector;     /* The current sector in the buffer */
+  size_t   sector;     /* The first sector in the cache */
+  size_t   nextsector; /* The sector following the last sector accessed */
   uint16_t sectsize;   /* The size of one sector on the device */
+  uint16_t ncached;    /* The number of sectors in the cache */
+  uint16_t dirtystart; /* Index of the first modified sector in the cache */
+  uint16_t dirtyend;   /* Index following the last modified sector */
   uint8_t  refs;       /* Number of references */
-  bool  dirty;         /* Data has been written to the buffer */
   bool  readonly;      /* true:  Only read operations are supported */
-  FAR uint8_t *buffer; /* One sector buffer */
+  FAR uint8_t *buffer; /* CONFIG_BCH_NSECTORS sector buffers */
 
 #if defined(CONFIG_BCH_ENCRYPTION)
   uint8_t   key[CONFIG_BCH_ENCRYPTION_KEY_SIZE];   /* Encryption key */
@@ -97,6 +135,9 @@ EXTERN const struct file_operations bch_fops;
 EXTERN void bchlib_semtake(FAR struct bchlib_s *bch);
 EXTERN int  bchlib_flushsector(FAR struct bchlib_s *bch);
 EXTERN int  bchlib_readsector(FAR struct bchlib_s *bch, size_t sector);
+EXTERN void bchlib_dirtysector(FAR struct bchlib_s *bch, size_t sector);
+EXTERN int  bchlib_invalidate(FAR struct bchlib_s *bch, size_t sector,
+                              size_t nsectors);
 
 #undef EXTERN
 #if defined(__cplusplus)
@@ -140,15 +140,17 @@ static int bch_close(FAR struct file *filep)
 {
   FAR struct inode *inode = filep->f_inode;
   FAR struct bchlib_s *bch;
-  int ret = OK;
+  int ret;
 
   DEBUGASSERT(inode && inode->i_private);
   bch = (FAR struct bchlib_s *)inode->i_private;
 
-  /* Flush any dirty pages remaining in the cache */
+  /* Flush any dirty pages remaining in the cache.  Writes are not written
+   * through, so this is where a write error is reported.
+   */
 
   bchlib_semtake(bch);
-  (void)bchlib_flushsector(bch);
+  ret = bchlib_flushsector(bch);
 
   /* Decrement the reference count (I don't use bchlib_decref() because I
    * want the entire close operation to be atomic wrt other driver operations.
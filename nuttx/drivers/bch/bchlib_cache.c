@@ -85,32 +85,39 @@ static void bch_xor(uint32_t *R, uint32_t *A, uint32_t *B)
 
 /****************************************************************************
  * Name: bch_cypher
+ *
+ * Description:
+ *   Encrypt or decrypt the 'nsectors' cached sectors beginning with
+ *   'sector'.
+ *
  ****************************************************************************/
 
 #if defined(CONFIG_BCH_ENCRYPTION)
-static int bch_cypher(FAR struct bchlib_s *bch, int encrypt)
+static void bch_cypher(FAR struct bchlib_s *bch, size_t sector,
+                       size_t nsectors, int encrypt)
 {
   int blocks = bch->sectsize / 16;
-  uint32_t *buffer = (uint32_t*)bch->buffer;
+  uint32_t *buffer = (uint32_t*)BCH_SECTBUFFER(bch, sector);
   int i;
 
-  for (i = 0; i < blocks; i++, buffer += 16 / sizeof(uint32_t) )
+  for (; nsectors > 0; nsectors--, sector++)
     {
-      uint32_t T[4];
-      uint32_t X[4] = {bch->sector, 0, 0, i};
+      for (i = 0; i < blocks; i++, buffer += 16 / sizeof(uint32_t) )
+        {
+          uint32_t T[4];
+          uint32_t X[4] = {sector, 0, 0, i};
 
-      aes_cypher(X, X, 16, NULL, bch->key, CONFIG_BCH_ENCRYPTION_KEY_SIZE,
-                 AES_MODE_ECB, CYPHER_ENCRYPT);
+          aes_cypher(X, X, 16, NULL, bch->key, CONFIG_BCH_ENCRYPTION_KEY_SIZE,
+                     AES_MODE_ECB, CYPHER_ENCRYPT);
 
-      /* Xor-Encrypt-Xor */
+          /* Xor-Encrypt-Xor */
 
-      bch_xor(T, X, buffer);
-      aes_cypher(T, T, 16, NULL, bch->key, CONFIG_BCH_ENCRYPTION_KEY_SIZE,
-                 AES_MODE_ECB, encrypt);
-      bch_xor(buffer, X, T);
+          bch_xor(T, X, buffer);
+          aes_cypher(T, T, 16, NULL, bch->key, CONFIG_BCH_ENCRYPTION_KEY_SIZE,
+                     AES_MODE_ECB, encrypt);
+          bch_xor(buffer, X, T);
+        }
     }
-
-  return OK;
 }
 #endif
 
@@ -122,7 +129,10 @@ static int bch_cypher(FAR struct bchlib_s *bch, int encrypt)
  * Name: bchlib_flushsector
  *
  * Description:
- *   Flush the current contents of the sector buffer (if dirty)
+ *   Write the modified sectors of the sector cache (if any) back to the
+ *   media in a single transfer.  If the write fails, the sectors stay
+ *   marked as modified so that the data is not lost and the error is
+ *   reported again by the next flush.
  *
  * Assumptions:
  *   Caller must assume mutual exclusion
@@ -132,28 +142,33 @@ static int bch_cypher(FAR struct bchlib_s *bch, int encrypt)
 int bchlib_flushsector(FAR struct bchlib_s *bch)
 {
   FAR struct inode *inode;
+  size_t sector;
+  size_t nsectors;
   ssize_t ret = OK;
 
-  /* Check if the sector has been modified and is out of synch with the
+  /* Check if any sector has been modified and is out of synch with the
    * media.
    */
 
-  if (bch->dirty)
+  if (bch->dirtyend > bch->dirtystart)
     {
-      inode = bch->inode;
+      inode    = bch->inode;
+      sector   = bch->sector + bch->dirtystart;
+      nsectors = bch->dirtyend - bch->dirtystart;
 
 #if defined(CONFIG_BCH_ENCRYPTION)
       /* Encrypt data as necessary */
 
-      bch_cypher(bch, CYPHER_ENCRYPT);
+      bch_cypher(bch, sector, nsectors, CYPHER_ENCRYPT);
 #endif
 
-      /* Write the sector to the media */
+      /* Write the sectors to the media */
 
-      ret = inode->u.i_bops->write(inode, bch->buffer, bch->sector, 1);
+      ret = inode->u.i_bops->write(inode, BCH_SECTBUFFER(bch, sector),
+                                   sector, nsectors);
       if (ret < 0)
         {
-          fdbg("Write failed: %d\n");
+          fdbg("Write failed: %d\n", ret);
         }
 
 #if defined(CONFIG_BCH_ENCRYPTION)
@@ -161,22 +176,31 @@ int bchlib_flushsector(FAR struct bchlib_s *bch)
        * TODO: Add configuration switch for extra sector buffer
        */
 
-      bch_cypher(bch, CYPHER_DECRYPT);
+      bch_cypher(bch, sector, nsectors, CYPHER_DECRYPT);
 #endif
 
-      /* The sector is now in sync with the media */
+      /* On success, the sectors are now in sync with the media */
 
-      bch->dirty = false;
+      if (ret >= 0)
+        {
+          bch->dirtystart = 0;
+          bch->dirtyend   = 0;
+        }
     }
 
-  return (int)ret;
+  return ret < 0 ? (int)ret : OK;
 }
 
 /****************************************************************************
  * Name: bchlib_readsector
  *
  * Description:
- *   Flush the current contents of the sector buffer (if dirty)
+ *   Make sure that 'sector' is in the sector cache.  If it is not, the
+ *   modified sectors of the cache are written back and the cache is
+ *   refilled beginning with 'sector'.  If the sector follows the sector
+ *   that was accessed last, the access is assumed to be sequential and
+ *   the cache is filled with as many of the following sectors as it holds.
+ *   Otherwise only the one sector is read.
  *
  * Assumptions:
  *   Caller must assume mutual exclusion
@@ -186,25 +210,111 @@ int bchlib_flushsector(FAR struct bchlib_s *bch)
 int bchlib_readsector(FAR struct bchlib_s *bch, size_t sector)
 {
   FAR struct inode *inode;
+  size_t nsectors;
   ssize_t ret = OK;
 
-  if (bch->sector != sector)
+  if (!BCH_CACHED(bch, sector))
     {
       inode = bch->inode;
 
-      (void)bchlib_flushsector(bch);
-      bch->sector = (size_t)-1;
+      ret = bchlib_flushsector(bch);
+      if (ret < 0)
+        {
+          return (int)ret;
+        }
+
+      /* Read ahead if the access is sequential */
 
-      ret = inode->u.i_bops->read(inode, bch->buffer, sector, 1);
+      nsectors = 1;
+      if (sector == bch->nextsector)
+        {
+          nsectors = bch->nsectors - sector;
+          if (nsectors > CONFIG_BCH_NSECTORS)
+            {
+              nsectors = CONFIG_BCH_NSECTORS;
+            }
+        }
+
+      bch->sector  = sector;
+      bch->ncached = 0;
+
+      ret = inode->u.i_bops->read(inode, bch->buffer, sector, nsectors);
       if (ret < 0)
         {
-          fdbg("Read failed: %d\n");
+          fdbg("Read failed: %d\n", ret);
+          return (int)ret;
         }
-      bch->sector = sector;
+
+      bch->ncached = nsectors;
 #if defined(CONFIG_BCH_ENCRYPTION)
-      bch_cypher(bch, CYPHER_DECRYPT);
+      bch_cypher(bch, sector, nsectors, CYPHER_DECRYPT);
 #endif
+      ret = OK;
     }
+
+  bch->nextsector = sector + 1;
   return (int)ret;
 }
 
+/****************************************************************************
+ * Name: bchlib_dirtysector
+ *
+ * Description:
+ *   Mark a cached sector as modified.
+ *
+ * Assumptions:
+ *   Caller must assume mutual exclusion.  The sector is in the cache.
+ *
+ ****************************************************************************/
+
+void bchlib_dirtysector(FAR struct bchlib_s *bch, size_t sector)
+{
+  uint16_t index;
+
+  DEBUGASSERT(BCH_CACHED(bch, sector));
+
+  index = sector - bch->sector;
+  if (bch->dirtyend <= bch->dirtystart)
+    {
+      bch->dirtystart = index;
+      bch->dirtyend   = index + 1;
+    }
+  else if (index < bch->dirtystart)
+    {
+      bch->dirtystart = index;
+    }
+  else if (index >= bch->dirtyend)
+    {
+      bch->dirtyend   = index + 1;
+    }
+}
+
+/****************************************************************************
+ * Name: bchlib_invalidate
+ *
+ * Description:
+ *   Write back and discard the cache if it holds any of the 'nsectors'
+ *   sectors beginning with 'sector'.  This must be done before those
+ *   sectors are written directly from the user buffer.
+ *
+ * Assumptions:
+ *   Caller must assume mutual exclusion
+ *
+ ****************************************************************************/
+
+int bchlib_invalidate(FAR struct bchlib_s *bch, size_t sector,
+                      size_t nsectors)
+{
+  int ret = OK;
+
+  if (BCH_OVERLAP(bch, sector, nsectors))
+    {
+      ret = bchlib_flushsector(bch);
+      if (ret >= 0)
+        {
+          bch->ncached = 0;
+        }
+    }
+
+  return ret;
+}
@@ -113,9 +113,13 @@ ssize_t bchlib_read(FAR void *handle, FAR char *buffer, size_t offset, size_t le
   bytesread = 0;
   if (sectoffset > 0)
     {
-      /* Read the sector into the sector buffer */
+      /* Read the sector into the sector cache */
 
-      bchlib_readsector(bch, sector);
+      ret = bchlib_readsector(bch, sector);
+      if (ret < 0)
+        {
+          return ret;
+        }
 
       /* Copy the tail end of the sector to the user buffer */
 
@@ -128,7 +132,7 @@ ssize_t bchlib_read(FAR void *handle, FAR char *buffer, size_t offset, size_t le
           nbytes = len;
         }
 
-      memcpy(buffer, &bch->buffer[sectoffset], nbytes);
+      memcpy(buffer, BCH_SECTBUFFER(bch, sector) + sectoffset, nbytes);
 
       /* Adjust pointers and counts */
 
@@ -145,8 +149,31 @@ ssize_t bchlib_read(FAR void *handle, FAR char *buffer, size_t offset, size_t le
       len       -= nbytes;
     }
 
-  /* Then read all of the full sectors following the partial sector directly
-   * into the user buffer.
+  /* Full sectors that are already in the sector cache are copied from
+   * there.
+   */
+
+  while (len >= bch->sectsize && BCH_CACHED(bch, sector))
+    {
+      memcpy(buffer, BCH_SECTBUFFER(bch, sector), bch->sectsize);
+      bch->nextsector = sector + 1;
+
+      /* Adjust pointers and counts */
+
+      sector++;
+      bytesread += bch->sectsize;
+
+      if (sector >= bch->nsectors)
+        {
+          return bytesread;
+        }
+
+      buffer    += bch->sectsize;
+      len       -= bch->sectsize;
+    }
+
+  /* Then read all of the remaining full sectors directly into the user
+   * buffer.
    */
 
   if (len >= bch->sectsize )
@@ -157,6 +184,17 @@ ssize_t bchlib_read(FAR void *handle, FAR char *buffer, size_t offset, size_t le
           nsectors = bch->nsectors - sector;
         }
 
+      /* Modified sectors in the cache must reach the media first */
+
+      if (BCH_OVERLAP(bch, sector, nsectors))
+        {
+          ret = bchlib_flushsector(bch);
+          if (ret < 0)
+            {
+              return ret;
+            }
+        }
+
       ret = bch->inode->u.i_bops->read(bch->inode, (FAR uint8_t *)buffer,
                                        sector, nsectors);
       if (ret < 0)
@@ -167,8 +205,9 @@ ssize_t bchlib_read(FAR void *handle, FAR char *buffer, size_t offset, size_t le
 
       /* Adjust pointers and counts */
 
-      sectoffset = 0;
-      sector    += nsectors;
+      sectoffset       = 0;
+      sector          += nsectors;
+      bch->nextsector  = sector;
 
       nbytes     = nsectors * bch->sectsize;
       bytesread += nbytes;
@@ -186,13 +225,17 @@ ssize_t bchlib_read(FAR void *handle, FAR char *buffer, size_t offset, size_t le
 
   if (len > 0)
     {
-      /* Read the sector into the sector buffer */
+      /* Read the sector into the sector cache */
 
-      bchlib_readsector(bch, sector);
+      ret = bchlib_readsector(bch, sector);
+      if (ret < 0)
+        {
+          return bytesread > 0 ? bytesread : ret;
+        }
 
       /* Copy the head end of the sector to the user buffer */
 
-      memcpy(buffer, bch->buffer, len);
+      memcpy(buffer, BCH_SECTBUFFER(bch, sector), len);
 
       /* Adjust counts */
 
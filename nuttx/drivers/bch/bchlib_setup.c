@@ -140,12 +140,12 @@ int bchlib_setup(const char *blkdev, bool readonly, FAR void **handle)
   bch->sector   = (size_t)-1;
   bch->readonly = readonly;
 
-  /* Allocate the sector I/O buffer */
+  /* Allocate the sector cache */
 
-  bch->buffer = (FAR uint8_t *)kmm_malloc(bch->sectsize);
+  bch->buffer = (FAR uint8_t *)kmm_malloc(CONFIG_BCH_NSECTORS * bch->sectsize);
   if (!bch->buffer)
     {
-      fdbg("Failed to allocate sector buffer\n");
+      fdbg("Failed to allocate sector cache\n");
       ret = -ENOMEM;
       goto errout_with_bch;
     }
@@ -81,6 +81,7 @@
 int bchlib_teardown(FAR void *handle)
 {
   FAR struct bchlib_s *bch = (FAR struct bchlib_s *)handle;
+  int ret;
 
   DEBUGASSERT(handle);
 
@@ -91,9 +92,12 @@ int bchlib_teardown(FAR void *handle)
       return -EBUSY;
     }
 
-  /* Flush any pending data to the block driver */
+  /* Flush any pending data to the block driver.  The state is released
+   * even if this fails, but the error is returned so that the caller knows
+   * that the data was lost.
+   */
 
-  bchlib_flushsector(bch);
+  ret = bchlib_flushsector(bch);
 
   /* Close the block driver */
 
@@ -108,6 +112,6 @@ int bchlib_teardown(FAR void *handle)
 
   sem_destroy(&bch->sem);
   kmm_free(bch);
-  return OK;
+  return ret;
 }
 
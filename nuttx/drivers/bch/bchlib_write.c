@@ -112,9 +112,13 @@ ssize_t bchlib_write(FAR void *handle, FAR const char *buffer, size_t offset, si
   byteswritten = 0;
   if (sectoffset > 0)
     {
-      /* Read the full sector into the sector buffer */
+      /* Read the full sector into the sector cache */
 
-      bchlib_readsector(bch, sector);
+      ret = bchlib_readsector(bch, sector);
+      if (ret < 0)
+        {
+          return ret;
+        }
 
       /* Copy the tail end of the sector from the user buffer */
 
@@ -127,8 +131,8 @@ ssize_t bchlib_write(FAR void *handle, FAR const char *buffer, size_t offset, si
           nbytes = len;
         }
 
-      memcpy(&bch->buffer[sectoffset], buffer, nbytes);
-      bch->dirty = true;
+      memcpy(BCH_SECTBUFFER(bch, sector) + sectoffset, buffer, nbytes);
+      bchlib_dirtysector(bch, sector);
 
       /* Adjust pointers and counts */
 
@@ -145,8 +149,32 @@ ssize_t bchlib_write(FAR void *handle, FAR const char *buffer, size_t offset, si
       len          -= nbytes;
     }
 
-  /* Then write all of the full sectors following the partial sector
-   * directly from the user buffer.
+  /* Full sectors that are already in the sector cache are updated there so
+   * that they are written back together with the partial sectors.
+   */
+
+  while (len >= bch->sectsize && BCH_CACHED(bch, sector))
+    {
+      memcpy(BCH_SECTBUFFER(bch, sector), buffer, bch->sectsize);
+      bchlib_dirtysector(bch, sector);
+      bch->nextsector = sector + 1;
+
+      /* Adjust pointers and counts */
+
+      sector++;
+      byteswritten += bch->sectsize;
+
+      if (sector >= bch->nsectors)
+        {
+          return byteswritten;
+        }
+
+      buffer       += bch->sectsize;
+      len          -= bch->sectsize;
+    }
+
+  /* Then write all of the remaining full sectors directly from the user
+   * buffer.
    */
 
   if (len >= bch->sectsize )
@@ -157,6 +185,14 @@ ssize_t bchlib_write(FAR void *handle, FAR const char *buffer, size_t offset, si
           nsectors = bch->nsectors - sector;
         }
 
+      /* The cache must not hold stale copies of these sectors */
+
+      ret = bchlib_invalidate(bch, sector, nsectors);
+      if (ret < 0)
+        {
+          return byteswritten > 0 ? byteswritten : ret;
+        }
+
       /* Write the contiguous sectors */
 
       ret = bch->inode->u.i_bops->write(bch->inode, (FAR uint8_t *)buffer,
@@ -169,8 +205,9 @@ ssize_t bchlib_write(FAR void *handle, FAR const char *buffer, size_t offset, si
 
       /* Adjust pointers and counts */
 
-      sectoffset    = 0;
-      sector       += nsectors;
+      sectoffset       = 0;
+      sector          += nsectors;
+      bch->nextsector  = sector;
 
       nbytes        = nsectors * bch->sectsize;
       byteswritten += nbytes;
@@ -188,28 +225,28 @@ ssize_t bchlib_write(FAR void *handle, FAR const char *buffer, size_t offset, si
 
   if (len > 0)
     {
-      /* Read the sector into the sector buffer */
+      /* Read the sector into the sector cache */
 
-      bchlib_readsector(bch, sector);
+      ret = bchlib_readsector(bch, sector);
+      if (ret < 0)
+        {
+          return byteswritten > 0 ? byteswritten : ret;
+        }
 
       /* Copy the head end of the sector from the user buffer */
 
-      memcpy(bch->buffer, buffer, len);
-      bch->dirty = true;
+      memcpy(BCH_SECTBUFFER(bch, sector), buffer, len);
+      bchlib_dirtysector(bch, sector);
 
       /* Adjust counts */
 
       byteswritten += len;
     }
 
-  /* Finally, flush any cached writes to the device as well */
-
-  ret = bchlib_flushsector(bch);
-  if (ret < 0)
-    {
-      fdbg("Flush failed: %d\n", ret);
-      return ret;
-    }
+  /* Modified sectors stay in the cache so that following writes to the
+   * same sectors are combined.  They are written back when the cache is
+   * refilled, when the device is closed, or by bchlib_teardown().
+   */
 
   return byteswritten;
 }
@@ -51,6 +51,7 @@
 #include <string.h>
 #include <debug.h>
 #include <errno.h>
+#include <crc32.h>
 
 #include <nuttx/kmalloc.h>
 #include <nuttx/fs/fs.h>
@@ -119,6 +120,28 @@
 #define offsetof(type, member) ( (size_t) &( ( (type *) 0)->member))
 #endif
 
+/* Sector map checkpoint.  Two areas are reserved at the end of the device.
+ * Each holds a header in its first MTD block, followed by an image of the
+ * sMap, releasecount and freecount arrays, followed by a journal with one
+ * entry for every erase block modified since the image was written.
+ */
+
+#ifdef CONFIG_MTD_SMART_CHECKPOINT
+#  ifndef CONFIG_MTD_SMART_CHECKPOINT_DIRTY
+#    define CONFIG_MTD_SMART_CHECKPOINT_DIRTY 8
+#  endif
+
+#  define SMART_CKPT_SIG1         'S'
+#  define SMART_CKPT_SIG2         'M'
+#  define SMART_CKPT_SIG3         'C'
+#  define SMART_CKPT_SIG4         'P'
+
+#  define SMART_CKPT_NONE         0xFF    /* No checkpoint area is active */
+#  define SMART_CKPT_ENTRYSIZE    4       /* Size of one journal entry */
+#else
+#  define smart_ckpt_dirty(dev, block)
+#endif
+
 /****************************************************************************
  * Private Types
  ****************************************************************************/
@@ -145,6 +168,14 @@ struct smart_struct_s
   uint8_t               rootdirentries;   /* Number of root directory entries */
   uint8_t               minor;            /* Minor number of the block entry */
 #endif
+#ifdef CONFIG_MTD_SMART_CHECKPOINT
+  uint16_t              ckptblocks;       /* Erase blocks per checkpoint area */
+  uint16_t              ckptndirty;       /* Number of journalled erase blocks */
+  uint8_t               ckptarea;         /* Active checkpoint area (0 or 1) */
+  uint32_t              ckptseq;          /* Sequence number of the active area */
+  FAR uint8_t          *ckptdirty;        /* Bitmap of journalled erase blocks */
+  FAR uint8_t          *ckptbuffer;       /* MTD block buffer for the checkpoint */
+#endif
 };
 
 #ifdef CONFIG_SMARTFS_MULTI_ROOT_DIRS
@@ -171,6 +202,21 @@ struct smart_sect_header_s
                                            * Bit 1-0: Format version    */
 };
 
+#ifdef CONFIG_MTD_SMART_CHECKPOINT
+struct smart_ckpt_header_s
+{
+  uint8_t               magic[4];         /* SMART_CKPT_SIG1-4 */
+  uint32_t              seq;              /* Incremented with each checkpoint */
+  uint32_t              datalen;          /* Size of the map image */
+  uint32_t              datacrc;          /* CRC32 of the map image */
+  uint16_t              totalsectors;     /* Geometry the image was taken with */
+  uint16_t              neraseblocks;
+  uint16_t              sectorsize;
+  uint16_t              ckptblocks;
+  uint32_t              hdrcrc;           /* CRC32 of the preceding fields */
+};
+#endif
+
 /****************************************************************************
  * Private Function Prototypes
  ****************************************************************************/
@@ -187,6 +233,9 @@ static ssize_t smart_write(FAR struct inode *inode, const unsigned char *buffer,
 #endif
 static int     smart_geometry(FAR struct inode *inode, struct geometry *geometry);
 static int     smart_ioctl(FAR struct inode *inode, int cmd, unsigned long arg);
+#ifdef CONFIG_MTD_SMART_CHECKPOINT
+static void    smart_ckpt_dirty(struct smart_struct_s *dev, uint16_t block);
+#endif
 
 /****************************************************************************
  * Private Data
@@ -344,6 +393,17 @@ static ssize_t smart_write(FAR struct inode *inode, const unsigned char *buffer,
 
   fvdbg("mtdsector: %d mtdnsectors: %d\n", mtdstartblock, mtdblockcount);
 
+#ifdef CONFIG_MTD_SMART_CHECKPOINT
+  /* Journal every erase block that will be rewritten */
+
+  for (eraseblock = start_sector / dev->sectorsPerBlk;
+       eraseblock * dev->sectorsPerBlk < start_sector + nsectors;
+       eraseblock++)
+    {
+      smart_ckpt_dirty(dev, eraseblock);
+    }
+#endif
+
   /* Start at first block to be written */
 
   remaining = mtdblockcount;
@@ -448,7 +508,7 @@ static int smart_geometry(FAR struct inode *inode, struct geometry *geometry)
           erasesize = 65536;
         }
 
-      geometry->geo_nsectors      = dev->geo.neraseblocks * erasesize /
+      geometry->geo_nsectors      = dev->neraseblocks * erasesize /
                                      dev->sectorsize;
       geometry->geo_sectorsize    = dev->sectorsize;
 
@@ -475,6 +535,10 @@ static int smart_setsectorsize(struct smart_struct_s *dev, uint16_t size)
 {
   uint32_t  erasesize;
   uint32_t  totalsectors;
+  size_t    allocsize;
+#ifdef CONFIG_MTD_SMART_CHECKPOINT
+  uint32_t  ckptsize;
+#endif
 
   /* Validate the size isn't zero so we don't divide by zero below */
 
@@ -499,6 +563,28 @@ static int smart_setsectorsize(struct smart_struct_s *dev, uint16_t size)
   dev->mtdBlksPerSector = dev->sectorsize / dev->geo.blocksize;
   dev->sectorsPerBlk = erasesize / dev->sectorsize;
 
+#ifdef CONFIG_MTD_SMART_CHECKPOINT
+  /* Reserve the two checkpoint areas at the end of the device.  The size
+   * of an area is calculated as if the whole device held sectors, which
+   * is slightly more than is needed once the areas are subtracted.
+   */
+
+  totalsectors = dev->neraseblocks * dev->sectorsPerBlk;
+  ckptsize  = totalsectors * sizeof(uint16_t) + (dev->neraseblocks << 1);
+  ckptsize  = (ckptsize + dev->geo.blocksize - 1) / dev->geo.blocksize + 1;
+  ckptsize  = ckptsize * dev->geo.blocksize +
+              dev->neraseblocks * SMART_CKPT_ENTRYSIZE;
+  dev->ckptblocks = (ckptsize + erasesize - 1) / erasesize;
+
+  if (2 * dev->ckptblocks >= dev->neraseblocks)
+    {
+      fdbg("Device too small for the sector map checkpoint\n");
+      return -EINVAL;
+    }
+
+  dev->neraseblocks -= 2 * dev->ckptblocks;
+#endif
+
   /* Release any existing rwbuffer and sMap */
 
   if (dev->sMap != NULL)
@@ -518,8 +604,12 @@ static int smart_setsectorsize(struct smart_struct_s *dev, uint16_t size)
   totalsectors = dev->neraseblocks * dev->sectorsPerBlk;
   dev->totalsectors = (uint16_t) totalsectors;
 
-  dev->sMap = (uint16_t *) kmm_malloc(totalsectors * sizeof(uint16_t) +
-              (dev->neraseblocks << 1));
+  allocsize = totalsectors * sizeof(uint16_t) + (dev->neraseblocks << 1);
+#ifdef CONFIG_MTD_SMART_CHECKPOINT
+  allocsize += ((dev->neraseblocks + 7) >> 3) + dev->geo.blocksize;
+#endif
+
+  dev->sMap = (uint16_t *) kmm_malloc(allocsize);
   if (!dev->sMap)
     {
       fdbg("Error allocating SMART virtual map buffer\n");
@@ -530,89 +620,964 @@ static int smart_setsectorsize(struct smart_struct_s *dev, uint16_t size)
   dev->releasecount = (uint8_t *) dev->sMap + (totalsectors * sizeof(uint16_t));
   dev->freecount = dev->releasecount + dev->neraseblocks;
 
+#ifdef CONFIG_MTD_SMART_CHECKPOINT
+  /* The journal bitmap and the checkpoint block buffer follow the counts.
+   * The map must be reloaded or checkpointed before anything is journalled.
+   */
+
+  dev->ckptdirty   = dev->freecount + dev->neraseblocks;
+  dev->ckptbuffer  = dev->ckptdirty + ((dev->neraseblocks + 7) >> 3);
+  dev->ckptarea    = SMART_CKPT_NONE;
+  dev->ckptndirty  = 0;
+  memset(dev->ckptdirty, 0, (dev->neraseblocks + 7) >> 3);
+#endif
+
   /* Allocate a read/write buffer */
 
   dev->rwbuffer = (char *) kmm_malloc(size);
   if (!dev->rwbuffer)
     {
-      fdbg("Error allocating SMART read/write buffer\n");
-      kmm_free(dev->sMap);
-      kmm_free(dev);
+      fdbg("Error allocating SMART read/write buffer\n");
+      kmm_free(dev->sMap);
+      kmm_free(dev);
+      return -EINVAL;
+    }
+
+  return OK;
+}
+
+/****************************************************************************
+ * Name: smart_bytewrite
+ *
+ * Description: Writes a non-page size count of bytes to the underlying
+ *              MTD device.  If the MTD driver supports a direct impl of
+ *              write, then it uses it, otherwise it does a read-modify-write
+ *              and depends on the architecture of the flash to only program
+ *              bits that acutally changed.
+ *
+ ****************************************************************************/
+
+static ssize_t smart_bytewrite(struct smart_struct_s *dev, size_t offset,
+        int nbytes, const uint8_t *buffer)
+{
+  ssize_t       ret;
+
+#ifdef CONFIG_MTD_BYTE_WRITE
+  /* Check if the underlying MTD device supports write */
+
+  if (dev->mtd->write != NULL)
+    {
+      /* Use the MTD's write method to write individual bytes */
+
+      ret = dev->mtd->write(dev->mtd, offset, nbytes, buffer);
+    }
+  else
+#endif
+    {
+      /* Perform block-based read-modify-write */
+
+      uint32_t  startblock;
+      uint16_t  nblocks;
+
+      /* First calculate the start block and number of blocks affected */
+
+      startblock = offset / dev->geo.blocksize;
+      nblocks    = (offset - startblock * dev->geo.blocksize + nbytes +
+                    dev->geo.blocksize-1) / dev->geo.blocksize;
+
+      DEBUGASSERT(nblocks <= dev->mtdBlksPerSector);
+
+      /* Do a block read */
+
+      ret = MTD_BREAD(dev->mtd, startblock, nblocks, (uint8_t *) dev->rwbuffer);
+      if (ret < 0)
+        {
+          fdbg("Error %d reading from device\n", -ret);
+          goto errout;
+        }
+
+      /* Modify the data */
+
+      memcpy(&dev->rwbuffer[offset - startblock * dev->geo.blocksize], buffer, nbytes);
+
+      /* Write the data back to the device */
+
+      ret = MTD_BWRITE(dev->mtd, startblock, nblocks, (uint8_t *) dev->rwbuffer);
+      if (ret < 0)
+        {
+          fdbg("Error %d writing to device\n", -ret);
+          goto errout;
+        }
+    }
+
+  ret = nbytes;
+
+errout:
+  return ret;
+}
+
+/****************************************************************************
+ * Name: smart_ckpt_datalen
+ *
+ * Description: Returns the size of the sector map image, which is the
+ *              sMap, releasecount and freecount arrays.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_MTD_SMART_CHECKPOINT
+static inline uint32_t smart_ckpt_datalen(struct smart_struct_s *dev)
+{
+  return dev->totalsectors * sizeof(uint16_t) + (dev->neraseblocks << 1);
+}
+#endif
+
+/****************************************************************************
+ * Name: smart_ckpt_address
+ *
+ * Description: Returns the byte address of a checkpoint area.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_MTD_SMART_CHECKPOINT
+static uint32_t smart_ckpt_address(struct smart_struct_s *dev, uint8_t area)
+{
+  return (uint32_t) (dev->neraseblocks + area * dev->ckptblocks) *
+         dev->sectorsPerBlk * dev->sectorsize;
+}
+#endif
+
+/****************************************************************************
+ * Name: smart_ckpt_journaladdr
+ *
+ * Description: Returns the byte address of the journal in a checkpoint
+ *              area.  The journal starts at the first MTD block after the
+ *              map image.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_MTD_SMART_CHECKPOINT
+static uint32_t smart_ckpt_journaladdr(struct smart_struct_s *dev,
+                                       uint8_t area)
+{
+  uint32_t  blocksize = dev->geo.blocksize;
+
+  return smart_ckpt_address(dev, area) + blocksize +
+         (smart_ckpt_datalen(dev) + blocksize - 1) / blocksize * blocksize;
+}
+#endif
+
+/****************************************************************************
+ * Name: smart_ckpt_isdirty
+ *
+ * Description: Tests if an erase block has been journalled since the last
+ *              checkpoint.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_MTD_SMART_CHECKPOINT
+static inline bool smart_ckpt_isdirty(struct smart_struct_s *dev,
+                                      uint16_t block)
+{
+  return (dev->ckptdirty[block >> 3] & (1 << (block & 7))) != 0;
+}
+#endif
+
+/****************************************************************************
+ * Name: smart_ckpt_program
+ *
+ * Description: Programs a few bytes within one MTD block of a checkpoint
+ *              area.  This is the same as smart_bytewrite, except that the
+ *              read-modify-write uses ckptbuffer so that whatever is in
+ *              rwbuffer is preserved.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_MTD_SMART_CHECKPOINT
+static int smart_ckpt_program(struct smart_struct_s *dev, uint32_t offset,
+                              size_t nbytes, const uint8_t *buffer)
+{
+  uint32_t  block;
+  ssize_t   ret;
+
+#ifdef CONFIG_MTD_BYTE_WRITE
+  if (dev->mtd->write != NULL)
+    {
+      ret = dev->mtd->write(dev->mtd, offset, nbytes, buffer);
+      return ret == (ssize_t) nbytes ? OK : -EIO;
+    }
+#endif
+
+  block = offset / dev->geo.blocksize;
+  DEBUGASSERT(offset + nbytes <= (block + 1) * dev->geo.blocksize);
+
+  ret = MTD_BREAD(dev->mtd, block, 1, dev->ckptbuffer);
+  if (ret == 1)
+    {
+      memcpy(&dev->ckptbuffer[offset - block * dev->geo.blocksize], buffer,
+             nbytes);
+      ret = MTD_BWRITE(dev->mtd, block, 1, dev->ckptbuffer);
+    }
+
+  return ret == 1 ? OK : -EIO;
+}
+#endif
+
+/****************************************************************************
+ * Name: smart_ckpt_retire
+ *
+ * Description: Makes the header of a checkpoint area invalid by
+ *              programming its signature.  The area is erased if that
+ *              fails.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_MTD_SMART_CHECKPOINT
+static int smart_ckpt_retire(struct smart_struct_s *dev, uint8_t area)
+{
+  uint8_t   magic[4];
+  int       ret;
+
+  memset(magic, ~CONFIG_SMARTFS_ERASEDSTATE, sizeof(magic));
+  ret = smart_ckpt_program(dev, smart_ckpt_address(dev, area),
+                           sizeof(magic), magic);
+  if (ret < 0)
+    {
+      ret = MTD_ERASE(dev->mtd, dev->neraseblocks + area * dev->ckptblocks,
+                      dev->ckptblocks);
+    }
+
+  return ret;
+}
+#endif
+
+/****************************************************************************
+ * Name: smart_ckpt_invalidate
+ *
+ * Description: Stops using the active checkpoint.  This is done when a
+ *              journal entry can't be written, so that the next scan reads
+ *              every sector header instead of trusting a stale map.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_MTD_SMART_CHECKPOINT
+static void smart_ckpt_invalidate(struct smart_struct_s *dev)
+{
+  if (dev->ckptarea != SMART_CKPT_NONE)
+    {
+      fdbg("Invalidating sector map checkpoint %d\n", dev->ckptarea);
+      (void)smart_ckpt_retire(dev, dev->ckptarea);
+      dev->ckptarea = SMART_CKPT_NONE;
+    }
+}
+#endif
+
+/****************************************************************************
+ * Name: smart_ckpt_write
+ *
+ * Description: Writes an image of the sector map to the inactive
+ *              checkpoint area and makes it the active one with an empty
+ *              journal.  The header is written last, so the previous
+ *              checkpoint and its journal stay valid until the new image is
+ *              complete.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_MTD_SMART_CHECKPOINT
+static int smart_ckpt_write(struct smart_struct_s *dev)
+{
+  struct    smart_ckpt_header_s header;
+  FAR uint8_t *data;
+  uint32_t  blocksize;
+  uint32_t  datalen;
+  uint32_t  nblocks;
+  uint32_t  remainder;
+  off_t     startblock;
+  ssize_t   nxfrd;
+  uint8_t   area;
+  int       ret;
+
+  area      = dev->ckptarea == 0 ? 1 : 0;
+  blocksize = dev->geo.blocksize;
+  data      = (FAR uint8_t *) dev->sMap;
+  datalen   = smart_ckpt_datalen(dev);
+
+  ret = MTD_ERASE(dev->mtd, dev->neraseblocks + area * dev->ckptblocks,
+                  dev->ckptblocks);
+  if (ret < 0)
+    {
+      goto errout;
+    }
+
+  /* Write the map image, starting at the MTD block after the header.  The
+   * final partial block is padded with the erased state.
+   */
+
+  startblock = smart_ckpt_address(dev, area) / blocksize;
+  nblocks    = datalen / blocksize;
+  remainder  = datalen - nblocks * blocksize;
+
+  if (nblocks > 0)
+    {
+      nxfrd = MTD_BWRITE(dev->mtd, startblock + 1, nblocks, data);
+      if (nxfrd != nblocks)
+        {
+          ret = -EIO;
+          goto errout;
+        }
+    }
+
+  if (remainder > 0)
+    {
+      memset(dev->ckptbuffer, CONFIG_SMARTFS_ERASEDSTATE, blocksize);
+      memcpy(dev->ckptbuffer, &data[nblocks * blocksize], remainder);
+      nxfrd = MTD_BWRITE(dev->mtd, startblock + 1 + nblocks, 1,
+                         dev->ckptbuffer);
+      if (nxfrd != 1)
+        {
+          ret = -EIO;
+          goto errout;
+        }
+    }
+
+  /* Now write the header */
+
+  header.magic[0]     = SMART_CKPT_SIG1;
+  header.magic[1]     = SMART_CKPT_SIG2;
+  header.magic[2]     = SMART_CKPT_SIG3;
+  header.magic[3]     = SMART_CKPT_SIG4;
+  header.seq          = dev->ckptseq + 1;
+  header.datalen      = datalen;
+  header.datacrc      = crc32(data, datalen);
+  header.totalsectors = dev->totalsectors;
+  header.neraseblocks = dev->neraseblocks;
+  header.sectorsize   = dev->sectorsize;
+  header.ckptblocks   = dev->ckptblocks;
+  header.hdrcrc       = crc32((FAR const uint8_t *) &header,
+                              offsetof(struct smart_ckpt_header_s, hdrcrc));
+
+  memset(dev->ckptbuffer, CONFIG_SMARTFS_ERASEDSTATE, blocksize);
+  memcpy(dev->ckptbuffer, &header, sizeof(header));
+  nxfrd = MTD_BWRITE(dev->mtd, startblock, 1, dev->ckptbuffer);
+  if (nxfrd != 1)
+    {
+      ret = -EIO;
+      goto errout;
+    }
+
+  /* The new area has the higher sequence number and wins from here on.
+   * Retire the old one so that a damaged new header can never bring back
+   * the old map.
+   */
+
+  if (dev->ckptarea != SMART_CKPT_NONE)
+    {
+      (void)smart_ckpt_retire(dev, dev->ckptarea);
+    }
+
+  dev->ckptarea   = area;
+  dev->ckptseq    = header.seq;
+  dev->ckptndirty = 0;
+  memset(dev->ckptdirty, 0, (dev->neraseblocks + 7) >> 3);
+
+  fvdbg("Checkpoint %d written to area %d\n", header.seq, area);
+  return OK;
+
+errout:
+
+  /* The previous checkpoint, if any, is still intact and still active */
+
+  fdbg("Error %d writing sector map checkpoint\n", -ret);
+  return ret;
+}
+#endif
+
+/****************************************************************************
+ * Name: smart_ckpt_dirty
+ *
+ * Description: Journals an erase block before its sector headers are
+ *              modified or it is erased for the first time since the last
+ *              checkpoint.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_MTD_SMART_CHECKPOINT
+static void smart_ckpt_dirty(struct smart_struct_s *dev, uint16_t block)
+{
+  uint16_t  entry[2];
+  uint32_t  offset;
+  int       ret;
+
+  if (dev->ckptarea == SMART_CKPT_NONE || block >= dev->neraseblocks ||
+      smart_ckpt_isdirty(dev, block))
+    {
+      return;
+    }
+
+  /* Each entry holds the block number and its complement, so a torn
+   * entry can be told apart from a valid one.
+   */
+
+  entry[0] = block;
+  entry[1] = ~block;
+
+  offset = smart_ckpt_journaladdr(dev, dev->ckptarea) +
+           dev->ckptndirty * SMART_CKPT_ENTRYSIZE;
+  ret = smart_ckpt_program(dev, offset, SMART_CKPT_ENTRYSIZE,
+                           (FAR const uint8_t *) entry);
+  if (ret < 0)
+    {
+      fdbg("Error %d journalling erase block %d\n", -ret, block);
+      smart_ckpt_invalidate(dev);
+      return;
+    }
+
+  dev->ckptdirty[block >> 3] |= 1 << (block & 7);
+  dev->ckptndirty++;
+}
+#endif
+
+/****************************************************************************
+ * Name: smart_ckpt_update
+ *
+ * Description: Writes a new checkpoint if enough erase blocks have been
+ *              journalled.  This must only be called between operations,
+ *              when the sector map matches what is on the device.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_MTD_SMART_CHECKPOINT
+static inline void smart_ckpt_update(struct smart_struct_s *dev)
+{
+  if (dev->ckptarea != SMART_CKPT_NONE &&
+      dev->ckptndirty >= CONFIG_MTD_SMART_CHECKPOINT_DIRTY)
+    {
+      (void)smart_ckpt_write(dev);
+    }
+}
+#endif
+
+/****************************************************************************
+ * Name: smart_readformat
+ *
+ * Description: Reads the format signature from the physical sector holding
+ *              logical sector zero and registers any additional root
+ *              directory devices.
+ *
+ ****************************************************************************/
+
+static int smart_readformat(struct smart_struct_s *dev, uint16_t sector)
+{
+  int       ret;
+  size_t    readaddress;
+#ifdef CONFIG_SMARTFS_MULTI_ROOT_DIRS
+  int       x;
+  char      devname[22];
+  struct    smart_multiroot_device_s *rootdirdev;
+#endif
+
+  /* Read the sector data */
+
+  readaddress = sector * dev->mtdBlksPerSector * dev->geo.blocksize;
+  ret = MTD_READ(dev->mtd, readaddress, 32, (uint8_t*) dev->rwbuffer);
+  if (ret != 32)
+    {
+      fdbg("Error reading physical sector %d.\n", sector);
+      return -EIO;
+    }
+
+  /* Validate the format signature */
+
+  if (dev->rwbuffer[SMART_FMT_POS1] != SMART_FMT_SIG1 ||
+      dev->rwbuffer[SMART_FMT_POS2] != SMART_FMT_SIG2 ||
+      dev->rwbuffer[SMART_FMT_POS3] != SMART_FMT_SIG3 ||
+      dev->rwbuffer[SMART_FMT_POS4] != SMART_FMT_SIG4)
+    {
+      return -EINVAL;
+    }
+
+  /* TODO: May want to validate / save the erase block aging info */
+
+  /* Mark the volume as formatted and set the sector size */
+
+  dev->formatstatus = SMART_FMT_STAT_FORMATTED;
+  dev->namesize = dev->rwbuffer[SMART_FMT_NAMESIZE_POS];
+  dev->formatversion = dev->rwbuffer[SMART_FMT_VERSION_POS];
+
+#ifdef CONFIG_SMARTFS_MULTI_ROOT_DIRS
+  dev->rootdirentries = dev->rwbuffer[SMART_FMT_ROOTDIRS_POS];
+
+  /* If rootdirentries is greater than 1, then we need to register
+   * additional block devices.
+   */
+
+  for (x = 1; x < dev->rootdirentries; x++)
+    {
+      if (dev->partname[0] != '\0')
+        {
+          snprintf(dev->rwbuffer, sizeof(devname), "/dev/smart%d%sd%d",
+                  dev->minor, dev->partname, x+1);
+        }
+      else
+        {
+          snprintf(devname, sizeof(devname), "/dev/smart%dd%d", dev->minor,
+                   x + 1);
+        }
+
+      /* Inode private data is a reference to a struct containing
+       * the SMART device structure and the root directory number.
+       */
+
+      rootdirdev = (struct smart_multiroot_device_s*) kmm_malloc(sizeof(*rootdirdev));
+      if (rootdirdev == NULL)
+        {
+          fdbg("Memory alloc failed\n");
+          return -ENOMEM;
+        }
+
+      /* Populate the rootdirdev */
+
+      rootdirdev->dev = dev;
+      rootdirdev->rootdirnum = x;
+      ret = register_blockdriver(dev->rwbuffer, &g_bops, 0, rootdirdev);
+
+      /* Inode private data is a reference to the SMART device structure */
+
+      ret = register_blockdriver(devname, &g_bops, 0, rootdirdev);
+    }
+#endif
+
+  return OK;
+}
+
+/****************************************************************************
+ * Name: smart_scansector
+ *
+ * Description: Reads the header of one physical sector and adds it to the
+ *              logical sector map and to the free and released sector
+ *              counts.  Returns 1 if the sector duplicated a logical sector
+ *              and one of the two copies had to be released, OK if it did
+ *              not, or a negated errno value.
+ *
+ ****************************************************************************/
+
+static int smart_scansector(struct smart_struct_s *dev, uint16_t sector)
+{
+  int       ret;
+  int       offset;
+  uint16_t  logicalsector;
+  uint16_t  loser;
+  uint16_t  seq1;
+  uint16_t  seq2;
+  size_t    readaddress;
+  struct    smart_sect_header_s header;
+
+  /* Calculate the read address for this sector */
+
+  readaddress = sector * dev->mtdBlksPerSector * dev->geo.blocksize;
+
+  /* Read the header for this sector */
+
+  ret = MTD_READ(dev->mtd, readaddress, sizeof(struct smart_sect_header_s),
+                 (uint8_t *) &header);
+  if (ret != sizeof(struct smart_sect_header_s))
+    {
+      return -EIO;
+    }
+
+  /* Get the logical sector number for this physical sector */
+
+  logicalsector = *((uint16_t *) header.logicalsector);
+#if CONFIG_SMARTFS_ERASEDSTATE == 0x00
+  if (logicalsector == 0)
+    {
+      logicalsector = -1;
+    }
+#endif
+
+  /* Test if this sector has been committed */
+
+  if ((header.status & SMART_STATUS_COMMITTED) ==
+          (CONFIG_SMARTFS_ERASEDSTATE & SMART_STATUS_COMMITTED))
+    {
+      return OK;
+    }
+
+  /* This block is commited, therefore not free.  Update the
+   * erase block's freecount.
+   */
+
+  dev->freecount[sector / dev->sectorsPerBlk]--;
+  dev->freesectors--;
+
+  /* Test if this sector has been release and if it has,
+   * update the erase block's releasecount.
+   */
+
+  if ((header.status & SMART_STATUS_RELEASED) !=
+          (CONFIG_SMARTFS_ERASEDSTATE & SMART_STATUS_RELEASED))
+    {
+      dev->releasecount[sector / dev->sectorsPerBlk]++;
+      return OK;
+    }
+
+  if ((header.status & SMART_STATUS_VERBITS) != SMART_STATUS_VERSION)
+    {
+      return OK;
+    }
+
+  /* Validate the logical sector number is in bounds */
+
+  if (logicalsector >= dev->totalsectors)
+    {
+      /* Error in logical sector read from the MTD device */
+
+      fdbg("Invalid logical sector %d at physical %d.\n",
+           logicalsector, sector);
+      return OK;
+    }
+
+  /* If this is logical sector zero, then read in the signature
+   * information to validate the format signature.
+   */
+
+  if (logicalsector == 0)
+    {
+      ret = smart_readformat(dev, sector);
+      if (ret == -EINVAL)
+        {
+          /* Invalid signature on a sector claiming to be sector 0!
+           * What should we do?  Release it?*/
+
+          return OK;
+        }
+      else if (ret < 0)
+        {
+          return ret;
+        }
+    }
+
+  /* Test for duplicate logical sectors on the device */
+
+  if (dev->sMap[logicalsector] == 0xFFFF)
+    {
+      /* Update the logical to physical sector map */
+
+      dev->sMap[logicalsector] = sector;
+      return OK;
+    }
+
+  /* Uh-oh, we found more than 1 physical sector claiming to be
+   * the * same logical sector.  Use the sequence number information
+   * to resolve who wins.
+   */
+
+  seq2 = *((uint16_t *) header.seq);
+
+  /* We must re-read the 1st physical sector to get it's seq number */
+
+  readaddress = dev->sMap[logicalsector]  * dev->mtdBlksPerSector * dev->geo.blocksize;
+  ret = MTD_READ(dev->mtd, readaddress, sizeof(struct smart_sect_header_s),
+          (uint8_t *) &header);
+  if (ret != sizeof(struct smart_sect_header_s))
+    {
+      return -EIO;
+    }
+
+  seq1 = *((uint16_t *) header.seq);
+
+  /* Now determine who wins */
+
+  if (seq1 > 0xFFF0 && seq2 < 10)
+    {
+      /* Seq 2 is the winner ... we assume it wrapped */
+
+      loser = dev->sMap[logicalsector];
+      dev->sMap[logicalsector] = sector;
+    }
+  else if (seq2 > seq1)
+    {
+      /* Seq 2 is bigger, so it's the winner */
+
+      loser = dev->sMap[logicalsector];
+      dev->sMap[logicalsector] = sector;
+    }
+  else
+    {
+      /* We keep the original mapping and seq2 is the loser */
+
+      loser = sector;
+    }
+
+  /* Now release the loser sector */
+
+  readaddress = loser  * dev->mtdBlksPerSector * dev->geo.blocksize;
+  ret = MTD_READ(dev->mtd, readaddress, sizeof(struct smart_sect_header_s),
+          (uint8_t *) &header);
+  if (ret != sizeof(struct smart_sect_header_s))
+    {
+      return -EIO;
+    }
+
+#if CONFIG_SMARTFS_ERASEDSTATE == 0xFF
+  header.status &= ~SMART_STATUS_RELEASED;
+#else
+  header.status |= SMART_STATUS_RELEASED;
+#endif
+  offset = readaddress + offsetof(struct smart_sect_header_s, status);
+  ret = smart_bytewrite(dev, offset, 1, &header.status);
+  if (ret < 0)
+    {
+      fdbg("Error %d releasing duplicate sector\n", -ret);
+      return ret;
+    }
+
+  /* The loser was counted as a live sector */
+
+  dev->releasecount[loser / dev->sectorsPerBlk]++;
+  return 1;
+}
+
+/****************************************************************************
+ * Name: smart_ckpt_load
+ *
+ * Description: Loads the sector map from the newest valid checkpoint and
+ *              rescans the erase blocks listed in its journal.  Returns a
+ *              negated errno value if there is no usable checkpoint, in
+ *              which case the caller must scan the whole device.  -ENOENT
+ *              means that neither area holds a checkpoint.  In any case
+ *              ckptseq is raised to the newest sequence number found.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_MTD_SMART_CHECKPOINT
+static int smart_ckpt_load(struct smart_struct_s *dev)
+{
+  struct    smart_ckpt_header_s header;
+  FAR uint8_t *data;
+  uint32_t  blocksize;
+  uint32_t  datalen;
+  uint32_t  datacrc = 0;
+  uint32_t  address;
+  uint32_t  offset;
+  uint32_t  nbytes;
+  uint32_t  seq = 0;
+  uint16_t  entry[2];
+  uint16_t  block;
+  uint16_t  sector;
+  uint8_t   area;
+  uint8_t   x;
+  ssize_t   nread;
+  bool      torn = false;
+  bool      rewrite = false;
+  int       ret;
+
+  blocksize = dev->geo.blocksize;
+  datalen   = smart_ckpt_datalen(dev);
+
+  /* Find the area with the newest valid header */
+
+  area = SMART_CKPT_NONE;
+  for (x = 0; x < 2; x++)
+    {
+      nread = MTD_READ(dev->mtd, smart_ckpt_address(dev, x),
+                       sizeof(header), (FAR uint8_t *) &header);
+      if (nread != sizeof(header) ||
+          header.magic[0] != SMART_CKPT_SIG1 ||
+          header.magic[1] != SMART_CKPT_SIG2 ||
+          header.magic[2] != SMART_CKPT_SIG3 ||
+          header.magic[3] != SMART_CKPT_SIG4 ||
+          header.hdrcrc != crc32((FAR const uint8_t *) &header,
+                                 offsetof(struct smart_ckpt_header_s, hdrcrc)))
+        {
+          continue;
+        }
+
+      /* Whatever happens to this area, the next checkpoint must be newer */
+
+      if (header.seq > dev->ckptseq)
+        {
+          dev->ckptseq = header.seq;
+        }
+
+      if (header.datalen != datalen ||
+          header.totalsectors != dev->totalsectors ||
+          header.neraseblocks != dev->neraseblocks ||
+          header.sectorsize != dev->sectorsize ||
+          header.ckptblocks != dev->ckptblocks)
+        {
+          fdbg("Checkpoint %d does not match the device geometry\n", x);
+          continue;
+        }
+
+      if (area == SMART_CKPT_NONE || header.seq > seq)
+        {
+          area    = x;
+          seq     = header.seq;
+          datacrc = header.datacrc;
+        }
+    }
+
+  if (area == SMART_CKPT_NONE)
+    {
+      return -ENOENT;
+    }
+
+  /* Read the map image and verify it */
+
+  data  = (FAR uint8_t *) dev->sMap;
+  nread = MTD_READ(dev->mtd, smart_ckpt_address(dev, area) + blocksize,
+                   datalen, data);
+  if (nread != (ssize_t) datalen)
+    {
+      return -EIO;
+    }
+
+  if (crc32(data, datalen) != datacrc)
+    {
+      fdbg("Checkpoint %d in area %d is corrupt\n", seq, area);
       return -EINVAL;
     }
 
-  return OK;
-}
+  /* Read the journal up to the first erased entry.  An invalid entry can
+   * only be the last one, torn by a power loss before the block it names
+   * was touched.  Anything after it means the journal is corrupt.
+   */
 
-/****************************************************************************
- * Name: smart_bytewrite
- *
- * Description: Writes a non-page size count of bytes to the underlying
- *              MTD device.  If the MTD driver supports a direct impl of
- *              write, then it uses it, otherwise it does a read-modify-write
- *              and depends on the architecture of the flash to only program
- *              bits that acutally changed.
- *
- ****************************************************************************/
+  address = smart_ckpt_journaladdr(dev, area);
+  for (offset = 0; offset < dev->neraseblocks * SMART_CKPT_ENTRYSIZE;
+       offset += SMART_CKPT_ENTRYSIZE)
+    {
+      if ((offset % blocksize) == 0)
+        {
+          nbytes = dev->neraseblocks * SMART_CKPT_ENTRYSIZE - offset;
+          if (nbytes > blocksize)
+            {
+              nbytes = blocksize;
+            }
 
-static ssize_t smart_bytewrite(struct smart_struct_s *dev, size_t offset,
-        int nbytes, const uint8_t *buffer)
-{
-  ssize_t       ret;
+          nread = MTD_READ(dev->mtd, address + offset, nbytes,
+                           dev->ckptbuffer);
+          if (nread != (ssize_t) nbytes)
+            {
+              return -EIO;
+            }
+        }
 
-#ifdef CONFIG_MTD_BYTE_WRITE
-  /* Check if the underlying MTD device supports write */
+      memcpy(entry, &dev->ckptbuffer[offset % blocksize], sizeof(entry));
+      if (entry[0] == (uint16_t) (CONFIG_SMARTFS_ERASEDSTATE * 0x0101) &&
+          entry[1] == (uint16_t) (CONFIG_SMARTFS_ERASEDSTATE * 0x0101))
+        {
+          break;
+        }
 
-  if (dev->mtd->write != NULL)
-    {
-      /* Use the MTD's write method to write individual bytes */
+      if (torn)
+        {
+          fdbg("Checkpoint %d journal is corrupt\n", seq);
+          return -EINVAL;
+        }
 
-      ret = dev->mtd->write(dev->mtd, offset, nbytes, buffer);
+      block = entry[0];
+      if (entry[1] != (uint16_t) ~block || block >= dev->neraseblocks ||
+          smart_ckpt_isdirty(dev, block))
+        {
+          torn = true;
+          continue;
+        }
+
+      dev->ckptdirty[block >> 3] |= 1 << (block & 7);
+      dev->ckptndirty++;
     }
-  else
-#endif
-    {
-      /* Perform block-based read-modify-write */
 
-      uint32_t  startblock;
-      uint16_t  nblocks;
+  /* Drop the mappings into the journalled blocks and rebuild them, and
+   * their counts, from the sector headers.
+   */
 
-      /* First calculate the start block and number of blocks affected */
+  dev->formatstatus = SMART_FMT_STAT_NOFMT;
+  if (dev->ckptndirty > 0)
+    {
+      for (sector = 0; sector < dev->totalsectors; sector++)
+        {
+          if (dev->sMap[sector] != 0xFFFF &&
+              smart_ckpt_isdirty(dev, dev->sMap[sector] / dev->sectorsPerBlk))
+            {
+              dev->sMap[sector] = 0xFFFF;
+            }
+        }
 
-      startblock = offset / dev->geo.blocksize;
-      nblocks    = (offset - startblock * dev->geo.blocksize + nbytes +
-                    dev->geo.blocksize-1) / dev->geo.blocksize;
+      for (block = 0; block < dev->neraseblocks; block++)
+        {
+          if (smart_ckpt_isdirty(dev, block))
+            {
+              dev->freecount[block] = dev->sectorsPerBlk;
+              dev->releasecount[block] = 0;
+            }
+        }
 
-      DEBUGASSERT(nblocks <= dev->mtdBlksPerSector);
+      for (block = 0; block < dev->neraseblocks; block++)
+        {
+          if (!smart_ckpt_isdirty(dev, block))
+            {
+              continue;
+            }
 
-      /* Do a block read */
+          for (sector = block * dev->sectorsPerBlk;
+               sector < (block + 1) * dev->sectorsPerBlk; sector++)
+            {
+              ret = smart_scansector(dev, sector);
+              if (ret < 0)
+                {
+                  return ret;
+                }
 
-      ret = MTD_BREAD(dev->mtd, startblock, nblocks, (uint8_t *) dev->rwbuffer);
-      if (ret < 0)
-        {
-          fdbg("Error %d reading from device\n", -ret);
-          goto errout;
+              /* A duplicate was released in a block that may not be in
+               * the journal.
+               */
+
+              if (ret > 0)
+                {
+                  rewrite = true;
+                }
+            }
         }
+    }
 
-      /* Modify the data */
+  dev->freesectors = 0;
+  for (block = 0; block < dev->neraseblocks; block++)
+    {
+      dev->freesectors += dev->freecount[block];
+    }
 
-      memcpy(&dev->rwbuffer[offset - startblock * dev->geo.blocksize], buffer, nbytes);
+  /* Check the format signature if logical sector zero was not rescanned */
 
-      /* Write the data back to the device */
+  if (dev->sMap[0] == 0xFFFF)
+    {
+      return -EINVAL;
+    }
 
-      ret = MTD_BWRITE(dev->mtd, startblock, nblocks, (uint8_t *) dev->rwbuffer);
+  if (dev->formatstatus != SMART_FMT_STAT_FORMATTED)
+    {
+      ret = smart_readformat(dev, dev->sMap[0]);
       if (ret < 0)
         {
-          fdbg("Error %d writing to device\n", -ret);
-          goto errout;
+          return ret;
         }
     }
 
-  ret = nbytes;
+  dev->ckptarea = area;
 
-errout:
-  return ret;
+  fvdbg("Loaded checkpoint %d from area %d, %d blocks journalled\n",
+        seq, area, dev->ckptndirty);
+
+  /* Nothing more can be appended after a torn entry */
+
+  if ((torn || rewrite) && smart_ckpt_write(dev) < 0)
+    {
+      smart_ckpt_invalidate(dev);
+    }
+
+  return OK;
 }
+#endif
 
 /****************************************************************************
  * Name: smart_scan
@@ -627,19 +1592,9 @@ static int smart_scan(struct smart_struct_s *dev)
 {
   int       sector;
   int       ret;
-  int       offset;
   uint16_t  totalsectors;
   uint16_t  sectorsize;
-  uint16_t  logicalsector;
-  uint16_t  seq1;
-  uint16_t  seq2;
-  size_t    readaddress;
   struct    smart_sect_header_s header;
-#ifdef CONFIG_SMARTFS_MULTI_ROOT_DIRS
-  int       x;
-  char      devname[22];
-  struct    smart_multiroot_device_s *rootdirdev;
-#endif
 
   fvdbg("Entry\n");
 
@@ -671,6 +1626,30 @@ static int smart_scan(struct smart_struct_s *dev)
       goto err_out;
     }
 
+#ifdef CONFIG_MTD_SMART_CHECKPOINT
+  /* Use the checkpoint of the sector map if there is a valid one */
+
+  ret = smart_ckpt_load(dev);
+  if (ret == OK)
+    {
+      return OK;
+    }
+
+  /* If there was a checkpoint that could not be used, retire both areas.
+   * Neither of them may be loaded again once the map has been rebuilt, even
+   * if writing the new checkpoint fails.
+   */
+
+  if (ret != -ENOENT)
+    {
+      (void)smart_ckpt_retire(dev, 0);
+      (void)smart_ckpt_retire(dev, 1);
+    }
+
+  memset(dev->ckptdirty, 0, (dev->neraseblocks + 7) >> 3);
+  dev->ckptndirty = 0;
+#endif
+
   /* Initialize the device variables */
 
   totalsectors = dev->neraseblocks * dev->sectorsPerBlk;
@@ -698,228 +1677,11 @@ static int smart_scan(struct smart_struct_s *dev)
     {
       fvdbg("Scan sector %d\n", sector);
 
-      /* Calculate the read address for this sector */
-
-      readaddress = sector * dev->mtdBlksPerSector * dev->geo.blocksize;
-
-      /* Read the header for this sector */
-
-      ret = MTD_READ(dev->mtd, readaddress, sizeof(struct smart_sect_header_s),
-                     (uint8_t *) &header);
-      if (ret != sizeof(struct smart_sect_header_s))
+      ret = smart_scansector(dev, sector);
+      if (ret < 0)
         {
           goto err_out;
         }
-
-      /* Get the logical sector number for this physical sector */
-
-      logicalsector = *((uint16_t *) header.logicalsector);
-#if CONFIG_SMARTFS_ERASEDSTATE == 0x00
-      if (logicalsector == 0)
-        {
-          logicalsector = -1;
-        }
-#endif
-
-      /* Test if this sector has been committed */
-
-      if ((header.status & SMART_STATUS_COMMITTED) ==
-              (CONFIG_SMARTFS_ERASEDSTATE & SMART_STATUS_COMMITTED))
-        {
-          continue;
-        }
-
-      /* This block is commited, therefore not free.  Update the
-       * erase block's freecount.
-       */
-
-      dev->freecount[sector / dev->sectorsPerBlk]--;
-      dev->freesectors--;
-
-      /* Test if this sector has been release and if it has,
-       * update the erase block's releasecount.
-       */
-
-      if ((header.status & SMART_STATUS_RELEASED) !=
-              (CONFIG_SMARTFS_ERASEDSTATE & SMART_STATUS_RELEASED))
-        {
-          dev->releasecount[sector / dev->sectorsPerBlk]++;
-          continue;
-        }
-
-      if ((header.status & SMART_STATUS_VERBITS) != SMART_STATUS_VERSION)
-        {
-          continue;
-        }
-
-      /* Validate the logical sector number is in bounds */
-
-      if (logicalsector >= totalsectors)
-        {
-          /* Error in logical sector read from the MTD device */
-
-          fdbg("Invalid logical sector %d at physical %d.\n",
-               logicalsector, sector);
-          continue;
-        }
-
-      /* If this is logical sector zero, then read in the signature
-       * information to validate the format signature.
-       */
-
-      if (logicalsector == 0)
-        {
-          /* Read the sector data */
-
-          ret = MTD_READ(dev->mtd, readaddress, 32,
-                         (uint8_t*) dev->rwbuffer);
-          if (ret != 32)
-            {
-              fdbg("Error reading physical sector %d.\n", sector);
-              goto err_out;
-            }
-
-          /* Validate the format signature */
-
-          if (dev->rwbuffer[SMART_FMT_POS1] != SMART_FMT_SIG1 ||
-              dev->rwbuffer[SMART_FMT_POS2] != SMART_FMT_SIG2 ||
-              dev->rwbuffer[SMART_FMT_POS3] != SMART_FMT_SIG3 ||
-              dev->rwbuffer[SMART_FMT_POS4] != SMART_FMT_SIG4)
-           {
-             /* Invalid signature on a sector claiming to be sector 0!
-              * What should we do?  Release it?*/
-
-             continue;
-           }
-
-          /* TODO: May want to validate / save the erase block aging info */
-
-          /* Mark the volume as formatted and set the sector size */
-
-          dev->formatstatus = SMART_FMT_STAT_FORMATTED;
-          dev->namesize = dev->rwbuffer[SMART_FMT_NAMESIZE_POS];
-          dev->formatversion = dev->rwbuffer[SMART_FMT_VERSION_POS];
-
-#ifdef CONFIG_SMARTFS_MULTI_ROOT_DIRS
-          dev->rootdirentries = dev->rwbuffer[SMART_FMT_ROOTDIRS_POS];
-
-          /* If rootdirentries is greater than 1, then we need to register
-           * additional block devices.
-           */
-
-          for (x = 1; x < dev->rootdirentries; x++)
-            {
-              if (dev->partname[0] != '\0')
-                {
-                  snprintf(dev->rwbuffer, sizeof(devname), "/dev/smart%d%sd%d",
-                          dev->minor, dev->partname, x+1);
-                }
-              else
-                {
-                  snprintf(devname, sizeof(devname), "/dev/smart%dd%d", dev->minor,
-                           x + 1);
-                }
-
-              /* Inode private data is a reference to a struct containing
-               * the SMART device structure and the root directory number.
-               */
-
-              rootdirdev = (struct smart_multiroot_device_s*) kmm_malloc(sizeof(*rootdirdev));
-              if (rootdirdev == NULL)
-                {
-                  fdbg("Memory alloc failed\n");
-                  ret = -ENOMEM;
-                  goto err_out;
-                }
-
-              /* Populate the rootdirdev */
-
-              rootdirdev->dev = dev;
-              rootdirdev->rootdirnum = x;
-              ret = register_blockdriver(dev->rwbuffer, &g_bops, 0, rootdirdev);
-
-              /* Inode private data is a reference to the SMART device structure */
-
-              ret = register_blockdriver(devname, &g_bops, 0, rootdirdev);
-            }
-#endif
-        }
-
-      /* Test for duplicate logical sectors on the device */
-
-      if (dev->sMap[logicalsector] != 0xFFFF)
-        {
-          /* Uh-oh, we found more than 1 physical sector claiming to be
-           * the * same logical sector.  Use the sequence number information
-           * to resolve who wins.
-           */
-
-          uint16_t loser;
-
-          seq2 = *((uint16_t *) header.seq);
-
-          /* We must re-read the 1st physical sector to get it's seq number */
-
-          readaddress = dev->sMap[logicalsector]  * dev->mtdBlksPerSector * dev->geo.blocksize;
-          ret = MTD_READ(dev->mtd, readaddress, sizeof(struct smart_sect_header_s),
-                  (uint8_t *) &header);
-          if (ret != sizeof(struct smart_sect_header_s))
-            {
-              goto err_out;
-            }
-
-          seq1 = *((uint16_t *) header.seq);
-
-          /* Now determine who wins */
-
-          if (seq1 > 0xFFF0 && seq2 < 10)
-            {
-              /* Seq 2 is the winner ... we assume it wrapped */
-
-              loser = dev->sMap[logicalsector];
-              dev->sMap[logicalsector] = sector;
-            }
-          else if (seq2 > seq1)
-            {
-              /* Seq 2 is bigger, so it's the winner */
-
-              loser = dev->sMap[logicalsector];
-              dev->sMap[logicalsector] = sector;
-            }
-          else
-            {
-              /* We keep the original mapping and seq2 is the loser */
-
-              loser = sector;
-            }
-
-          /* Now release the loser sector */
-
-          readaddress = loser  * dev->mtdBlksPerSector * dev->geo.blocksize;
-          ret = MTD_READ(dev->mtd, readaddress, sizeof(struct smart_sect_header_s),
-                  (uint8_t *) &header);
-          if (ret != sizeof(struct smart_sect_header_s))
-            {
-              goto err_out;
-            }
-
-#if CONFIG_SMARTFS_ERASEDSTATE == 0xFF
-          header.status &= ~SMART_STATUS_RELEASED;
-#else
-          header.status |= SMART_STATUS_RELEASED;
-#endif
-          offset = readaddress + offsetof(struct smart_sect_header_s, status);
-          ret = smart_bytewrite(dev, offset, 1, &header.status);
-          if (ret < 0)
-            {
-              fdbg("Error %d releasing duplicate sector\n", -ret);
-              goto err_out;
-            }
-        }
-
-      /* Update the logical to physical sector map */
-
-      dev->sMap[logicalsector] = sector;
     }
 
   fdbg("SMART Scan\n");
@@ -928,6 +1690,15 @@ static int smart_scan(struct smart_struct_s *dev)
   fdbg("   Sect/block:   %10d\n", dev->sectorsPerBlk);
   fdbg("   MTD Blk/Sect: %10d\n", dev->mtdBlksPerSector);
 
+#ifdef CONFIG_MTD_SMART_CHECKPOINT
+  /* Checkpoint the map so that the next scan does not have to do this */
+
+  if (dev->formatstatus == SMART_FMT_STAT_FORMATTED)
+    {
+      (void)smart_ckpt_write(dev);
+    }
+#endif
+
   ret = OK;
 
 err_out:
@@ -1138,6 +1909,14 @@ static inline int smart_llformat(struct smart_struct_s *dev, unsigned long arg)
     }
 #endif
 
+#ifdef CONFIG_MTD_SMART_CHECKPOINT
+  /* The checkpoint areas were erased too.  Start over with a checkpoint of
+   * the empty map.
+   */
+
+  (void)smart_ckpt_write(dev);
+#endif
+
   return OK;
 }
 #endif /* CONFIG_FS_WRITABLE */
@@ -1299,6 +2078,7 @@ static int smart_garbagecollect(struct smart_struct_s *dev)
            * try to move sectors into the block we are trying to erase.
            */
 
+          smart_ckpt_dirty(dev, collectblock);
           dev->freecount[collectblock] = 0;
 
           /* Next move all live data in the block to a new home. */
@@ -1359,6 +2139,7 @@ static int smart_garbagecollect(struct smart_struct_s *dev)
 
               /* Write the data to the new physical sector location */
 
+              smart_ckpt_dirty(dev, newsector / dev->sectorsPerBlk);
               ret = MTD_BWRITE(dev->mtd, newsector * dev->mtdBlksPerSector,
                                dev->mtdBlksPerSector, (uint8_t *) dev->rwbuffer);
 
@@ -1562,6 +2343,8 @@ static inline int smart_writesector(struct smart_struct_s *dev, unsigned long ar
     {
       /* Write the entire sector to the new physical location, uncommitted. */
 
+      smart_ckpt_dirty(dev, physsector / dev->sectorsPerBlk);
+      smart_ckpt_dirty(dev, dev->sMap[req->logsector] / dev->sectorsPerBlk);
       ret = MTD_BWRITE(dev->mtd, physsector * dev->mtdBlksPerSector,
               dev->mtdBlksPerSector, (uint8_t *) dev->rwbuffer);
       if (ret != dev->mtdBlksPerSector)
@@ -1839,6 +2622,7 @@ static inline int smart_allocsector(struct smart_struct_s *dev, unsigned long re
   x = physicalsector * dev->mtdBlksPerSector;
 
   fvdbg("Write MTD block %d\n", x);
+  smart_ckpt_dirty(dev, physicalsector / dev->sectorsPerBlk);
   ret = MTD_BWRITE(dev->mtd, x, 1, (uint8_t *) dev->rwbuffer);
   if (ret != 1)
     {
@@ -1929,6 +2713,7 @@ static inline int smart_freesector(struct smart_struct_s *dev, unsigned long
 
   /* Write the status back to the device */
 
+  smart_ckpt_dirty(dev, physsector / dev->sectorsPerBlk);
   offset = readaddr + offsetof(struct smart_sect_header_s, status);
   ret = smart_bytewrite(dev, offset, 1, &header.status);
   if (ret != 1)
@@ -2113,6 +2898,17 @@ static int smart_ioctl(FAR struct inode *inode, int cmd, unsigned long arg)
     }
 
 ok_out:
+#ifdef CONFIG_MTD_SMART_CHECKPOINT
+  /* Write a new checkpoint if the journal has grown long enough.  This is
+   * only safe between requests.
+   */
+
+  if (ret >= 0)
+    {
+      smart_ckpt_update(dev);
+    }
+#endif
+
   return ret;
 }
 
@@ -2179,6 +2975,9 @@ int smart_initialize(int minor, FAR struct mtd_dev_s *mtd, const char *partname)
 
       dev->sMap = NULL;
       dev->rwbuffer = NULL;
+#ifdef CONFIG_MTD_SMART_CHECKPOINT
+      dev->ckptseq = 0;
+#endif
       ret = smart_setsectorsize(dev, CONFIG_MTD_SMART_SECTOR_SIZE);
       if (ret != OK)
         {
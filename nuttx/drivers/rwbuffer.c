@@ -217,7 +217,15 @@ static void rwb_wrstarttimeout(FAR struct rwbuffer_s *rwb)
    */
 
   int ticks = (CONFIG_DRVR_WRDELAY + CLK_TCK/2) / CLK_TCK;
+
+#if defined(CONFIG_SCHED_WORKPRIORITY) && defined(CONFIG_SCHED_WORKQUEUE)
+  /* The write-back may take a long time.  Let other ready work go first. */
+
+  (void)work_queuepriority(LPWORK, &rwb->work, rwb_wrtimeout,
+                           (FAR void *)rwb, ticks, WORK_PRIORITY_MIN, 0);
+#else
   (void)work_queue(LPWORK, &rwb->work, rwb_wrtimeout, (FAR void *)rwb, ticks);
+#endif
 }
 
 /****************************************************************************
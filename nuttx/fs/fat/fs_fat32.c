@@ -60,6 +60,7 @@
 
 #include <nuttx/kmalloc.h>
 #include <nuttx/fs/fs.h>
+#include <nuttx/fs/ioctl.h>
 #include <nuttx/fs/fat.h>
 #include <nuttx/fs/dirent.h>
 
@@ -345,14 +346,21 @@ static int fat_open(FAR struct file *filep, const char *relpath,
 
   filep->f_priv = ff;
 
+  /* Identify the file for FIOC_FILEID.  This must be done before the new
+   * instance is in the list.
+   */
+
+  fat_assignfileid(fs, ff);
+
   /* Then insert the new instance into the mountpoint structure.
    * It needs to be there (1) to handle error conditions that effect
-   * all files, and (2) to inform the umount logic that we are busy
-   * (but a simple reference count could have done that).
+   * all files, (2) to inform the umount logic that we are busy
+   * (but a simple reference count could have done that), and (3) to find
+   * the other open instances of the same file.
    */
 
   ff->ff_next = fs->fs_head;
-  fs->fs_head = ff->ff_next;
+  fs->fs_head = ff;
 
   fat_semgive(fs);
 
@@ -390,7 +398,10 @@ static int fat_close(FAR struct file *filep)
 {
   struct inode         *inode;
   struct fat_file_s    *ff;
+  struct fat_file_s    *prev;
+  struct fat_file_s    *curr;
   struct fat_mountpt_s *fs;
+  int                   trimret = OK;
   int                   ret;
 
   /* Sanity checks */
@@ -407,9 +418,50 @@ static int fat_close(FAR struct file *filep)
    * the file even when there is healthy mount.
    */
 
+  /* Release any clusters reserved with FIOC_FALLOCATE beyond the end of
+   * the file so that they do not stay allocated after the close.
+   */
+
+  if ((ff->ff_bflags & FFBUFF_PREALLOC) != 0)
+    {
+      fat_semtake(fs);
+      trimret = fat_checkmount(fs);
+      if (trimret == OK)
+        {
+          trimret = fat_trimchain(fs, ff);
+        }
+
+      fat_semgive(fs);
+    }
+
   /* Synchronize the file buffers and disk content; update times */
 
   ret = fat_sync(filep);
+  if (ret >= 0)
+    {
+      ret = trimret;
+    }
+
+  /* Remove the instance from the list of open files */
+
+  fat_semtake(fs);
+  for (prev = NULL, curr = fs->fs_head;
+       curr && curr != ff;
+       prev = curr, curr = curr->ff_next);
+
+  if (curr)
+    {
+      if (prev)
+        {
+          prev->ff_next = ff->ff_next;
+        }
+      else
+        {
+          fs->fs_head = ff->ff_next;
+        }
+    }
+
+  fat_semgive(fs);
 
   /* Then deallocate the memory structures created when the open method
    * was called.
@@ -533,6 +585,12 @@ static ssize_t fat_read(FAR struct file *filep, char *buffer, size_t buflen)
               goto errout_with_semaphore;
             }
 
+          /* Remember the cluster for lseek() */
+
+          fat_runcacheadd(ff,
+                          SEC_NSECTORS(fs, filep->f_pos) / fs->fs_fatsecperclus,
+                          cluster);
+
           /* Setup to read the first sector from the new cluster */
 
           ff->ff_currentcluster   = cluster;
@@ -661,9 +719,11 @@ static ssize_t fat_write(FAR struct file *filep, const char *buffer,
   struct fat_mountpt_s *fs;
   struct fat_file_s    *ff;
   int32_t               cluster;
+  int32_t               nextcluster;
   unsigned int          byteswritten;
   unsigned int          writesize;
   unsigned int          nsectors;
+  unsigned int          ncontig;
   uint8_t              *userbuffer = (uint8_t*)buffer;
   int                   sectorindex;
   int                   ret;
@@ -779,6 +839,12 @@ static ssize_t fat_write(FAR struct file *filep, const char *buffer,
               goto errout_with_semaphore;
             }
 
+          /* Remember the cluster for lseek() */
+
+          fat_runcacheadd(ff,
+                          SEC_NSECTORS(fs, filep->f_pos) / fs->fs_fatsecperclus,
+                          cluster);
+
           /* Setup to write the first sector from the new cluster */
 
           ff->ff_currentcluster   = cluster;
@@ -801,13 +867,46 @@ fat_write_restart:
            * buffer without using our tiny read buffer.
            *
            * Limit the number of sectors that we write on this time
-           * through the loop to the remaining contiguous sectors
-           * in this cluster
+           * through the loop to the remaining contiguous sectors.  These
+           * are the remaining sectors in this cluster plus the sectors of
+           * any following clusters in the chain that are adjacent on the
+           * media.  fat_extendchain() follows the existing chain (perhaps
+           * preallocated with FIOC_FALLOCATE) or prefers the adjacent
+           * cluster when it has to allocate a new one.
            */
 
-          if (nsectors > ff->ff_sectorsincluster)
+          ncontig = ff->ff_sectorsincluster;
+          cluster = ff->ff_currentcluster;
+
+          while (ncontig < nsectors)
             {
-              nsectors = ff->ff_sectorsincluster;
+              nextcluster = fat_extendchain(fs, cluster);
+              if (nextcluster < 0)
+                {
+                  ret = nextcluster;
+                  goto errout_with_chain;
+                }
+              else if (nextcluster != cluster + 1)
+                {
+                  /* Not contiguous (or no free cluster).  That will be
+                   * handled the next time through the loop.
+                   */
+
+                  break;
+                }
+
+              fat_runcacheadd(ff,
+                              (SEC_NSECTORS(fs, filep->f_pos) + ncontig) /
+                              fs->fs_fatsecperclus,
+                              nextcluster);
+
+              cluster  = nextcluster;
+              ncontig += fs->fs_fatsecperclus;
+            }
+
+          if (nsectors > ncontig)
+            {
+              nsectors = ncontig;
             }
 
           /* We are not sure of the state of the sector cache so the
@@ -838,10 +937,11 @@ fat_write_restart:
                 }
 #endif
 
-              goto errout_with_semaphore;
+              goto errout_with_chain;
             }
 
-          ff->ff_sectorsincluster -= nsectors;
+          ff->ff_currentcluster    = cluster;
+          ff->ff_sectorsincluster  = ncontig - nsectors;
           ff->ff_currentsector    += nsectors;
           writesize                = nsectors * fs->fs_hwsectorsize;
           ff->ff_bflags           |= FFBUFF_MODIFIED;
@@ -932,12 +1032,22 @@ fat_write_restart:
 
   if (filep->f_pos > ff->ff_size)
     {
-      ff->ff_size = filep->f_pos;
+      ff->ff_size    = filep->f_pos;
+      ff->ff_bflags |= FFBUFF_GROWN;
     }
 
   fat_semgive(fs);
   return byteswritten;
 
+errout_with_chain:
+  /* Clusters may have been added to the chain for a multi-sector transfer
+   * that did not complete.  They lie beyond the end of the file, so treat
+   * them like reserved clusters and let fat_trimchain() release them when
+   * the file is closed.
+   */
+
+  ff->ff_bflags |= (FFBUFF_MODIFIED|FFBUFF_PREALLOC|FFBUFF_GROWN);
+
 errout_with_semaphore:
   fat_semgive(fs);
   return ret;
@@ -953,6 +1063,8 @@ static off_t fat_seek(FAR struct file *filep, off_t offset, int whence)
   struct fat_mountpt_s *fs;
   struct fat_file_s    *ff;
   int32_t               cluster;
+  uint32_t              known;
+  uint32_t              index;
   off_t                 position;
   unsigned int          clustersize;
   int                   ret;
@@ -1057,6 +1169,26 @@ static off_t fat_seek(FAR struct file *filep, off_t offset, int whence)
        */
 
       clustersize = fs->fs_fatsecperclus * fs->fs_hwsectorsize;
+
+      /* Start with the closest known cluster before the one containing
+       * the requested position rather than with the first cluster.
+       */
+
+      fat_runcacheadd(ff, 0, cluster);
+
+      index = position / clustersize;
+      known = fat_runcachefind(ff, &index);
+      if (known)
+        {
+          cluster       = known;
+          filep->f_pos  = (off_t)index * clustersize;
+          position     -= filep->f_pos;
+        }
+      else
+        {
+          index = 0;
+        }
+
       for (;;)
         {
           /* Skip over clusters prior to the one containing
@@ -1123,8 +1255,12 @@ static off_t fat_seek(FAR struct file *filep, off_t offset, int whence)
               goto errout_with_semaphore;
             }
 
-          /* Otherwise, update the position and continue looking */
+          /* Otherwise, remember the cluster, update the position and
+           * continue looking
+           */
 
+          index++;
+          fat_runcacheadd(ff, index, cluster);
           filep->f_pos += clustersize;
           position     -= clustersize;
         }
@@ -1160,7 +1296,7 @@ static off_t fat_seek(FAR struct file *filep, off_t offset, int whence)
   if ((ff->ff_oflags & O_WROK) != 0 &&  filep->f_pos > ff->ff_size)
     {
       ff->ff_size    = filep->f_pos;
-      ff->ff_bflags |= FFBUFF_MODIFIED;
+      ff->ff_bflags |= (FFBUFF_MODIFIED|FFBUFF_GROWN);
     }
 
   fat_semgive(fs);
@@ -1179,6 +1315,9 @@ static int fat_ioctl(FAR struct file *filep, int cmd, unsigned long arg)
 {
   struct inode         *inode;
   struct fat_mountpt_s *fs;
+  struct fat_file_s    *ff;
+  FAR const off_t      *length;
+  FAR uint32_t         *fileid;
   int                   ret;
 
   /* Sanity checks */
@@ -1187,6 +1326,7 @@ static int fat_ioctl(FAR struct file *filep, int cmd, unsigned long arg)
 
   /* Recover our private data from the struct file instance */
 
+  ff    = filep->f_priv;
   inode = filep->f_inode;
   fs    = inode->i_private;
 
@@ -1202,10 +1342,55 @@ static int fat_ioctl(FAR struct file *filep, int cmd, unsigned long arg)
       return ret;
     }
 
-  /* ioctl calls are just passed through to the contained block driver */
+  switch (cmd)
+    {
+      /* Reserve clusters for the file without changing its size */
+
+      case FIOC_FALLOCATE:
+        length = (FAR const off_t *)((uintptr_t)arg);
+        if (length == NULL)
+          {
+            ret = -EINVAL;
+          }
+        else if ((ff->ff_oflags & O_WROK) == 0)
+          {
+            ret = -EACCES;
+          }
+        else
+          {
+            ret = fat_preallocate(fs, ff, *length);
+          }
+        break;
+
+      /* Identify the file by the ID assigned when it was opened.  The ID
+       * is withdrawn if the file has since been removed or truncated.  An
+       * empty file is not identified since the other open instances do not
+       * learn about the first cluster when it is allocated.
+       */
+
+      case FIOC_FILEID:
+        fileid = (FAR uint32_t *)((uintptr_t)arg);
+        if (fileid == NULL)
+          {
+            ret = -EINVAL;
+          }
+        else if (ff->ff_fileid == 0 || ff->ff_startcluster == 0)
+          {
+            ret = -ENOENT;
+          }
+        else
+          {
+            *fileid = ff->ff_fileid;
+          }
+        break;
+
+      default:
+        ret = -ENOSYS;
+        break;
+    }
 
   fat_semgive(fs);
-  return -ENOSYS;
+  return ret;
 }
 
 /****************************************************************************
@@ -1246,6 +1431,20 @@ static int fat_sync(FAR struct file *filep)
       goto errout_with_semaphore;
     }
 
+  /* If clusters were reserved with FIOC_FALLOCATE but the file has not
+   * been written into them since, release them now.  Otherwise they are
+   * kept for the writes that are still to come and released on close.
+   */
+
+  if ((ff->ff_bflags & (FFBUFF_PREALLOC|FFBUFF_GROWN)) == FFBUFF_PREALLOC)
+    {
+      ret = fat_trimchain(fs, ff);
+      if (ret < 0)
+        {
+          goto errout_with_semaphore;
+        }
+    }
+
   /* Check if the has been modified in any way */
 
   if ((ff->ff_bflags & FFBUFF_MODIFIED) != 0)
@@ -1393,8 +1592,13 @@ static int fat_dup(FAR const struct file *oldp, FAR struct file *newp)
   newff->ff_dirsector        = oldff->ff_dirsector;        /* Sector containing directory entry */
   newff->ff_size             = oldff->ff_size;             /* Size of the file */
   newff->ff_startcluster     = oldff->ff_startcluster;     /* Start cluster of file on media */
+  newff->ff_fileid           = oldff->ff_fileid;           /* FIOC_FILEID value */
   newff->ff_currentsector    = oldff->ff_currentsector;    /* Current sector */
   newff->ff_cachesector      = 0;                          /* Sector in file buffer */
+#if CONFIG_FAT_NCLUSTERRUNS > 0
+  newff->ff_runnext          = oldff->ff_runnext;          /* Cluster run cache */
+  memcpy(newff->ff_runs, oldff->ff_runs, sizeof(newff->ff_runs));
+#endif
 
   /* Attach the private date to the struct file instance */
 
@@ -1407,7 +1611,7 @@ static int fat_dup(FAR const struct file *oldp, FAR struct file *newp)
    */
 
   newff->ff_next = fs->fs_head;
-  fs->fs_head = newff->ff_next;
+  fs->fs_head = newff;
 
   fat_semgive(fs);
   return OK;
@@ -1817,6 +2021,15 @@ static int fat_unbind(void *handle, FAR struct inode **blkdriver)
     }
   else
     {
+      /* Write back any dirty sectors still held in the sector cache and
+       * the FSINFO free count and NextFree hint.
+       */
+
+      if (fs->fs_buffer)
+        {
+          (void)fat_updatefsinfo(fs);
+        }
+
        /* Unmount ... close the block driver */
 
       if (fs->fs_blkdriver)
@@ -1846,7 +2059,8 @@ static int fat_unbind(void *handle, FAR struct inode **blkdriver)
 
       if (fs->fs_buffer)
         {
-          fat_io_free(fs->fs_buffer, fs->fs_hwsectorsize);
+          fat_io_free(fs->fs_cache[0].sc_buffer,
+                      CONFIG_FAT_NSECTORCACHE * fs->fs_hwsectorsize);
         }
 
       kmm_free(fs);
@@ -2059,11 +2273,11 @@ static int fat_mkdir(struct inode *mountpt, const char *relpath, mode_t mode)
       goto errout_with_semaphore;
     }
 
-  /* Flush any existing, dirty data in fs_buffer (because we need
-   * it to create the directory entries.
+  /* Get a sector cache entry for the first sector of the new directory
+   * (because we need it to create the directory entries).
    */
 
-  ret = fat_fscacheflush(fs);
+  ret = fat_fscacheassign(fs, dirsector);
   if (ret < 0)
     {
       goto errout_with_semaphore;
@@ -2075,7 +2289,6 @@ static int fat_mkdir(struct inode *mountpt, const char *relpath, mode_t mode)
 
   /* Now erase the contents of fs_buffer */
 
-  fs->fs_currentsector = dirsector;
   memset(direntry, 0, fs->fs_hwsectorsize);
 
   /* Now clear all sectors in the new directory cluster (except for the first) */
@@ -55,6 +55,24 @@
  * Pre-processor Definitions
  ****************************************************************************/
 
+/* Configuration ************************************************************/
+/* The number of sectors held in the sector cache of each mountpoint */
+
+#ifndef CONFIG_FAT_NSECTORCACHE
+#  define CONFIG_FAT_NSECTORCACHE 4
+#endif
+
+#if CONFIG_FAT_NSECTORCACHE < 1
+#  undef  CONFIG_FAT_NSECTORCACHE
+#  define CONFIG_FAT_NSECTORCACHE 1
+#endif
+
+/* The number of cluster runs remembered for each open file */
+
+#ifndef CONFIG_FAT_NCLUSTERRUNS
+#  define CONFIG_FAT_NCLUSTERRUNS 4
+#endif
+
 /****************************************************************************
  * These offsets describes the master boot record.
  *
@@ -276,6 +294,8 @@
 #define FFBUFF_VALID        1
 #define FFBUFF_DIRTY        2
 #define FFBUFF_MODIFIED     4
+#define FFBUFF_PREALLOC     8  /* Clusters reserved past the end of the file */
+#define FFBUFF_GROWN        16 /* File grew since the clusters were reserved */
 
 /****************************************************************************
  * These offset describe the FSINFO sector
@@ -682,10 +702,10 @@
  * Name: fat_io_alloc and fat_io_free
  *
  * Description:
- *   The FAT file system allocates two I/O buffers for data transfer, each
- *   are the size of one device sector.  One of the buffers is allocated
- *   once for each FAT volume that is mounted; the other buffers are
- *   allocated each time a FAT file is opened.
+ *   The FAT file system allocates two kinds of I/O buffers for data
+ *   transfer.  The sector cache (CONFIG_FAT_NSECTORCACHE sectors) is
+ *   allocated once for each FAT volume that is mounted; a buffer of one
+ *   device sector is allocated each time a FAT file is opened.
  *
  *   Some hardware, however, may require special DMA-capable memory in
  *   order to perform the transfers.  If CONFIG_FAT_DMAMEMORY is defined
@@ -709,6 +729,34 @@
  * Public Types
  ****************************************************************************/
 
+/* This structure describes one sector held in the mountpoint sector cache.
+ * The sector that is currently being accessed is also described by the
+ * fs_buffer, fs_currentsector and fs_dirty fields of the mountpoint; those
+ * fields are authoritative for that sector.
+ */
+
+struct fat_sectorcache_s
+{
+  off_t    sc_sector;              /* The cached sector number (-1: none) */
+  uint32_t sc_lastuse;             /* Time of last use (for LRU replacement) */
+  bool     sc_dirty;               /* true: The sector must be written back */
+  uint8_t *sc_buffer;              /* Buffer holding one sector */
+};
+
+/* This structure describes a run of clusters that are contiguous on the
+ * media:  File cluster cr_index is media cluster cr_cluster and so on for
+ * cr_length clusters.
+ */
+
+#if CONFIG_FAT_NCLUSTERRUNS > 0
+struct fat_clusterrun_s
+{
+  uint32_t cr_index;               /* Index of the first cluster in the file */
+  uint32_t cr_cluster;             /* The first cluster on the media */
+  uint32_t cr_length;              /* Number of clusters in the run (0: unused) */
+};
+#endif
+
 /* This structure represents the overall mountpoint state.  An instance of this
  * structure is retained as inode private data on each mountpoint that is
  * mounted with a fat32 filesystem.
@@ -727,12 +775,13 @@ struct fat_mountpt_s
   off_t    fs_rootbase;            /* MBR: Cluster no. of 1st cluster of root dir */
   off_t    fs_database;            /* Logical block of start data sectors */
   off_t    fs_fsinfo;              /* MBR: Sector number of FSINFO sector */
-  off_t    fs_currentsector;       /* The sector number buffered in fs_buffer */
+  off_t    fs_currentsector;       /* The sector number buffered in fs_buffer (-1: none) */
   uint32_t fs_nclusters;           /* Maximum number of data clusters */
   uint32_t fs_nfatsects;           /* MBR: Count of sectors occupied by one fat */
   uint32_t fs_fattotsec;           /* MBR: Total count of sectors on the volume */
   uint32_t fs_fsifreecount;        /* FSI: Last free cluster count on volume */
   uint32_t fs_fsinextfree;         /* FSI: Cluster number of 1st free cluster */
+  uint32_t fs_fileid;              /* Last FIOC_FILEID value handed out */
   uint16_t fs_fatresvdseccount;    /* MBR: The total number of reserved sectors */
   uint16_t fs_rootentcnt;          /* MBR: Count of 32-bit root directory entries */
   bool     fs_mounted;             /* true: The file system is ready */
@@ -741,8 +790,10 @@ struct fat_mountpt_s
   uint8_t  fs_type;                /* FSTYPE_FAT12, FSTYPE_FAT16, or FSTYPE_FAT32 */
   uint8_t  fs_fatnumfats;          /* MBR: Number of FATs (probably 2) */
   uint8_t  fs_fatsecperclus;       /* MBR: Sectors per allocation unit: 2**n, n=0..7 */
-  uint8_t *fs_buffer;              /* This is an allocated buffer to hold one sector
-                                    * from the device */
+  uint8_t  fs_cacheslot;           /* The sector cache entry in fs_buffer */
+  uint32_t fs_cacheclock;          /* Sector cache use counter (for LRU) */
+  uint8_t *fs_buffer;              /* The buffer of the current sector cache entry */
+  struct fat_sectorcache_s fs_cache[CONFIG_FAT_NSECTORCACHE];
 };
 
 /* This structure represents on open file under the mountpoint.  An instance
@@ -758,12 +809,17 @@ struct fat_file_s
   uint8_t  ff_sectorsincluster;    /* Sectors remaining in cluster */
   uint16_t ff_dirindex;            /* Index into ff_dirsector to directory entry */
   uint32_t ff_currentcluster;      /* Current cluster being accessed */
+  uint32_t ff_fileid;              /* FIOC_FILEID value (0: revoked) */
   off_t    ff_dirsector;           /* Sector containing the directory entry */
   off_t    ff_size;                /* Size of the file in bytes */
   off_t    ff_startcluster;        /* Start cluster of file on media */
   off_t    ff_currentsector;       /* Current sector being operated on */
   off_t    ff_cachesector;         /* Current sector in the file buffer */
   uint8_t *ff_buffer;              /* File buffer (for partial sector accesses) */
+#if CONFIG_FAT_NCLUSTERRUNS > 0
+  uint8_t  ff_runnext;             /* Next entry of ff_runs to be replaced */
+  struct fat_clusterrun_s ff_runs[CONFIG_FAT_NCLUSTERRUNS];
+#endif
 };
 
 /* This structure holds the sequency of directory entries used by one
@@ -916,10 +972,17 @@ EXTERN int    fat_dirtruncate(struct fat_mountpt_s *fs, struct fat_dirinfo_s *di
 EXTERN int    fat_dircreate(struct fat_mountpt_s *fs, struct fat_dirinfo_s *dirinfo);
 EXTERN int    fat_remove(struct fat_mountpt_s *fs, const char *relpath, bool directory);
 
+/* Identification of open files (FIOC_FILEID) */
+
+EXTERN void   fat_assignfileid(struct fat_mountpt_s *fs, struct fat_file_s *ff);
+EXTERN void   fat_revokefileid(struct fat_mountpt_s *fs, off_t dirsector,
+                               uint16_t dirindex, uint32_t cluster);
+
 /* Mountpoint and file buffer cache (for partial sector accesses) */
 
 EXTERN int    fat_fscacheflush(struct fat_mountpt_s *fs);
 EXTERN int    fat_fscacheread(struct fat_mountpt_s *fs, off_t sector);
+EXTERN int    fat_fscacheassign(struct fat_mountpt_s *fs, off_t sector);
 EXTERN int    fat_ffcacheflush(struct fat_mountpt_s *fs, struct fat_file_s *ff);
 EXTERN int    fat_ffcacheread(struct fat_mountpt_s *fs, struct fat_file_s *ff, off_t sector);
 EXTERN int    fat_ffcacheinvalidate(struct fat_mountpt_s *fs, struct fat_file_s *ff);
@@ -929,6 +992,18 @@ EXTERN int    fat_ffcacheinvalidate(struct fat_mountpt_s *fs, struct fat_file_s
 EXTERN int    fat_updatefsinfo(struct fat_mountpt_s *fs);
 EXTERN int    fat_nfreeclusters(struct fat_mountpt_s *fs, off_t *pfreeclusters);
 EXTERN int    fat_currentsector(struct fat_mountpt_s *fs, struct fat_file_s *ff, off_t position);
+EXTERN int    fat_preallocate(struct fat_mountpt_s *fs, struct fat_file_s *ff, off_t length);
+EXTERN int    fat_trimchain(struct fat_mountpt_s *fs, struct fat_file_s *ff);
+
+/* Cache of the cluster chain of an open file */
+
+#if CONFIG_FAT_NCLUSTERRUNS > 0
+EXTERN void   fat_runcacheadd(struct fat_file_s *ff, uint32_t index, uint32_t cluster);
+EXTERN uint32_t fat_runcachefind(struct fat_file_s *ff, uint32_t *pindex);
+#else
+#  define fat_runcacheadd(ff,index,cluster)
+#  define fat_runcachefind(ff,pindex) (0)
+#endif
 
 #undef EXTERN
 #if defined(__cplusplus)
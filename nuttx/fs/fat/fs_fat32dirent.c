@@ -2513,11 +2513,11 @@ int fat_allocatedirentry(struct fat_mountpt_s *fs, struct fat_dirinfo_s *dirinfo
           return cluster;
         }
 
-     /* Flush out any cached data in fs_buffer.. we are going to use
-      * it to initialize the new directory cluster.
+     /* Get a sector cache entry for the first sector of the new directory
+      * cluster.. we are going to use it to initialize the cluster.
       */
 
-      ret = fat_fscacheflush(fs);
+      ret = fat_fscacheassign(fs, fat_cluster2sector(fs, cluster));
       if (ret < 0)
         {
           return ret;
@@ -2525,7 +2525,6 @@ int fat_allocatedirentry(struct fat_mountpt_s *fs, struct fat_dirinfo_s *dirinfo
 
       /* Clear all sectors comprising the new directory cluster */
 
-      fs->fs_currentsector = fat_cluster2sector(fs, cluster);
       memset(fs->fs_buffer, 0, fs->fs_hwsectorsize);
 
       sector = fs->fs_currentsector;
@@ -2824,6 +2823,8 @@ int fat_remove(struct fat_mountpt_s *fs, const char *relpath, bool directory)
   struct fat_dirinfo_s dirinfo;
   uint32_t             dircluster;
   uint8_t             *direntry;
+  off_t                dirsector;
+  uint16_t             dirindex;
   int                  ret;
 
   /* Find the directory entry referring to the entry to be deleted */
@@ -2845,6 +2846,13 @@ int fat_remove(struct fat_mountpt_s *fs, const char *relpath, bool directory)
       return -EPERM;
     }
 
+  /* Remember where the directory entry is.  The sector holding it is the
+   * current sector.
+   */
+
+  dirsector = fs->fs_currentsector;
+  dirindex  = dirinfo.dir.fd_index;
+
   /* The object has to have write access to be deleted */
 
   direntry = &fs->fs_buffer[dirinfo.fd_seq.ds_offset];
@@ -2953,6 +2961,12 @@ int fat_remove(struct fat_mountpt_s *fs, const char *relpath, bool directory)
         }
     }
 
+  /* Any instance of the file that is still open no longer identifies the
+   * file at this directory entry or in these clusters.
+   */
+
+  fat_revokefileid(fs, dirsector, dirindex, dircluster);
+
   /* Mark the directory entry 'deleted'.  If long file name support is
    * enabled, then multiple directory entries may be freed.
    */
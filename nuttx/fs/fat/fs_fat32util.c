@@ -87,6 +87,171 @@
  * Private Functions
  ****************************************************************************/
 
+/****************************************************************************
+ * Name: fat_cachesave
+ *
+ * Desciption: Save the state of the current sector (fs_currentsector and
+ *   fs_dirty) in its sector cache entry.
+ *
+ ****************************************************************************/
+
+static inline void fat_cachesave(struct fat_mountpt_s *fs)
+{
+  struct fat_sectorcache_s *entry = &fs->fs_cache[fs->fs_cacheslot];
+
+  entry->sc_sector = fs->fs_currentsector;
+  entry->sc_dirty  = fs->fs_dirty;
+}
+
+/****************************************************************************
+ * Name: fat_cacheselect
+ *
+ * Desciption: Make a sector cache entry the current sector.  The state of
+ *   the previous current sector must already have been saved.
+ *
+ ****************************************************************************/
+
+static inline void fat_cacheselect(struct fat_mountpt_s *fs, int slot)
+{
+  struct fat_sectorcache_s *entry = &fs->fs_cache[slot];
+
+  entry->sc_lastuse    = ++fs->fs_cacheclock;
+  fs->fs_cacheslot     = slot;
+  fs->fs_buffer        = entry->sc_buffer;
+  fs->fs_currentsector = entry->sc_sector;
+  fs->fs_dirty         = entry->sc_dirty;
+}
+
+/****************************************************************************
+ * Name: fat_cacheinvalidate
+ *
+ * Desciption: Discard the contents of the whole sector cache.
+ *
+ ****************************************************************************/
+
+static void fat_cacheinvalidate(struct fat_mountpt_s *fs)
+{
+  int i;
+
+  for (i = 0; i < CONFIG_FAT_NSECTORCACHE; i++)
+    {
+      fs->fs_cache[i].sc_sector  = -1;
+      fs->fs_cache[i].sc_lastuse = 0;
+      fs->fs_cache[i].sc_dirty   = false;
+    }
+
+  fs->fs_currentsector = -1;
+  fs->fs_dirty         = false;
+}
+
+/****************************************************************************
+ * Name: fat_cachefind
+ *
+ * Desciption: Return the sector cache entry holding the sector or, if the
+ *   sector is not cached, -1.  The state of the current sector must have
+ *   been saved.
+ *
+ ****************************************************************************/
+
+static int fat_cachefind(struct fat_mountpt_s *fs, off_t sector)
+{
+  int i;
+
+  for (i = 0; i < CONFIG_FAT_NSECTORCACHE; i++)
+    {
+      if (fs->fs_cache[i].sc_sector == sector)
+        {
+          return i;
+        }
+    }
+
+  return -1;
+}
+
+/****************************************************************************
+ * Name: fat_cachewriteback
+ *
+ * Desciption: Write back a dirty sector cache entry.  Sectors in the FAT
+ *   region are also written to each copy of the FAT.  The state of the
+ *   current sector must have been saved.
+ *
+ ****************************************************************************/
+
+static int fat_cachewriteback(struct fat_mountpt_s *fs, int slot)
+{
+  struct fat_sectorcache_s *entry = &fs->fs_cache[slot];
+  off_t sector = entry->sc_sector;
+  int ret;
+
+  if (entry->sc_dirty)
+    {
+      /* Write the dirty sector */
+
+      ret = fat_hwwrite(fs, entry->sc_buffer, sector, 1);
+      if (ret < 0)
+        {
+          return ret;
+        }
+
+      /* Does the sector lie in the FAT region? */
+
+      if (sector >= fs->fs_fatbase &&
+          sector < fs->fs_fatbase + fs->fs_nfatsects)
+        {
+          /* Yes, then make the change in the FAT copy as well */
+          int i;
+
+          for (i = fs->fs_fatnumfats; i >= 2; i--)
+            {
+              sector += fs->fs_nfatsects;
+              ret = fat_hwwrite(fs, entry->sc_buffer, sector, 1);
+              if (ret < 0)
+                {
+                  return ret;
+                }
+            }
+        }
+
+      /* No longer dirty */
+
+      entry->sc_dirty = false;
+    }
+
+  return OK;
+}
+
+/****************************************************************************
+ * Name: fat_cachevictim
+ *
+ * Desciption: Select the least recently used sector cache entry and write
+ *   it back if it is dirty so that it can be re-used.  The state of the
+ *   current sector must have been saved.
+ *
+ ****************************************************************************/
+
+static int fat_cachevictim(struct fat_mountpt_s *fs)
+{
+  int victim = 0;
+  int ret;
+  int i;
+
+  for (i = 1; i < CONFIG_FAT_NSECTORCACHE; i++)
+    {
+      if (fs->fs_cache[i].sc_lastuse < fs->fs_cache[victim].sc_lastuse)
+        {
+          victim = i;
+        }
+    }
+
+  ret = fat_cachewriteback(fs, victim);
+  if (ret < 0)
+    {
+      return ret;
+    }
+
+  return victim;
+}
+
 /****************************************************************************
  * Name: fat_checkfsinfo
  *
@@ -513,6 +678,7 @@ int fat_mount(struct fat_mountpt_s *fs, bool writeable)
   FAR struct inode *inode;
   struct geometry geo;
   int ret;
+  int i;
 
   /* Assume that the mount is successful */
 
@@ -541,15 +707,24 @@ int fat_mount(struct fat_mountpt_s *fs, bool writeable)
   fs->fs_hwsectorsize = geo.geo_sectorsize;
   fs->fs_hwnsectors   = geo.geo_nsectors;
 
-  /* Allocate a buffer to hold one hardware sector */
+  /* Allocate one buffer to hold all of the sectors of the sector cache */
 
-  fs->fs_buffer = (uint8_t*)fat_io_alloc(fs->fs_hwsectorsize);
+  fs->fs_buffer = (uint8_t*)fat_io_alloc(CONFIG_FAT_NSECTORCACHE *
+                                         fs->fs_hwsectorsize);
   if (!fs->fs_buffer)
     {
       ret = -ENOMEM;
       goto errout;
     }
 
+  for (i = 0; i < CONFIG_FAT_NSECTORCACHE; i++)
+    {
+      fs->fs_cache[i].sc_buffer = &fs->fs_buffer[i * fs->fs_hwsectorsize];
+    }
+
+  fs->fs_cacheslot  = 0;
+  fs->fs_cacheclock = 0;
+
   /* Search FAT boot record on the drive.  First check at sector zero.  This
    * could be either the boot record or a partition that refers to the boot
    * record.
@@ -574,7 +749,6 @@ int fat_mount(struct fat_mountpt_s *fs, bool writeable)
        * indexed by 16x the partition number.
        */
 
-       int i;
        for (i = 0; i < 4; i++)
          {
            /* Check if the partition exists and, if so, get the bootsector for that
@@ -638,6 +812,12 @@ int fat_mount(struct fat_mountpt_s *fs, bool writeable)
         }
     }
 
+  /* The boot record was read directly into fs_buffer.  Start with an
+   * empty sector cache.
+   */
+
+  fat_cacheinvalidate(fs);
+
   /* We have what appears to be a valid FAT filesystem! Now read the
    * FSINFO sector (FAT32 only)
    */
@@ -673,7 +853,8 @@ int fat_mount(struct fat_mountpt_s *fs, bool writeable)
   return OK;
 
  errout_with_buffer:
-  fat_io_free(fs->fs_buffer, fs->fs_hwsectorsize);
+  fat_io_free(fs->fs_cache[0].sc_buffer,
+              CONFIG_FAT_NSECTORCACHE * fs->fs_hwsectorsize);
   fs->fs_buffer = 0;
 
  errout:
@@ -773,6 +954,32 @@ int fat_hwwrite(struct fat_mountpt_s *fs, uint8_t *buffer, off_t sector,
         {
           ssize_t nSectorsWritten =
               inode->u.i_bops->write(inode, buffer, sector, nsectors);
+          int i;
+
+          /* Any other copy of these sectors in the sector cache is now
+           * stale.  The current sector is described by fs_currentsector.
+           */
+
+          for (i = 0; i < CONFIG_FAT_NSECTORCACHE; i++)
+            {
+              struct fat_sectorcache_s *entry = &fs->fs_cache[i];
+              off_t cached = (i == fs->fs_cacheslot) ?
+                             fs->fs_currentsector : entry->sc_sector;
+
+              if (entry->sc_buffer != buffer &&
+                  cached >= sector && cached < sector + nsectors)
+                {
+                  entry->sc_sector  = -1;
+                  entry->sc_lastuse = 0;
+                  entry->sc_dirty   = false;
+
+                  if (i == fs->fs_cacheslot)
+                    {
+                      fs->fs_currentsector = -1;
+                      fs->fs_dirty         = false;
+                    }
+                }
+            }
 
           if (nSectorsWritten == nsectors)
             {
@@ -1204,9 +1411,34 @@ int32_t fat_extendchain(struct fat_mountpt_s *fs, uint32_t cluster)
           return startsector;
         }
 
-      /* Okay.. it checks out */
+      /* Okay.. it checks out.  The cluster immediately following the
+       * end of the chain is the best choice because it keeps the chain
+       * contiguous.
+       */
+
+      newcluster = cluster + 1;
+      if (newcluster < fs->fs_nclusters)
+        {
+          startsector = fat_getcluster(fs, newcluster);
+          if (startsector == 0)
+            {
+              goto found;
+            }
+          else if (startsector < 0)
+            {
+              return startsector;
+            }
+        }
+
+      /* Otherwise, search from the FSINFO NextFree hint rather than
+       * walking over all of the clusters that follow the chain.
+       */
 
-      startcluster = cluster;
+      startcluster = fs->fs_fsinextfree;
+      if (startcluster < 2 || startcluster >= fs->fs_nclusters)
+        {
+          startcluster = cluster;
+        }
     }
 
   /* Loop until (1) we discover that there are not free clusters
@@ -1271,6 +1503,7 @@ int32_t fat_extendchain(struct fat_mountpt_s *fs, uint32_t cluster)
    * number in 'newcluster'  Now mark that cluster as in-use.
    */
 
+found:
   ret = fat_putcluster(fs, newcluster, 0x0fffffff);
   if (ret < 0)
     {
@@ -1292,13 +1525,17 @@ int32_t fat_extendchain(struct fat_mountpt_s *fs, uint32_t cluster)
         }
     }
 
-  /* And update the FINSINFO for the next time we have to search */
+  /* And update the FINSINFO for the next time we have to search.  The
+   * NextFree hint is written back even if the free count is not known so
+   * that the search does not start at the beginning after a remount.
+   */
 
   fs->fs_fsinextfree = newcluster;
+  fs->fs_fsidirty    = true;
+
   if (fs->fs_fsifreecount != 0xffffffff)
     {
       fs->fs_fsifreecount--;
-      fs->fs_fsidirty = 1;
     }
 
   /* Return then number of the new cluster that was added to the chain */
@@ -1447,6 +1684,13 @@ int  fat_dirtruncate(struct fat_mountpt_s *fs, struct fat_dirinfo_s *dirinfo)
 
   fs->fs_dirty = true;
 
+  /* The file that is opened next at this directory entry is not the file
+   * that any other open instance refers to.
+   */
+
+  fat_revokefileid(fs, fs->fs_currentsector, dirinfo->dir.fd_index,
+                   startcluster);
+
   /* Now remove the entire cluster chain comprising the file */
 
   savesector = fs->fs_currentsector;
@@ -1465,100 +1709,200 @@ int  fat_dirtruncate(struct fat_mountpt_s *fs, struct fat_dirinfo_s *dirinfo)
   return fat_fscacheread(fs, savesector);
 }
 
+/****************************************************************************
+ * Name: fat_assignfileid
+ *
+ * Desciption: Assign the FIOC_FILEID value of a newly opened file.  If the
+ *   same file is already open, the new instance gets the same ID.
+ *   Otherwise, the file gets an ID that has never been used on this
+ *   volume.  The start cluster alone cannot identify a file: the clusters
+ *   of a removed or truncated file are soon reused (the very same start
+ *   cluster, in the case of O_TRUNC).
+ *
+ * Assumptions:  The caller holds mountpoint semaphore and 'ff' is not yet
+ *   in the list of open files.
+ *
+ ****************************************************************************/
+
+void fat_assignfileid(struct fat_mountpt_s *fs, struct fat_file_s *ff)
+{
+  struct fat_file_s *other;
+
+  for (other = fs->fs_head; other; other = other->ff_next)
+    {
+      if (other->ff_fileid != 0 &&
+          other->ff_dirsector == ff->ff_dirsector &&
+          (other->ff_dirindex & DIRSEC_NDXMASK(fs)) ==
+          (ff->ff_dirindex & DIRSEC_NDXMASK(fs)) &&
+          other->ff_startcluster == ff->ff_startcluster)
+        {
+          ff->ff_fileid = other->ff_fileid;
+          return;
+        }
+    }
+
+  if (++fs->fs_fileid == 0)
+    {
+      fs->fs_fileid = 1;
+    }
+
+  ff->ff_fileid = fs->fs_fileid;
+}
+
+/****************************************************************************
+ * Name: fat_revokefileid
+ *
+ * Desciption: The file at the directory entry 'dirindex' in 'dirsector',
+ *   whose cluster chain starts at 'cluster', is being removed or
+ *   truncated.  Withdraw the FIOC_FILEID of every instance of the file
+ *   that is still open so that the ID is never matched to the file that
+ *   reuses the directory entry or the clusters.
+ *
+ * Assumptions:  The caller holds mountpoint semaphore.
+ *
+ ****************************************************************************/
+
+void fat_revokefileid(struct fat_mountpt_s *fs, off_t dirsector,
+                      uint16_t dirindex, uint32_t cluster)
+{
+  struct fat_file_s *ff;
+
+  for (ff = fs->fs_head; ff; ff = ff->ff_next)
+    {
+      if ((ff->ff_dirsector == dirsector &&
+           (ff->ff_dirindex & DIRSEC_NDXMASK(fs)) ==
+           (dirindex & DIRSEC_NDXMASK(fs))) ||
+          (cluster != 0 && ff->ff_startcluster == cluster))
+        {
+          ff->ff_fileid = 0;
+        }
+    }
+}
+
 /****************************************************************************
  * Name: fat_fscacheflush
  *
- * Desciption: Flush any dirty sector if fs_buffer as necessary
+ * Desciption: Write back all dirty sectors in the sector cache
  *
  ****************************************************************************/
 
 int fat_fscacheflush(struct fat_mountpt_s *fs)
 {
   int ret;
+  int i;
 
-  /* Check if the fs_buffer is dirty.  In this case, we will write back the
-   * contents of fs_buffer.
+  /* Write back each dirty sector in the cache, including the current sector
+   * in fs_buffer.
    */
 
-  if (fs->fs_dirty)
+  fat_cachesave(fs);
+  for (i = 0; i < CONFIG_FAT_NSECTORCACHE; i++)
     {
-      /* Write the dirty sector */
-
-      ret = fat_hwwrite(fs, fs->fs_buffer, fs->fs_currentsector, 1);
+      ret = fat_cachewriteback(fs, i);
       if (ret < 0)
         {
           return ret;
         }
+    }
 
-      /* Does the sector lie in the FAT region? */
-
-      if (fs->fs_currentsector >= fs->fs_fatbase &&
-          fs->fs_currentsector < fs->fs_fatbase + fs->fs_nfatsects)
-        {
-          /* Yes, then make the change in the FAT copy as well */
-          int i;
-
-          for (i = fs->fs_fatnumfats; i >= 2; i--)
-            {
-              fs->fs_currentsector += fs->fs_nfatsects;
-              ret = fat_hwwrite(fs, fs->fs_buffer, fs->fs_currentsector, 1);
-              if (ret < 0)
-                {
-                  return ret;
-                }
-            }
-        }
-
-      /* No longer dirty */
+  /* The current sector is no longer dirty */
 
-      fs->fs_dirty = false;
-    }
+  fs->fs_dirty = false;
   return OK;
 }
 
 /****************************************************************************
  * Name: fat_fscacheread
  *
- * Desciption: Read the specified sector into the sector cache, flushing any
- *   existing dirty sectors as necessary.
+ * Desciption: Make the specified sector the current sector in fs_buffer,
+ *   reading it into the sector cache if it is not already cached.  The
+ *   least recently used sector is replaced, writing it back first if it is
+ *   dirty.
  *
  ****************************************************************************/
 
 int fat_fscacheread(struct fat_mountpt_s *fs, off_t sector)
 {
+  int slot;
   int ret;
 
   /* fs->fs_currentsector holds the current sector that is buffered in
    * fs->fs_buffer. If the requested sector is the same as this sector, then
-   * we do nothing. Otherwise, we will have to read the new sector.
+   * we do nothing.
    */
 
-    if (fs->fs_currentsector != sector)
-      {
-        /* We will need to read the new sector.  First, flush the cached
-         * sector if it is dirty.
-         */
+  if (fs->fs_currentsector == sector)
+    {
+      return OK;
+    }
 
-        ret = fat_fscacheflush(fs);
-        if (ret < 0)
-          {
-              return ret;
-          }
+  /* Otherwise, check if the sector is elsewhere in the sector cache */
+
+  fat_cachesave(fs);
+  slot = fat_cachefind(fs, sector);
+  if (slot < 0)
+    {
+      /* We will need to read the new sector.  First, get an entry for it,
+       * flushing the sector that it holds if it is dirty.
+       */
 
-        /* Then read the specified sector into the cache */
+      slot = fat_cachevictim(fs);
+      if (slot < 0)
+        {
+          return slot;
+        }
 
-        ret = fat_hwread(fs, fs->fs_buffer, sector, 1);
-        if (ret < 0)
-          {
-            return ret;
-          }
+      /* Then read the specified sector into the cache */
 
-        /* Update the cached sector number */
+      ret = fat_hwread(fs, fs->fs_cache[slot].sc_buffer, sector, 1);
+      if (ret < 0)
+        {
+          /* The entry no longer holds valid data */
 
-        fs->fs_currentsector = sector;
+          fs->fs_cache[slot].sc_sector  = -1;
+          fs->fs_cache[slot].sc_lastuse = 0;
+          fs->fs_currentsector = fs->fs_cache[fs->fs_cacheslot].sc_sector;
+          fs->fs_dirty         = fs->fs_cache[fs->fs_cacheslot].sc_dirty;
+          return ret;
+        }
+
+      /* Update the cached sector number */
+
+      fs->fs_cache[slot].sc_sector = sector;
     }
 
-    return OK;
+  fat_cacheselect(fs, slot);
+  return OK;
+}
+
+/****************************************************************************
+ * Name: fat_fscacheassign
+ *
+ * Desciption: Make the specified sector the current sector in fs_buffer
+ *   without reading it.  This is used when the caller will overwrite the
+ *   whole sector.
+ *
+ ****************************************************************************/
+
+int fat_fscacheassign(struct fat_mountpt_s *fs, off_t sector)
+{
+  int slot;
+
+  fat_cachesave(fs);
+  slot = fat_cachefind(fs, sector);
+  if (slot < 0)
+    {
+      slot = fat_cachevictim(fs);
+      if (slot < 0)
+        {
+          return slot;
+        }
+
+      fs->fs_cache[slot].sc_sector = sector;
+    }
+
+  fat_cacheselect(fs, slot);
+  return OK;
 }
 
 /****************************************************************************
@@ -1700,6 +2044,12 @@ int fat_updatefsinfo(struct fat_mountpt_s *fs)
         {
           /* Create an image of the FSINFO sector in the fs_buffer */
 
+          ret = fat_fscacheassign(fs, fs->fs_fsinfo);
+          if (ret < 0)
+            {
+              return ret;
+            }
+
           memset(fs->fs_buffer, 0, fs->fs_hwsectorsize);
           FSI_PUTLEADSIG(fs->fs_buffer, 0x41615252);
           FSI_PUTSTRUCTSIG(fs->fs_buffer, 0x61417272);
@@ -1709,9 +2059,8 @@ int fat_updatefsinfo(struct fat_mountpt_s *fs)
 
           /* Then flush this to disk */
 
-          fs->fs_currentsector = fs->fs_fsinfo;
-          fs->fs_dirty         = true;
-          ret                  = fat_fscacheflush(fs);
+          fs->fs_dirty = true;
+          ret          = fat_fscacheflush(fs);
 
           /* No longer dirty */
 
@@ -1869,3 +2218,347 @@ int fat_currentsector(struct fat_mountpt_s *fs, struct fat_file_s *ff,
 
   return -ENOSPC;
 }
+
+/****************************************************************************
+ * Name: fat_preallocate
+ *
+ * Desciption: Make sure that the cluster chain of the file is long enough
+ *   to hold 'length' bytes, allocating clusters as necessary.  The file
+ *   size is not changed.  Subsequent writes up to 'length' then follow the
+ *   existing chain and do not have to search the FAT for free clusters.
+ *
+ ****************************************************************************/
+
+int fat_preallocate(struct fat_mountpt_s *fs, struct fat_file_s *ff,
+                    off_t length)
+{
+  uint32_t clustersize;
+  uint32_t nclusters;
+  uint32_t index;
+  int32_t  cluster;
+
+  if (length <= 0)
+    {
+      return length < 0 ? -EINVAL : OK;
+    }
+
+  clustersize = fs->fs_fatsecperclus * fs->fs_hwsectorsize;
+  nclusters   = (length - 1) / clustersize + 1;
+
+  /* Create a new cluster chain if the file does not have one */
+
+  if (ff->ff_startcluster == 0)
+    {
+      cluster = fat_createchain(fs);
+      if (cluster < 0)
+        {
+          return cluster;
+        }
+      else if (cluster < 2 || cluster >= fs->fs_nclusters)
+        {
+          return -ENOSPC;
+        }
+
+      ff->ff_startcluster = cluster;
+      if (ff->ff_currentcluster == 0)
+        {
+          ff->ff_currentcluster   = cluster;
+          ff->ff_sectorsincluster = fs->fs_fatsecperclus;
+        }
+
+      index = 0;
+    }
+  else
+    {
+      /* Start with the closest known cluster before the last one */
+
+      fat_runcacheadd(ff, 0, ff->ff_startcluster);
+
+      index   = nclusters - 1;
+      cluster = fat_runcachefind(ff, &index);
+      if (!cluster)
+        {
+          cluster = ff->ff_startcluster;
+          index   = 0;
+        }
+    }
+
+  /* Then follow and extend the chain up to the last cluster */
+
+  while (index < nclusters - 1)
+    {
+      cluster = fat_extendchain(fs, cluster);
+      if (cluster < 0)
+        {
+          return cluster;
+        }
+      else if (cluster < 2 || cluster >= fs->fs_nclusters)
+        {
+          return -ENOSPC;
+        }
+
+      index++;
+      fat_runcacheadd(ff, index, cluster);
+    }
+
+  /* The FAT has been modified.  Make sure that it is written back when the
+   * file is synchronized or closed.  Remember the reservation so that any
+   * clusters that are still unused can be released by fat_trimchain().
+   */
+
+  ff->ff_bflags |= (FFBUFF_MODIFIED|FFBUFF_PREALLOC);
+  ff->ff_bflags &= ~FFBUFF_GROWN;
+  return OK;
+}
+
+/****************************************************************************
+ * Name: fat_trimchain
+ *
+ * Desciption: Release the clusters at the end of the chain of the file that
+ *   are not needed to hold ff_size bytes, i.e., clusters that were reserved
+ *   with fat_preallocate() or added for a write that failed, but never
+ *   became part of the file.  The file size is not changed.
+ *
+ ****************************************************************************/
+
+int fat_trimchain(struct fat_mountpt_s *fs, struct fat_file_s *ff)
+{
+  uint32_t clustersize;
+  uint32_t nclusters;
+  uint32_t index;
+  int32_t  cluster;
+  int32_t  lastcluster;
+  int32_t  nextcluster;
+  bool     current = false;
+  int      ret;
+
+  ff->ff_bflags &= ~(FFBUFF_PREALLOC|FFBUFF_GROWN);
+  if (ff->ff_startcluster == 0)
+    {
+      return OK;
+    }
+
+  clustersize = fs->fs_fatsecperclus * fs->fs_hwsectorsize;
+  nclusters   = ff->ff_size > 0 ? (ff->ff_size - 1) / clustersize + 1 : 0;
+
+  if (nclusters == 0)
+    {
+      /* The whole chain goes */
+
+      lastcluster = 0;
+      cluster     = ff->ff_startcluster;
+    }
+  else
+    {
+      /* Find the last cluster that holds data, starting with the closest
+       * known cluster before it.
+       */
+
+      fat_runcacheadd(ff, 0, ff->ff_startcluster);
+
+      index       = nclusters - 1;
+      lastcluster = fat_runcachefind(ff, &index);
+      if (!lastcluster)
+        {
+          lastcluster = ff->ff_startcluster;
+          index       = 0;
+        }
+
+      while (index < nclusters - 1)
+        {
+          lastcluster = fat_getcluster(fs, lastcluster);
+          if (lastcluster < 0)
+            {
+              return lastcluster;
+            }
+          else if (lastcluster < 2 || lastcluster >= fs->fs_nclusters)
+            {
+              return -EINVAL;
+            }
+
+          index++;
+        }
+
+      /* Nothing to do if the chain already ends there */
+
+      cluster = fat_getcluster(fs, lastcluster);
+      if (cluster < 0)
+        {
+          return cluster;
+        }
+      else if (cluster < 2 || cluster >= fs->fs_nclusters)
+        {
+          return OK;
+        }
+
+      /* Terminate the chain after the last cluster */
+
+      ret = fat_putcluster(fs, lastcluster, 0x0fffffff);
+      if (ret < 0)
+        {
+          return ret;
+        }
+    }
+
+  /* Free the rest of the chain, noting whether the current cluster of the
+   * file is freed with it.
+   */
+
+  while (cluster >= 2 && cluster < fs->fs_nclusters)
+    {
+      nextcluster = fat_getcluster(fs, cluster);
+      if (nextcluster < 0)
+        {
+          return nextcluster;
+        }
+
+      ret = fat_putcluster(fs, cluster, 0);
+      if (ret < 0)
+        {
+          return ret;
+        }
+
+      if (fs->fs_fsifreecount != 0xffffffff)
+        {
+          fs->fs_fsifreecount++;
+          fs->fs_fsidirty = 1;
+        }
+
+      if (cluster == ff->ff_currentcluster)
+        {
+          current = true;
+        }
+
+      cluster = nextcluster;
+    }
+
+  /* The file position cannot lie beyond the end of the file, but a seek to
+   * the end of the file may have advanced into the first reserved cluster.
+   * Move back to the end of the last cluster so that the next write extends
+   * the chain from there.
+   */
+
+  if (nclusters == 0)
+    {
+      ff->ff_startcluster     = 0;
+      ff->ff_currentcluster   = 0;
+      ff->ff_currentsector    = 0;
+      ff->ff_sectorsincluster = 0;
+    }
+  else if (current)
+    {
+      ff->ff_currentcluster   = lastcluster;
+      ff->ff_currentsector    = fat_cluster2sector(fs, lastcluster) +
+                                fs->fs_fatsecperclus;
+      ff->ff_sectorsincluster = 0;
+    }
+
+  /* Forget the clusters that are no longer part of the file */
+
+#if CONFIG_FAT_NCLUSTERRUNS > 0
+  memset(ff->ff_runs, 0, sizeof(ff->ff_runs));
+  ff->ff_runnext = 0;
+#endif
+
+  ff->ff_bflags |= FFBUFF_MODIFIED;
+  return OK;
+}
+
+/****************************************************************************
+ * Name: fat_runcacheadd
+ *
+ * Desciption: Remember that cluster number 'index' of the file is media
+ *   cluster 'cluster'.  Clusters that continue a known run of contiguous
+ *   clusters just extend that run;  otherwise a new run is started,
+ *   replacing the oldest run if necessary.
+ *
+ ****************************************************************************/
+
+#if CONFIG_FAT_NCLUSTERRUNS > 0
+void fat_runcacheadd(struct fat_file_s *ff, uint32_t index, uint32_t cluster)
+{
+  struct fat_clusterrun_s *run;
+  int i;
+
+  for (i = 0; i < CONFIG_FAT_NCLUSTERRUNS; i++)
+    {
+      run = &ff->ff_runs[i];
+      if (run->cr_length > 0 && index >= run->cr_index &&
+          index - run->cr_index <= run->cr_length)
+        {
+          if (index - run->cr_index < run->cr_length)
+            {
+              /* Already known */
+
+              return;
+            }
+
+          if (cluster == run->cr_cluster + run->cr_length)
+            {
+              /* The next cluster in the run */
+
+              run->cr_length++;
+              return;
+            }
+        }
+    }
+
+  /* Start a new run */
+
+  run             = &ff->ff_runs[ff->ff_runnext];
+  run->cr_index   = index;
+  run->cr_cluster = cluster;
+  run->cr_length  = 1;
+
+  if (++ff->ff_runnext >= CONFIG_FAT_NCLUSTERRUNS)
+    {
+      ff->ff_runnext = 0;
+    }
+}
+#endif
+
+/****************************************************************************
+ * Name: fat_runcachefind
+ *
+ * Desciption: Find the known cluster of the file that is closest to, but
+ *   not after, cluster number *pindex of the file.  On return, *pindex is
+ *   the cluster number of that cluster in the file.  Zero is returned if no
+ *   such cluster is known.
+ *
+ ****************************************************************************/
+
+#if CONFIG_FAT_NCLUSTERRUNS > 0
+uint32_t fat_runcachefind(struct fat_file_s *ff, uint32_t *pindex)
+{
+  struct fat_clusterrun_s *run;
+  uint32_t target  = *pindex;
+  uint32_t cluster = 0;
+  uint32_t best    = 0;
+  uint32_t offset;
+  int i;
+
+  for (i = 0; i < CONFIG_FAT_NCLUSTERRUNS; i++)
+    {
+      run = &ff->ff_runs[i];
+      if (run->cr_length > 0 && run->cr_index <= target)
+        {
+          /* The closest cluster of this run to the target */
+
+          offset = target - run->cr_index;
+          if (offset >= run->cr_length)
+            {
+              offset = run->cr_length - 1;
+            }
+
+          if (!cluster || run->cr_index + offset > best)
+            {
+              best    = run->cr_index + offset;
+              cluster = run->cr_cluster + offset;
+            }
+        }
+    }
+
+  *pindex = best;
+  return cluster;
+}
+#endif
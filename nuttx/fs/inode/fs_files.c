@@ -298,6 +298,22 @@ errout:
   return ERROR;
 }
 
+/****************************************************************************
+ * Name: file_close_detached
+ *
+ * Description:
+ *   Close a struct file instance that is not part of any task's file list,
+ *   such as one that was cloned with file_dup2() and held privately by the
+ *   OS.
+ *
+ ****************************************************************************/
+
+int file_close_detached(FAR struct file *filep)
+{
+  DEBUGASSERT(filep != NULL);
+  return _files_close(filep);
+}
+
 /****************************************************************************
  * Name: files_allocate
  *
@@ -0,0 +1,143 @@
+/****************************************************************************
+ * fs/mmap/fs_madvise.c
+ *
+ *   Copyright (C) 2014 Gregory Nutt. All rights reserved.
+ *   Author: Gregory Nutt <gnutt@nuttx.org>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name NuttX nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <sys/types.h>
+#include <sys/mman.h>
+
+#include <stdint.h>
+#include <errno.h>
+#include <assert.h>
+#include <debug.h>
+
+#include "inode/inode.h"
+#include "fs_rammap.h"
+
+#ifdef CONFIG_FS_RAMMAP
+
+/****************************************************************************
+ * Global Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: posix_madvise
+ *
+ * Description:
+ *   Advise the system about the expected use of part of a memory mapped
+ *   file.  Only POSIX_MADV_WILLNEED has any effect:  A region that was
+ *   mapped with MAP_NONBLOCK may not yet hold all of the file data.
+ *   POSIX_MADV_WILLNEED reads any part of the specified range that has
+ *   not yet been read, so that the range may be accessed safely when
+ *   posix_madvise() returns.
+ *
+ * Parameters:
+ *   addr    The address of the part of the mapping.
+ *   len     The length of the part of the mapping.
+ *   advice  One of the POSIX_MADV_* values defined in sys/mman.h.
+ *
+ * Returned Value:
+ *   Zero on success; otherwise an error number is returned (errno is not
+ *   set):
+ *
+ *     EINVAL
+ *       'advice' is not valid.
+ *     ENOMEM
+ *       'addr' is not within a mapped region.
+ *
+ *   Or any error reported by the file system while reading.
+ *
+ ****************************************************************************/
+
+int posix_madvise(FAR void *addr, size_t len, int advice)
+{
+  FAR struct fs_rammap_s *map;
+  size_t start;
+  int ret;
+
+  if (advice < POSIX_MADV_NORMAL || advice > POSIX_MADV_DONTNEED)
+    {
+      return EINVAL;
+    }
+
+  /* Find the region containing this address */
+
+  rammap_initialize();
+  while (sem_wait(&g_rammaps.exclsem) < 0)
+    {
+      DEBUGASSERT(get_errno() == EINTR);
+    }
+
+  /* Hold a reference so that a concurrent munmap() cannot free the region
+   * while it is being read.
+   */
+
+  map = rammap_find(addr);
+  if (map)
+    {
+      map->crefs++;
+    }
+
+  sem_post(&g_rammaps.exclsem);
+
+  if (!map)
+    {
+      fdbg("Region not found\n");
+      return ENOMEM;
+    }
+
+  /* Read the specified range of the file now if it is needed */
+
+  ret = OK;
+  if (advice == POSIX_MADV_WILLNEED)
+    {
+      start = (uintptr_t)addr - (uintptr_t)map->addr;
+      if (len > map->length - start)
+        {
+          len = map->length - start;
+        }
+
+      ret = rammap_populate(map, start + len);
+    }
+
+  (void)rammap_release(map);
+  return ret < 0 ? -ret : OK;
+}
+
+#endif /* CONFIG_FS_RAMMAP */
@@ -1,7 +1,7 @@
 /****************************************************************************
  * fs/mmap/fs_mmap.c
  *
- *   Copyright (C) 2008-2009, 2011 Gregory Nutt. All rights reserved.
+ *   Copyright (C) 2008-2009, 2011, 2014 Gregory Nutt. All rights reserved.
  *   Author: Gregory Nutt <gnutt@nuttx.org>
  *
  * Redistribution and use in source and binary forms, with or without
@@ -74,7 +74,9 @@
  *
  *   2. If CONFIG_FS_RAMMAP is defined in the configuration, then mmap() will
  *      support simulation of memory mapped files by copying files whole
- *      into RAM.
+ *      into RAM.  Mappings of the same part of the same file share one
+ *      copy, and changes are written back on msync() and munmap() if the
+ *      file was mapped with PROT_WRITE.
  *
  * Parameters:
  *   start   A hint at where to map the memory -- ignored.  The address
@@ -100,7 +102,10 @@
  *           MAP_LOCKED     - Ignored
  *           MAP_NORESERVE  - Ignored
  *           MAP_POPULATE   - Ignored
- *           MAP_NONBLOCK   - Ignored
+ *           MAP_NONBLOCK   - Ignored except with CONFIG_FS_RAMMAP.  Then
+ *                            only the first part of the file is read
+ *                            before returning; the rest is read by the
+ *                            work queue (see posix_madvise()).
  *   fd      file descriptor of the backing file -- required.
  *   offset  The offset into the file to map
  *
@@ -161,7 +166,7 @@ FAR void *mmap(FAR void *start, size_t length, int prot, int flags,
   if (ret < 0)
     {
 #ifdef CONFIG_FS_RAMMAP
-      return rammap(fd, length, offset);
+      return rammap(fd, length, offset, prot, flags);
 #else
       fdbg("ioctl(FIOC_MMAP) failed: %d\n", get_errno());
       return MAP_FAILED;
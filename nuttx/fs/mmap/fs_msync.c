@@ -0,0 +1,155 @@
+/****************************************************************************
+ * fs/mmap/fs_msync.c
+ *
+ *   Copyright (C) 2014 Gregory Nutt. All rights reserved.
+ *   Author: Gregory Nutt <gnutt@nuttx.org>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name NuttX nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <sys/types.h>
+#include <sys/mman.h>
+
+#include <stdint.h>
+#include <errno.h>
+#include <debug.h>
+
+#include "inode/inode.h"
+#include "fs_rammap.h"
+
+#ifdef CONFIG_FS_RAMMAP
+
+/****************************************************************************
+ * Global Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: msync
+ *
+ * Description:
+ *   Write the changes made to a memory mapped file back to the file.  This
+ *   applies only to files that were mapped into RAM with PROT_WRITE from a
+ *   file descriptor that was opened for writing; msync() succeeds without
+ *   doing anything for other mappings.
+ *
+ *   Without an MMU there is no way to know which parts of the region were
+ *   modified, so the entire range is written.  The data is always written
+ *   synchronously: MS_ASYNC behaves like MS_SYNC.  There is only one copy
+ *   of each region, so MS_INVALIDATE has no effect.
+ *
+ * Parameters:
+ *   addr    The address of the part of the mapping to write back.
+ *   len     The number of bytes to write back.
+ *   flags   MS_ASYNC or MS_SYNC, optionally OR'ed with MS_INVALIDATE.
+ *
+ * Returned Value:
+ *   On success, msync() returns 0, on failure -1, and errno is set
+ *   appropriately:
+ *
+ *     EINVAL
+ *       'flags' contains both MS_ASYNC and MS_SYNC.
+ *     ENOMEM
+ *       'addr' is not within a mapped region.
+ *
+ *   Or any error reported by the file system while writing.
+ *
+ ****************************************************************************/
+
+int msync(FAR void *addr, size_t len, int flags)
+{
+  FAR struct fs_rammap_s *map;
+  size_t start;
+  int release;
+  int ret;
+
+  if ((flags & (MS_ASYNC | MS_SYNC)) == (MS_ASYNC | MS_SYNC))
+    {
+      set_errno(EINVAL);
+      return ERROR;
+    }
+
+  /* Find the region containing this address */
+
+  rammap_initialize();
+  ret = sem_wait(&g_rammaps.exclsem);
+  if (ret < 0)
+    {
+      return ERROR;
+    }
+
+  /* Hold a reference so that a concurrent munmap() cannot free the region
+   * while it is being written.
+   */
+
+  map = rammap_find(addr);
+  if (map)
+    {
+      map->crefs++;
+    }
+
+  sem_post(&g_rammaps.exclsem);
+
+  if (!map)
+    {
+      fdbg("Region not found\n");
+      set_errno(ENOMEM);
+      return ERROR;
+    }
+
+  /* Write the requested part of the region back to the file */
+
+  start = (uintptr_t)addr - (uintptr_t)map->addr;
+  if (len > map->length - start)
+    {
+      len = map->length - start;
+    }
+
+  ret = rammap_writeback(map, start, len);
+  release = rammap_release(map);
+  if (ret >= 0)
+    {
+      ret = release;
+    }
+
+  if (ret < 0)
+    {
+      set_errno(-ret);
+      return ERROR;
+    }
+
+  return OK;
+}
+
+#endif /* CONFIG_FS_RAMMAP */
@@ -1,7 +1,7 @@
 /****************************************************************************
  * fs/mmap/fs_munmap.c
  *
- *   Copyright (C) 2011 Gregory Nutt. All rights reserved.
+ *   Copyright (C) 2011, 2014 Gregory Nutt. All rights reserved.
  *   Author: Gregory Nutt <gnutt@nuttx.org>
  *
  * Redistribution and use in source and binary forms, with or without
@@ -42,13 +42,9 @@
 #include <sys/types.h>
 #include <sys/mman.h>
 
-#include <stdint.h>
 #include <errno.h>
-#include <assert.h>
 #include <debug.h>
 
-#include <nuttx/kmalloc.h>
-
 #include "inode/inode.h"
 #include "fs_rammap.h"
 
@@ -95,12 +91,19 @@
  *      into RAM.  munmap() is required in this case to free the allocated
  *      memory holding the shared copy of the file.
  *
+ *      The same region may have been returned by several calls to mmap().
+ *      Each call to munmap() releases one of those mappings; the region is
+ *      written back to the file (if it was mapped with PROT_WRITE) and
+ *      freed only when the last mapping is removed.  Partial unmapping is
+ *      not supported: the mapping that contains 'start' is removed as a
+ *      whole.
+ *
  * Parameters:
  *   start   The start address of the mapping to delete.  For this
- *           simplified munmap() implementation, the *must* be the start
- *           address of the memory region (the same address returned by
- *           mmap()).
- *   length  The length region to be umapped.
+ *           simplified munmap() implementation, this should be the same
+ *           address that was returned by mmap().
+ *   length  The length region to be umapped.  Ignored; the whole mapping
+ *           is removed.
  *
  * Returned Value:
  *   On success, munmap() returns 0, on failure -1, and errno is set
@@ -110,14 +113,10 @@
 
 int munmap(FAR void *start, size_t length)
 {
-  FAR struct fs_rammap_s *prev;
-  FAR struct fs_rammap_s *curr;
-  FAR void *newaddr;
-  unsigned int offset;
+  FAR struct fs_rammap_s *map;
   int ret;
-  int err;
 
-  /* Find a region containing this start and length in the list of regions */
+  /* Find the region containing this start address in the list of regions */
 
   rammap_initialize();
   ret = sem_wait(&g_rammaps.exclsem);
@@ -126,87 +125,30 @@ int munmap(FAR void *start, size_t length)
       return ERROR;
     }
 
-  /* Seach the list of regions */
-
-  for (prev = NULL, curr = g_rammaps.head; curr; prev = curr, curr = curr->flink)
-    {
-      /* Does this region include any part of the specified range? */
-
-      if ((uintptr_t)start < (uintptr_t)curr->addr + curr->length &&
-          (uintptr_t)start + length >= (uintptr_t)curr->addr)
-        {
-          break;
-        }
-    }
+  map = rammap_find(start);
+  sem_post(&g_rammaps.exclsem);
 
   /* Did we find the region */
 
-  if (!curr)
+  if (!map)
     {
       fdbg("Region not found\n");
-      err = EINVAL;
-      goto errout_with_semaphore;
-    }
-
-  /* Get the offset from the beginning of the region and the actual number
-   * of bytes to "unmap".  All mappings must extend to the end of the region.
-   * There is no support for free a block of memory but leaving a block of
-   * memory at the end.  This is a consequence of using kumm_realloc() to
-   * simulate the unmapping.
-   */
-
-  offset = start - curr->addr;
-  if (offset + length < curr->length)
-    {
-      fdbg("Cannot umap without unmapping to the end\n");
-      err = ENOSYS;
-      goto errout_with_semaphore;
-    }
-
-  /* Okay.. the region is beging umapped to the end.  Make sure the length
-   * indicates that.
-   */
-
-  length = curr->length - offset;
-
-  /* Are we unmapping the entire region (offset == 0)? */
-
-  if (length >= curr->length)
-    {
-      /* Yes.. remove the mapping from the list */
-
-      if (prev)
-        {
-          prev->flink = curr->flink;
-        }
-      else
-        {
-          g_rammaps.head = curr->flink;
-        }
-
-      /* Then free the region */
-
-      kumm_free(curr);
+      set_errno(EINVAL);
+      return ERROR;
     }
 
-  /* No.. We have been asked to "unmap' only a portion of the memory
-   * (offset > 0).
+  /* Release this mapping of the region.  The region is written back and
+   * freed if this was the last mapping.
    */
 
-  else
+  ret = rammap_release(map);
+  if (ret < 0)
     {
-      newaddr = kumm_realloc(curr->addr, sizeof(struct fs_rammap_s) + length);
-      DEBUGASSERT(newaddr == (FAR void*)(curr->addr));
-      curr->length = length;
+      set_errno(-ret);
+      return ERROR;
     }
 
-  sem_post(&g_rammaps.exclsem);
   return OK;
-
-errout_with_semaphore:
-  sem_post(&g_rammaps.exclsem);
-  set_errno(err);
-  return ERROR;
 }
 
 #endif /* CONFIG_FS_RAMMAP */
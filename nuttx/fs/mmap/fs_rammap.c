@@ -1,7 +1,7 @@
 /****************************************************************************
  * fs/mmap/fs_rammmap.c
  *
- *   Copyright (C) 2011 Gregory Nutt. All rights reserved.
+ *   Copyright (C) 2011, 2014 Gregory Nutt. All rights reserved.
  *   Author: Gregory Nutt <gnutt@nuttx.org>
  *
  * Redistribution and use in source and binary forms, with or without
@@ -42,12 +42,18 @@
 #include <sys/types.h>
 #include <sys/mman.h>
 
+#include <stdint.h>
+#include <stdbool.h>
 #include <string.h>
-#include <unistd.h>
+#include <fcntl.h>
 #include <errno.h>
+#include <assert.h>
 #include <debug.h>
 
+#include <nuttx/compiler.h>
 #include <nuttx/kmalloc.h>
+#include <nuttx/fs/fs.h>
+#include <nuttx/fs/ioctl.h>
 
 #include "inode/inode.h"
 #include "fs_rammap.h"
@@ -62,6 +68,108 @@
 
 struct fs_allmaps_s g_rammaps;
 
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: rammap_semtake
+ ****************************************************************************/
+
+static void rammap_semtake(FAR sem_t *sem)
+{
+  /* Take the semaphore (perhaps waiting) */
+
+  while (sem_wait(sem) < 0)
+    {
+      /* The only case that an error should occur here is if the wait was
+       * awakened by a signal.
+       */
+
+      DEBUGASSERT(get_errno() == EINTR);
+    }
+}
+
+/****************************************************************************
+ * Name: rammap_fileid
+ *
+ * Description:
+ *   Determine how the file open on 'filep' can be recognized when it is
+ *   mapped again through a different file descriptor.  A driver is
+ *   identified by its inode alone.  Many files share the inode of the
+ *   mountpoint, however, so a file on a mounted volume must also report a
+ *   file ID with FIOC_FILEID.
+ *
+ * Returned Value:
+ *   True if the file can be identified and its mappings can be shared.
+ *
+ ****************************************************************************/
+
+static bool rammap_fileid(FAR struct file *filep, FAR uint32_t *fileid)
+{
+  FAR struct inode *inode = filep->f_inode;
+
+  *fileid = 0;
+
+#ifndef CONFIG_DISABLE_MOUNTPOINT
+  if (INODE_IS_MOUNTPT(inode))
+    {
+      if (inode->u.i_mops && inode->u.i_mops->ioctl)
+        {
+          return inode->u.i_mops->ioctl(filep, FIOC_FILEID,
+                                        (unsigned long)((uintptr_t)fileid))
+                   >= 0;
+        }
+
+      return false;
+    }
+#endif
+
+  return true;
+}
+
+/****************************************************************************
+ * Name: rammap_worker
+ *
+ * Description:
+ *   Populate one more chunk of a region from the work queue, then re-queue
+ *   so that other work is not held off while a large file is read.  The
+ *   worker holds its own reference to the region, so the region cannot be
+ *   freed underneath it.
+ *
+ ****************************************************************************/
+
+#ifdef RAMMAP_BACKGROUND
+static void rammap_worker(FAR void *arg)
+{
+  FAR struct fs_rammap_s *map = (FAR struct fs_rammap_s *)arg;
+  int ret;
+
+  /* There is nothing more to do if every mapping has already been removed
+   * and only the worker's reference remains.
+   */
+
+  if (map->crefs > 1)
+    {
+      ret = rammap_populate(map, map->populated + CONFIG_FS_RAMMAP_CHUNKSIZE);
+      if (ret >= 0 && map->populated < map->length)
+        {
+          ret = work_queue(LPWORK, &map->work, rammap_worker, map, 0);
+          if (ret >= 0)
+            {
+              return;
+            }
+        }
+    }
+
+  /* Population is complete (or failed; any part that is still missing will
+   * be read on demand).  Release the worker's reference.
+   */
+
+  (void)rammap_release(map);
+}
+#endif
+
 /****************************************************************************
  * Global Functions
  ****************************************************************************/
@@ -89,6 +197,258 @@ void rammap_initialize(void)
     }
 }
 
+/****************************************************************************
+ * Name: rammap_find
+ *
+ * Description:
+ *   Find the region that contains the specified address.  The caller must
+ *   hold g_rammaps.exclsem.
+ *
+ * Returned Value:
+ *   The region containing 'addr' or NULL if there is no such region.
+ *
+ ****************************************************************************/
+
+FAR struct fs_rammap_s *rammap_find(FAR const void *addr)
+{
+  FAR struct fs_rammap_s *map;
+
+  for (map = g_rammaps.head; map; map = map->flink)
+    {
+      if ((uintptr_t)addr >= (uintptr_t)map->addr &&
+          (uintptr_t)addr <  (uintptr_t)map->addr + map->length)
+        {
+          break;
+        }
+    }
+
+  return map;
+}
+
+/****************************************************************************
+ * Name: rammap_populate
+ *
+ * Description:
+ *   Make sure that the first 'upto' bytes of the region have been read from
+ *   the file, reading any that have not in CONFIG_FS_RAMMAP_CHUNKSIZE
+ *   pieces.
+ *
+ * Returned Value:
+ *   OK on success; a negated errno value on failure.
+ *
+ ****************************************************************************/
+
+int rammap_populate(FAR struct fs_rammap_s *map, size_t upto)
+{
+  FAR uint8_t *buffer;
+  ssize_t nread;
+  size_t nbytes;
+  int ret = OK;
+
+  if (upto > map->length)
+    {
+      upto = map->length;
+    }
+
+  /* The region only ever grows, so it is safe to skip the semaphore if
+   * the requested part has already been read.
+   */
+
+  if (map->populated >= upto)
+    {
+      return OK;
+    }
+
+  rammap_semtake(&map->exclsem);
+  while (map->populated < upto)
+    {
+      nbytes = map->length - map->populated;
+      if (nbytes > CONFIG_FS_RAMMAP_CHUNKSIZE)
+        {
+          nbytes = CONFIG_FS_RAMMAP_CHUNKSIZE;
+        }
+
+      buffer = (FAR uint8_t *)map->addr + map->populated;
+      nread  = file_pread(&map->file, buffer, nbytes,
+                          map->offset + map->populated);
+      if (nread < 0)
+        {
+          /* Handle the special case where the read was interrupted by a
+           * signal.  All other read errors are bad.
+           */
+
+          ret = -get_errno();
+          if (ret == -EINTR)
+            {
+              ret = OK;
+              continue;
+            }
+
+          fdbg("Read failed: offset=%d errno=%d\n",
+               (int)(map->offset + map->populated), -ret);
+          break;
+        }
+
+      /* Check for end of file.  Zero any memory beyond the amount read
+       * from the file.
+       */
+
+      if (nread == 0)
+        {
+          memset(buffer, 0, map->length - map->populated);
+          map->populated = map->length;
+          break;
+        }
+
+      map->populated += nread;
+      map->datalen    = map->populated;
+    }
+
+  sem_post(&map->exclsem);
+  return ret;
+}
+
+/****************************************************************************
+ * Name: rammap_writeback
+ *
+ * Description:
+ *   Write 'len' bytes of the region starting at 'start' (an offset from the
+ *   beginning of the region) back to the file.  Nothing is written if the
+ *   region is not writable.  Bytes beyond the end of the file data are
+ *   never written so that the file size does not change.
+ *
+ * Returned Value:
+ *   OK on success; a negated errno value on failure.
+ *
+ ****************************************************************************/
+
+int rammap_writeback(FAR struct fs_rammap_s *map, size_t start, size_t len)
+{
+#ifndef CONFIG_DISABLE_MOUNTPOINT
+  FAR struct inode *inode;
+#endif
+  ssize_t nwritten;
+  int ret = OK;
+
+  if (!map->writable)
+    {
+      return OK;
+    }
+
+  rammap_semtake(&map->exclsem);
+
+  /* Only data that was read from the file can be written back */
+
+  if (start >= map->datalen)
+    {
+      len = 0;
+    }
+  else if (len > map->datalen - start)
+    {
+      len = map->datalen - start;
+    }
+
+  while (len > 0)
+    {
+      nwritten = file_pwrite(&map->file, (FAR uint8_t *)map->addr + start,
+                             len, map->offset + start);
+      if (nwritten < 0)
+        {
+          ret = -get_errno();
+          if (ret == -EINTR)
+            {
+              ret = OK;
+              continue;
+            }
+
+          fdbg("Write failed: offset=%d errno=%d\n",
+               (int)(map->offset + start), -ret);
+          goto errout_with_semaphore;
+        }
+
+      start += nwritten;
+      len   -= nwritten;
+    }
+
+  /* Then flush the file system's buffered copy of the data to the media */
+
+#ifndef CONFIG_DISABLE_MOUNTPOINT
+  inode = map->file.f_inode;
+  if (INODE_IS_MOUNTPT(inode) && inode->u.i_mops && inode->u.i_mops->sync)
+    {
+      ret = inode->u.i_mops->sync(&map->file);
+      if (ret > 0)
+        {
+          ret = OK;
+        }
+    }
+#endif
+
+errout_with_semaphore:
+  sem_post(&map->exclsem);
+  return ret;
+}
+
+/****************************************************************************
+ * Name: rammap_release
+ *
+ * Description:
+ *   Release one reference to the region.  When the last reference is
+ *   released, the region is removed from the list, written back to the
+ *   file, and freed.
+ *
+ * Returned Value:
+ *   OK on success; a negated errno value if the final write-back failed.
+ *   The region is freed in any event.
+ *
+ ****************************************************************************/
+
+int rammap_release(FAR struct fs_rammap_s *map)
+{
+  FAR struct fs_rammap_s *prev;
+  FAR struct fs_rammap_s *curr;
+  int ret;
+
+  rammap_semtake(&g_rammaps.exclsem);
+  DEBUGASSERT(map->crefs > 0);
+
+  if (--map->crefs > 0)
+    {
+      sem_post(&g_rammaps.exclsem);
+      return OK;
+    }
+
+  /* That was the last reference.  Remove the region from the list so that
+   * it can no longer be found.
+   */
+
+  for (prev = NULL, curr = g_rammaps.head;
+       curr && curr != map;
+       prev = curr, curr = curr->flink);
+
+  DEBUGASSERT(curr == map);
+  if (prev)
+    {
+      prev->flink = map->flink;
+    }
+  else
+    {
+      g_rammaps.head = map->flink;
+    }
+
+  sem_post(&g_rammaps.exclsem);
+
+  /* Write any changes back to the file, close the private file, and free
+   * the region.
+   */
+
+  ret = rammap_writeback(map, 0, map->length);
+  (void)file_close_detached(&map->file);
+  sem_destroy(&map->exclsem);
+  kumm_free(map);
+  return ret;
+}
+
 /****************************************************************************
  * Name: rammmap
  *
@@ -97,9 +457,14 @@ void rammap_initialize(void)
  *
  * Parameters:
  *   fd      file descriptor of the backing file -- required.
- *   length  The length of the mapping.  For exception #1 above, this length
- *           ignored:  The entire underlying media is always accessible.
+ *   length  The length of the mapping.
  *   offset  The offset into the file to map
+ *   prot    See the PROT_* definitions in sys/mman.h.  Changes are written
+ *           back to the file only if PROT_WRITE is included.
+ *   flags   See the MAP_* definitions in sys/mman.h.  Only MAP_SHARED
+ *           mappings are shared and written back; a MAP_PRIVATE mapping is
+ *           a private copy.  With MAP_NONBLOCK, only the first chunk is
+ *           read before returning; the remainder is read by the work queue.
  *
  * Returned Value:
  *   On success, rammmap() returns a pointer to the mapped area. On error, the
@@ -114,131 +479,191 @@ void rammap_initialize(void)
  *
  ****************************************************************************/
 
-FAR void *rammap(int fd, size_t length, off_t offset)
+FAR void *rammap(int fd, size_t length, off_t offset, int prot, int flags)
 {
   FAR struct fs_rammap_s *map;
+  FAR struct file *filep;
   FAR uint8_t *alloc;
-  FAR uint8_t *rdbuffer;
-  ssize_t nread;
-  off_t fpos;
-  int err;
+  struct file clone;
+  uint32_t fileid;
+  size_t start;
+  bool shareable;
+  bool writable;
+  bool created;
   int ret;
 
-  /* There is a major design flaw that I have not yet thought of fix for:
-   * The goal is to have a single region of memory that represents a single
-   * file and can be shared by many threads.  That is, given a filename a
-   * thread should be able to open the file, get a file descriptor, and
-   * call mmap() to get a memory region.  Different file descriptors opened
-   * with the same file path should get the same memory region when mapped.
-   *
-   * The design flaw is that I don't have sufficient knowledge to know that
-   * these different file descriptors map to the same file.  So, for the time
-   * being, a new memory region is created each time that rammap() is called.
-   * Not very useful!
-   */
+  /* Get the file structure corresponding to the file descriptor */
+
+  filep = fs_getfilep(fd);
+  if (!filep)
+    {
+      /* The errno value has already been set */
 
-  /* Allocate a region of memory of the specified size */
+      return MAP_FAILED;
+    }
+
+  /* Only MAP_SHARED mappings are shared with other mappings of the file
+   * and written back to it.  A MAP_PRIVATE mapping gets a region of its
+   * own whose changes are never written back.
+   */
 
-  alloc = (FAR uint8_t *)kumm_malloc(sizeof(struct fs_rammap_s) + length);
-  if (!alloc)
+  if ((flags & MAP_SHARED) != 0)
     {
-      fdbg("Region allocation failed, length: %d\n", (int)length);
-      err = ENOMEM;
-      goto errout;
+      shareable = rammap_fileid(filep, &fileid);
+      writable  = (prot & PROT_WRITE) != 0 && (filep->f_oflags & O_WROK) != 0;
+    }
+  else
+    {
+      fileid    = 0;
+      shareable = false;
+      writable  = false;
     }
 
-  /* Initialize the region */
+  /* Is this part of the file already mapped?  If so, just take another
+   * reference to the existing region.
+   */
 
-  map         = (FAR struct fs_rammap_s *)alloc;
-  memset(map, 0, sizeof(struct fs_rammap_s));
-  map->addr   = alloc + sizeof(struct fs_rammap_s);
-  map->length = length;
-  map->offset = offset;
+  rammap_initialize();
+  rammap_semtake(&g_rammaps.exclsem);
 
-  /* Seek to the specified file offset */
+  for (map = g_rammaps.head; map; map = map->flink)
+    {
+      if (shareable && map->shareable &&
+          map->file.f_inode == filep->f_inode &&
+          map->fileid == fileid &&
+          offset >= map->offset &&
+          offset + length <= map->offset + map->length)
+        {
+          break;
+        }
+    }
 
-  fpos = lseek(fd, offset,  SEEK_SET);
-  if (fpos == (off_t)-1)
+  if (map)
     {
-      /* Seek failed... errno has already been set, but EINVAL is probably
-       * the correct response.
-       */
+      map->crefs++;
+      sem_post(&g_rammaps.exclsem);
 
-      fdbg("Seek to position %d failed\n", (int)offset);
-      err = EINVAL;
-      goto errout_with_region;
-    }
+      start   = offset - map->offset;
+      created = false;
 
-  /* Read the file data into the memory region */
+      /* If the region was first mapped read-only, changes made through this
+       * mapping can only be written back through this file descriptor.
+       */
 
-  rdbuffer = map->addr;
-  while (length > 0)
+      if (writable && !map->writable)
+        {
+          memset(&clone, 0, sizeof(struct file));
+          ret = file_dup2(filep, &clone);
+          if (ret < 0)
+            {
+              ret = -get_errno();
+              goto errout_with_region;
+            }
+
+          rammap_semtake(&map->exclsem);
+          (void)file_close_detached(&map->file);
+          memcpy(&map->file, &clone, sizeof(struct file));
+          map->writable = true;
+          sem_post(&map->exclsem);
+        }
+    }
+  else
     {
-      nread = read(fd, rdbuffer, length);
-      if (nread < 0)
+      /* Allocate a region of memory of the specified size */
+
+      alloc = (FAR uint8_t *)kumm_malloc(sizeof(struct fs_rammap_s) + length);
+      if (!alloc)
         {
-           /* Handle the special case where the read was interrupted by a
-            * signal.
-            */
-
-           err = get_errno();
-           if (err != EINTR)
-             {
-               /* All other read errors are bad.  errno is already set.
-                * (but maybe should be forced to EINVAL?).  NOTE that if
-                * FS DEBUG is enabled, then the following fdbg() macro will
-                * destroy the errno value.
-                */
-
-               fdbg("Read failed: offset=%d errno=%d\n", (int)offset, err);
-#ifdef CONFIG_DEBUG_FS
-               goto errout_with_region;
-#else
-               goto errout_with_errno;
-#endif
-             }
+          fdbg("Region allocation failed, length: %d\n", (int)length);
+          sem_post(&g_rammaps.exclsem);
+          set_errno(ENOMEM);
+          return MAP_FAILED;
         }
 
-      /* Check for end of file. */
+      /* Initialize the region */
+
+      map            = (FAR struct fs_rammap_s *)alloc;
+      memset(map, 0, sizeof(struct fs_rammap_s));
+      map->addr      = alloc + sizeof(struct fs_rammap_s);
+      map->length    = length;
+      map->offset    = offset;
+      map->fileid    = fileid;
+      map->crefs     = 1;
+      map->shareable = shareable;
+      map->writable  = writable;
+      sem_init(&map->exclsem, 0, 1);
+
+      /* The region keeps its own clone of the file so that it can still be
+       * populated and written back after 'fd' has been closed.
+       */
 
-      if (nread == 0)
+      ret = file_dup2(filep, &map->file);
+      if (ret < 0)
         {
-          break;
+          fdbg("Failed to clone the file: %d\n", get_errno());
+          sem_post(&g_rammaps.exclsem);
+          sem_destroy(&map->exclsem);
+          kumm_free(alloc);
+          return MAP_FAILED;
         }
 
-      /* Increment number of bytes read */
+      /* Add the region to the list of regions */
+
+      map->flink     = g_rammaps.head;
+      g_rammaps.head = map;
+      sem_post(&g_rammaps.exclsem);
 
-      rdbuffer += nread;
-      length   -= nread;
+      start   = 0;
+      created = true;
     }
 
-  /* Zero any memory beyond the amount read from the file */
+  /* Read the mapped part of the file into the region (if it has not been
+   * read already).
+   */
 
-  memset(rdbuffer, 0, length);
+#ifndef RAMMAP_BACKGROUND
+  UNUSED(flags);
+  UNUSED(created);
+#else
+  if ((flags & MAP_NONBLOCK) != 0)
+    {
+      /* Read only the first chunk now */
 
-  /* Add the buffer to the list of regions */
+      ret = rammap_populate(map, start + CONFIG_FS_RAMMAP_CHUNKSIZE);
+      if (ret >= 0 && created && map->populated < map->length)
+        {
+          /* Let the work queue read the rest.  The worker holds its own
+           * reference to the region until it is done.
+           */
+
+          rammap_semtake(&g_rammaps.exclsem);
+          map->crefs++;
+          sem_post(&g_rammaps.exclsem);
+
+          ret = work_queue(LPWORK, &map->work, rammap_worker, map, 0);
+          if (ret < 0)
+            {
+              (void)rammap_release(map);
+              ret = rammap_populate(map, map->length);
+            }
+        }
+    }
+  else
+#endif
+    {
+      ret = rammap_populate(map, start + length);
+    }
 
-  rammap_initialize();
-  ret = sem_wait(&g_rammaps.exclsem);
   if (ret < 0)
     {
-      goto errout_with_errno;
+      goto errout_with_region;
     }
 
-  map->flink  = g_rammaps.head;
-  g_rammaps.head = map;
-
-  sem_post(&g_rammaps.exclsem);
-  return map->addr;
+  return (FAR uint8_t *)map->addr + start;
 
 errout_with_region:
-  kumm_free(alloc);
-errout:
-  set_errno(err);
-  return MAP_FAILED;
-
-errout_with_errno:
-  kumm_free(alloc);
+  (void)rammap_release(map);
+  set_errno(-ret);
   return MAP_FAILED;
 }
 
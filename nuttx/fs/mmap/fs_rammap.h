@@ -1,7 +1,7 @@
 /****************************************************************************
  * fs/mmap/rammap.h
  *
- *   Copyright (C) 2011 Gregory Nutt. All rights reserved.
+ *   Copyright (C) 2011, 2014 Gregory Nutt. All rights reserved.
  *   Author: Gregory Nutt <gnutt@nuttx.org>
  *
  * References: Linux/Documentation/filesystems/romfs.txt
@@ -45,14 +45,32 @@
 #include <nuttx/config.h>
 
 #include <sys/types.h>
+#include <stdint.h>
+#include <stdbool.h>
 #include <semaphore.h>
 
+#include <nuttx/fs/fs.h>
+#include <nuttx/wqueue.h>
+
 #ifdef CONFIG_FS_RAMMAP
 
 /****************************************************************************
  * Pre-processor Definitions
  ****************************************************************************/
 
+/* Configuration ************************************************************/
+
+#ifndef CONFIG_FS_RAMMAP_CHUNKSIZE
+#  define CONFIG_FS_RAMMAP_CHUNKSIZE 1024
+#endif
+
+/* Background population requires the work queue */
+
+#undef RAMMAP_BACKGROUND
+#ifdef CONFIG_SCHED_WORKQUEUE
+#  define RAMMAP_BACKGROUND 1
+#endif
+
 /****************************************************************************
  * Public Types
  ****************************************************************************/
@@ -69,9 +87,18 @@
  * - All of the file must be present in memory.  This limits the size of
  *   files that may be memory mapped (especially on MCUs with no significant
  *   RAM resources).
- * - All mapped files are read-only.  You can write to the in-memory image,
- *   but the file contents will not change.
+ * - Changes to the in-memory image reach the file only when the mapping
+ *   is synchronized with msync() or when the last mapping is removed, and
+ *   only for MAP_SHARED mappings created with PROT_WRITE on a writable
+ *   file descriptor.  Each MAP_PRIVATE mapping has a region of its own.
  * - There are not access privileges.
+ *
+ * Regions are keyed by the inode of the mapped file and, for files on a
+ * mounted volume, by the FIOC_FILEID of the file so that mapping the same
+ * part of the same file again returns the same memory.  The region holds a
+ * private clone of the file descriptor that was used to create it; data is
+ * read into the region through that clone in CONFIG_FS_RAMMAP_CHUNKSIZE
+ * pieces, either before mmap() returns or from the work queue.
  */
 
 struct fs_rammap_s
@@ -80,6 +107,17 @@ struct fs_rammap_s
   FAR void           *addr;        /* Start of allocated memory */
   size_t              length;      /* Length of region */
   off_t               offset;      /* File offset */
+  uint32_t            fileid;      /* File identity on a mounted volume */
+  uint16_t            crefs;       /* Number of references to the region */
+  bool                shareable;   /* True: Inode and fileid identify the file */
+  bool                writable;    /* True: Write changes back to the file */
+  sem_t               exclsem;     /* Serializes population and write-back */
+  size_t              populated;   /* Number of bytes populated so far */
+  size_t              datalen;     /* Number of bytes read from the file */
+  struct file         file;        /* Private clone of the mapped file */
+#ifdef RAMMAP_BACKGROUND
+  struct work_s       work;        /* Supports background population */
+#endif
 };
 
 /* This structure defines all "mapped" files */
@@ -127,9 +165,14 @@ void rammap_initialize(void);
  *
  * Parameters:
  *   fd      file descriptor of the backing file -- required.
- *   length  The length of the mapping.  For exception #1 above, this length
- *           ignored:  The entire underlying media is always accessible.
+ *   length  The length of the mapping.
  *   offset  The offset into the file to map
+ *   prot    See the PROT_* definitions in sys/mman.h.  Changes are written
+ *           back to the file only if PROT_WRITE is included.
+ *   flags   See the MAP_* definitions in sys/mman.h.  Only MAP_SHARED
+ *           mappings are shared and written back; a MAP_PRIVATE mapping is
+ *           a private copy.  With MAP_NONBLOCK, only the first chunk is
+ *           read before returning; the remainder is read by the work queue.
  *
  * Returned Value:
  *   On success, rammmap() returns a pointer to the mapped area. On error, the
@@ -144,7 +187,68 @@ void rammap_initialize(void);
  *
  ****************************************************************************/
 
-FAR void *rammap(int fd, size_t length, off_t offset);
+FAR void *rammap(int fd, size_t length, off_t offset, int prot, int flags);
+
+/****************************************************************************
+ * Name: rammap_find
+ *
+ * Description:
+ *   Find the region that contains the specified address.  The caller must
+ *   hold g_rammaps.exclsem.
+ *
+ * Returned Value:
+ *   The region containing 'addr' or NULL if there is no such region.
+ *
+ ****************************************************************************/
+
+FAR struct fs_rammap_s *rammap_find(FAR const void *addr);
+
+/****************************************************************************
+ * Name: rammap_populate
+ *
+ * Description:
+ *   Make sure that the first 'upto' bytes of the region have been read from
+ *   the file, reading any that have not in CONFIG_FS_RAMMAP_CHUNKSIZE
+ *   pieces.
+ *
+ * Returned Value:
+ *   OK on success; a negated errno value on failure.
+ *
+ ****************************************************************************/
+
+int rammap_populate(FAR struct fs_rammap_s *map, size_t upto);
+
+/****************************************************************************
+ * Name: rammap_writeback
+ *
+ * Description:
+ *   Write 'len' bytes of the region starting at 'start' (an offset from the
+ *   beginning of the region) back to the file.  Nothing is written if the
+ *   region is not writable.  Bytes beyond the end of the file data are
+ *   never written so that the file size does not change.
+ *
+ * Returned Value:
+ *   OK on success; a negated errno value on failure.
+ *
+ ****************************************************************************/
+
+int rammap_writeback(FAR struct fs_rammap_s *map, size_t start, size_t len);
+
+/****************************************************************************
+ * Name: rammap_release
+ *
+ * Description:
+ *   Release one reference to the region.  When the last reference is
+ *   released, the region is removed from the list, written back to the
+ *   file, and freed.
+ *
+ * Returned Value:
+ *   OK on success; a negated errno value if the final write-back failed.
+ *   The region is freed in any event.
+ *
+ ****************************************************************************/
+
+int rammap_release(FAR struct fs_rammap_s *map);
 
 #endif /* CONFIG_FS_RAMMAP */
 #endif /* __FS_MMAP_RAMMAP_H */
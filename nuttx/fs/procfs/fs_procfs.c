@@ -87,6 +87,14 @@ extern const struct procfs_operations mtd_procfsoperations;
 extern const struct procfs_operations part_procfsoperations;
 extern const struct procfs_operations smartfs_procfsoperations;
 
+/* Likewise, this one is implemented in mm/mempool */
+
+extern const struct procfs_operations mempool_procfsoperations;
+
+/* And this one in sched/wqueue */
+
+extern const struct procfs_operations work_procfsoperations;
+
 /* And even worse, this one is specific to the STM32.  The solution to
  * this nasty couple would be to replace this hard-coded, ROM-able
  * operations table with a RAM-base registration table.
@@ -117,6 +125,10 @@ static const struct procfs_entry_s g_procfsentries[] =
   { "fs/smartfs**",     &smartfs_procfsoperations },
 #endif
 
+#if defined(CONFIG_MM_MEMPOOL) && !defined(CONFIG_FS_PROCFS_EXCLUDE_MEMPOOL)
+  { "mempool",          &mempool_procfsoperations },
+#endif
+
 #if defined(CONFIG_MTD) && !defined(CONFIG_FS_PROCFS_EXCLUDE_MTD)
   { "mtd",              &mtd_procfsoperations },
 #endif
@@ -129,6 +141,10 @@ static const struct procfs_entry_s g_procfsentries[] =
   { "uptime",           &uptime_operations },
 #endif
 
+#if defined(CONFIG_SCHED_WORKSTATS) && !defined(CONFIG_FS_PROCFS_EXCLUDE_WORK)
+  { "work",             &work_procfsoperations },
+#endif
+
 #if defined(CONFIG_STM32_CCM_PROCFS) && !defined(CONFIG_FS_PROCFS_EXCLUDE_CCM)
   { "ccm",             &ccm_procfsoperations },
 #endif
@@ -60,7 +60,7 @@
 #include <nuttx/fs/procfs.h>
 #include <nuttx/fs/dirent.h>
 
-#ifdef CONFIG_SCHED_CPULOAD
+#if defined(CONFIG_SCHED_CPULOAD) || defined(CONFIG_SCHED_CPUTIME)
 #  include <nuttx/clock.h>
 #endif
 
@@ -92,6 +92,9 @@ enum proc_node_e
   PROC_CMDLINE,                       /* Task command line */
 #ifdef CONFIG_SCHED_CPULOAD
   PROC_LOADAVG,                       /* Average CPU utilization */
+#endif
+#ifdef CONFIG_SCHED_CPUTIME
+  PROC_CPUTIME,                       /* CPU accounting */
 #endif
   PROC_STACK,                         /* Task stack info */
   PROC_GROUP,                         /* Group directory */
@@ -148,6 +151,11 @@ static ssize_t proc_loadavg(FAR struct proc_file_s *procfile,
                  FAR struct tcb_s *tcb, FAR char *buffer, size_t buflen,
                  off_t offset);
 #endif
+#ifdef CONFIG_SCHED_CPUTIME
+static ssize_t proc_cputime(FAR struct proc_file_s *procfile,
+                 FAR struct tcb_s *tcb, FAR char *buffer, size_t buflen,
+                 off_t offset);
+#endif
 static ssize_t proc_stack(FAR struct proc_file_s *procfile,
                  FAR struct tcb_s *tcb, FAR char *buffer, size_t buflen,
                  off_t offset);
@@ -230,6 +238,13 @@ static const struct proc_node_s g_loadavg =
 };
 #endif
 
+#ifdef CONFIG_SCHED_CPUTIME
+static const struct proc_node_s g_cputime =
+{
+  "cputime",      "cputime", (uint8_t)PROC_CPUTIME,      DTYPE_FILE        /* CPU accounting */
+};
+#endif
+
 static const struct proc_node_s g_stack =
 {
   "stack",        "stack",   (uint8_t)PROC_STACK,        DTYPE_FILE        /* Task stack info */
@@ -258,6 +273,9 @@ static FAR const struct proc_node_s * const g_nodeinfo[] =
   &g_cmdline,      /* Task command line */
 #ifdef CONFIG_SCHED_CPULOAD
   &g_loadavg,      /* Average CPU utilization */
+#endif
+#ifdef CONFIG_SCHED_CPUTIME
+  &g_cputime,      /* CPU accounting */
 #endif
   &g_stack,        /* Task stack info */
   &g_group,        /* Group directory */
@@ -274,6 +292,9 @@ static const struct proc_node_s * const g_level0info[] =
   &g_cmdline,      /* Task command line */
 #ifdef CONFIG_SCHED_CPULOAD
   &g_loadavg,      /* Average CPU utilization */
+#endif
+#ifdef CONFIG_SCHED_CPUTIME
+  &g_cputime,      /* CPU accounting */
 #endif
   &g_stack,        /* Task stack info */
   &g_group,        /* Group directory */
@@ -590,6 +611,83 @@ static ssize_t proc_loadavg(FAR struct proc_file_s *procfile,
 }
 #endif
 
+/****************************************************************************
+ * Name: proc_cputime
+ *
+ * Description:
+ *   Report the CPU accounting of the thread on one line:  The execution
+ *   time in seconds, the longest uninterrupted run in microseconds, and the
+ *   number of voluntary and involuntary context switches.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_SCHED_CPUTIME
+static ssize_t proc_cputime(FAR struct proc_file_s *procfile,
+                            FAR struct tcb_s *tcb, FAR char *buffer,
+                            size_t buflen, off_t offset)
+{
+  struct cputime_s cputime;
+  size_t remaining;
+  size_t linesize;
+  size_t copysize;
+  size_t totalsize;
+
+  /* Get the accounting data.  clock_cputime should only fail if the PID is
+   * not valid.  This could happen if the thread exited sometime after the
+   * procfs entry was opened.
+   */
+
+  if (clock_cputime(procfile->pid, &cputime) < 0)
+    {
+      return 0;
+    }
+
+  remaining = buflen;
+  totalsize = 0;
+
+  /* Show the execution time */
+
+  linesize   = snprintf(procfile->line, STATUS_LINELEN, "%lu.%06lu ",
+                        (unsigned long)(cputime.runtime / 1000000),
+                        (unsigned long)(cputime.runtime % 1000000));
+  copysize   = procfs_memcpy(procfile->line, linesize, buffer, remaining, &offset);
+
+  totalsize += copysize;
+  buffer    += copysize;
+  remaining -= copysize;
+
+  if (totalsize >= buflen)
+    {
+      return totalsize;
+    }
+
+  /* Show the longest run */
+
+  linesize   = snprintf(procfile->line, STATUS_LINELEN, "%lu ",
+                        (unsigned long)cputime.maxrun);
+  copysize   = procfs_memcpy(procfile->line, linesize, buffer, remaining, &offset);
+
+  totalsize += copysize;
+  buffer    += copysize;
+  remaining -= copysize;
+
+  if (totalsize >= buflen)
+    {
+      return totalsize;
+    }
+
+  /* Show the voluntary and involuntary context switch counts */
+
+  linesize   = snprintf(procfile->line, STATUS_LINELEN, "%lu %lu\n",
+                        (unsigned long)cputime.nvcsw,
+                        (unsigned long)cputime.nivcsw);
+  copysize   = procfs_memcpy(procfile->line, linesize, buffer, remaining, &offset);
+
+  totalsize += copysize;
+  return totalsize;
+}
+#endif
+
 /****************************************************************************
  * Name: proc_stack
  ****************************************************************************/
@@ -1063,6 +1161,11 @@ static ssize_t proc_read(FAR struct file *filep, FAR char *buffer,
     case PROC_LOADAVG: /* Average CPU utilization */
       ret = proc_loadavg(procfile, tcb, buffer, buflen, filep->f_pos);
       break;
+#endif
+#ifdef CONFIG_SCHED_CPUTIME
+    case PROC_CPUTIME: /* CPU accounting */
+      ret = proc_cputime(procfile, tcb, buffer, buflen, filep->f_pos);
+      break;
 #endif
     case PROC_STACK: /* Task stack info */
       ret = proc_stack(procfile, tcb, buffer, buflen, filep->f_pos);
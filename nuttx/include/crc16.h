@@ -75,6 +75,20 @@ uint16_t crc16part(FAR const uint8_t *src, size_t len, uint16_t crc16val);
 
 uint16_t crc16(FAR const uint8_t *src, size_t len);
 
+/****************************************************************************
+ * Name: crc16combine
+ *
+ * Description:
+ *   Return the CRC of two concatenated buffers given the CRC of each.
+ *   'crc1' is the CRC of the first buffer, and 'crc2' and 'len2' are the
+ *   CRC and length of the second.  'crc2' must have been calculated with an
+ *   initial value of zero as by crc16().  This allows the CRC of a large
+ *   buffer to be calculated in pieces, in any order.
+ *
+ ****************************************************************************/
+
+uint16_t crc16combine(uint16_t crc1, uint16_t crc2, size_t len2);
+
 #undef EXTERN
 #ifdef __cplusplus
 }
@@ -75,6 +75,20 @@ uint32_t crc32part(FAR const uint8_t *src, size_t len, uint32_t crc32val);
 
 uint32_t crc32(FAR const uint8_t *src, size_t len);
 
+/****************************************************************************
+ * Name: crc32combine
+ *
+ * Description:
+ *   Return the CRC of two concatenated buffers given the CRC of each.
+ *   'crc1' is the CRC of the first buffer, and 'crc2' and 'len2' are the
+ *   CRC and length of the second.  'crc2' must have been calculated with an
+ *   initial value of zero as by crc32().  This allows the CRC of a large
+ *   buffer to be calculated in pieces, in any order.
+ *
+ ****************************************************************************/
+
+uint32_t crc32combine(uint32_t crc1, uint32_t crc2, size_t len2);
+
 #undef EXTERN
 #ifdef __cplusplus
 }
@@ -1539,6 +1539,46 @@ int up_timer_cancel(FAR struct timespec *ts);
 int up_timer_start(FAR const struct timespec *ts);
 #endif
 
+/****************************************************************************
+ * Name: up_perf_gettime
+ *
+ * Description:
+ *   Return the current value of a free-running, high-resolution counter.
+ *   The counter is used to time stamp context switches for the CPU
+ *   accounting and may wrap around, but not within one system timer tick.
+ *
+ *   Provided by platform-specific code and called from the RTOS base code.
+ *
+ * Input Parameters:
+ *   None
+ *
+ * Returned Value:
+ *   The current counter value.
+ *
+ * Assumptions:
+ *   May be called from interrupt level handling with interrupts disabled.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_SCHED_CPUTIME
+uint32_t up_perf_gettime(void);
+#endif
+
+/****************************************************************************
+ * Name: up_perf_getfreq
+ *
+ * Description:
+ *   Return the frequency of the counter returned by up_perf_gettime() in
+ *   Hz.
+ *
+ *   Provided by platform-specific code and called from the RTOS base code.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_SCHED_CPUTIME
+uint32_t up_perf_getfreq(void);
+#endif
+
 /****************************************************************************
  * Name: up_romgetc
  *
@@ -177,6 +177,18 @@ struct cpuload_s
 };
 #endif
 
+/* This structure is used to report the CPU accounting of a thread */
+
+#ifdef CONFIG_SCHED_CPUTIME
+struct cputime_s
+{
+  uint64_t runtime;          /* Total execution time (microseconds) */
+  uint32_t maxrun;           /* Longest uninterrupted run (microseconds) */
+  uint32_t nvcsw;            /* Number of voluntary context switches */
+  uint32_t nivcsw;           /* Number of involuntary context switches */
+};
+#endif
+
 /****************************************************************************
  * Public Data
  ****************************************************************************/
@@ -339,6 +351,28 @@ int clock_systimespec(FAR struct timespec *ts);
 int clock_cpuload(int pid, FAR struct cpuload_s *cpuload);
 #endif
 
+/****************************************************************************
+ * Function:  clock_cputime
+ *
+ * Description:
+ *   Return the CPU accounting of the selected PID.  The execution time
+ *   includes the current run if the thread is running.
+ *
+ * Parameters:
+ *   pid - The task ID of the thread of interest.  pid == 0 is the IDLE thread.
+ *   cputime - The location to return the CPU accounting
+ *
+ * Return Value:
+ *   OK (0) on success; a negated errno value on failure.  The only reason
+ *   that this function can fail is if 'pid' no longer refers to a valid
+ *   thread.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_SCHED_CPUTIME
+int clock_cputime(int pid, FAR struct cputime_s *cputime);
+#endif
+
 #undef EXTERN
 #ifdef __cplusplus
 }
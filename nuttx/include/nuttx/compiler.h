@@ -211,6 +211,12 @@
 # define CONFIG_HAVE_DOUBLE 1
 # define CONFIG_HAVE_LONG_DOUBLE 1
 
+/* GCC provides __builtin_clz() (count leading zeros).  It is a single
+ * instruction on most architectures and a library call on the others.
+ */
+
+# define CONFIG_HAVE_BUILTIN_CLZ 1
+
 /* Structures and unions can be assigned and passed as values */
 
 # define CONFIG_CAN_PASS_STRUCTS 1
@@ -518,6 +518,20 @@ void files_releaselist(FAR struct filelist *list);
 int file_dup2(FAR struct file *filep1, FAR struct file *filep2);
 #endif
 
+/****************************************************************************
+ * Name: file_close_detached
+ *
+ * Description:
+ *   Close a struct file instance that is not part of any task's file list,
+ *   such as one that was cloned with file_dup2() and held privately by the
+ *   OS.
+ *
+ ****************************************************************************/
+
+#if CONFIG_NFILE_DESCRIPTORS > 0
+int file_close_detached(FAR struct file *filep);
+#endif
+
 /* fs_filedup.c *************************************************************/
 /****************************************************************************
  * Name: fs_dupfd OR dup
@@ -127,6 +127,23 @@
 #define FIONWRITE       _FIOC(0x0006)     /* IN:  Location to return value (int *)
                                            * OUT: Bytes writable to this fd
                                            */
+#define FIOC_FALLOCATE  _FIOC(0x0007)     /* IN:  Pointer to the length (off_t *)
+                                           *      for which storage is
+                                           *      reserved.  The file size
+                                           *      is not changed.  Unused
+                                           *      storage is released on
+                                           *      close (or on fsync if
+                                           *      nothing was appended).
+                                           * OUT: None
+                                           */
+#define FIOC_FILEID     _FIOC(0x0008)     /* IN:  Location to return the ID (uint32_t *)
+                                           * OUT: A non-zero value that identifies
+                                           *      the open file within its volume.
+                                           *      All open instances of the same
+                                           *      file return the same value.  A
+                                           *      value is never reused for a
+                                           *      different file.
+                                           */
 
 /* NuttX file system ioctl definitions **************************************/
 
@@ -0,0 +1,210 @@
+/****************************************************************************
+ * include/nuttx/mm/mempool.h
+ * Fixed-size block memory pools.
+ *
+ *   Copyright (C) 2014 Gregory Nutt. All rights reserved.
+ *   Author: Gregory Nutt <gnutt@nuttx.org>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name NuttX nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+#ifndef __INCLUDE_NUTTX_MM_MEMPOOL_H
+#define __INCLUDE_NUTTX_MM_MEMPOOL_H
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <sys/types.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <semaphore.h>
+
+#ifdef CONFIG_MM_MEMPOOL
+
+/****************************************************************************
+ * Pre-Processor Definitions
+ ****************************************************************************/
+/* Configuration ************************************************************/
+/* CONFIG_MM_MEMPOOL - Enable fixed-block memory pool support
+ * CONFIG_DEBUG_MEMPOOL - Just like CONFIG_DEBUG_MM, but only generates
+ *   output from the memory pool logic.
+ */
+
+/****************************************************************************
+ * Public Types
+ ****************************************************************************/
+
+/* A free block holds a link to the next free block in its first word */
+
+struct mempool_blk_s
+{
+  FAR struct mempool_blk_s *flink;
+};
+
+/* This describes one memory pool.  The structure is provided by the caller
+ * of mempool_initialize() (usually statically) and must not be accessed
+ * directly except to read the statistics.
+ */
+
+struct mempool_s
+{
+  FAR struct mempool_s *flink;        /* Next pool in the list of all pools */
+  FAR const char *name;               /* Name reported by procfs */
+  FAR struct mempool_blk_s *freelist; /* List of free blocks */
+  FAR void *heapmem;                  /* Block storage if from the heap */
+  size_t   blocksize;                 /* Size of each block */
+  uint16_t nblocks;                   /* Total number of blocks */
+  uint16_t nfree;                     /* Number of free blocks */
+  uint16_t maxused;                   /* High-water mark of blocks in use */
+  uint16_t nfail;                     /* Number of failed allocations */
+  bool     wait;                      /* True: mempool_alloc() may wait */
+  sem_t    sem;                       /* Counts free blocks if 'wait' */
+};
+
+/****************************************************************************
+ * Public Function Prototypes
+ ****************************************************************************/
+
+#ifdef __cplusplus
+#define EXTERN extern "C"
+extern "C"
+{
+#else
+#define EXTERN extern
+#endif
+
+/****************************************************************************
+ * Name: mempool_initialize
+ *
+ * Description:
+ *   Set up a pool of 'nblocks' blocks of 'blocksize' bytes each.  The
+ *   blocks are carved from the memory at 'pool_start' which must be
+ *   aligned for the blocks' contents and at least 'nblocks' times
+ *   'blocksize' bytes, rounded up to pointer alignment.  If 'pool_start'
+ *   is NULL, the memory is allocated from the kernel heap instead.
+ *
+ * Input Parameters:
+ *   pool       - The pool structure to initialize.
+ *   name       - A name for the pool as reported by /proc/mempool.  The
+ *                string is not copied.
+ *   pool_start - The block storage or NULL to allocate it.
+ *   blocksize  - The size of each block in bytes
+ *   nblocks    - The number of blocks in the pool
+ *   wait       - True if mempool_alloc() should wait for a free block
+ *                rather than failing when the pool is empty.
+ *
+ * Returned Value:
+ *   Zero (OK) on success; a negated errno value on failure.
+ *
+ ****************************************************************************/
+
+int mempool_initialize(FAR struct mempool_s *pool, FAR const char *name,
+                       FAR void *pool_start, size_t blocksize,
+                       unsigned int nblocks, bool wait);
+
+/****************************************************************************
+ * Name: mempool_release
+ *
+ * Description:
+ *   Remove the pool from the list of pools and free any heap memory that
+ *   mempool_initialize() allocated for it.  All blocks must have been
+ *   returned to the pool.
+ *
+ ****************************************************************************/
+
+void mempool_release(FAR struct mempool_s *pool);
+
+/****************************************************************************
+ * Name: mempool_tryalloc
+ *
+ * Description:
+ *   Take a block from the pool without waiting.  This may be called from
+ *   interrupt handlers.
+ *
+ * Returned Value:
+ *   The allocated block or NULL if the pool is empty.
+ *
+ ****************************************************************************/
+
+FAR void *mempool_tryalloc(FAR struct mempool_s *pool);
+
+/****************************************************************************
+ * Name: mempool_alloc
+ *
+ * Description:
+ *   Take a block from the pool.  If the pool was initialized with 'wait'
+ *   and this is not called from an interrupt handler, wait until a block
+ *   is freed if the pool is empty.
+ *
+ * Returned Value:
+ *   The allocated block or NULL if the pool is empty and either waiting is
+ *   not possible or the wait was interrupted by a signal.
+ *
+ ****************************************************************************/
+
+FAR void *mempool_alloc(FAR struct mempool_s *pool);
+
+/****************************************************************************
+ * Name: mempool_free
+ *
+ * Description:
+ *   Return a block to the pool.  This may be called from interrupt
+ *   handlers.
+ *
+ ****************************************************************************/
+
+void mempool_free(FAR struct mempool_s *pool, FAR void *blk);
+
+/****************************************************************************
+ * Name: mempool_foreach
+ *
+ * Description:
+ *   Call 'handler' for each initialized pool until it returns a non-zero
+ *   value.  The pools cannot be added or removed while this runs.
+ *
+ * Returned Value:
+ *   The last value returned by 'handler' or zero if there are no pools.
+ *
+ ****************************************************************************/
+
+typedef CODE int (*mempool_handler_t)(FAR struct mempool_s *pool,
+                                      FAR void *arg);
+
+int mempool_foreach(mempool_handler_t handler, FAR void *arg);
+
+#undef EXTERN
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CONFIG_MM_MEMPOOL */
+#endif /* __INCLUDE_NUTTX_MM_MEMPOOL_H */
@@ -176,6 +176,25 @@
 #define MM_IS_ALLOCATED(n) \
   ((int)((struct mm_allocnode_s*)(n)->preceding) < 0))
 
+/* Fast bins.  Freed chunks no larger than MM_FASTBIN_MAXCHUNK are cached in
+ * per-size lists, one for each multiple of MM_MIN_CHUNK.
+ */
+
+#ifdef CONFIG_MM_FASTBINS
+#  ifndef CONFIG_MM_FASTBIN_MAXSIZE
+#    define CONFIG_MM_FASTBIN_MAXSIZE 120
+#  endif
+
+#  ifndef CONFIG_MM_FASTBIN_DEPTH
+#    define CONFIG_MM_FASTBIN_DEPTH 8
+#  endif
+
+#  define MM_FASTBIN_MAXCHUNK \
+     MM_ALIGN_UP(CONFIG_MM_FASTBIN_MAXSIZE + SIZEOF_MM_ALLOCNODE)
+#  define MM_NFASTBINS      (MM_FASTBIN_MAXCHUNK >> MM_MIN_SHIFT)
+#  define MM_FASTBIN_NDX(s) (((s) >> MM_MIN_SHIFT) - 1)
+#endif
+
 /****************************************************************************
  * Public Types
  ****************************************************************************/
@@ -230,6 +249,19 @@ struct mm_freenode_s
 #define CHECK_FREENODE_SIZE \
   DEBUGASSERT(sizeof(struct mm_freenode_s) == SIZEOF_MM_FREENODE)
 
+/* This describes a chunk cached in a fast bin.  It is still marked as
+ * allocated so that it is not merged with its free neighbors.
+ */
+
+#ifdef CONFIG_MM_FASTBINS
+struct mm_fastnode_s
+{
+  mmsize_t size;                   /* Size of this chunk */
+  mmsize_t preceding;              /* Size of the preceding chunk */
+  FAR struct mm_fastnode_s *flink; /* Supports a singly linked list */
+};
+#endif
+
 /* This describes one heap (possibly with multiple regions) */
 
 struct mm_heap_s
@@ -261,6 +293,13 @@ struct mm_heap_s
    */
 
   struct mm_freenode_s mm_nodelist[MM_NNODES];
+
+#ifdef CONFIG_MM_FASTBINS
+  /* Recently freed small chunks, by size, and the number in each list */
+
+  FAR struct mm_fastnode_s *mm_fastbin[MM_NFASTBINS];
+  uint8_t mm_fastcount[MM_NFASTBINS];
+#endif
 };
 
 /****************************************************************************
@@ -364,6 +403,8 @@ FAR void *kmm_malloc(size_t size);
 /* Functions contained in mm_free.c *****************************************/
 
 void mm_free(FAR struct mm_heap_s *heap, FAR void *mem);
+void mm_freechunk(FAR struct mm_heap_s *heap,
+                  FAR struct mm_freenode_s *node);
 
 /* Functions contained in kmm_free.c ****************************************/
 
@@ -496,6 +537,15 @@ void mm_addfreechunk(FAR struct mm_heap_s *heap,
 
 int mm_size2ndx(size_t size);
 
+/* Functions contained in mm_fastbin.c **************************************/
+
+#ifdef CONFIG_MM_FASTBINS
+FAR void *mm_fastalloc(FAR struct mm_heap_s *heap, size_t size);
+bool mm_fastfree(FAR struct mm_heap_s *heap,
+                 FAR struct mm_freenode_s *node);
+int  mm_fastflush(FAR struct mm_heap_s *heap);
+#endif
+
 #undef EXTERN
 #ifdef __cplusplus
 }
@@ -46,6 +46,7 @@
 #include <sys/types.h>
 #include <stdint.h>
 #include <stdbool.h>
+#include <limits.h>
 #include <mqueue.h>
 #include <queue.h>
 #include <signal.h>
@@ -56,13 +57,19 @@
  * Pre-processor Definitions
  ****************************************************************************/
 
+#ifdef CONFIG_MQ_PRIOINDEX
+#  define MQ_PRIOINDEX_NWORDS ((MQ_PRIO_MAX + 32) >> 5)
+#endif
+
 /****************************************************************************
  * Global Type Declarations
  ****************************************************************************/
 
 /* This structure defines a message queue */
 
-struct mq_des; /* forward reference */
+struct mq_des;       /* forward reference */
+struct mqueue_msg_s; /* forward reference */
+struct mempool_s;    /* forward reference */
 
 struct mqueue_inode_s
 {
@@ -83,6 +90,13 @@ struct mqueue_inode_s
   int ntsigno;                /* Notification: Signal number */
   union sigval ntvalue;       /* Notification: Signal value */
 #endif
+#ifdef CONFIG_MQ_ZEROCOPY
+  FAR struct mempool_s *pool; /* Buffer pool (NULL if messages are copied) */
+#endif
+#ifdef CONFIG_MQ_PRIOINDEX
+  uint32_t prioset[MQ_PRIOINDEX_NWORDS];  /* Priorities present */
+  FAR struct mqueue_msg_s *priotail[MQ_PRIO_MAX + 1]; /* Last of each */
+#endif
 };
 
 /* This describes the message queue descriptor that is held in the
@@ -196,6 +210,120 @@ mqd_t mq_descreate(FAR struct tcb_s* mtcb, FAR struct mqueue_inode_s* msgq,
 
 void mq_desclose(mqd_t mqdes);
 
+#ifdef CONFIG_MQ_ZEROCOPY
+/****************************************************************************
+ * Name: mq_setpool
+ *
+ * Description:
+ *   Make the message queue pass buffers from 'pool' by reference.  Each
+ *   pool block holds a small message header followed by the message data
+ *   so the largest message is a little smaller than the pool block size.
+ *   Once a pool is set, the message queue may only be used with
+ *   mq_sendbuf() and mq_receivebuf(); mq_send() and mq_receive() fail with
+ *   EPERM.  The pool must not be released while the message queue exists.
+ *
+ * Parameters:
+ *   mqdes - Message queue descriptor
+ *   pool  - An initialized memory pool
+ *
+ * Return Value:
+ *   0 (OK) on success.  On failure, -1 (ERROR) is returned and the errno
+ *   is set appropriately:
+ *
+ *   EINVAL  'mqdes' or 'pool' is invalid or the pool blocks are too small
+ *   EBUSY   The message queue already has a pool or holds messages
+ *
+ ****************************************************************************/
+
+int mq_setpool(mqd_t mqdes, FAR struct mempool_s *pool);
+
+/****************************************************************************
+ * Name: mq_bufalloc
+ *
+ * Description:
+ *   Allocate a message buffer from the pool of the message queue.  This
+ *   waits for a free buffer if the pool was initialized to wait and this
+ *   is not called from an interrupt handler.  The caller owns the buffer
+ *   until it passes it to mq_sendbuf() or frees it with mq_buffree().
+ *
+ * Parameters:
+ *   mqdes - Message queue descriptor
+ *
+ * Return Value:
+ *   The address of the message data or NULL if no buffer is available.
+ *
+ ****************************************************************************/
+
+FAR void *mq_bufalloc(mqd_t mqdes);
+
+/****************************************************************************
+ * Name: mq_buffree
+ *
+ * Description:
+ *   Return a buffer obtained from mq_bufalloc() or mq_receivebuf() to the
+ *   pool of the message queue.
+ *
+ * Parameters:
+ *   mqdes - Message queue descriptor
+ *   buf   - The address of the message data
+ *
+ * Return Value:
+ *   None
+ *
+ ****************************************************************************/
+
+void mq_buffree(mqd_t mqdes, FAR void *buf);
+
+/****************************************************************************
+ * Name: mq_sendbuf
+ *
+ * Description:
+ *   Queue the buffer 'buf' without copying it.  This is otherwise like
+ *   mq_send():  The message is placed by priority and the call blocks
+ *   while the queue is full unless O_NONBLOCK is set.  On success, the
+ *   buffer belongs to the message queue and must no longer be accessed by
+ *   the sender.  On failure, the sender still owns the buffer.  This may
+ *   be called from an interrupt handler.
+ *
+ * Parameters:
+ *   mqdes  - Message queue descriptor
+ *   buf    - A buffer from mq_bufalloc() on the same message queue
+ *   buflen - The length of the message in bytes
+ *   prio   - The priority of the message
+ *
+ * Return Value:
+ *   0 (OK) on success.  On failure, -1 (ERROR) is returned with the errno
+ *   set as for mq_send().  EINVAL is also reported if the message queue
+ *   has no pool.
+ *
+ ****************************************************************************/
+
+int mq_sendbuf(mqd_t mqdes, FAR void *buf, size_t buflen, int prio);
+
+/****************************************************************************
+ * Name: mq_receivebuf
+ *
+ * Description:
+ *   Remove the oldest message of the highest priority from the message
+ *   queue and return its buffer without copying it.  This is otherwise
+ *   like mq_receive().  The caller owns the returned buffer and must free
+ *   it with mq_buffree().
+ *
+ * Parameters:
+ *   mqdes - Message queue descriptor
+ *   buf   - Location to return the address of the message data
+ *   prio  - Location to return the message priority (may be NULL)
+ *
+ * Return Value:
+ *   The length of the message in bytes on success.  On failure, -1 (ERROR)
+ *   is returned with the errno set as for mq_receive().  EINVAL is also
+ *   reported if the message queue has no pool.
+ *
+ ****************************************************************************/
+
+ssize_t mq_receivebuf(mqd_t mqdes, FAR void **buf, FAR int *prio);
+#endif
+
 #undef EXTERN
 #ifdef __cplusplus
 }
@@ -125,6 +125,9 @@ struct iob_s
   uint16_t io_offset;   /* Data begins at this offset */
 #endif
   uint16_t io_pktlen;   /* Total length of the packet */
+#ifdef CONFIG_IOB_REFCOUNT
+  uint8_t  io_refs;     /* References to the chain (head of chain only) */
+#endif
 
   uint8_t  io_data[CONFIG_IOB_BUFSIZE];
 };
@@ -195,6 +198,22 @@ FAR struct iob_s *iob_alloc(bool throttled);
 
 FAR struct iob_s *iob_free(FAR struct iob_s *iob);
 
+/****************************************************************************
+ * Name: iob_addref
+ *
+ * Description:
+ *   Add a reference to an I/O buffer chain so that it may be shared by
+ *   several consumers without copying.  Each reference is released by one
+ *   call to iob_free_chain(); the chain is only returned to the free list
+ *   when the last reference is released.  A shared chain must be treated as
+ *   read-only.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_IOB_REFCOUNT
+void iob_addref(FAR struct iob_s *iob);
+#endif
+
 /****************************************************************************
  * Name: iob_free_chain
  *
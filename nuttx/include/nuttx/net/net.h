@@ -70,7 +70,7 @@
 
 /* This defines a bitmap big enough for one bit for each socket option */
 
-typedef uint16_t sockopt_t;
+typedef uint32_t sockopt_t;
 
 /* This defines the storage size of a timeout value.  This effects only
  * range of supported timeout values.  With an LSB in seciseconds, the
@@ -105,8 +105,8 @@ struct socket
 
   FAR void     *s_conn;      /* Connection: struct tcp_conn_s or udp_conn_s */
 
-#ifdef CONFIG_NET_TCP_WRITE_BUFFERS
-  /* Callback instance for TCP send */
+#if defined(CONFIG_NET_TCP_WRITE_BUFFERS) || defined(CONFIG_NET_UDP_WRITE_BUFFERS)
+  /* Callback instance for TCP send or for buffered UDP sendto */
 
   FAR struct devif_callback_s *s_sndcb;
 #endif
@@ -425,6 +425,7 @@ int psock_close(FAR struct socket *psock);
  ****************************************************************************/
 
 struct sockaddr; /* Forward reference. Defined in nuttx/include/sys/socket.h */
+struct msghdr;  /* Forward reference. Defined in nuttx/include/sys/socket.h */
 int psock_bind(FAR struct socket *psock, FAR const struct sockaddr *addr,
                socklen_t addrlen);
 
@@ -699,6 +700,49 @@ ssize_t psock_recvfrom(FAR struct socket *psock, FAR void *buf, size_t len,
 #define psock_recv(psock,buf,len,flags) \
   psock_recvfrom(psock,buf,len,flags,NULL,0)
 
+/****************************************************************************
+ * Function: psock_sendmsg
+ *
+ * Description:
+ *   Send a message gathered from the msg_iov buffers of 'msg'.  For a
+ *   datagram socket, all of the buffers are sent as a single datagram to
+ *   the address in msg_name (or to the connected peer if msg_name is NULL).
+ *
+ * Parameters:
+ *   psock    A pointer to a NuttX-specific, internal socket structure
+ *   msg      Describes the message to send
+ *   flags    Send flags
+ *
+ * Returned Value:
+ *   On success, returns the number of characters sent.  On error, -1 is
+ *   returned, and errno is set appropriately (see psock_sendto()).
+ *
+ ****************************************************************************/
+
+ssize_t psock_sendmsg(FAR struct socket *psock, FAR const struct msghdr *msg,
+                      int flags);
+
+/****************************************************************************
+ * Function: psock_recvmsg
+ *
+ * Description:
+ *   Receive a message and scatter it into the msg_iov buffers of 'msg'.
+ *   The sender's address is returned in msg_name if it is not NULL.
+ *
+ * Parameters:
+ *   psock    A pointer to a NuttX-specific, internal socket structure
+ *   msg      Describes the buffers that receive the message
+ *   flags    Receive flags
+ *
+ * Returned Value:
+ *   On success, returns the number of characters received.  On error, -1
+ *   is returned, and errno is set appropriately (see psock_recvfrom()).
+ *
+ ****************************************************************************/
+
+ssize_t psock_recvmsg(FAR struct socket *psock, FAR struct msghdr *msg,
+                      int flags);
+
 /****************************************************************************
  * Function: psock_getsockopt
  *
@@ -136,6 +136,7 @@
 #define TCB_FLAG_CANCEL_PENDING    (1 << 3) /* Bit 3: Pthread cancel is pending */
 #define TCB_FLAG_ROUND_ROBIN       (1 << 4) /* Bit 4: Round robin sched enabled */
 #define TCB_FLAG_EXIT_PROCESSING   (1 << 5) /* Bit 5: Exitting */
+#define TCB_FLAG_SPORADIC          (1 << 6) /* Bit 6: Sporadic sched enabled */
 
 /* Values for struct task_group tg_flags */
 
@@ -441,6 +442,7 @@ struct task_group_s
  */
 
 FAR struct wdog_s;                       /* Forward reference                   */
+struct sporadic_s;                       /* Forward reference                   */
 
 struct tcb_s
 {
@@ -486,6 +488,17 @@ struct tcb_s
 
 #if CONFIG_RR_INTERVAL > 0
   int      timeslice;                    /* RR timeslice interval remaining     */
+#endif
+#ifdef CONFIG_SCHED_SPORADIC
+  FAR struct sporadic_s *sporadic;       /* Sporadic server state               */
+#endif
+#ifdef CONFIG_SCHED_CPUTIME
+  uint64_t run_time;                     /* Total execution time (counts)       */
+  uint32_t run_slice;                    /* Length of the current run (counts)  */
+  uint32_t run_max;                      /* Longest run (counts)                */
+  uint32_t run_stamp;                    /* Counter when last accounted         */
+  uint32_t nvcsw;                        /* Voluntary context switches          */
+  uint32_t nivcsw;                       /* Involuntary context switches        */
 #endif
   FAR struct wdog_s *waitdog;            /* All timed waits used this wdog      */
 
@@ -0,0 +1,207 @@
+/****************************************************************************
+ * include/nuttx/sched_note.h
+ *
+ *   Copyright (C) 2014 Gregory Nutt. All rights reserved.
+ *   Author: Gregory Nutt <gnutt@nuttx.org>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name NuttX nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+#ifndef __INCLUDE_NUTTX_SCHED_NOTE_H
+#define __INCLUDE_NUTTX_SCHED_NOTE_H
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <sys/types.h>
+#include <stdint.h>
+
+#ifdef CONFIG_SCHED_INSTRUMENTATION_BUFFER
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+/* Configuration ************************************************************/
+
+#ifndef CONFIG_SCHED_NOTE_BUFSIZE
+#  define CONFIG_SCHED_NOTE_BUFSIZE 2048
+#endif
+
+/* Notes are stored in the buffer as packed byte sequences.  Multi-byte
+ * fields are always stored in little-endian order so that the host-side
+ * decoder (tools/notedecode.c) does not need to know anything about the
+ * target.  Each note begins with struct note_common_s; nc_length holds
+ * the size of the complete note so that variable-length notes (such as
+ * NOTE_START with its task name) can be skipped without decoding them.
+ */
+
+#define NOTE_COMMON_SIZE     sizeof(struct note_common_s)
+
+/****************************************************************************
+ * Public Types
+ ****************************************************************************/
+
+/* Identifies the type of a note */
+
+enum note_type_e
+{
+  NOTE_START = 0,             /* A task or thread was started */
+  NOTE_STOP,                  /* A task or thread was stopped */
+  NOTE_SWITCH,                /* A context switch occurred */
+  NOTE_IRQ_ENTER,             /* An interrupt handler was entered */
+  NOTE_IRQ_LEAVE,             /* An interrupt handler returned */
+  NOTE_SEMWAIT                /* A thread blocked on a semaphore */
+};
+
+/* This structure provides the common header of each note */
+
+struct note_common_s
+{
+  uint8_t nc_length;          /* Length of the note, including this header */
+  uint8_t nc_type;            /* See enum note_type_e */
+  uint8_t nc_priority;        /* Priority of the thread */
+  uint8_t nc_pid[2];          /* ID of the thread */
+  uint8_t nc_systime[4];      /* Time stamp in microseconds */
+};
+
+/* This is the specific form of the NOTE_START note */
+
+struct note_start_s
+{
+  struct note_common_s nst_cmn; /* Common note parameters */
+#if CONFIG_TASK_NAME_SIZE > 0
+  char nst_name[CONFIG_TASK_NAME_SIZE]; /* Task name (not NUL terminated) */
+#endif
+};
+
+/* This is the specific form of the NOTE_STOP note */
+
+struct note_stop_s
+{
+  struct note_common_s nsp_cmn; /* Common note parameters */
+};
+
+/* This is the specific form of the NOTE_SWITCH note.  The common header
+ * describes the thread being suspended.
+ */
+
+struct note_switch_s
+{
+  struct note_common_s nsw_cmn; /* Common note parameters */
+  uint8_t nsw_pid[2];           /* ID of the thread being resumed */
+  uint8_t nsw_priority;         /* Priority of the thread being resumed */
+};
+
+/* This is the specific form of the NOTE_IRQ_ENTER and NOTE_IRQ_LEAVE
+ * notes.  The common header describes the interrupted thread.
+ */
+
+struct note_irqhandler_s
+{
+  struct note_common_s nih_cmn; /* Common note parameters */
+  uint8_t nih_irq[2];           /* IRQ number */
+};
+
+/* This is the specific form of the NOTE_SEMWAIT note.  The address is
+ * only meaningful as an identifier for the semaphore.
+ */
+
+struct note_semwait_s
+{
+  struct note_common_s nsm_cmn; /* Common note parameters */
+  uint8_t nsm_sem[sizeof(uintptr_t)]; /* Address of the semaphore */
+};
+
+/****************************************************************************
+ * Public Function Prototypes
+ ****************************************************************************/
+
+#ifdef __cplusplus
+#define EXTERN extern "C"
+extern "C"
+{
+#else
+#define EXTERN extern
+#endif
+
+/****************************************************************************
+ * Name: sched_note_get
+ *
+ * Description:
+ *   Remove buffered notes from the circular note buffer.  Only complete
+ *   notes are returned; a note that does not fit into the remaining space
+ *   of the user buffer is left in the note buffer for the next call.
+ *
+ * Input Parameters:
+ *   buffer - Location to return the notes
+ *   buflen - The size of the user buffer
+ *
+ * Returned Value:
+ *   On success, the number of bytes returned is returned; zero means that
+ *   the note buffer is empty.  -EFBIG is returned if buflen is too small
+ *   to hold even the first note.
+ *
+ ****************************************************************************/
+
+ssize_t sched_note_get(FAR uint8_t *buffer, size_t buflen);
+
+/****************************************************************************
+ * Name: sched_note_size
+ *
+ * Description:
+ *   Return the number of bytes currently held in the note buffer.
+ *
+ ****************************************************************************/
+
+size_t sched_note_size(void);
+
+/****************************************************************************
+ * Name: devnote_register
+ *
+ * Description:
+ *   Register /dev/note, a read-only character driver that drains the
+ *   scheduler note buffer.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_DRIVER_NOTE
+void devnote_register(void);
+#endif
+
+#undef EXTERN
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CONFIG_SCHED_INSTRUMENTATION_BUFFER */
+#endif /* __INCLUDE_NUTTX_SCHED_NOTE_H */
@@ -42,6 +42,7 @@
 
 #include <nuttx/config.h>
 
+#include <stdint.h>
 #include <semaphore.h>
 
 #include <nuttx/fs/fs.h>
@@ -68,6 +69,18 @@ struct nsem_inode_s
 };
 #endif
 
+#ifdef CONFIG_PRIORITY_INHERITANCE
+/* Statistics about the pool of pre-allocated semaphore holders */
+
+struct semholder_stats_s
+{
+  uint16_t npool;                   /* Size of the pool */
+  uint16_t nfree;                   /* Number of free holders in the pool */
+  uint16_t minfree;                 /* Fewest free holders ever */
+  uint32_t nfails;                  /* Holders that could not be recorded */
+};
+#endif
+
 /****************************************************************************
  * Public Data
  ****************************************************************************/
@@ -86,6 +99,21 @@ extern "C"
  * Public Function Prototypes
  ****************************************************************************/
 
+/****************************************************************************
+ * Name: sem_holderstats
+ *
+ * Description:
+ *   Return statistics about the pool of pre-allocated holders used for
+ *   priority inheritance.  The first holder of each semaphore is kept in
+ *   the semaphore itself; only additional holders come from the pool.
+ *   A non-zero nfails means that CONFIG_SEM_PREALLOCHOLDERS is too small.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_PRIORITY_INHERITANCE
+void sem_holderstats(FAR struct semholder_stats_s *stats);
+#endif
+
 #undef EXTERN
 #ifdef __cplusplus
 }
@@ -135,10 +135,17 @@ struct wdog_s
 #ifdef CONFIG_PIC
   FAR void          *picbase;    /* PIC base address */
 #endif
-  int                lag;        /* Timer associated with the delay */
+  int                lag;        /* Timer associated with the delay (or
+                                  * the expiration tick if
+                                  * CONFIG_WDOG_TIMERWHEEL) */
   uint8_t            flags;      /* See WDOGF_* definitions above */
   uint8_t            argc;       /* The number of parameters to pass */
   uint32_t           parm[CONFIG_MAX_WDOGPARMS];
+#ifdef CONFIG_WDOG_TIMERWHEEL
+  FAR struct wdog_s *prev;       /* Support for doubly linked wheel slots */
+  uint8_t            level;      /* Wheel level holding the watchdog */
+  uint8_t            slot;       /* Slot within that level */
+#endif
 };
 
 /* Watchdog 'handle' */
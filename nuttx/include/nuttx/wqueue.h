@@ -90,6 +90,11 @@
  * CONFIG_SCHED_LPWORKSTACKSIZE - The stack size allocated for the lower
  *   priority worker thread.  Default: 2048.
  *
+ * CONFIG_SCHED_WORKPRIORITY - Order kernel work by priority and deadline
+ *   rather than FIFO.
+ * CONFIG_SCHED_WORKSTATS - Collect kernel work queue statistics and
+ *   report them in /proc/work.
+ *
  * The user-mode work queue is only available in the protected or kernel
  * builds.  This those configurations, the user-mode work queue provides the
  * same (non-standard) facility for use by applications.
@@ -268,7 +273,17 @@
 #  endif
 #  define USRWORK  LPWORK     /* Redirect user-mode references */
 
-#endif /* CONFIG_LIB_USRWORK && !__KERNEL__
+#endif /* CONFIG_LIB_USRWORK && !__KERNEL__ */
+
+/* Work priorities.  Ready work with a higher priority is performed before
+ * work with a lower priority.  work_queue() uses WORK_PRIORITY_DEFAULT.
+ */
+
+#ifdef CONFIG_SCHED_WORKPRIORITY
+#  define WORK_PRIORITY_MIN     0
+#  define WORK_PRIORITY_DEFAULT 128
+#  define WORK_PRIORITY_MAX     255
+#endif
 
 /****************************************************************************
  * Public Types
@@ -292,6 +307,10 @@ struct work_s
   FAR void *arg;         /* Callback argument */
   uint32_t  qtime;       /* Time work queued */
   uint32_t  delay;       /* Delay until work performed */
+#ifdef CONFIG_SCHED_WORKPRIORITY
+  uint32_t  deadline;    /* Start deadline after qtime (0 = none) */
+  uint8_t   priority;    /* Priority of the work */
+#endif
 };
 
 /****************************************************************************
@@ -361,6 +380,41 @@ int work_usrstart(void);
 int work_queue(int qid, FAR struct work_s *work, worker_t worker,
                FAR void *arg, uint32_t delay);
 
+/****************************************************************************
+ * Name: work_queuepriority
+ *
+ * Description:
+ *   Queue kernel-mode work with an explicit priority and deadline.  This is
+ *   the same as work_queue() except that the work is inserted ahead of all
+ *   queued work of lower priority and, among work of the same priority,
+ *   ahead of work with a later deadline.  Work with no deadline follows
+ *   work of the same priority that has one.  Work of the same priority and
+ *   deadline is performed in FIFO order.
+ *
+ * Input parameters:
+ *   qid      - The work queue ID
+ *   work     - The work structure to queue
+ *   worker   - The worker callback to be invoked.
+ *   arg      - The argument that will be passed to the worker callback.
+ *   delay    - Delay (in clock ticks) from the time queue until the worker
+ *              is invoked. Zero means to perform the work immediately.
+ *   priority - The work priority, WORK_PRIORITY_MIN to WORK_PRIORITY_MAX
+ *   deadline - Time (in clock ticks) from the time queued by which the
+ *              worker should be started.  Zero means no deadline.  The
+ *              deadline only orders the work; missed deadlines are counted
+ *              in the work queue statistics.
+ *
+ * Returned Value:
+ *   Zero on success, a negated errno on failure
+ *
+ ****************************************************************************/
+
+#if defined(CONFIG_SCHED_WORKPRIORITY) && defined(CONFIG_SCHED_WORKQUEUE)
+int work_queuepriority(int qid, FAR struct work_s *work, worker_t worker,
+                       FAR void *arg, uint32_t delay, uint8_t priority,
+                       uint32_t deadline);
+#endif
+
 /****************************************************************************
  * Name: work_cancel
  *
@@ -44,6 +44,8 @@
 
 #include <sys/types.h>
 #include <stdint.h>
+#include <stdbool.h>
+#include <time.h>
 #include <nuttx/sched.h>
 
 /********************************************************************************
@@ -56,7 +58,7 @@
 
 #define SCHED_FIFO     1  /* FIFO per priority scheduling policy */
 #define SCHED_RR       2  /* Round robin scheduling policy */
-#define SCHED_SPORADIC 3  /* Not supported */
+#define SCHED_SPORADIC 3  /* Sporadic server scheduling policy */
 #define SCHED_OTHER    4  /* Not supported */
 
 /* Pthread definitions **********************************************************/
@@ -67,11 +69,19 @@
  * Public Type Definitions
  ********************************************************************************/
 
-/* This is the POSIX-like scheduling parameter structure */
+/* This is the POSIX-like scheduling parameter structure.  The sched_ss_*
+ * fields are used only with the SCHED_SPORADIC policy.
+ */
 
 struct sched_param
 {
-  int sched_priority;
+  int sched_priority;                   /* Base (high) priority */
+#ifdef CONFIG_SCHED_SPORADIC
+  int sched_ss_low_priority;            /* Priority when budget is exhausted */
+  struct timespec sched_ss_repl_period; /* Replenishment period */
+  struct timespec sched_ss_init_budget; /* Initial execution budget */
+  int sched_ss_max_repl;                /* Maximum pending replenishments */
+#endif
 };
 
 /********************************************************************************
@@ -125,7 +135,9 @@ int    sched_unlock(void);
 int    sched_lockcount(void);
 
 /* If instrumentation of the scheduler is enabled, then some outboard logic
- * must provide the following interfaces.
+ * must provide the following interfaces.  If
+ * CONFIG_SCHED_INSTRUMENTATION_BUFFER is selected, then they are provided
+ * by sched/sched/sched_note.c.
  */
 
 #ifdef CONFIG_SCHED_INSTRUMENTATION
@@ -141,6 +153,18 @@ void   sched_note_switch(FAR struct tcb_s *pFromTcb,
 # define sched_note_switch(t1, t2)
 #endif /* CONFIG_SCHED_INSTRUMENTATION */
 
+#ifdef CONFIG_SCHED_INSTRUMENTATION_IRQHANDLER
+void   sched_note_irqhandler(int irq, FAR void *handler, bool enter);
+#else
+# define sched_note_irqhandler(i,h,e)
+#endif
+
+#ifdef CONFIG_SCHED_INSTRUMENTATION_SEMAPHORE
+void   sched_note_semwait(FAR struct tcb_s *tcb, FAR sem_t *sem);
+#else
+# define sched_note_semwait(t,s)
+#endif
+
 #undef EXTERN
 #if defined(__cplusplus)
 }
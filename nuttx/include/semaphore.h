@@ -44,6 +44,7 @@
 
 #include <stdint.h>
 #include <limits.h>
+#include <queue.h>
 
 #ifdef __cplusplus
 #define EXTERN extern "C"
@@ -92,26 +93,36 @@ struct sem_s
    */
 
 #ifdef CONFIG_PRIORITY_INHERITANCE
+  struct semholder_s holder;     /* First holder (the only holder of a mutex) */
 # if CONFIG_SEM_PREALLOCHOLDERS > 0
-  FAR struct semholder_s *hhead; /* List of holders of semaphore counts */
-# else
-  struct semholder_s holder;     /* Single holder */
+  FAR struct semholder_s *hhead; /* List of additional holders */
 # endif
 #endif
+
+  /* The tasks blocked on the semaphore, highest priority first */
+
+  dq_queue_t waitlist;
 };
 
 typedef struct sem_s sem_t;
 
 /* Initializers */
 
+#define SEM_WAITLIST_INITIALIZER {NULL, NULL}
+
 #ifdef CONFIG_PRIORITY_INHERITANCE
 # if CONFIG_SEM_PREALLOCHOLDERS > 0
-#  define SEM_INITIALIZER(c) {(c), NULL}  /* semcount, hhead */
+   /* semcount, holder, hhead, waitlist */
+#  define SEM_INITIALIZER(c) \
+     {(c), SEMHOLDER_INITIALIZER, NULL, SEM_WAITLIST_INITIALIZER}
 # else
-#  define SEM_INITIALIZER(c) {(c), SEMHOLDER_INITIALIZER} /* semcount, holder */
+   /* semcount, holder, waitlist */
+#  define SEM_INITIALIZER(c) \
+     {(c), SEMHOLDER_INITIALIZER, SEM_WAITLIST_INITIALIZER}
 # endif
 #else
-#  define SEM_INITIALIZER(c) {(c)} /* semcount */
+   /* semcount, waitlist */
+#  define SEM_INITIALIZER(c) {(c), SEM_WAITLIST_INITIALIZER}
 #endif
 
 /****************************************************************************
@@ -94,6 +94,13 @@ struct mallinfo
                  * chunks handed out by malloc. */
   int fordblks; /* This is the total size of memory occupied
                  * by free (not in use) chunks.*/
+#ifdef CONFIG_MM_FASTBINS
+  int smblks;   /* This is the number of free chunks held in the
+                 * fast bins (included in ordblks). */
+  int fsmblks;  /* This is the total size of memory occupied by
+                 * free chunks in the fast bins (included in
+                 * fordblks). */
+#endif
 };
 
 /****************************************************************************
@@ -164,7 +164,13 @@ int mlockall(int flags);
 FAR void *mmap(FAR void *start, size_t length, int prot, int flags, int fd,
                off_t offset);
 int mprotect(FAR void *addr, size_t len, int prot);
+
+#ifdef CONFIG_FS_RAMMAP
 int msync(FAR void *addr, size_t len, int flags);
+#else
+#  define msync(addr, len, flags) (0)
+#endif
+
 int munlock(FAR const void *addr, size_t len);
 int munlockall(void);
 
@@ -174,7 +180,12 @@ int munmap(FAR void *start, size_t length);
 #  define munmap(start, length)
 #endif
 
+#ifdef CONFIG_FS_RAMMAP
 int posix_madvise(FAR void *addr, size_t len, int advice);
+#else
+#  define posix_madvise(addr, len, advice) (0)
+#endif
+
 int posix_mem_offset(FAR const void *addr, size_t len, FAR off_t *off,
                      FAR size_t *contig_len, FAR int *fildes);
 int posix_typed_mem_get_info(int fildes, FAR struct posix_typed_mem_info *info);
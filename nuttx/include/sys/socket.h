@@ -41,6 +41,7 @@
  ****************************************************************************/
 
 #include <sys/types.h>
+#include <sys/uio.h>
 
 /****************************************************************************
  * Definitions
@@ -115,6 +116,7 @@
 #define MSG_ERRQUEUE   0x2000 /* Fetch message from error queue.  */
 #define MSG_NOSIGNAL   0x4000 /* Do not generate SIGPIPE.  */
 #define MSG_MORE       0x8000 /* Sender will send more.  */
+#define MSG_WAITFORONE 0x10000 /* recvmmsg(): Block only for the first message */
 
 /* Socket options */
 
@@ -150,6 +152,8 @@
 #define SO_SNDTIMEO    15 /* Sets the timeout value specifying the amount of time that an
                            * output function blocks because flow control prevents data from
                            * being sent(get/set). arg: struct timeval */
+#define SO_REUSEPORT   16 /* Allow reuse of local port numbers (get/set)
+                           * arg: pointer to integer containing a boolean value */
 
 /* Protocol levels supported by get/setsockopt(): */
 
@@ -199,6 +203,32 @@ struct linger
   int  l_linger;  /* Linger time, in seconds. */
 };
 
+/* Used with sendmsg() and recvmsg() to describe a message assembled from,
+ * or scattered into, several buffers.  Ancillary data is not supported:
+ * msg_controllen is always returned as zero.
+ */
+
+struct msghdr
+{
+  FAR void         *msg_name;       /* Optional address */
+  socklen_t         msg_namelen;    /* Size of address */
+  FAR struct iovec *msg_iov;        /* Scatter/gather array */
+  int               msg_iovlen;     /* Number of elements in msg_iov */
+  FAR void         *msg_control;    /* Ancillary data (unused) */
+  socklen_t         msg_controllen; /* Ancillary data buffer length */
+  int               msg_flags;      /* Flags on received message */
+};
+
+/* Used with sendmmsg() and recvmmsg() to transfer several messages in one
+ * call.
+ */
+
+struct mmsghdr
+{
+  struct msghdr msg_hdr;            /* Message header */
+  unsigned int  msg_len;            /* Number of bytes transferred */
+};
+
 /****************************************************************************
  * Public Function Prototypes
  ****************************************************************************/
@@ -227,6 +257,15 @@ ssize_t recv(int sockfd, FAR void *buf, size_t len, int flags);
 ssize_t recvfrom(int sockfd, FAR void *buf, size_t len, int flags,
                  FAR struct sockaddr *from, FAR socklen_t *fromlen);
 
+ssize_t sendmsg(int sockfd, FAR const struct msghdr *msg, int flags);
+ssize_t recvmsg(int sockfd, FAR struct msghdr *msg, int flags);
+
+struct timespec; /* Forward reference */
+int sendmmsg(int sockfd, FAR struct mmsghdr *msgvec, unsigned int vlen,
+             int flags);
+int recvmmsg(int sockfd, FAR struct mmsghdr *msgvec, unsigned int vlen,
+             int flags, FAR struct timespec *timeout);
+
 int setsockopt(int sockfd, int level, int option,
                FAR const void *value, socklen_t value_len);
 int getsockopt(int sockfd, int level, int option,
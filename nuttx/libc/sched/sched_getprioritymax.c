@@ -89,7 +89,11 @@
 
 int sched_get_priority_max(int policy)
 {
-  if (policy != SCHED_FIFO && policy != SCHED_RR)
+  if (policy != SCHED_FIFO && policy != SCHED_RR
+#ifdef CONFIG_SCHED_SPORADIC
+      && policy != SCHED_SPORADIC
+#endif
+     )
     {
       return ERROR;
     }
@@ -43,8 +43,11 @@
 
 #include <nuttx/config.h>
 #include <sys/types.h>
+#include <stdint.h>
 #include <string.h>
 
+#include "lib_memcopy.h"
+
 /************************************************************
  * Global Functions
  ************************************************************/
@@ -55,6 +58,48 @@ int memcmp(FAR const void *s1, FAR const void *s2, size_t n)
   unsigned char *p1 = (unsigned char *)s1;
   unsigned char *p2 = (unsigned char *)s2;
 
+#ifdef CONFIG_MEMCPY_OPTSPEED
+  /* If both buffers have the same alignment, skip over equal words once
+   * the buffers are word aligned.  The first differing word, if any, is
+   * then resolved by the byte loop below.
+   */
+
+  if (n >= LIB_MINWORDCOPY &&
+      (((uintptr_t)p1 ^ (uintptr_t)p2) & LIB_WORDMASK) == 0)
+    {
+      while (((uintptr_t)p1 & LIB_WORDMASK) != 0)
+        {
+          if (*p1 != *p2)
+            {
+              return *p1 < *p2 ? -1 : 1;
+            }
+
+          p1++;
+          p2++;
+          n--;
+        }
+
+      while (n >= 4 * LIB_WORDSIZE &&
+             ((FAR uintptr_t *)p1)[0] == ((FAR uintptr_t *)p2)[0] &&
+             ((FAR uintptr_t *)p1)[1] == ((FAR uintptr_t *)p2)[1] &&
+             ((FAR uintptr_t *)p1)[2] == ((FAR uintptr_t *)p2)[2] &&
+             ((FAR uintptr_t *)p1)[3] == ((FAR uintptr_t *)p2)[3])
+        {
+          p1 += 4 * LIB_WORDSIZE;
+          p2 += 4 * LIB_WORDSIZE;
+          n  -= 4 * LIB_WORDSIZE;
+        }
+
+      while (n >= LIB_WORDSIZE &&
+             *(FAR uintptr_t *)p1 == *(FAR uintptr_t *)p2)
+        {
+          p1 += LIB_WORDSIZE;
+          p2 += LIB_WORDSIZE;
+          n  -= LIB_WORDSIZE;
+        }
+    }
+#endif
+
   while (n-- > 0)
     {
       if (*p1 < *p2)
@@ -0,0 +1,283 @@
+/****************************************************************************
+ * libc/string/lib_memcopy.h
+ *
+ *   Copyright (C) 2014 Gregory Nutt. All rights reserved.
+ *   Author: Gregory Nutt <gnutt@nuttx.org>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name NuttX nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+#ifndef __LIBC_STRING_LIB_MEMCOPY_H
+#define __LIBC_STRING_LIB_MEMCOPY_H
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <sys/types.h>
+#include <stdint.h>
+
+#ifdef CONFIG_MEMCPY_OPTSPEED
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+/* The speed-optimized memory functions work on native machine words: 64-bit
+ * words on 64-bit platforms (such as the simulator on a 64-bit host) and
+ * 32-bit words otherwise.  All word accesses are aligned so these functions
+ * are safe on architectures that do not support unaligned accesses.
+ */
+
+#define LIB_WORDSIZE   sizeof(uintptr_t)
+#define LIB_WORDMASK   (LIB_WORDSIZE - 1)
+#define LIB_WORDBITS   (8 * LIB_WORDSIZE)
+
+/* Copies smaller than this are done a byte at a time */
+
+#define LIB_MINWORDCOPY (2 * LIB_WORDSIZE)
+
+/* Merge two adjacent, aligned source words into the destination word that
+ * begins 'shift' bits into the first one.  'lo' is the word at the lower
+ * address.
+ */
+
+#ifdef CONFIG_ENDIAN_BIG
+#  define LIB_MERGE(lo,hi,shift) \
+     (((lo) << (shift)) | ((hi) >> (LIB_WORDBITS - (shift))))
+#else
+#  define LIB_MERGE(lo,hi,shift) \
+     (((lo) >> (shift)) | ((hi) << (LIB_WORDBITS - (shift))))
+#endif
+
+/****************************************************************************
+ * Inline Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: lib_copyfwd
+ *
+ * Description:
+ *   Copy 'n' bytes from 'src' to 'dest', lowest address first.  This is
+ *   safe for overlapping regions if 'dest' is below 'src'.
+ *
+ *   The destination is first aligned to a word boundary.  If the source is
+ *   then also aligned, words are copied four at a time.  Otherwise, each
+ *   destination word is assembled from two aligned source words.  The
+ *   aligned source loads may read a few bytes beyond the end of the source
+ *   region, but never beyond the word that holds its last byte.
+ *
+ ****************************************************************************/
+
+static inline void lib_copyfwd(FAR uint8_t *pout, FAR const uint8_t *pin,
+                               size_t n)
+{
+  FAR uintptr_t *wout;
+  FAR const uintptr_t *win;
+  uintptr_t w0;
+  uintptr_t w1;
+  unsigned int shift;
+
+  if (n >= LIB_MINWORDCOPY)
+    {
+      /* Align the destination to a word boundary */
+
+      while (((uintptr_t)pout & LIB_WORDMASK) != 0)
+        {
+          *pout++ = *pin++;
+          n--;
+        }
+
+      wout  = (FAR uintptr_t *)pout;
+      shift = (unsigned int)((uintptr_t)pin & LIB_WORDMASK);
+
+      if (shift == 0)
+        {
+          /* Both are aligned.  Copy four words per iteration. */
+
+          win = (FAR const uintptr_t *)pin;
+          while (n >= 4 * LIB_WORDSIZE)
+            {
+              w0      = win[0];
+              w1      = win[1];
+              wout[0] = w0;
+              wout[1] = w1;
+              w0      = win[2];
+              w1      = win[3];
+              wout[2] = w0;
+              wout[3] = w1;
+              win    += 4;
+              wout   += 4;
+              n      -= 4 * LIB_WORDSIZE;
+            }
+
+          while (n >= LIB_WORDSIZE)
+            {
+              *wout++ = *win++;
+              n      -= LIB_WORDSIZE;
+            }
+
+          pin = (FAR const uint8_t *)win;
+        }
+      else
+        {
+          /* The source is misaligned.  Shift and merge aligned source
+           * words.
+           */
+
+          win    = (FAR const uintptr_t *)(pin - shift);
+          pin   += n & ~LIB_WORDMASK;
+          shift *= 8;
+
+          w0 = *win++;
+          while (n >= 2 * LIB_WORDSIZE)
+            {
+              w1      = win[0];
+              wout[0] = LIB_MERGE(w0, w1, shift);
+              w0      = win[1];
+              wout[1] = LIB_MERGE(w1, w0, shift);
+              win    += 2;
+              wout   += 2;
+              n      -= 2 * LIB_WORDSIZE;
+            }
+
+          if (n >= LIB_WORDSIZE)
+            {
+              w1      = *win;
+              *wout++ = LIB_MERGE(w0, w1, shift);
+              n      -= LIB_WORDSIZE;
+            }
+        }
+
+      pout = (FAR uint8_t *)wout;
+    }
+
+  /* Copy any remaining bytes */
+
+  while (n-- > 0)
+    {
+      *pout++ = *pin++;
+    }
+}
+
+/****************************************************************************
+ * Name: lib_copybwd
+ *
+ * Description:
+ *   Copy 'n' bytes ending just below 'pout' from the bytes ending just
+ *   below 'pin', highest address first.  This is safe for overlapping
+ *   regions if the destination is above the source.
+ *
+ ****************************************************************************/
+
+static inline void lib_copybwd(FAR uint8_t *pout, FAR const uint8_t *pin,
+                               size_t n)
+{
+  FAR uintptr_t *wout;
+  FAR const uintptr_t *win;
+  uintptr_t w0;
+  uintptr_t w1;
+  unsigned int shift;
+
+  if (n >= LIB_MINWORDCOPY)
+    {
+      /* Align the end of the destination to a word boundary */
+
+      while (((uintptr_t)pout & LIB_WORDMASK) != 0)
+        {
+          *--pout = *--pin;
+          n--;
+        }
+
+      wout  = (FAR uintptr_t *)pout;
+      shift = (unsigned int)((uintptr_t)pin & LIB_WORDMASK);
+
+      if (shift == 0)
+        {
+          /* Both are aligned.  Copy four words per iteration. */
+
+          win = (FAR const uintptr_t *)pin;
+          while (n >= 4 * LIB_WORDSIZE)
+            {
+              win    -= 4;
+              wout   -= 4;
+              w0      = win[3];
+              w1      = win[2];
+              wout[3] = w0;
+              wout[2] = w1;
+              w0      = win[1];
+              w1      = win[0];
+              wout[1] = w0;
+              wout[0] = w1;
+              n      -= 4 * LIB_WORDSIZE;
+            }
+
+          while (n >= LIB_WORDSIZE)
+            {
+              *--wout = *--win;
+              n      -= LIB_WORDSIZE;
+            }
+
+          pin = (FAR const uint8_t *)win;
+        }
+      else
+        {
+          /* The source is misaligned.  Shift and merge aligned source
+           * words, starting with the word that holds the last source byte.
+           */
+
+          win    = (FAR const uintptr_t *)(pin - shift);
+          pin   -= n & ~LIB_WORDMASK;
+          shift *= 8;
+
+          w1 = *win;
+          while (n >= LIB_WORDSIZE)
+            {
+              w0      = *--win;
+              *--wout = LIB_MERGE(w0, w1, shift);
+              w1      = w0;
+              n      -= LIB_WORDSIZE;
+            }
+        }
+
+      pout = (FAR uint8_t *)wout;
+    }
+
+  /* Copy any remaining bytes */
+
+  while (n-- > 0)
+    {
+      *--pout = *--pin;
+    }
+}
+
+#endif /* CONFIG_MEMCPY_OPTSPEED */
+#endif /* __LIBC_STRING_LIB_MEMCOPY_H */
@@ -43,8 +43,11 @@
 
 #include <nuttx/config.h>
 #include <sys/types.h>
+#include <stdint.h>
 #include <string.h>
 
+#include "lib_memcopy.h"
+
 /****************************************************************************
  * Global Functions
  ****************************************************************************/
@@ -56,9 +59,17 @@
 #ifndef CONFIG_ARCH_MEMCPY
 FAR void *memcpy(FAR void *dest, FAR const void *src, size_t n)
 {
+#ifdef CONFIG_MEMCPY_OPTSPEED
+  /* This version is optimized for speed:  It copies a word at a time */
+
+  lib_copyfwd((FAR uint8_t *)dest, (FAR const uint8_t *)src, n);
+#else
+  /* This version is optimized for size */
+
   FAR unsigned char *pout = (FAR unsigned char*)dest;
   FAR unsigned char *pin  = (FAR unsigned char*)src;
   while (n-- > 0) *pout++ = *pin++;
+#endif
   return dest;
 }
 #endif
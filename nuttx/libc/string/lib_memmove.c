@@ -43,8 +43,11 @@
 
 #include <nuttx/config.h>
 #include <sys/types.h>
+#include <stdint.h>
 #include <string.h>
 
+#include "lib_memcopy.h"
+
 /************************************************************
  * Global Functions
  ************************************************************/
@@ -52,6 +55,21 @@
 #ifndef CONFIG_ARCH_MEMMOVE
 FAR void *memmove(FAR void *dest, FAR const void *src, size_t count)
 {
+#ifdef CONFIG_MEMCPY_OPTSPEED
+  /* This version is optimized for speed:  It copies a word at a time in
+   * whichever direction is safe for the overlap.
+   */
+
+  if (dest <= src)
+    {
+      lib_copyfwd((FAR uint8_t *)dest, (FAR const uint8_t *)src, count);
+    }
+  else
+    {
+      lib_copybwd((FAR uint8_t *)dest + count,
+                  (FAR const uint8_t *)src + count, count);
+    }
+#else
   char *tmp, *s;
   if (dest <= src)
     {
@@ -71,6 +89,7 @@ FAR void *memmove(FAR void *dest, FAR const void *src, size_t count)
 	  *--tmp = *--s;
         }
     }
+#endif
 
   return dest;
 }
@@ -0,0 +1,422 @@
+/****************************************************************************
+ * mm/mempool/mempool.c
+ *
+ *   Copyright (C) 2014 Gregory Nutt. All rights reserved.
+ *   Author: Gregory Nutt <gnutt@nuttx.org>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name NuttX nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <stdint.h>
+#include <semaphore.h>
+#include <sched.h>
+#include <assert.h>
+#include <errno.h>
+#include <debug.h>
+
+#include <arch/irq.h>
+#include <nuttx/arch.h>
+#include <nuttx/kmalloc.h>
+#include <nuttx/mm/mempool.h>
+
+#ifdef CONFIG_MM_MEMPOOL
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+/* Blocks are aligned so that a pointer may be held in the first word */
+
+#define MEMPOOL_ALIGN_MASK  (sizeof(uintptr_t) - 1)
+#define MEMPOOL_ALIGN_UP(a) (((a) + MEMPOOL_ALIGN_MASK) & ~MEMPOOL_ALIGN_MASK)
+
+/* Debug */
+
+#ifdef CONFIG_CPP_HAVE_VARARGS
+#  ifdef CONFIG_DEBUG_MEMPOOL
+#    define mempooldbg(format, ...)    dbg(format, ##__VA_ARGS__)
+#  else
+#    define mempooldbg(format, ...)    mdbg(format, ##__VA_ARGS__)
+#  endif
+#else
+#  ifdef CONFIG_DEBUG_MEMPOOL
+#    define mempooldbg                 dbg
+#  else
+#    define mempooldbg                 (void)
+#  endif
+#endif
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+/* The list of all initialized pools.  Modified only with pre-emption
+ * disabled.
+ */
+
+static FAR struct mempool_s *g_mempools;
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: mempool_take
+ *
+ * Description:
+ *   Remove the block at the head of the free list and update the usage
+ *   statistics.  Interrupts must be disabled.
+ *
+ ****************************************************************************/
+
+static inline FAR void *mempool_take(FAR struct mempool_s *pool)
+{
+  FAR struct mempool_blk_s *blk;
+  uint16_t nused;
+
+  blk = pool->freelist;
+  if (blk)
+    {
+      pool->freelist = blk->flink;
+      pool->nfree--;
+
+      nused = pool->nblocks - pool->nfree;
+      if (nused > pool->maxused)
+        {
+          pool->maxused = nused;
+        }
+    }
+  else
+    {
+      pool->nfail++;
+    }
+
+  return blk;
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: mempool_initialize
+ *
+ * Description:
+ *   Set up a pool of 'nblocks' blocks of 'blocksize' bytes each.  See
+ *   include/nuttx/mm/mempool.h.
+ *
+ ****************************************************************************/
+
+int mempool_initialize(FAR struct mempool_s *pool, FAR const char *name,
+                       FAR void *pool_start, size_t blocksize,
+                       unsigned int nblocks, bool wait)
+{
+  FAR struct mempool_blk_s *blk;
+  FAR uint8_t *next;
+  unsigned int i;
+
+  DEBUGASSERT(pool && name);
+
+  if (nblocks < 1 || nblocks > UINT16_MAX || blocksize < 1)
+    {
+      return -EINVAL;
+    }
+
+  /* Every block must be able to hold the free list link */
+
+  if (blocksize < sizeof(struct mempool_blk_s))
+    {
+      blocksize = sizeof(struct mempool_blk_s);
+    }
+
+  blocksize = MEMPOOL_ALIGN_UP(blocksize);
+
+  /* Allocate the block storage if the caller did not provide it */
+
+  pool->heapmem = NULL;
+  if (!pool_start)
+    {
+      pool_start = kmm_malloc(blocksize * nblocks);
+      if (!pool_start)
+        {
+          mempooldbg("ERROR: Failed to allocate %u blocks for %s\n",
+                     nblocks, name);
+          return -ENOMEM;
+        }
+
+      pool->heapmem = pool_start;
+    }
+
+  DEBUGASSERT(((uintptr_t)pool_start & MEMPOOL_ALIGN_MASK) == 0);
+
+  /* Thread all of the blocks into the free list in address order */
+
+  next = (FAR uint8_t *)pool_start;
+  pool->freelist = (FAR struct mempool_blk_s *)next;
+
+  for (i = 1; i < nblocks; i++)
+    {
+      blk   = (FAR struct mempool_blk_s *)next;
+      next += blocksize;
+      blk->flink = (FAR struct mempool_blk_s *)next;
+    }
+
+  ((FAR struct mempool_blk_s *)next)->flink = NULL;
+
+  pool->name      = name;
+  pool->blocksize = blocksize;
+  pool->nblocks   = nblocks;
+  pool->nfree     = nblocks;
+  pool->maxused   = 0;
+  pool->nfail     = 0;
+  pool->wait      = wait;
+
+  /* The semaphore counts the free blocks when allocations may wait */
+
+  if (wait)
+    {
+      sem_init(&pool->sem, 0, nblocks);
+    }
+
+  /* Add the pool to the list of all pools */
+
+  sched_lock();
+  pool->flink = g_mempools;
+  g_mempools  = pool;
+  sched_unlock();
+
+  return OK;
+}
+
+/****************************************************************************
+ * Name: mempool_release
+ *
+ * Description:
+ *   Remove the pool from the list of pools and free any heap memory that
+ *   mempool_initialize() allocated for it.
+ *
+ ****************************************************************************/
+
+void mempool_release(FAR struct mempool_s *pool)
+{
+  FAR struct mempool_s *prev;
+  FAR struct mempool_s *curr;
+
+  DEBUGASSERT(pool && pool->nfree == pool->nblocks);
+
+  sched_lock();
+  for (prev = NULL, curr = g_mempools;
+       curr && curr != pool;
+       prev = curr, curr = curr->flink);
+
+  if (curr)
+    {
+      if (prev)
+        {
+          prev->flink = pool->flink;
+        }
+      else
+        {
+          g_mempools = pool->flink;
+        }
+    }
+
+  sched_unlock();
+
+  if (pool->wait)
+    {
+      sem_destroy(&pool->sem);
+    }
+
+  if (pool->heapmem)
+    {
+      kmm_free(pool->heapmem);
+      pool->heapmem = NULL;
+    }
+
+  pool->freelist = NULL;
+  pool->nblocks  = 0;
+  pool->nfree    = 0;
+}
+
+/****************************************************************************
+ * Name: mempool_tryalloc
+ *
+ * Description:
+ *   Take a block from the pool without waiting.  This may be called from
+ *   interrupt handlers.
+ *
+ ****************************************************************************/
+
+FAR void *mempool_tryalloc(FAR struct mempool_s *pool)
+{
+  FAR void *blk = NULL;
+  irqstate_t flags;
+
+  DEBUGASSERT(pool);
+
+  /* We don't know what context we are called from so we use extreme
+   * measures to protect the free list:  We disable interrupts very
+   * briefly.
+   */
+
+  flags = irqsave();
+  if (!pool->wait)
+    {
+      blk = mempool_take(pool);
+    }
+
+  /* Blocks counted by the semaphore may already be promised to waiting
+   * tasks, so only take one if the count is positive.  We cannot call
+   * sem_trywait() because we may be called from an interrupt handler,
+   * but a simple decrement is all that is needed.
+   */
+
+  else if (pool->sem.semcount > 0)
+    {
+      pool->sem.semcount--;
+      blk = mempool_take(pool);
+      DEBUGASSERT(blk);
+    }
+  else
+    {
+      pool->nfail++;
+    }
+
+  irqrestore(flags);
+  return blk;
+}
+
+/****************************************************************************
+ * Name: mempool_alloc
+ *
+ * Description:
+ *   Take a block from the pool, waiting for one to be freed if the pool
+ *   permits it and we are not in an interrupt handler.
+ *
+ ****************************************************************************/
+
+FAR void *mempool_alloc(FAR struct mempool_s *pool)
+{
+  FAR void *blk;
+  irqstate_t flags;
+  int ret;
+
+  DEBUGASSERT(pool);
+
+  if (!pool->wait || up_interrupt_context())
+    {
+      return mempool_tryalloc(pool);
+    }
+
+  /* Each count of the semaphore reserves one block on the free list.
+   * Once we hold a count, no other allocation (including one from an
+   * interrupt handler) can take our block.
+   */
+
+  ret = sem_wait(&pool->sem);
+  if (ret < 0)
+    {
+      mempooldbg("ERROR: Wait for %s interrupted\n", pool->name);
+      return NULL;
+    }
+
+  flags = irqsave();
+  blk = mempool_take(pool);
+  irqrestore(flags);
+
+  DEBUGASSERT(blk);
+  return blk;
+}
+
+/****************************************************************************
+ * Name: mempool_free
+ *
+ * Description:
+ *   Return a block to the pool.  This may be called from interrupt
+ *   handlers.
+ *
+ ****************************************************************************/
+
+void mempool_free(FAR struct mempool_s *pool, FAR void *blk)
+{
+  FAR struct mempool_blk_s *node = (FAR struct mempool_blk_s *)blk;
+  irqstate_t flags;
+
+  DEBUGASSERT(pool && blk && pool->nfree < pool->nblocks);
+
+  flags = irqsave();
+  node->flink    = pool->freelist;
+  pool->freelist = node;
+  pool->nfree++;
+
+  /* Make the block available to any task waiting for one */
+
+  if (pool->wait)
+    {
+      sem_post(&pool->sem);
+    }
+
+  irqrestore(flags);
+}
+
+/****************************************************************************
+ * Name: mempool_foreach
+ *
+ * Description:
+ *   Call 'handler' for each initialized pool until it returns a non-zero
+ *   value.
+ *
+ ****************************************************************************/
+
+int mempool_foreach(mempool_handler_t handler, FAR void *arg)
+{
+  FAR struct mempool_s *pool;
+  int ret = 0;
+
+  DEBUGASSERT(handler);
+
+  sched_lock();
+  for (pool = g_mempools; pool && ret == 0; pool = pool->flink)
+    {
+      ret = handler(pool, arg);
+    }
+
+  sched_unlock();
+  return ret;
+}
+
+#endif /* CONFIG_MM_MEMPOOL */
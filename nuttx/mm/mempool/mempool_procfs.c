@@ -0,0 +1,341 @@
+/****************************************************************************
+ * mm/mempool/mempool_procfs.c
+ *
+ *   Copyright (C) 2014 Gregory Nutt. All rights reserved.
+ *   Author: Gregory Nutt <gnutt@nuttx.org>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name NuttX nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <sys/types.h>
+#include <sys/stat.h>
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+#include <fcntl.h>
+#include <assert.h>
+#include <errno.h>
+#include <debug.h>
+
+#include <nuttx/kmalloc.h>
+#include <nuttx/fs/fs.h>
+#include <nuttx/fs/procfs.h>
+#include <nuttx/mm/mempool.h>
+
+#if defined(CONFIG_MM_MEMPOOL) && defined(CONFIG_FS_PROCFS) && \
+   !defined(CONFIG_FS_PROCFS_EXCLUDE_MEMPOOL)
+
+/****************************************************************************
+ * Private Types
+ ****************************************************************************/
+/* This structure describes one open "file" */
+
+struct mempool_file_s
+{
+  struct procfs_file_s base;   /* Base open file structure */
+  unsigned int next;           /* Index of the next pool to report */
+};
+
+/* This describes the progress of one read() */
+
+struct mempool_read_s
+{
+  FAR struct mempool_file_s *priv; /* The open file */
+  FAR char *buffer;                /* User buffer */
+  size_t buflen;                   /* Size of the user buffer */
+  size_t total;                    /* Number of bytes in the user buffer */
+  unsigned int index;              /* Index of the current pool */
+};
+
+/****************************************************************************
+ * Private Function Prototypes
+ ****************************************************************************/
+/* File system methods */
+
+static int     mempool_open(FAR struct file *filep, FAR const char *relpath,
+                 int oflags, mode_t mode);
+static int     mempool_close(FAR struct file *filep);
+static ssize_t mempool_read(FAR struct file *filep, FAR char *buffer,
+                 size_t buflen);
+
+static int     mempool_dup(FAR const struct file *oldp,
+                 FAR struct file *newp);
+
+static int     mempool_stat(FAR const char *relpath, FAR struct stat *buf);
+
+/****************************************************************************
+ * Public Variables
+ ****************************************************************************/
+
+/* See fs/procfs/fs_procfs.c -- this structure is explicitly externed there.
+ * We use the old-fashioned kind of initializers so that this will compile
+ * with any compiler.
+ */
+
+const struct procfs_operations mempool_procfsoperations =
+{
+  mempool_open,   /* open */
+  mempool_close,  /* close */
+  mempool_read,   /* read */
+  NULL,           /* write */
+
+  mempool_dup,    /* dup */
+
+  NULL,           /* opendir */
+  NULL,           /* closedir */
+  NULL,           /* readdir */
+  NULL,           /* rewinddir */
+
+  mempool_stat    /* stat */
+};
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: mempool_line
+ *
+ * Description:
+ *   mempool_foreach() callback that formats one line for each pool not
+ *   yet reported.  Returns non-zero when the user buffer is full.
+ *
+ ****************************************************************************/
+
+static int mempool_line(FAR struct mempool_s *pool, FAR void *arg)
+{
+  FAR struct mempool_read_s *info = (FAR struct mempool_read_s *)arg;
+  size_t remaining;
+  int ret;
+
+  /* Skip over the pools that were reported by earlier reads */
+
+  if (info->index++ < info->priv->next)
+    {
+      return 0;
+    }
+
+  remaining = info->buflen - info->total;
+  ret = snprintf(&info->buffer[info->total], remaining,
+                 "%-12s %8lu %6u %6u %6u %6u\n", pool->name,
+                 (unsigned long)pool->blocksize, pool->nblocks,
+                 pool->nfree, pool->maxused, pool->nfail);
+
+  if (ret < 0 || ret >= remaining)
+    {
+      /* It did not fit.  Discard the partial line and try again on the
+       * next read.
+       */
+
+      info->buffer[info->total] = '\0';
+      return 1;
+    }
+
+  info->total += ret;
+  info->priv->next++;
+  return 0;
+}
+
+/****************************************************************************
+ * Name: mempool_open
+ ****************************************************************************/
+
+static int mempool_open(FAR struct file *filep, FAR const char *relpath,
+                        int oflags, mode_t mode)
+{
+  FAR struct mempool_file_s *attr;
+
+  fvdbg("Open '%s'\n", relpath);
+
+  /* PROCFS is read-only.  Any attempt to open with any kind of write
+   * access is not permitted.
+   */
+
+  if ((oflags & O_WRONLY) != 0 || (oflags & O_RDONLY) == 0)
+    {
+      fdbg("ERROR: Only O_RDONLY supported\n");
+      return -EACCES;
+    }
+
+  /* Allocate a context structure */
+
+  attr = (FAR struct mempool_file_s *)
+    kmm_zalloc(sizeof(struct mempool_file_s));
+
+  if (!attr)
+    {
+      fdbg("ERROR: Failed to allocate file attributes\n");
+      return -ENOMEM;
+    }
+
+  /* Save the context as the open-specific state in filep->f_priv */
+
+  filep->f_priv = (FAR void *)attr;
+  return OK;
+}
+
+/****************************************************************************
+ * Name: mempool_close
+ ****************************************************************************/
+
+static int mempool_close(FAR struct file *filep)
+{
+  FAR struct mempool_file_s *attr;
+
+  /* Recover our private data from the struct file instance */
+
+  attr = (FAR struct mempool_file_s *)filep->f_priv;
+  DEBUGASSERT(attr);
+
+  /* Release the file attributes structure */
+
+  kmm_free(attr);
+  filep->f_priv = NULL;
+  return OK;
+}
+
+/****************************************************************************
+ * Name: mempool_read
+ ****************************************************************************/
+
+static ssize_t mempool_read(FAR struct file *filep, FAR char *buffer,
+                            size_t buflen)
+{
+  struct mempool_read_s info;
+  int ret;
+
+  fvdbg("buffer=%p buflen=%d\n", buffer, (int)buflen);
+
+  /* Recover our private data from the struct file instance */
+
+  info.priv   = (FAR struct mempool_file_s *)filep->f_priv;
+  info.buffer = buffer;
+  info.buflen = buflen;
+  info.total  = 0;
+  info.index  = 0;
+  DEBUGASSERT(info.priv);
+
+  /* Output a header before the first entry */
+
+  if (filep->f_pos == 0)
+    {
+      ret = snprintf(buffer, buflen, "%-12s %8s %6s %6s %6s %6s\n",
+                     "Name", "Blksize", "Total", "Free", "Hiwat", "Fail");
+
+      if (ret < 0 || ret >= buflen)
+        {
+          return 0;
+        }
+
+      info.total = ret;
+    }
+
+  /* Then one line for each pool that has not yet been reported */
+
+  (void)mempool_foreach(mempool_line, &info);
+
+  /* Update the file offset */
+
+  if (info.total > 0)
+    {
+      filep->f_pos += info.total;
+    }
+
+  return info.total;
+}
+
+/****************************************************************************
+ * Name: mempool_dup
+ *
+ * Description:
+ *   Duplicate open file data in the new file structure.
+ *
+ ****************************************************************************/
+
+static int mempool_dup(FAR const struct file *oldp, FAR struct file *newp)
+{
+  FAR struct mempool_file_s *oldattr;
+  FAR struct mempool_file_s *newattr;
+
+  fvdbg("Dup %p->%p\n", oldp, newp);
+
+  /* Recover our private data from the old struct file instance */
+
+  oldattr = (FAR struct mempool_file_s *)oldp->f_priv;
+  DEBUGASSERT(oldattr);
+
+  /* Allocate a new container to hold the task and attribute selection */
+
+  newattr = (FAR struct mempool_file_s *)
+    kmm_zalloc(sizeof(struct mempool_file_s));
+
+  if (!newattr)
+    {
+      fdbg("ERROR: Failed to allocate file attributes\n");
+      return -ENOMEM;
+    }
+
+  /* The copy the file attributes from the old attributes to the new */
+
+  memcpy(newattr, oldattr, sizeof(struct mempool_file_s));
+
+  /* Save the new attributes in the new file structure */
+
+  newp->f_priv = (FAR void *)newattr;
+  return OK;
+}
+
+/****************************************************************************
+ * Name: mempool_stat
+ *
+ * Description: Return information about a file or directory
+ *
+ ****************************************************************************/
+
+static int mempool_stat(const char *relpath, struct stat *buf)
+{
+  /* File/directory size, access block size */
+
+  buf->st_mode    = S_IFREG|S_IROTH|S_IRGRP|S_IRUSR;
+  buf->st_size    = 0;
+  buf->st_blksize = 0;
+  buf->st_blocks  = 0;
+  return OK;
+}
+
+#endif /* CONFIG_MM_MEMPOOL && CONFIG_FS_PROCFS */
@@ -117,11 +117,12 @@ void mm_extend(FAR struct mm_heap_s *heap, FAR void *mem, size_t size,
   newnode->preceding = oldnode->size | MM_ALLOC_BIT;
 
   heap->mm_heapend[region] = newnode;
-  mm_givesemaphore(heap);
 
   /* Finally "free" the new block of memory where the old terminal node was
-   * located.
+   * located.  This bypasses the fast bins so that the new block is merged
+   * with any free memory at the end of the region.
    */
 
-  mm_free(heap, (FAR void *)mem);
+  mm_freechunk(heap, (FAR struct mm_freenode_s *)oldnode);
+  mm_givesemaphore(heap);
 }
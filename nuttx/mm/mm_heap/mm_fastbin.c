@@ -0,0 +1,169 @@
+/****************************************************************************
+ * mm/mm_heap/mm_fastbin.c
+ *
+ *   Copyright (C) 2014 Gregory Nutt. All rights reserved.
+ *   Author: Gregory Nutt <gnutt@nuttx.org>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name NuttX nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <stdbool.h>
+#include <assert.h>
+
+#include <nuttx/mm/mm.h>
+
+#ifdef CONFIG_MM_FASTBINS
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+#ifndef NULL
+#  define NULL ((void*)0)
+#endif
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: mm_fastalloc
+ *
+ * Description:
+ *   Take a chunk of exactly 'size' bytes from the fast bins.  The size must
+ *   already include the allocated node header and be a multiple of the
+ *   granule size.  The caller must hold the MM semaphore.
+ *
+ * Returned Value:
+ *   The allocated memory or NULL if the matching fast bin is empty.
+ *
+ ****************************************************************************/
+
+FAR void *mm_fastalloc(FAR struct mm_heap_s *heap, size_t size)
+{
+  FAR struct mm_fastnode_s *node;
+  int ndx;
+
+  if (size > MM_FASTBIN_MAXCHUNK)
+    {
+      return NULL;
+    }
+
+  ndx  = MM_FASTBIN_NDX(size);
+  node = heap->mm_fastbin[ndx];
+  if (!node)
+    {
+      return NULL;
+    }
+
+  /* The chunk is still marked as allocated and has exactly this size */
+
+  DEBUGASSERT(node->size == size && (node->preceding & MM_ALLOC_BIT) != 0);
+
+  heap->mm_fastbin[ndx] = node->flink;
+  heap->mm_fastcount[ndx]--;
+
+  return (FAR void *)((FAR char *)node + SIZEOF_MM_ALLOCNODE);
+}
+
+/****************************************************************************
+ * Name: mm_fastfree
+ *
+ * Description:
+ *   Cache an allocated chunk in the fast bin for its size.  The chunk is
+ *   left marked as allocated.  The caller must hold the MM semaphore.
+ *
+ * Returned Value:
+ *   true if the chunk was cached; false if it is too large or the fast bin
+ *   is full and so the chunk must be returned to the heap.
+ *
+ ****************************************************************************/
+
+bool mm_fastfree(FAR struct mm_heap_s *heap, FAR struct mm_freenode_s *node)
+{
+  FAR struct mm_fastnode_s *fastnode = (FAR struct mm_fastnode_s *)node;
+  int ndx;
+
+  if (fastnode->size > MM_FASTBIN_MAXCHUNK)
+    {
+      return false;
+    }
+
+  ndx = MM_FASTBIN_NDX(fastnode->size);
+  if (heap->mm_fastcount[ndx] >= CONFIG_MM_FASTBIN_DEPTH)
+    {
+      return false;
+    }
+
+  fastnode->flink       = heap->mm_fastbin[ndx];
+  heap->mm_fastbin[ndx] = fastnode;
+  heap->mm_fastcount[ndx]++;
+  return true;
+}
+
+/****************************************************************************
+ * Name: mm_fastflush
+ *
+ * Description:
+ *   Return all chunks cached in the fast bins to the heap, merging them
+ *   with adjacent free chunks.  The caller must hold the MM semaphore.
+ *
+ * Returned Value:
+ *   The number of chunks returned to the heap.
+ *
+ ****************************************************************************/
+
+int mm_fastflush(FAR struct mm_heap_s *heap)
+{
+  FAR struct mm_fastnode_s *node;
+  int nflushed = 0;
+  int ndx;
+
+  for (ndx = 0; ndx < MM_NFASTBINS; ndx++)
+    {
+      while ((node = heap->mm_fastbin[ndx]) != NULL)
+        {
+          heap->mm_fastbin[ndx] = node->flink;
+          mm_freechunk(heap, (FAR struct mm_freenode_s *)node);
+          nflushed++;
+        }
+
+      heap->mm_fastcount[ndx] = 0;
+    }
+
+  return nflushed;
+}
+
+#endif /* CONFIG_MM_FASTBINS */
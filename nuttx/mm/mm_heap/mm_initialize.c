@@ -198,6 +198,13 @@ void mm_initialize(FAR struct mm_heap_s *heap, FAR void *heapstart,
       heap->mm_nodelist[i].blink   = &heap->mm_nodelist[i-1];
     }
 
+#ifdef CONFIG_MM_FASTBINS
+  /* The fast bins start out empty */
+
+  memset(heap->mm_fastbin, 0, sizeof(heap->mm_fastbin));
+  memset(heap->mm_fastcount, 0, sizeof(heap->mm_fastcount));
+#endif
+
   /* Initialize the malloc semaphore to one (to support one-at-
    * a-time access to private data sets).
    */
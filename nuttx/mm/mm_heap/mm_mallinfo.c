@@ -76,6 +76,12 @@ int mm_mallinfo(FAR struct mm_heap_s *heap, FAR struct mallinfo *info)
   int    ordblks  = 0;  /* Number of non-inuse chunks */
   size_t uordblks = 0;  /* Total allocated space */
   size_t fordblks = 0;  /* Total non-inuse space */
+#ifdef CONFIG_MM_FASTBINS
+  FAR struct mm_fastnode_s *fastnode;
+  int    smblks   = 0;  /* Number of chunks in the fast bins */
+  size_t fsmblks  = 0;  /* Total space in the fast bins */
+  int    ndx;
+#endif
 #if CONFIG_MM_REGIONS > 1
   int region;
 #else
@@ -129,6 +135,29 @@ int mm_mallinfo(FAR struct mm_heap_s *heap, FAR struct mallinfo *info)
     }
 #undef region
 
+#ifdef CONFIG_MM_FASTBINS
+  /* Chunks in the fast bins are marked as allocated but are really free */
+
+  mm_takesemaphore(heap);
+
+  for (ndx = 0; ndx < MM_NFASTBINS; ndx++)
+    {
+      for (fastnode = heap->mm_fastbin[ndx];
+           fastnode;
+           fastnode = fastnode->flink)
+        {
+          smblks++;
+          fsmblks += fastnode->size;
+        }
+    }
+
+  mm_givesemaphore(heap);
+
+  ordblks  += smblks;
+  uordblks -= fsmblks;
+  fordblks += fsmblks;
+#endif
+
   DEBUGASSERT(uordblks + fordblks == heap->mm_heapsize);
 
   info->arena    = heap->mm_heapsize;
@@ -136,5 +165,9 @@ int mm_mallinfo(FAR struct mm_heap_s *heap, FAR struct mallinfo *info)
   info->mxordblk = mxordblk;
   info->uordblks = uordblks;
   info->fordblks = fordblks;
+#ifdef CONFIG_MM_FASTBINS
+  info->smblks   = smblks;
+  info->fsmblks  = fsmblks;
+#endif
   return OK;
 }
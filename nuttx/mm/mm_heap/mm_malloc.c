@@ -69,43 +69,22 @@
  ****************************************************************************/
 
 /****************************************************************************
- * Public Functions
- ****************************************************************************/
-
-/****************************************************************************
- * Name: mm_malloc
+ * Name: mm_allocchunk
  *
  * Description:
- *  Find the smallest chunk that satisfies the request. Take the memory from
- *  that chunk, save the remaining, smaller chunk (if any).
- *
- *  8-byte alignment of the allocated data is assured.
+ *  Find the smallest free chunk of at least 'size' bytes, allocate it and
+ *  return any unused remainder to the heap.  The size must already include
+ *  the allocated node header and be a multiple of the granule size.  The
+ *  caller must hold the MM semaphore.
  *
  ****************************************************************************/
 
-FAR void *mm_malloc(FAR struct mm_heap_s *heap, size_t size)
+static FAR void *mm_allocchunk(FAR struct mm_heap_s *heap, size_t size)
 {
   FAR struct mm_freenode_s *node;
   void *ret = NULL;
   int ndx;
 
-  /* Handle bad sizes */
-
-  if (size <= 0)
-    {
-      return NULL;
-    }
-
-  /* Adjust the size to account for (1) the size of the allocated node and
-   * (2) to make sure that it is an even multiple of our granule size.
-   */
-
-  size = MM_ALIGN_UP(size + SIZEOF_MM_ALLOCNODE);
-
-  /* We need to hold the MM semaphore while we muck with the nodelist. */
-
-  mm_takesemaphore(heap);
-
   /* Get the location in the node list to start the search. Special case
    * really big allocations
    */
@@ -193,6 +172,64 @@ FAR void *mm_malloc(FAR struct mm_heap_s *heap, size_t size)
       ret = (void*)((char*)node + SIZEOF_MM_ALLOCNODE);
     }
 
+  return ret;
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: mm_malloc
+ *
+ * Description:
+ *  Find the smallest chunk that satisfies the request. Take the memory from
+ *  that chunk, save the remaining, smaller chunk (if any).
+ *
+ *  8-byte alignment of the allocated data is assured.
+ *
+ ****************************************************************************/
+
+FAR void *mm_malloc(FAR struct mm_heap_s *heap, size_t size)
+{
+  void *ret;
+
+  /* Handle bad sizes */
+
+  if (size <= 0)
+    {
+      return NULL;
+    }
+
+  /* Adjust the size to account for (1) the size of the allocated node and
+   * (2) to make sure that it is an even multiple of our granule size.
+   */
+
+  size = MM_ALIGN_UP(size + SIZEOF_MM_ALLOCNODE);
+
+  /* We need to hold the MM semaphore while we muck with the nodelist. */
+
+  mm_takesemaphore(heap);
+
+#ifdef CONFIG_MM_FASTBINS
+  /* Try the fast bins first.  If the heap cannot satisfy the request
+   * either, return the chunks held in the fast bins to the heap and try
+   * once more.
+   */
+
+  ret = mm_fastalloc(heap, size);
+  if (!ret)
+    {
+      ret = mm_allocchunk(heap, size);
+      if (!ret && mm_fastflush(heap) > 0)
+        {
+          ret = mm_allocchunk(heap, size);
+        }
+    }
+#else
+  ret = mm_allocchunk(heap, size);
+#endif
+
   mm_givesemaphore(heap);
 
   /* If CONFIG_DEBUG_MM is defined, then output the result of the allocation
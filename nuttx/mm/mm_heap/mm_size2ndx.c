@@ -59,7 +59,9 @@
 
 int mm_size2ndx(size_t size)
 {
+#ifndef CONFIG_HAVE_BUILTIN_CLZ
   int ndx = 0;
+#endif
 
   if (size >= MM_MAX_CHUNK)
     {
@@ -67,6 +69,20 @@ int mm_size2ndx(size_t size)
     }
 
   size >>= MM_MIN_SHIFT;
+
+#ifdef CONFIG_HAVE_BUILTIN_CLZ
+  /* The index is the position of the most significant bit set.  size is
+   * less than MM_MAX_CHUNK here and so fits in an unsigned int.
+   */
+
+  if (size <= 1)
+    {
+      return 0;
+    }
+
+  return (int)(8 * sizeof(unsigned int) - 1) -
+         __builtin_clz((unsigned int)size);
+#else
   while (size > 1)
     {
       ndx++;
@@ -74,4 +90,5 @@ int mm_size2ndx(size_t size)
     }
 
   return ndx;
+#endif
 }
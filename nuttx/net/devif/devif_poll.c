@@ -167,11 +167,32 @@ static int devif_poll_udp_connections(FAR struct net_driver_s *dev,
 {
   FAR struct udp_conn_s *conn = NULL;
   int bstop = 0;
+#ifdef CONFIG_NET_UDP_WRITE_BUFFERS
+  bool sent;
+#endif
 
   /* Traverse all of the allocated UDP connections and perform the poll action */
 
   while (!bstop && (conn = udp_nextconn(conn)))
     {
+#ifdef CONFIG_NET_UDP_WRITE_BUFFERS
+      /* Keep polling the same connection for as long as it has buffered
+       * datagrams to send and the driver is willing to accept more.
+       */
+
+      do
+        {
+          /* Perform the UDP TX poll */
+
+          udp_poll(dev, conn);
+          sent = (dev->d_len > 0);
+
+          /* Call back into the driver */
+
+          bstop = callback(dev);
+        }
+      while (!bstop && sent && !sq_empty(&conn->write_q));
+#else
       /* Perform the UDP TX poll */
 
       udp_poll(dev, conn);
@@ -179,6 +200,7 @@ static int devif_poll_udp_connections(FAR struct net_driver_s *dev,
       /* Call back into the driver */
 
       bstop = callback(dev);
+#endif
     }
 
   return bstop;
@@ -84,6 +84,23 @@ void iob_free_chain(FAR struct iob_s *iob)
 {
   FAR struct iob_s *next;
 
+#ifdef CONFIG_IOB_REFCOUNT
+  /* If the chain is shared, just release this reference to it */
+
+  if (iob)
+    {
+      irqstate_t flags = irqsave();
+      if (iob->io_refs > 1)
+        {
+          iob->io_refs--;
+          irqrestore(flags);
+          return;
+        }
+
+      irqrestore(flags);
+    }
+#endif
+
   /* Free each IOB in the chain -- one at a time to keep the count straight */
 
   for (; iob; iob = next)
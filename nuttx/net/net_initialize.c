@@ -141,7 +141,13 @@ void net_initialize(void)
   /* Initialize the UDP connection structures */
 
   udp_initialize();
+
+  /* Initialize the UDP write buffering */
+
+#ifdef CONFIG_NET_UDP_WRITE_BUFFERS
+  udp_wrbuffer_initialize();
 #endif
+#endif /* CONFIG_NET_UDP */
 
 #ifdef CONFIG_NET_IGMP
   /* Initialize IGMP support */
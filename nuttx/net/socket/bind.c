@@ -211,6 +211,13 @@ int psock_bind(FAR struct socket *psock, const struct sockaddr *addr,
 
 #ifdef CONFIG_NET_UDP
       case SOCK_DGRAM:
+#ifdef CONFIG_NET_UDP_REUSEADDR
+        /* Tell the UDP layer if this socket is willing to share its port */
+
+        ((FAR struct udp_conn_s *)psock->s_conn)->reuse =
+          (_SO_GETOPT(psock->s_options, SO_REUSEADDR) ||
+           _SO_GETOPT(psock->s_options, SO_REUSEPORT));
+#endif
         ret = udp_bind(psock->s_conn, inaddr);
         break;
 #endif
@@ -86,9 +86,9 @@ int net_clone(FAR struct socket *psock1, FAR struct socket *psock2)
 #endif
 #endif
   psock2->s_conn     = psock1->s_conn;      /* UDP or TCP connection structure */
-#ifdef CONFIG_NET_TCP_WRITE_BUFFERS
+#if defined(CONFIG_NET_TCP_WRITE_BUFFERS) || defined(CONFIG_NET_UDP_WRITE_BUFFERS)
   psock2->s_sndcb    = NULL;                /* Force allocation of new callback
-                                             * instance for TCP send */
+                                             * instance for TCP/UDP send */
 #endif
 
   /* Increment the reference count on the connection */
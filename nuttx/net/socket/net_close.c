@@ -58,6 +58,12 @@
 #  include <nuttx/clock.h>
 #endif
 
+#ifdef CONFIG_NET_UDP_WRITE_BUFFERS
+#  include <semaphore.h>
+#  include <queue.h>
+#  include <time.h>
+#endif
+
 #include "netdev/netdev.h"
 #include "devif/devif.h"
 #include "tcp/tcp.h"
@@ -86,6 +92,14 @@ struct tcp_close_s
 };
 #endif
 
+#ifdef CONFIG_NET_UDP_WRITE_BUFFERS
+struct udp_close_s
+{
+  FAR struct devif_callback_s *cl_cb; /* Reference to UDP callback instance */
+  sem_t                    cl_sem;    /* Signals that the write queue is empty */
+};
+#endif
+
 /****************************************************************************
  * Private Functions
  ****************************************************************************/
@@ -394,6 +408,130 @@ static inline int netclose_disconnect(FAR struct socket *psock)
 }
 #endif /* CONFIG_NET_TCP */
 
+/****************************************************************************
+ * Function: udpclose_interrupt
+ *
+ * Description:
+ *   Handle uIP callback events while waiting for the buffered datagrams of
+ *   a closing UDP socket to be sent.
+ *
+ * Parameters:
+ *   dev      The structure of the network driver that caused the interrupt
+ *   pvconn   The UDP connection structure cast to void *
+ *   pvpriv   An instance of struct udp_close_s cast to void*
+ *   flags    Set of events describing why the callback was invoked
+ *
+ * Returned Value:
+ *   Modified value of the input flags
+ *
+ * Assumptions:
+ *   Running at the interrupt level
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_NET_UDP_WRITE_BUFFERS
+static uint16_t udpclose_interrupt(FAR struct net_driver_s *dev,
+                                   FAR void *pvconn, FAR void *pvpriv,
+                                   uint16_t flags)
+{
+  FAR struct udp_close_s *pstate = (FAR struct udp_close_s *)pvpriv;
+  FAR struct udp_conn_s *conn = (FAR struct udp_conn_s *)pvconn;
+
+  DEBUGASSERT(pstate != NULL && conn != NULL);
+
+  nllvdbg("conn: %p flags: %04x\n", conn, flags);
+
+  /* Wake up the closing thread once every datagram has been sent */
+
+  if (sq_empty(&conn->write_q))
+    {
+      pstate->cl_cb->flags = 0;
+      pstate->cl_cb->priv  = NULL;
+      pstate->cl_cb->event = NULL;
+      sem_post(&pstate->cl_sem);
+    }
+
+  return flags;
+}
+#endif /* CONFIG_NET_UDP_WRITE_BUFFERS */
+
+/****************************************************************************
+ * Function: netclose_drain
+ *
+ * Description:
+ *   Give the datagrams still buffered on a UDP connection a chance to be
+ *   sent before the connection is freed.  The wait is bounded by the
+ *   SO_LINGER time, if set, or by CONFIG_NET_UDP_LINGER otherwise.  A
+ *   timeout of zero does not wait at all.  Whatever is left after the wait
+ *   is discarded by udp_free().
+ *
+ * Parameters:
+ *   psock - The UDP socket being closed (last reference)
+ *
+ * Returned Value:
+ *   None
+ *
+ * Assumptions:
+ *   Called from normal user-level logic with the network unlocked
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_NET_UDP_WRITE_BUFFERS
+static inline void netclose_drain(FAR struct socket *psock)
+{
+  FAR struct udp_conn_s *conn = (FAR struct udp_conn_s *)psock->s_conn;
+  struct udp_close_s state;
+  struct timespec abstime;
+  unsigned int timeo;
+  net_lock_t flags;
+
+  /* Get the linger time in deciseconds */
+
+  timeo = CONFIG_NET_UDP_LINGER;
+#ifdef CONFIG_NET_SOLINGER
+  if (_SO_GETOPT(psock->s_options, SO_LINGER))
+    {
+      timeo = psock->s_linger;
+    }
+#endif
+
+  flags = net_lock();
+  if (timeo > 0 && !sq_empty(&conn->write_q) &&
+      (state.cl_cb = udp_callback_alloc(conn)) != NULL)
+    {
+      sem_init(&state.cl_sem, 0, 0);
+
+      state.cl_cb->flags = UDP_POLL;
+      state.cl_cb->priv  = (FAR void *)&state;
+      state.cl_cb->event = udpclose_interrupt;
+
+      DEBUGVERIFY(clock_gettime(CLOCK_REALTIME, &abstime));
+
+      abstime.tv_sec  += timeo / 10;
+      abstime.tv_nsec += (timeo % 10) * 100000000;
+      if (abstime.tv_nsec >= 1000000000)
+        {
+          abstime.tv_sec++;
+          abstime.tv_nsec -= 1000000000;
+        }
+
+      /* Wait with the network unlocked so that the driver can keep polling
+       * the connection.  The semaphore counts, so a wake-up that happens
+       * before we get to sem_timedwait() is not lost.
+       */
+
+      net_unlock(flags);
+      (void)sem_timedwait(&state.cl_sem, &abstime);
+      flags = net_lock();
+
+      udp_callback_free(conn, state.cl_cb);
+      sem_destroy(&state.cl_sem);
+    }
+
+  net_unlock(flags);
+}
+#endif /* CONFIG_NET_UDP_WRITE_BUFFERS */
+
 /****************************************************************************
  * Public Functions
  ****************************************************************************/
@@ -508,6 +646,15 @@ int psock_close(FAR struct socket *psock)
 
               if (conn->crefs <= 1)
                 {
+#ifdef CONFIG_NET_UDP_WRITE_BUFFERS
+                  /* Let the buffered datagrams go out first.  The write
+                   * buffer callback is still needed to send them.
+                   */
+
+                  netclose_drain(psock);
+                  psock->s_sndcb = NULL;    /* Freed by udp_free() */
+#endif
+
                   /* Yes... free the connection structure */
 
                   conn->crefs = 0;          /* No more references on the connection */
@@ -515,6 +662,22 @@ int psock_close(FAR struct socket *psock)
                 }
               else
                 {
+#ifdef CONFIG_NET_UDP_WRITE_BUFFERS
+                  /* The write buffer callback sends the datagrams queued on
+                   * the shared connection, including those of the other
+                   * references.  Leave it to the connection;  udp_free()
+                   * will release it with the last reference.
+                   */
+
+                  if (psock->s_sndcb)
+                    {
+                      net_lock_t flags = net_lock();
+                      psock->s_sndcb->priv = NULL;
+                      psock->s_sndcb = NULL;
+                      net_unlock(flags);
+                    }
+#endif
+
                   /* No.. Just decrement the reference count */
 
                   conn->crefs--;
@@ -56,19 +56,32 @@
 
 #include <devif/devif.h>
 #include "tcp/tcp.h"
+#include "udp/udp.h"
 #include "socket/socket.h"
 
 /****************************************************************************
  * Pre-processor Definitions
  ****************************************************************************/
 
-/* Network polling can only be supported on TCP and only if read-ahead buffering
- * is enabled (it could be supported on UDP as will if it also had read-ahead
- * buffering.
+/* Network polling can only be supported if read-ahead buffering is enabled
+ * for the protocol:  There must be some place to hold the data that made
+ * the socket readable until the recv() call comes to collect it.
  */
 
+#if defined(CONFIG_NET_TCP) && defined(CONFIG_NET_TCP_READAHEAD)
+#  define HAVE_TCP_POLL 1
+#else
+#  undef HAVE_TCP_POLL
+#endif
+
+#if defined(CONFIG_NET_UDP) && defined(CONFIG_NET_UDP_READAHEAD)
+#  define HAVE_UDP_POLL 1
+#else
+#  undef HAVE_UDP_POLL
+#endif
+
 #if !defined(CONFIG_DISABLE_POLL) && CONFIG_NSOCKET_DESCRIPTORS > 0 && \
-    defined(CONFIG_NET_TCP) && defined(CONFIG_NET_TCP_READAHEAD)
+    (defined(HAVE_TCP_POLL) || defined(HAVE_UDP_POLL))
 #  define HAVE_NETPOLL 1
 #else
 #  undef HAVE_NETPOLL
@@ -95,7 +108,7 @@ struct net_poll_s
  *
  * Description:
  *   This function is called from the interrupt level to perform the actual
- *   TCP receive operation via by the device interface layer.
+ *   TCP or UDP poll event notification via by the device interface layer.
  *
  * Parameters:
  *   dev      The structure of the network driver that caused the interrupt
@@ -126,16 +139,25 @@ static uint16_t poll_interrupt(FAR struct net_driver_s *dev, FAR void *conn,
     {
       pollevent_t eventset = 0;
 
-      /* Check for data or connection availability events. */
+      /* Check for data or connection availability events.  NOTE that
+       * UDP_NEWDATA is the same bit as TCP_NEWDATA.  The UDP datagram will
+       * be retained in the read-ahead buffer after this callback returns.
+       */
 
       if ((flags & (TCP_NEWDATA | TCP_BACKLOG)) != 0)
         {
           eventset |= POLLIN & info->fds->events;
         }
 
-      /* A poll is a sign that we are free to send data. */
+      /* A poll is a sign that we are free to send data.  With UDP write
+       * buffering, sendto() may also have to wait for a write buffer.
+       */
 
-      if ((flags & TCP_POLL) != 0)
+      if ((flags & TCP_POLL) != 0
+#if defined(HAVE_UDP_POLL) && defined(CONFIG_NET_UDP_WRITE_BUFFERS)
+          && (info->psock->s_type != SOCK_DGRAM || udp_wrbuffer_test() == OK)
+#endif
+         )
         {
           eventset |= (POLLOUT & info->fds->events);
         }
@@ -164,13 +186,13 @@ static uint16_t poll_interrupt(FAR struct net_driver_s *dev, FAR void *conn,
 #endif /* HAVE_NETPOLL */
 
 /****************************************************************************
- * Function: net_pollsetup
+ * Function: tcp_pollsetup
  *
  * Description:
  *   Setup to monitor events on one TCP/IP socket
  *
  * Input Parameters:
- *   conn  - The TCP/IP connection of interest
+ *   psock - The TCP/IP socket of interest
  *   fds   - The structure describing the events to be monitored, OR NULL if
  *           this is a request to stop monitoring events.
  *
@@ -179,8 +201,8 @@ static uint16_t poll_interrupt(FAR struct net_driver_s *dev, FAR void *conn,
  *
  ****************************************************************************/
 
-#ifdef HAVE_NETPOLL
-static inline int net_pollsetup(FAR struct socket *psock,
+#if defined(HAVE_NETPOLL) && defined(HAVE_TCP_POLL)
+static inline int tcp_pollsetup(FAR struct socket *psock,
                                 FAR struct pollfd *fds)
 {
   FAR struct tcp_conn_s *conn = psock->s_conn;
@@ -323,16 +345,146 @@ errout_with_lock:
   net_unlock(flags);
   return ret;
 }
-#endif /* HAVE_NETPOLL */
+#endif /* HAVE_NETPOLL && HAVE_TCP_POLL */
+
+/****************************************************************************
+ * Function: udp_pollsetup
+ *
+ * Description:
+ *   Setup to monitor events on one UDP socket
+ *
+ * Input Parameters:
+ *   psock - The UDP socket of interest
+ *   fds   - The structure describing the events to be monitored, OR NULL if
+ *           this is a request to stop monitoring events.
+ *
+ * Returned Value:
+ *  0: Success; Negated errno on failure
+ *
+ ****************************************************************************/
+
+#if defined(HAVE_NETPOLL) && defined(HAVE_UDP_POLL)
+static inline int udp_pollsetup(FAR struct socket *psock,
+                                FAR struct pollfd *fds)
+{
+  FAR struct udp_conn_s *conn = psock->s_conn;
+  FAR struct net_poll_s *info;
+  FAR struct devif_callback_s *cb;
+  net_lock_t flags;
+  int ret;
+
+  /* Sanity check */
+
+#ifdef CONFIG_DEBUG
+  if (!conn || !fds)
+    {
+      return -EINVAL;
+    }
+#endif
+
+  /* Allocate a container to hold the poll information */
+
+  info = (FAR struct net_poll_s *)kmm_malloc(sizeof(struct net_poll_s));
+  if (!info)
+    {
+      return -ENOMEM;
+    }
+
+  /* Some of the  following must be atomic */
+
+  flags = net_lock();
+
+  /* Allocate a UDP callback structure */
+
+  cb = udp_callback_alloc(conn);
+  if (!cb)
+    {
+      ret = -EBUSY;
+      goto errout_with_lock;
+    }
+
+  /* Initialize the poll info container */
+
+  info->psock  = psock;
+  info->fds    = fds;
+  info->cb     = cb;
+
+  /* Initialize the callback structure.  Save the reference to the info
+   * structure as callback private data so that it will be available during
+   * callback processing.
+   */
+
+  cb->flags    = (UDP_NEWDATA | UDP_POLL);
+  cb->priv     = (FAR void *)info;
+  cb->event    = poll_interrupt;
+
+  /* Save the reference in the poll info structure as fds private as well
+   * for use durring poll teardown as well.
+   */
+
+  fds->priv    = (FAR void *)info;
+
+  /* Check for read data availability now */
+
+  if (!IOB_QEMPTY(&conn->readahead))
+    {
+      /* Normal data may be read without blocking. */
+
+      fds->revents |= (POLLRDNORM & fds->events);
+    }
+
+  /* A UDP socket has no connection to lose.  Without write buffering,
+   * sendto() never waits for buffer space, so it is always writable.  With
+   * write buffering, it is writable only if a write buffer is free.
+   * Otherwise, ask to be notified when sendto_interrupt() releases one.  If
+   * there is no room for that, the next UDP_POLL reports POLLOUT instead.
+   */
+
+#ifdef CONFIG_NET_UDP_WRITE_BUFFERS
+  if (udp_wrbuffer_test() == OK)
+    {
+      fds->revents |= (POLLWRNORM & fds->events);
+    }
+  else if ((fds->events & POLLOUT) != 0 &&
+           udp_wrbuffer_pollsetup(fds, true) == OK &&
+           udp_wrbuffer_test() == OK)
+    {
+      /* A buffer was released before we were in the list */
+
+      fds->revents |= (POLLWRNORM & fds->events);
+    }
+#else
+  fds->revents |= (POLLWRNORM & fds->events);
+#endif
+
+  /* Check if any requested events are already in effect */
+
+  if (fds->revents != 0)
+    {
+      /* Yes.. then signal the poll logic */
+
+      sem_post(fds->sem);
+    }
+
+  net_unlock(flags);
+  return OK;
+
+errout_with_lock:
+  kmm_free(info);
+  net_unlock(flags);
+  return ret;
+}
+#endif /* HAVE_NETPOLL && HAVE_UDP_POLL */
 
 /****************************************************************************
  * Function: net_pollteardown
  *
  * Description:
- *   Teardown monitoring of events on an TCP/IP socket
+ *   Teardown monitoring of events on an TCP/IP or UDP socket
  *
  * Input Parameters:
- *   conn  - The TCP/IP connection of interest
+ *   psock - The TCP/IP or UDP socket of interest
+ *   fds   - The structure describing the events being monitored
  *
  * Returned Value:
  *  0: Success; Negated errno on failure
@@ -343,14 +495,13 @@ errout_with_lock:
 static inline int net_pollteardown(FAR struct socket *psock,
                                    FAR struct pollfd *fds)
 {
-  FAR struct tcp_conn_s *conn = psock->s_conn;
   FAR struct net_poll_s *info;
   net_lock_t flags;
 
   /* Sanity check */
 
 #ifdef CONFIG_DEBUG
-  if (!conn || !fds->priv)
+  if (!psock->s_conn || !fds->priv)
     {
       return -EINVAL;
     }
@@ -365,7 +516,23 @@ static inline int net_pollteardown(FAR struct socket *psock,
       /* Release the callback */
 
       flags = net_lock();
-      tcp_callback_free(conn, info->cb);
+#ifdef HAVE_UDP_POLL
+      if (psock->s_type == SOCK_DGRAM)
+        {
+          FAR struct udp_conn_s *conn = psock->s_conn;
+          udp_callback_free(conn, info->cb);
+#ifdef CONFIG_NET_UDP_WRITE_BUFFERS
+          (void)udp_wrbuffer_pollsetup(fds, false);
+#endif
+        }
+#endif
+#ifdef HAVE_TCP_POLL
+      if (psock->s_type == SOCK_STREAM)
+        {
+          FAR struct tcp_conn_s *conn = psock->s_conn;
+          tcp_callback_free(conn, info->cb);
+        }
+#endif
       net_unlock(flags);
 
       /* Release the poll/select data slot */
@@ -408,26 +575,38 @@ int psock_poll(FAR struct socket *psock, FAR struct pollfd *fds, bool setup)
 {
   int ret;
 
-#ifdef CONFIG_NET_UDP
-  /* poll() not supported for UDP */
+  /* Check if we are setting up or tearing down the poll */
 
-  if (psock->s_type != SOCK_STREAM)
+  if (setup)
     {
-      return -ENOSYS;
-    }
+      switch (psock->s_type)
+        {
+#ifdef HAVE_TCP_POLL
+          case SOCK_STREAM:
+            /* Perform the TCP/IP poll() setup */
+
+            ret = tcp_pollsetup(psock, fds);
+            break;
 #endif
 
-  /* Check if we are setting up or tearing down the poll */
+#ifdef HAVE_UDP_POLL
+          case SOCK_DGRAM:
+            /* Perform the UDP poll() setup */
 
-  if (setup)
-    {
-      /* Perform the TCP/IP poll() setup */
+            ret = udp_pollsetup(psock, fds);
+            break;
+#endif
 
-      ret = net_pollsetup(psock, fds);
+          default:
+            /* poll() not supported for this socket type */
+
+            ret = -ENOSYS;
+            break;
+        }
     }
   else
     {
-      /* Perform the TCP/IP poll() teardown */
+      /* Perform the TCP/IP or UDP poll() teardown */
 
       ret = net_pollteardown(psock, fds);
     }
@@ -55,6 +55,19 @@
  * Pre-Processor Definitions
  ****************************************************************************/
 
+/* Non-blocking reads are possible on sockets with read-ahead buffering */
+
+#if defined(CONFIG_NET_TCP_READAHEAD) && defined(CONFIG_NET_UDP_READAHEAD)
+#  define HAVE_NONBLOCK 1
+#  define NONBLOCK_TYPE(t) ((t) == SOCK_STREAM || (t) == SOCK_DGRAM)
+#elif defined(CONFIG_NET_TCP_READAHEAD)
+#  define HAVE_NONBLOCK 1
+#  define NONBLOCK_TYPE(t) ((t) == SOCK_STREAM)
+#elif defined(CONFIG_NET_UDP_READAHEAD)
+#  define HAVE_NONBLOCK 1
+#  define NONBLOCK_TYPE(t) ((t) == SOCK_DGRAM)
+#endif
+
 /****************************************************************************
  * Public Functions
  ****************************************************************************/
@@ -144,10 +157,10 @@ int net_vfcntl(int sockfd, int cmd, va_list ap)
 
           ret = O_RDWR | O_SYNC | O_RSYNC;
 
-#ifdef CONFIG_NET_TCP_READAHEAD
-          /* TCP/IP sockets may also be non-blocking if read-ahead is enabled */
+#ifdef HAVE_NONBLOCK
+          /* Sockets may also be non-blocking if read-ahead is enabled */
 
-          if (psock->s_type == SOCK_STREAM && _SS_ISNONBLOCK(psock->s_flags))
+          if (NONBLOCK_TYPE(psock->s_type) && _SS_ISNONBLOCK(psock->s_flags))
             {
               ret |= O_NONBLOCK;
             }
@@ -165,13 +178,14 @@ int net_vfcntl(int sockfd, int cmd, va_list ap)
          */
 
         {
-#ifdef CONFIG_NET_TCP_READAHEAD
+#ifdef HAVE_NONBLOCK
            /* Non-blocking is the only configurable option.  And it applies only to
-            * read operations on TCP/IP sockets when read-ahead is enabled.
+            * read operations on TCP/IP and UDP sockets when read-ahead is
+            * enabled.
             */
 
           int mode =  va_arg(ap, int);
-          if (psock->s_type == SOCK_STREAM)
+          if (NONBLOCK_TYPE(psock->s_type))
             {
                if ((mode & O_NONBLOCK) != 0)
                  {
@@ -388,6 +388,82 @@ static inline void recvfrom_readahead(struct recvfrom_s *pstate)
 }
 #endif /* CONFIG_NET_UDP || CONFIG_NET_TCP */
 
+/****************************************************************************
+ * Function: recvfrom_udpreadahead
+ *
+ * Description:
+ *   Copy one buffered datagram from the UDP read-ahead queue.  Datagram
+ *   semantics are preserved:  The entire datagram is removed from the
+ *   queue, even if it does not fit in the user buffer.
+ *
+ * Parameters:
+ *   pstate   recvfrom state structure
+ *
+ * Returned Value:
+ *   None
+ *
+ * Assumptions:
+ *   The network is locked and the read-ahead queue is not empty.
+ *
+ ****************************************************************************/
+
+#if defined(CONFIG_NET_UDP) && defined(CONFIG_NET_UDP_READAHEAD)
+static inline void recvfrom_udpreadahead(struct recvfrom_s *pstate)
+{
+  FAR struct udp_conn_s *conn = (FAR struct udp_conn_s *)pstate->rf_sock->s_conn;
+  FAR struct iob_s *iob;
+  int recvlen;
+
+  /* Remove the datagram at the head of the read-ahead queue */
+
+  iob = iob_remove_queue(&conn->readahead);
+  DEBUGASSERT(iob != NULL && conn->nreadahead > 0);
+  conn->nreadahead--;
+
+  /* Save the sender's address in the caller's 'from' location */
+
+  if (pstate->rf_from)
+    {
+      struct udp_rahdr_s hdr;
+
+      (void)iob_copyout((FAR uint8_t *)&hdr, iob,
+                        sizeof(struct udp_rahdr_s), 0);
+
+#ifdef CONFIG_NET_IPv6
+      pstate->rf_from->sin_family = AF_INET6;
+      pstate->rf_from->sin_port   = hdr.srcport;
+      net_ipaddr_copy(pstate->rf_from->sin6_addr.s6_addr, hdr.srcipaddr);
+#else
+      pstate->rf_from->sin_family = AF_INET;
+      pstate->rf_from->sin_port   = hdr.srcport;
+      net_ipaddr_copy(pstate->rf_from->sin_addr.s_addr, hdr.srcipaddr);
+#endif
+    }
+
+  /* Transfer the payload from the I/O buffer chain into the user buffer */
+
+  recvlen = iob_copyout(pstate->rf_buffer, iob, pstate->rf_buflen,
+                        sizeof(struct udp_rahdr_s));
+  if (recvlen > 0)
+    {
+      nllvdbg("Received %d bytes (of %d)\n", recvlen,
+              iob->io_pktlen - (int)sizeof(struct udp_rahdr_s));
+
+      /* Update the accumulated size of the data read */
+
+      pstate->rf_recvlen += recvlen;
+      pstate->rf_buffer  += recvlen;
+      pstate->rf_buflen  -= recvlen;
+    }
+
+  /* And free the I/O buffer chain.  Any part of the datagram that did not
+   * fit in the user buffer is discarded.
+   */
+
+  (void)iob_free_chain(iob);
+}
+#endif /* CONFIG_NET_UDP && CONFIG_NET_UDP_READAHEAD */
+
 /****************************************************************************
  * Function: recvfrom_timeout
  *
@@ -1041,6 +1117,11 @@ static ssize_t recvfrom_result(int result, struct recvfrom_s *pstate)
  *   Perform the recvfrom operation for packet socket
  *
  * Parameters:
+ *   psock    Pointer to the socket structure for the packet socket
+ *   buf      Buffer to receive data
+ *   len      Length of buffer
+ *   from     Link layer address of source (may be NULL)
+ *   flags    Receive flags
  *
  * Returned Value:
  *
@@ -1050,7 +1131,7 @@ static ssize_t recvfrom_result(int result, struct recvfrom_s *pstate)
 
 #ifdef CONFIG_NET_PKT
 static ssize_t pkt_recvfrom(FAR struct socket *psock, FAR void *buf, size_t len,
-                            FAR struct sockaddr_ll *from)
+                            FAR struct sockaddr_ll *from, int flags)
 {
   FAR struct pkt_conn_s *conn = (FAR struct pkt_conn_s *)psock->s_conn;
   struct recvfrom_s state;
@@ -1079,6 +1160,16 @@ static ssize_t pkt_recvfrom(FAR struct socket *psock, FAR void *buf, size_t len,
     }
 #endif
 
+  /* Packets are not buffered, so one can only be received by waiting for
+   * it.  Return EAGAIN now if MSG_DONTWAIT was specified.
+   */
+
+  if ((flags & MSG_DONTWAIT) != 0)
+    {
+      ret = -EAGAIN;
+      goto errout_with_state;
+    }
+
   /* Set up the callback in the connection */
 
   state.rf_cb = pkt_callback_alloc(conn);
@@ -1110,9 +1201,7 @@ static ssize_t pkt_recvfrom(FAR struct socket *psock, FAR void *buf, size_t len,
       ret = -EBUSY;
     }
 
-#if 0 /* Not used */
 errout_with_state:
-#endif
   net_unlock(save);
   recvfrom_uninit(&state);
   return ret;
@@ -1130,6 +1219,7 @@ errout_with_state:
  *   buf      Buffer to receive data
  *   len      Length of buffer
  *   infrom   INET address of source (may be NULL)
+ *   flags    Receive flags
  *
  * Returned Value:
  *   On success, returns the number of characters sent.  On  error,
@@ -1142,10 +1232,10 @@ errout_with_state:
 #ifdef CONFIG_NET_UDP
 #ifdef CONFIG_NET_IPv6
 static ssize_t udp_recvfrom(FAR struct socket *psock, FAR void *buf, size_t len,
-                            FAR struct sockaddr_in6 *infrom )
+                            FAR struct sockaddr_in6 *infrom, int flags)
 #else
 static ssize_t udp_recvfrom(FAR struct socket *psock, FAR void *buf, size_t len,
-                            FAR struct sockaddr_in *infrom )
+                            FAR struct sockaddr_in *infrom, int flags)
 #endif
 {
   FAR struct udp_conn_s *conn = (FAR struct udp_conn_s *)psock->s_conn;
@@ -1171,6 +1261,39 @@ static ssize_t udp_recvfrom(FAR struct socket *psock, FAR void *buf, size_t len,
       goto errout_with_state;
     }
 
+#ifdef CONFIG_NET_UDP_READAHEAD
+  /* Check if there is a datagram already buffered in the read-ahead queue.
+   * If so, return it without waiting.
+   */
+
+  if (!IOB_QEMPTY(&conn->readahead))
+    {
+      recvfrom_udpreadahead(&state);
+      ret = state.rf_recvlen;
+      goto errout_with_state;
+    }
+
+  /* Nothing is buffered.  If this socket is configured as non-blocking,
+   * or if MSG_DONTWAIT was specified, then return EAGAIN now.
+   */
+
+  if (_SS_ISNONBLOCK(psock->s_flags) || (flags & MSG_DONTWAIT) != 0)
+    {
+      ret = -EAGAIN;
+      goto errout_with_state;
+    }
+#else
+  /* Without read-ahead buffering, a datagram can only be received by
+   * waiting for it.  Return EAGAIN now if MSG_DONTWAIT was specified.
+   */
+
+  if ((flags & MSG_DONTWAIT) != 0)
+    {
+      ret = -EAGAIN;
+      goto errout_with_state;
+    }
+#endif
+
   /* Set up the callback in the connection */
 
   state.rf_cb = udp_callback_alloc(conn);
@@ -1222,6 +1345,7 @@ errout_with_state:
  *   buf      Buffer to receive data
  *   len      Length of buffer
  *   infrom   INET address of source (may be NULL)
+ *   flags    Receive flags
  *
  * Returned Value:
  *   On success, returns the number of characters sent.  On  error,
@@ -1234,10 +1358,10 @@ errout_with_state:
 #ifdef CONFIG_NET_TCP
 #ifdef CONFIG_NET_IPv6
 static ssize_t tcp_recvfrom(FAR struct socket *psock, FAR void *buf, size_t len,
-                            FAR struct sockaddr_in6 *infrom )
+                            FAR struct sockaddr_in6 *infrom, int flags)
 #else
 static ssize_t tcp_recvfrom(FAR struct socket *psock, FAR void *buf, size_t len,
-                            FAR struct sockaddr_in *infrom )
+                            FAR struct sockaddr_in *infrom, int flags)
 #endif
 {
   struct recvfrom_s       state;
@@ -1308,13 +1432,15 @@ static ssize_t tcp_recvfrom(FAR struct socket *psock, FAR void *buf, size_t len,
 
   /* In general, this uIP-based implementation will not support non-blocking
    * socket operations... except in a few cases:  Here for TCP receive with read-ahead
-   * enabled.  If this socket is configured as non-blocking then return EAGAIN
-   * if no data was obtained from the read-ahead buffers.
+   * enabled.  If this socket is configured as non-blocking (or if MSG_DONTWAIT
+   * was specified) then return EAGAIN if no data was obtained from the
+   * read-ahead buffers.  Without read-ahead, nothing can be received without
+   * waiting, so MSG_DONTWAIT always returns EAGAIN.
    */
 
   else
 #ifdef CONFIG_NET_TCP_READAHEAD
-  if (_SS_ISNONBLOCK(psock->s_flags))
+  if (_SS_ISNONBLOCK(psock->s_flags) || (flags & MSG_DONTWAIT) != 0)
     {
       /* Return the number of bytes read from the read-ahead buffer if
        * something was received (already in 'ret'); EAGAIN if not.
@@ -1334,6 +1460,14 @@ static ssize_t tcp_recvfrom(FAR struct socket *psock, FAR void *buf, size_t len,
    */
 
   else
+#else
+  if ((flags & MSG_DONTWAIT) != 0 && state.rf_buflen > 0)
+    {
+      /* Nothing can be received without waiting */
+
+      ret = -EAGAIN;
+    }
+  else
 #endif
 
   /* We get here when we we decide that we need to setup the wait for incoming
@@ -1517,21 +1651,21 @@ ssize_t psock_recvfrom(FAR struct socket *psock, FAR void *buf, size_t len,
 #if defined(CONFIG_NET_PKT)
   if (psock->s_type == SOCK_RAW)
     {
-      ret = pkt_recvfrom(psock, buf, len, llfrom);
+      ret = pkt_recvfrom(psock, buf, len, llfrom, flags);
     }
   else
 #endif
 #if defined(CONFIG_NET_TCP)
   if (psock->s_type == SOCK_STREAM)
     {
-      ret = tcp_recvfrom(psock, buf, len, infrom);
+      ret = tcp_recvfrom(psock, buf, len, infrom, flags);
     }
   else
 #endif
 #if defined(CONFIG_NET_UDP)
   if (psock->s_type == SOCK_DGRAM)
     {
-      ret = udp_recvfrom(psock, buf, len, infrom);
+      ret = udp_recvfrom(psock, buf, len, infrom, flags);
     }
   else
 #endif
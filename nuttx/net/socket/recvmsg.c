@@ -0,0 +1,320 @@
+/****************************************************************************
+ * net/socket/recvmsg.c
+ *
+ *   Copyright (C) 2014 Gregory Nutt. All rights reserved.
+ *   Author: Gregory Nutt <gnutt@nuttx.org>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name NuttX nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+#ifdef CONFIG_NET
+
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <string.h>
+#include <time.h>
+#include <errno.h>
+#include <debug.h>
+
+#include <nuttx/clock.h>
+#include <nuttx/kmalloc.h>
+#include <nuttx/net/net.h>
+
+#include "socket/socket.h"
+
+/****************************************************************************
+ * Global Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Function: psock_recvmsg
+ *
+ * Description:
+ *   Receive a message and scatter it into the msg_iov buffers of 'msg'.
+ *   The sender's address is returned in msg_name if it is not NULL.
+ *
+ *   The receive logic delivers data into one contiguous buffer.  If more
+ *   than one buffer is provided, the message is received into a temporary
+ *   buffer and then scattered into the caller's buffers.
+ *
+ * Parameters:
+ *   psock    A pointer to a NuttX-specific, internal socket structure
+ *   msg      Describes the buffers that receive the message
+ *   flags    Receive flags
+ *
+ * Returned Value:
+ *   On success, returns the number of characters received.  On error, -1
+ *   is returned, and errno is set appropriately (see psock_recvfrom()).
+ *
+ * Assumptions:
+ *
+ ****************************************************************************/
+
+ssize_t psock_recvmsg(FAR struct socket *psock, FAR struct msghdr *msg,
+                      int flags)
+{
+  FAR struct sockaddr *from;
+  FAR socklen_t *fromlen;
+  FAR uint8_t *buffer;
+  FAR uint8_t *src;
+  ssize_t nrecvd;
+  size_t len;
+  size_t ncopy;
+  int errcode;
+  int i;
+
+  /* Verify that the message header is usable */
+
+  if (!msg || msg->msg_iovlen < 0 || (!msg->msg_iov && msg->msg_iovlen > 0))
+    {
+      ndbg("ERROR: Invalid message header\n");
+      set_errno(EINVAL);
+      return ERROR;
+    }
+
+  from    = (FAR struct sockaddr *)msg->msg_name;
+  fromlen = from ? &msg->msg_namelen : NULL;
+
+  /* The simple case:  There is at most one buffer and the data can be
+   * received into it directly.
+   */
+
+  if (msg->msg_iovlen <= 1)
+    {
+      if (msg->msg_iovlen == 1)
+        {
+          buffer = (FAR uint8_t *)msg->msg_iov[0].iov_base;
+          len    = msg->msg_iov[0].iov_len;
+        }
+      else
+        {
+          buffer = NULL;
+          len    = 0;
+        }
+
+      nrecvd = psock_recvfrom(psock, buffer, len, flags, from, fromlen);
+    }
+  else
+    {
+      /* Receive into a temporary buffer large enough for all of the
+       * caller's buffers.
+       */
+
+      for (i = 0, len = 0; i < msg->msg_iovlen; i++)
+        {
+          len += msg->msg_iov[i].iov_len;
+        }
+
+      buffer = (FAR uint8_t *)kmm_malloc(len > 0 ? len : 1);
+      if (!buffer)
+        {
+          ndbg("ERROR: Failed to allocate %d byte buffer\n", len);
+          set_errno(ENOMEM);
+          return ERROR;
+        }
+
+      nrecvd = psock_recvfrom(psock, buffer, len, flags, from, fromlen);
+
+      /* Then scatter the received data into the caller's buffers */
+
+      for (i = 0, src = buffer, len = nrecvd > 0 ? nrecvd : 0;
+           i < msg->msg_iovlen && len > 0;
+           i++)
+        {
+          ncopy = msg->msg_iov[i].iov_len;
+          if (ncopy > len)
+            {
+              ncopy = len;
+            }
+
+          memcpy(msg->msg_iov[i].iov_base, src, ncopy);
+          src += ncopy;
+          len -= ncopy;
+        }
+
+      /* Preserve the errno value from the receive across kmm_free() */
+
+      errcode = get_errno();
+      kmm_free(buffer);
+      set_errno(errcode);
+    }
+
+  /* Ancillary data is not supported and no message flags are reported */
+
+  if (nrecvd >= 0)
+    {
+      msg->msg_controllen = 0;
+      msg->msg_flags      = 0;
+    }
+
+  return nrecvd;
+}
+
+/****************************************************************************
+ * Function: recvmsg
+ *
+ * Description:
+ *   Receive a message on the socket 'sockfd' and scatter it into the
+ *   msg_iov buffers of 'msg'.  The sender's address is returned in
+ *   msg_name if it is not NULL.
+ *
+ * Parameters:
+ *   sockfd   Socket descriptor of socket
+ *   msg      Describes the buffers that receive the message
+ *   flags    Receive flags
+ *
+ * Returned Value:
+ *   On success, returns the number of characters received.  On error, -1
+ *   is returned, and errno is set appropriately (see recvfrom()).
+ *
+ * Assumptions:
+ *
+ ****************************************************************************/
+
+ssize_t recvmsg(int sockfd, FAR struct msghdr *msg, int flags)
+{
+  FAR struct socket *psock;
+
+  /* Get the underlying socket structure */
+
+  psock = sockfd_socket(sockfd);
+
+  /* Then let psock_recvmsg() do all of the work */
+
+  return psock_recvmsg(psock, msg, flags);
+}
+
+/****************************************************************************
+ * Function: recvmmsg
+ *
+ * Description:
+ *   Receive up to 'vlen' messages on the socket 'sockfd' with one call.
+ *   The number of bytes received for each message is returned in its
+ *   msg_len field.
+ *
+ *   If MSG_WAITFORONE is set in 'flags', only the first receive may block;
+ *   MSG_DONTWAIT is applied to the rest.  Without read-ahead buffering
+ *   (CONFIG_NET_UDP_READAHEAD or CONFIG_NET_TCP_READAHEAD), nothing can be
+ *   received without waiting, so only one message is then received.  If 'timeout' is not NULL, no more
+ *   messages are received once that much time has elapsed.  As with Linux,
+ *   the timeout is only checked after each message is received, so it does
+ *   not limit how long a blocking receive may wait.
+ *
+ * Parameters:
+ *   sockfd   Socket descriptor of socket
+ *   msgvec   The array of messages to receive
+ *   vlen     The number of messages in 'msgvec'
+ *   flags    Receive flags
+ *   timeout  The maximum time to spend receiving (may be NULL)
+ *
+ * Returned Value:
+ *   On success, returns the number of messages received.  If an error
+ *   occurs after at least one message was received, the number of messages
+ *   received is returned.  Otherwise, -1 is returned and errno is set
+ *   appropriately (see recvfrom()).
+ *
+ * Assumptions:
+ *
+ ****************************************************************************/
+
+int recvmmsg(int sockfd, FAR struct mmsghdr *msgvec, unsigned int vlen,
+             int flags, FAR struct timespec *timeout)
+{
+  FAR struct socket *psock;
+  struct timespec deadline;
+  struct timespec now;
+  ssize_t nrecvd;
+  unsigned int i;
+
+  /* Get the absolute time at which no more messages should be received */
+
+  if (timeout)
+    {
+      (void)clock_gettime(CLOCK_REALTIME, &deadline);
+      deadline.tv_sec  += timeout->tv_sec;
+      deadline.tv_nsec += timeout->tv_nsec;
+      if (deadline.tv_nsec >= NSEC_PER_SEC)
+        {
+          deadline.tv_sec++;
+          deadline.tv_nsec -= NSEC_PER_SEC;
+        }
+    }
+
+  /* Get the underlying socket structure once for all of the messages */
+
+  psock = sockfd_socket(sockfd);
+
+  for (i = 0; i < vlen; )
+    {
+      nrecvd = psock_recvmsg(psock, &msgvec[i].msg_hdr,
+                             flags & ~MSG_WAITFORONE);
+      if (nrecvd < 0)
+        {
+          /* The errno is already set.  Report the error only if no message
+           * was received.
+           */
+
+          return i > 0 ? (int)i : ERROR;
+        }
+
+      msgvec[i].msg_len = (unsigned int)nrecvd;
+      i++;
+
+      /* Don't wait for any more messages if MSG_WAITFORONE was specified */
+
+      if ((flags & MSG_WAITFORONE) != 0)
+        {
+          flags |= MSG_DONTWAIT;
+        }
+
+      /* Stop if the timeout has expired */
+
+      if (timeout)
+        {
+          (void)clock_gettime(CLOCK_REALTIME, &now);
+          if (now.tv_sec > deadline.tv_sec ||
+              (now.tv_sec == deadline.tv_sec &&
+               now.tv_nsec >= deadline.tv_nsec))
+            {
+              break;
+            }
+        }
+    }
+
+  return (int)i;
+}
+
+#endif /* CONFIG_NET */
@@ -0,0 +1,186 @@
+/****************************************************************************
+ * net/socket/sendmsg.c
+ *
+ *   Copyright (C) 2014 Gregory Nutt. All rights reserved.
+ *   Author: Gregory Nutt <gnutt@nuttx.org>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name NuttX nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+#ifdef CONFIG_NET
+
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <errno.h>
+#include <debug.h>
+
+#include <nuttx/net/net.h>
+
+#include "socket/socket.h"
+
+/****************************************************************************
+ * Global Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Function: psock_sendmsg
+ *
+ * Description:
+ *   Send a message gathered from the msg_iov buffers of 'msg'.  For a
+ *   datagram socket, all of the buffers are sent as a single datagram to
+ *   the address in msg_name (or to the connected peer if msg_name is NULL).
+ *
+ * Parameters:
+ *   psock    A pointer to a NuttX-specific, internal socket structure
+ *   msg      Describes the message to send
+ *   flags    Send flags
+ *
+ * Returned Value:
+ *   On success, returns the number of characters sent.  On error, -1 is
+ *   returned, and errno is set appropriately (see psock_sendto()).
+ *
+ * Assumptions:
+ *
+ ****************************************************************************/
+
+ssize_t psock_sendmsg(FAR struct socket *psock, FAR const struct msghdr *msg,
+                      int flags)
+{
+  /* Verify that the message header is usable */
+
+  if (!msg || msg->msg_iovlen < 0 || (!msg->msg_iov && msg->msg_iovlen > 0))
+    {
+      ndbg("ERROR: Invalid message header\n");
+      set_errno(EINVAL);
+      return ERROR;
+    }
+
+  /* Let psock_sendtov() gather the buffers and do all of the work */
+
+  return psock_sendtov(psock, msg->msg_iov, msg->msg_iovlen, flags,
+                       (FAR const struct sockaddr *)msg->msg_name,
+                       msg->msg_namelen);
+}
+
+/****************************************************************************
+ * Function: sendmsg
+ *
+ * Description:
+ *   Send a message gathered from the msg_iov buffers of 'msg' on the socket
+ *   'sockfd'.  This avoids having to copy a message that is built from
+ *   several fragments (e.g., a header and a payload) into one buffer before
+ *   it is sent.
+ *
+ * Parameters:
+ *   sockfd   Socket descriptor of socket
+ *   msg      Describes the message to send
+ *   flags    Send flags
+ *
+ * Returned Value:
+ *   On success, returns the number of characters sent.  On error, -1 is
+ *   returned, and errno is set appropriately (see sendto()).
+ *
+ * Assumptions:
+ *
+ ****************************************************************************/
+
+ssize_t sendmsg(int sockfd, FAR const struct msghdr *msg, int flags)
+{
+  FAR struct socket *psock;
+
+  /* Get the underlying socket structure */
+
+  psock = sockfd_socket(sockfd);
+
+  /* And let psock_sendmsg do all of the work */
+
+  return psock_sendmsg(psock, msg, flags);
+}
+
+/****************************************************************************
+ * Function: sendmmsg
+ *
+ * Description:
+ *   Send up to 'vlen' messages on the socket 'sockfd' with one call.  The
+ *   number of bytes sent for each message is returned in its msg_len
+ *   field.
+ *
+ * Parameters:
+ *   sockfd   Socket descriptor of socket
+ *   msgvec   The array of messages to send
+ *   vlen     The number of messages in 'msgvec'
+ *   flags    Send flags
+ *
+ * Returned Value:
+ *   On success, returns the number of messages sent.  This may be less than
+ *   'vlen' if an error occurs after at least one message was sent.  If the
+ *   first message cannot be sent, -1 is returned and errno is set
+ *   appropriately (see sendto()).
+ *
+ * Assumptions:
+ *
+ ****************************************************************************/
+
+int sendmmsg(int sockfd, FAR struct mmsghdr *msgvec, unsigned int vlen,
+             int flags)
+{
+  FAR struct socket *psock;
+  ssize_t nsent;
+  unsigned int i;
+
+  /* Get the underlying socket structure once for all of the messages */
+
+  psock = sockfd_socket(sockfd);
+
+  for (i = 0; i < vlen; i++)
+    {
+      nsent = psock_sendmsg(psock, &msgvec[i].msg_hdr, flags);
+      if (nsent < 0)
+        {
+          /* The errno is already set.  Report the error only if no message
+           * was sent.
+           */
+
+          return i > 0 ? (int)i : ERROR;
+        }
+
+      msgvec[i].msg_len = (unsigned int)nsent;
+    }
+
+  return (int)i;
+}
+
+#endif /* CONFIG_NET */
@@ -42,6 +42,7 @@
 
 #include <sys/types.h>
 #include <sys/socket.h>
+#include <sys/uio.h>
 #include <stdint.h>
 #include <string.h>
 #include <errno.h>
@@ -94,8 +95,9 @@ struct sendto_s
 #endif
   FAR struct devif_callback_s *st_cb; /* Reference to callback instance */
   sem_t st_sem;                       /* Semaphore signals sendto completion */
-  uint16_t st_buflen;                 /* Length of send buffer (error if <0) */
-  const char *st_buffer;              /* Pointer to send buffer */
+  uint16_t st_buflen;                 /* Total length of the datagram */
+  FAR const struct iovec *st_iov;     /* Buffers gathered into the datagram */
+  int st_iovcnt;                      /* Number of buffers in st_iov */
   int st_sndlen;                      /* Result of the send (length sent or negated errno) */
 };
 
@@ -164,11 +166,13 @@ static inline int send_timeout(FAR struct sendto_s *pstate)
  *
  ****************************************************************************/
 
-#ifdef CONFIG_NET_UDP
+#if defined(CONFIG_NET_UDP) && !defined(CONFIG_NET_UDP_WRITE_BUFFERS)
 static uint16_t sendto_interrupt(struct net_driver_s *dev, void *conn,
                                  void *pvpriv, uint16_t flags)
 {
   FAR struct sendto_s *pstate = (FAR struct sendto_s *)pvpriv;
+  FAR uint8_t *dest;
+  int i;
 
   nllvdbg("flags: %04x\n", flags);
   if (pstate)
@@ -207,9 +211,17 @@ static uint16_t sendto_interrupt(struct net_driver_s *dev, void *conn,
 
       else
         {
-          /* Copy the user data into d_snddata and send it */
+          /* Gather the user data into d_snddata and send it */
+
+          dest = dev->d_snddata;
+          for (i = 0; i < pstate->st_iovcnt; i++)
+            {
+              memcpy(dest, pstate->st_iov[i].iov_base,
+                     pstate->st_iov[i].iov_len);
+              dest += pstate->st_iov[i].iov_len;
+            }
 
-          devif_send(dev, pstate->st_buffer, pstate->st_buflen);
+          dev->d_sndlen     = pstate->st_buflen;
           pstate->st_sndlen = pstate->st_buflen;
         }
 
@@ -233,86 +245,48 @@ static uint16_t sendto_interrupt(struct net_driver_s *dev, void *conn,
  ****************************************************************************/
 
 /****************************************************************************
- * Function: psock_sendto
+ * Function: psock_sendtov
  *
  * Description:
- *   If sendto() is used on a connection-mode (SOCK_STREAM, SOCK_SEQPACKET)
- *   socket, the parameters to and 'tolen' are ignored (and the error EISCONN
- *   may be returned when they are not NULL and 0), and the error ENOTCONN is
- *   returned when the socket was not actually connected.
+ *   Same as psock_sendto() except that the data to be sent is gathered from
+ *   the 'iovcnt' buffers described by 'iov'.  For a datagram socket, all of
+ *   the buffers are sent as one datagram.
  *
  * Parameters:
  *   psock    A pointer to a NuttX-specific, internal socket structure
- *   buf      Data to send
- *   len      Length of data to send
+ *   iov      Buffers holding the data to send
+ *   iovcnt   Number of buffers in 'iov'
  *   flags    Send flags
  *   to       Address of recipient
  *   tolen    The length of the address structure
  *
  * Returned Value:
- *   On success, returns the number of characters sent.  On  error,
- *   -1 is returned, and errno is set appropriately:
- *
- *   EAGAIN or EWOULDBLOCK
- *     The socket is marked non-blocking and the requested operation
- *     would block.
- *   EBADF
- *     An invalid descriptor was specified.
- *   ECONNRESET
- *     Connection reset by peer.
- *   EDESTADDRREQ
- *     The socket is not connection-mode, and no peer address is set.
- *   EFAULT
- *      An invalid user space address was specified for a parameter.
- *   EINTR
- *      A signal occurred before any data was transmitted.
- *   EINVAL
- *      Invalid argument passed.
- *   EISCONN
- *     The connection-mode socket was connected already but a recipient
- *     was specified. (Now either this error is returned, or the recipient
- *     specification is ignored.)
- *   EMSGSIZE
- *     The socket type requires that message be sent atomically, and the
- *     size of the message to be sent made this impossible.
- *   ENOBUFS
- *     The output queue for a network interface was full. This generally
- *     indicates that the interface has stopped sending, but may be
- *     caused by transient congestion.
- *   ENOMEM
- *     No memory available.
- *   ENOTCONN
- *     The socket is not connected, and no target has been given.
- *   ENOTSOCK
- *     The argument s is not a socket.
- *   EOPNOTSUPP
- *     Some bit in the flags argument is inappropriate for the socket
- *     type.
- *   EPIPE
- *     The local end has been shut down on a connection oriented socket.
- *     In this case the process will also receive a SIGPIPE unless
- *     MSG_NOSIGNAL is set.
+ *   See psock_sendto()
  *
  * Assumptions:
  *
  ****************************************************************************/
 
-ssize_t psock_sendto(FAR struct socket *psock, FAR const void *buf,
-                     size_t len, int flags, FAR const struct sockaddr *to,
-                     socklen_t tolen)
+ssize_t psock_sendtov(FAR struct socket *psock, FAR const struct iovec *iov,
+                      int iovcnt, int flags, FAR const struct sockaddr *to,
+                      socklen_t tolen)
 {
 #ifdef CONFIG_NET_UDP
-  FAR struct udp_conn_s *conn;
 #ifdef CONFIG_NET_IPv6
   FAR const struct sockaddr_in6 *into = (const struct sockaddr_in6 *)to;
 #else
   FAR const struct sockaddr_in *into = (const struct sockaddr_in *)to;
 #endif
+#ifndef CONFIG_NET_UDP_WRITE_BUFFERS
+  FAR struct udp_conn_s *conn;
   struct sendto_s state;
   net_lock_t save;
-  int ret;
+#endif
+  size_t len;
+  ssize_t ret;
 #endif
   int err;
+  int i;
 
   /* If to is NULL or tolen is zero, then this function is same as send (for
    * connected socket types)
@@ -321,7 +295,29 @@ ssize_t psock_sendto(FAR struct socket *psock, FAR const void *buf,
   if (!to || !tolen)
     {
 #ifdef CONFIG_NET_TCP
-      return psock_send(psock, buf, len, flags);
+      ssize_t nsent = 0;
+      ssize_t nbytes;
+
+      /* Send each buffer in turn, stopping early if one could not be sent
+       * completely.
+       */
+
+      for (i = 0; i < iovcnt; i++)
+        {
+          nbytes = psock_send(psock, iov[i].iov_base, iov[i].iov_len, flags);
+          if (nbytes < 0)
+            {
+              return nsent > 0 ? nsent : nbytes;
+            }
+
+          nsent += nbytes;
+          if (nbytes < iov[i].iov_len)
+            {
+              break;
+            }
+        }
+
+      return nsent;
 #else
       ndbg("ERROR: No to address\n");
       err = EINVAL;
@@ -360,6 +356,22 @@ ssize_t psock_sendto(FAR struct socket *psock, FAR const void *buf,
       goto errout;
     }
 
+#ifdef CONFIG_NET_UDP
+  /* Get the total size of the datagram.  It must fit in a single packet. */
+
+  for (i = 0, len = 0; i < iovcnt; i++)
+    {
+      len += iov[i].iov_len;
+    }
+
+  if (len > UDP_MSS)
+    {
+      ndbg("ERROR: Datagram too large: %d\n", len);
+      err = EMSGSIZE;
+      goto errout;
+    }
+#endif
+
   /* Make sure that the IP address mapping is in the ARP table */
 
 #ifdef CONFIG_NET_ARP_SEND
@@ -374,7 +386,21 @@ ssize_t psock_sendto(FAR struct socket *psock, FAR const void *buf,
 
   /* Perform the UDP sendto operation */
 
-#ifdef CONFIG_NET_UDP
+#if defined(CONFIG_NET_UDP) && defined(CONFIG_NET_UDP_WRITE_BUFFERS)
+  /* Queue the datagram in a write buffer and return without waiting for
+   * the driver to poll for it.
+   */
+
+  ret = psock_udp_sendtov(psock, iov, iovcnt, flags, into);
+  if (ret < 0)
+    {
+      err = -ret;
+      goto errout;
+    }
+
+  return ret;
+
+#elif defined(CONFIG_NET_UDP)
   /* Set the socket state to sending */
 
   psock->s_flags = _SS_SETSTATE(psock->s_flags, _SF_SEND);
@@ -388,7 +414,8 @@ ssize_t psock_sendto(FAR struct socket *psock, FAR const void *buf,
   memset(&state, 0, sizeof(struct sendto_s));
   sem_init(&state.st_sem, 0, 0);
   state.st_buflen = len;
-  state.st_buffer = buf;
+  state.st_iov    = iov;
+  state.st_iovcnt = iovcnt;
 
   /* Set the initial time for calculating timeouts */
 
@@ -461,6 +488,83 @@ errout:
   return ERROR;
 }
 
+/****************************************************************************
+ * Function: psock_sendto
+ *
+ * Description:
+ *   If sendto() is used on a connection-mode (SOCK_STREAM, SOCK_SEQPACKET)
+ *   socket, the parameters to and 'tolen' are ignored (and the error EISCONN
+ *   may be returned when they are not NULL and 0), and the error ENOTCONN is
+ *   returned when the socket was not actually connected.
+ *
+ * Parameters:
+ *   psock    A pointer to a NuttX-specific, internal socket structure
+ *   buf      Data to send
+ *   len      Length of data to send
+ *   flags    Send flags
+ *   to       Address of recipient
+ *   tolen    The length of the address structure
+ *
+ * Returned Value:
+ *   On success, returns the number of characters sent.  On  error,
+ *   -1 is returned, and errno is set appropriately:
+ *
+ *   EAGAIN or EWOULDBLOCK
+ *     The socket is marked non-blocking and the requested operation
+ *     would block.
+ *   EBADF
+ *     An invalid descriptor was specified.
+ *   ECONNRESET
+ *     Connection reset by peer.
+ *   EDESTADDRREQ
+ *     The socket is not connection-mode, and no peer address is set.
+ *   EFAULT
+ *      An invalid user space address was specified for a parameter.
+ *   EINTR
+ *      A signal occurred before any data was transmitted.
+ *   EINVAL
+ *      Invalid argument passed.
+ *   EISCONN
+ *     The connection-mode socket was connected already but a recipient
+ *     was specified. (Now either this error is returned, or the recipient
+ *     specification is ignored.)
+ *   EMSGSIZE
+ *     The socket type requires that message be sent atomically, and the
+ *     size of the message to be sent made this impossible.
+ *   ENOBUFS
+ *     The output queue for a network interface was full. This generally
+ *     indicates that the interface has stopped sending, but may be
+ *     caused by transient congestion.
+ *   ENOMEM
+ *     No memory available.
+ *   ENOTCONN
+ *     The socket is not connected, and no target has been given.
+ *   ENOTSOCK
+ *     The argument s is not a socket.
+ *   EOPNOTSUPP
+ *     Some bit in the flags argument is inappropriate for the socket
+ *     type.
+ *   EPIPE
+ *     The local end has been shut down on a connection oriented socket.
+ *     In this case the process will also receive a SIGPIPE unless
+ *     MSG_NOSIGNAL is set.
+ *
+ * Assumptions:
+ *
+ ****************************************************************************/
+
+ssize_t psock_sendto(FAR struct socket *psock, FAR const void *buf,
+                     size_t len, int flags, FAR const struct sockaddr *to,
+                     socklen_t tolen)
+{
+  struct iovec iov;
+
+  iov.iov_base = (FAR void *)buf;
+  iov.iov_len  = len;
+
+  return psock_sendtov(psock, &iov, 1, flags, to, tolen);
+}
+
 /****************************************************************************
  * Function: sendto
  *
@@ -110,10 +110,11 @@
 #define _SO_RCVTIMEO     _SO_BIT(SO_RCVTIMEO)
 #define _SO_SNDLOWAT     _SO_BIT(SO_SNDLOWAT)
 #define _SO_SNDTIMEO     _SO_BIT(SO_SNDTIMEO)
+#define _SO_REUSEPORT    _SO_BIT(SO_REUSEPORT)
 
 /* This is the larget option value */
 
-#define _SO_MAXOPT       (15)
+#define _SO_MAXOPT       (16)
 
 /* Macros to set, test, clear options */
 
@@ -183,6 +184,14 @@ int net_timeo(uint32_t start_time, socktimeo_t timeo);
 ssize_t psock_send(FAR struct socket *psock, FAR const void *buf, size_t len,
                    int flags);
 
+/* sendto.c ******************************************************************/
+
+struct iovec; /* Forward reference */
+
+ssize_t psock_sendtov(FAR struct socket *psock, FAR const struct iovec *iov,
+                      int iovcnt, int flags, FAR const struct sockaddr *to,
+                      socklen_t tolen);
+
 #undef EXTERN
 #if defined(__cplusplus)
 }
@@ -126,6 +126,9 @@ struct tcp_conn_s
   uint16_t mss;           /* Current maximum segment size for the
                            * connection */
   uint16_t winsize;       /* Current window size of the connection */
+#ifdef CONFIG_NET_TCP_HASH
+  FAR struct tcp_conn_s *hnext; /* Next in the port hash bucket */
+#endif
 #ifdef CONFIG_NET_TCP_WRITE_BUFFERS
   uint32_t unacked;       /* Number bytes sent but not yet ACKed */
 #else
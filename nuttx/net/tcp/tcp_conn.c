@@ -60,6 +60,20 @@
 #include "devif/devif.h"
 #include "tcp/tcp.h"
 
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+/* Select the hash bucket for a pair of local and remote port numbers.  The
+ * port numbers are in network byte order, but both bytes contribute equally
+ * so the byte order does not matter.
+ */
+
+#ifdef CONFIG_NET_TCP_HASH
+#  define TCP_HASH(l,r) \
+     (((((l) ^ (r)) >> 8) ^ (l) ^ (r)) % CONFIG_NET_TCP_CONNS)
+#endif
+
 /****************************************************************************
  * Public Data
  ****************************************************************************/
@@ -84,6 +98,14 @@ static dq_queue_t g_active_tcp_connections;
 
 static uint16_t g_last_tcp_port;
 
+#ifdef CONFIG_NET_TCP_HASH
+/* The active TCP connections, indexed by the hash of their local and remote
+ * port numbers.
+ */
+
+static FAR struct tcp_conn_s *g_tcp_hash[CONFIG_NET_TCP_CONNS];
+#endif
+
 /****************************************************************************
  * Private Functions
  ****************************************************************************/
@@ -158,6 +180,51 @@ static int tcp_selectport(uint16_t portno)
   return portno;
 }
 
+/****************************************************************************
+ * Name: tcp_hash_add() and tcp_hash_remove()
+ *
+ * Description:
+ *   Add a connection to, or remove a connection from, the hash bucket
+ *   selected by its local and remote port numbers.  A connection is in
+ *   the hash table whenever it is in the active connection list.
+ *
+ * Assumptions:
+ *   The network is locked.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_NET_TCP_HASH
+static inline void tcp_hash_add(FAR struct tcp_conn_s *conn)
+{
+  FAR struct tcp_conn_s **bucket = &g_tcp_hash[TCP_HASH(conn->lport,
+                                                         conn->rport)];
+
+  conn->hnext = *bucket;
+  *bucket     = conn;
+}
+
+static inline void tcp_hash_remove(FAR struct tcp_conn_s *conn)
+{
+  FAR struct tcp_conn_s **pprev;
+
+  for (pprev = &g_tcp_hash[TCP_HASH(conn->lport, conn->rport)];
+       *pprev;
+       pprev = &(*pprev)->hnext)
+    {
+      if (*pprev == conn)
+        {
+          *pprev = conn->hnext;
+          break;
+        }
+    }
+
+  conn->hnext = NULL;
+}
+#else
+#  define tcp_hash_add(c)
+#  define tcp_hash_remove(c)
+#endif
+
 /****************************************************************************
  * Public Functions
  ****************************************************************************/
@@ -351,6 +418,7 @@ void tcp_free(FAR struct tcp_conn_s *conn)
       /* Remove the connection from the active list */
 
       dq_rem(&conn->node, &g_active_tcp_connections);
+      tcp_hash_remove(conn);
     }
 
 #ifdef CONFIG_NET_TCP_READAHEAD
@@ -412,7 +480,16 @@ void tcp_free(FAR struct tcp_conn_s *conn)
 
 FAR struct tcp_conn_s *tcp_active(struct tcp_iphdr_s *buf)
 {
+#ifdef CONFIG_NET_TCP_HASH
+  /* Only the connections in the same hash bucket as the port numbers of the
+   * segment can match.
+   */
+
+  FAR struct tcp_conn_s *conn = g_tcp_hash[TCP_HASH(buf->destport,
+                                                    buf->srcport)];
+#else
   FAR struct tcp_conn_s *conn = (struct tcp_conn_s *)g_active_tcp_connections.head;
+#endif
   in_addr_t srcipaddr = net_ip4addr_conv32(buf->srcipaddr);
 
   while (conn)
@@ -432,7 +509,11 @@ FAR struct tcp_conn_s *tcp_active(struct tcp_iphdr_s *buf)
 
       /* Look at the next active connection */
 
+#ifdef CONFIG_NET_TCP_HASH
+      conn = conn->hnext;
+#else
       conn = (FAR struct tcp_conn_s *)conn->node.flink;
+#endif
     }
 
   return conn;
@@ -556,6 +637,7 @@ FAR struct tcp_conn_s *tcp_alloc_accept(FAR struct tcp_iphdr_s *buf)
        */
 
       dq_addlast(&conn->node, &g_active_tcp_connections);
+      tcp_hash_add(conn);
     }
 
   return conn;
@@ -718,6 +800,7 @@ int tcp_connect(FAR struct tcp_conn_s *conn,
 
   flags = net_lock();
   dq_addlast(&conn->node, &g_active_tcp_connections);
+  tcp_hash_add(conn);
   net_unlock(flags);
 
   return OK;
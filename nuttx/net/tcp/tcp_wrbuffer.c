@@ -48,44 +48,25 @@
 #  define CONFIG_DEBUG_NET 1
 #endif
 
-#include <queue.h>
-#include <semaphore.h>
 #include <string.h>
 #include <assert.h>
 #include <debug.h>
 
+#include <nuttx/mm/mempool.h>
 #include <nuttx/net/iob.h>
 
 #include "tcp/tcp.h"
 
-/****************************************************************************
- * Private Types
- ****************************************************************************/
-
-/* Package all globals used by this logic into a structure */
-
-struct wrbuffer_s
-{
-  /* The semaphore to protect the buffers */
-
-  sem_t sem;
-
-  /* This is the list of available write buffers */
-
-  sq_queue_t freebuffers;
-
-  /* These are the pre-allocated write buffers */
-
-  struct tcp_wrbuffer_s buffers[CONFIG_NET_TCP_NWRBCHAINS];
-};
-
 /****************************************************************************
  * Private Data
  ****************************************************************************/
 
-/* This is the state of the global write buffer resource */
+/* This is the pool of pre-allocated write buffers.  Allocations wait for a
+ * free buffer; buffers are released from interrupt level.
+ */
 
-static struct wrbuffer_s g_wrbuffer;
+static struct mempool_s g_wrbpool;
+static struct tcp_wrbuffer_s g_wrbuffers[CONFIG_NET_TCP_NWRBCHAINS];
 
 /****************************************************************************
  * Private Functions
@@ -108,16 +89,9 @@ static struct wrbuffer_s g_wrbuffer;
 
 void tcp_wrbuffer_initialize(void)
 {
-  int i;
-
-  sq_init(&g_wrbuffer.freebuffers);
-
-  for (i = 0; i < CONFIG_NET_TCP_NWRBCHAINS; i++)
-    {
-      sq_addfirst(&g_wrbuffer.buffers[i].wb_node, &g_wrbuffer.freebuffers);
-    }
-
-  sem_init(&g_wrbuffer.sem, 0, CONFIG_NET_TCP_NWRBCHAINS);
+  DEBUGVERIFY(mempool_initialize(&g_wrbpool, "tcp_wrb", g_wrbuffers,
+                                 sizeof(struct tcp_wrbuffer_s),
+                                 CONFIG_NET_TCP_NWRBCHAINS, true));
 }
 
 /****************************************************************************
@@ -148,14 +122,13 @@ FAR struct tcp_wrbuffer_s *tcp_wrbuffer_alloc(void)
    * buffer
    */
 
-  DEBUGVERIFY(sem_wait(&g_wrbuffer.sem));
-
-  /* Now, we are guaranteed to have a write buffer structure reserved
-   * for us in the free list.
-   */
+  wrb = (FAR struct tcp_wrbuffer_s *)mempool_alloc(&g_wrbpool);
+  if (!wrb)
+    {
+      ndbg("ERROR: Failed to allocate write buffer\n");
+      return NULL;
+    }
 
-  wrb = (FAR struct tcp_wrbuffer_s *)sq_remfirst(&g_wrbuffer.freebuffers);
-  DEBUGASSERT(wrb);
   memset(wrb, 0, sizeof(struct tcp_wrbuffer_s));
 
   /* Now get the first I/O buffer for the write buffer structure */
@@ -164,7 +137,7 @@ FAR struct tcp_wrbuffer_s *tcp_wrbuffer_alloc(void)
   if (!wrb->wb_iob)
     {
       ndbg("ERROR: Failed to allocate I/O buffer\n");
-      tcp_wrbuffer_release(wrb);
+      mempool_free(&g_wrbpool, wrb);
       return NULL;
     }
 
@@ -196,8 +169,7 @@ void tcp_wrbuffer_release(FAR struct tcp_wrbuffer_s *wrb)
 
   /* Then free the write buffer structure */
 
-  sq_addlast(&wrb->wb_node, &g_wrbuffer.freebuffers);
-  sem_post(&g_wrbuffer.sem);
+  mempool_free(&g_wrbpool, wrb);
 }
 
 #endif /* CONFIG_NET && CONFIG_NET_TCP && CONFIG_NET_TCP_WRITE_BUFFERS */
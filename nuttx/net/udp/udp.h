@@ -43,6 +43,11 @@
 #include <nuttx/config.h>
 
 #include <sys/types.h>
+#include <queue.h>
+
+#if defined(CONFIG_NET_UDP_READAHEAD) || defined(CONFIG_NET_UDP_WRITE_BUFFERS)
+#  include <nuttx/net/iob.h>
+#endif
 
 #ifdef CONFIG_NET_UDP
 
@@ -71,12 +76,66 @@ struct udp_conn_s
   uint16_t rport;         /* The remote port number in network byte order */
   uint8_t  ttl;           /* Default time-to-live */
   uint8_t  crefs;         /* Reference counts on this instance */
+#ifdef CONFIG_NET_UDP_REUSEADDR
+  uint8_t  reuse;         /* Local port may be shared (SO_REUSEADDR) */
+#endif
+#ifdef CONFIG_NET_UDP_HASH
+  FAR struct udp_conn_s *hnext; /* Next in the local port hash bucket */
+#endif
+
+#ifdef CONFIG_NET_UDP_READAHEAD
+  /* Read-ahead buffering.
+   *
+   *   readahead - A singly linked list of type struct iob_qentry_s
+   *               where the UDP/IP read-ahead data is retained.  Each
+   *               I/O buffer chain holds one datagram, prefixed with a
+   *               struct udp_rahdr_s.
+   *   nreadahead - The number of datagrams in the readahead queue.
+   */
+
+  uint8_t  nreadahead;    /* Number of datagrams in readahead */
+  struct iob_queue_s readahead;   /* Read-ahead buffering */
+#endif
+
+#ifdef CONFIG_NET_UDP_WRITE_BUFFERS
+  /* Write buffering
+   *
+   *   write_q   - The queue of struct udp_wrbuffer_s datagrams waiting to
+   *               be sent.  FIFO ordering.
+   */
+
+  sq_queue_t write_q;     /* Write buffering for datagrams */
+#endif
 
   /* Defines the list of UDP callbacks */
 
   struct devif_callback_s *list;
 };
 
+#ifdef CONFIG_NET_UDP_READAHEAD
+/* This header precedes the payload of each datagram in the read-ahead
+ * queue so that recvfrom() can still report the address of the sender.
+ */
+
+struct udp_rahdr_s
+{
+  net_ipaddr_t srcipaddr; /* The IP address of the sender */
+  uint16_t srcport;       /* The sender's port number in network byte order */
+};
+#endif
+
+/* This structure supports UDP write buffering */
+
+#ifdef CONFIG_NET_UDP_WRITE_BUFFERS
+struct udp_wrbuffer_s
+{
+  sq_entry_t wb_node;      /* Supports a singly linked list */
+  net_ipaddr_t wb_ripaddr; /* The IP address of the recipient */
+  uint16_t   wb_rport;     /* The recipient's port in network byte order */
+  struct iob_s *wb_iob;    /* Head of the I/O buffer chain */
+};
+#endif
+
 /****************************************************************************
  * Public Data
  ****************************************************************************/
@@ -144,6 +203,25 @@ void udp_free(FAR struct udp_conn_s *conn);
 
 FAR struct udp_conn_s *udp_active(FAR struct udp_iphdr_s *buf);
 
+/****************************************************************************
+ * Name: udp_nextactive()
+ *
+ * Description:
+ *   Find the next connection structure after 'conn' that should also
+ *   receive the UDP packet described by the provided header.  This is
+ *   used to deliver broadcast and multicast datagrams to every socket
+ *   sharing the local port.
+ *
+ * Assumptions:
+ *   This function is called from UIP logic at interrupt level
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_NET_UDP_REUSEADDR
+FAR struct udp_conn_s *udp_nextactive(FAR struct udp_iphdr_s *buf,
+                                      FAR struct udp_conn_s *conn);
+#endif
+
 /****************************************************************************
  * Name: udp_nextconn()
  *
@@ -288,6 +366,214 @@ int udp_input(FAR struct net_driver_s *dev);
 uint16_t udp_callback(FAR struct net_driver_s *dev,
                       FAR struct udp_conn_s *conn, uint16_t flags);
 
+/****************************************************************************
+ * Function: udp_datahandler
+ *
+ * Description:
+ *   Handle a datagram that is not accepted by the application because
+ *   there is no recvfrom() in place to receive it:  The datagram and the
+ *   address of its sender are retained in the read-ahead queue.
+ *
+ * Input Parameters:
+ *   dev  - The device driver structure holding the received datagram
+ *   conn - A pointer to the UDP connection structure
+ *
+ * Returned value:
+ *   The number of payload bytes actually buffered is returned.  This will
+ *   be either zero or equal to dev->d_len; partial datagrams are not
+ *   buffered.
+ *
+ * Assumptions:
+ *   This function is called at the interrupt level with interrupts disabled.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_NET_UDP_READAHEAD
+uint16_t udp_datahandler(FAR struct net_driver_s *dev,
+                         FAR struct udp_conn_s *conn);
+#endif
+
+/****************************************************************************
+ * Function: udp_datacopy
+ *
+ * Description:
+ *   Copy the address of the sender and the received datagram into a new
+ *   I/O buffer chain in the format expected in the read-ahead queue.
+ *
+ * Input Parameters:
+ *   dev  - The device driver structure holding the received datagram
+ *
+ * Returned value:
+ *   The new I/O buffer chain on success; NULL if no I/O buffers are
+ *   available.
+ *
+ * Assumptions:
+ *   This function is called at the interrupt level with interrupts disabled.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_NET_UDP_READAHEAD
+FAR struct iob_s *udp_datacopy(FAR struct net_driver_s *dev);
+#endif
+
+/****************************************************************************
+ * Function: udp_readahead_add
+ *
+ * Description:
+ *   Add an I/O buffer chain created by udp_datacopy() to the tail of the
+ *   read-ahead queue of a connection.
+ *
+ * Input Parameters:
+ *   conn - A pointer to the UDP connection structure
+ *   iob  - The I/O buffer chain holding the datagram
+ *
+ * Returned value:
+ *   OK on success.  On failure, a negated errno value is returned and the
+ *   caller retains ownership of the I/O buffer chain.
+ *
+ * Assumptions:
+ *   This function is called at the interrupt level with interrupts disabled.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_NET_UDP_READAHEAD
+int udp_readahead_add(FAR struct udp_conn_s *conn, FAR struct iob_s *iob);
+#endif
+
+/* Defined in udp_wrbuffer.c ************************************************/
+/****************************************************************************
+ * Function: udp_wrbuffer_initialize
+ *
+ * Description:
+ *   Initialize the list of free write buffers
+ *
+ * Assumptions:
+ *   Called once early initialization.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_NET_UDP_WRITE_BUFFERS
+void udp_wrbuffer_initialize(void);
+#endif
+
+/****************************************************************************
+ * Function: udp_wrbuffer_alloc
+ *
+ * Description:
+ *   Allocate a UDP write buffer by taking a pre-allocated buffer from
+ *   the free list.  This function is called from UDP logic when a datagram
+ *   is about to be sent.  If 'nonblock' is false, this function will wait
+ *   for a write buffer to become available; otherwise, it returns NULL
+ *   immediately if there is none.
+ *
+ * Input parameters:
+ *   nonblock - True: Do not wait for a write buffer to become free.
+ *
+ * Assumptions:
+ *   Called from user logic with the network unlocked.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_NET_UDP_WRITE_BUFFERS
+FAR struct udp_wrbuffer_s *udp_wrbuffer_alloc(bool nonblock);
+#endif
+
+/****************************************************************************
+ * Function: udp_wrbuffer_release
+ *
+ * Description:
+ *   Release a UDP write buffer by returning the buffer to the free list.
+ *   This function is called from UDP logic after it is consumed the
+ *   buffered data.
+ *
+ * Assumptions:
+ *   Called from interrupt level with interrupts disabled.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_NET_UDP_WRITE_BUFFERS
+void udp_wrbuffer_release(FAR struct udp_wrbuffer_s *wrb);
+#endif
+
+/****************************************************************************
+ * Function: udp_wrbuffer_test
+ *
+ * Description:
+ *   Check if a write buffer is free, i.e., if udp_wrbuffer_alloc() would
+ *   return a buffer without waiting.
+ *
+ * Returned Value:
+ *   OK if a write buffer is free; -ENOSPC otherwise.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_NET_UDP_WRITE_BUFFERS
+int udp_wrbuffer_test(void);
+#endif
+
+/****************************************************************************
+ * Function: udp_wrbuffer_pollsetup
+ *
+ * Description:
+ *   Add 'fds' to (setup == true) or remove it from (setup == false) the
+ *   list of poll() structures that are notified with POLLOUT when a write
+ *   buffer is released.
+ *
+ * Returned Value:
+ *   OK on success; -EBUSY if there is no free slot for another waiter.
+ *
+ ****************************************************************************/
+
+#if defined(CONFIG_NET_UDP_WRITE_BUFFERS) && !defined(CONFIG_DISABLE_POLL)
+struct pollfd;            /* Forward reference */
+int udp_wrbuffer_pollsetup(FAR struct pollfd *fds, bool setup);
+#endif
+
+/* Defined in udp_sendto_buffered.c *****************************************/
+/****************************************************************************
+ * Function: psock_udp_sendtov
+ *
+ * Description:
+ *   Gather a UDP datagram from the 'iovcnt' buffers in 'iov', queue it for
+ *   transmission to the address in 'to', and return without waiting for
+ *   the network driver to send it.  The address and the size of the
+ *   datagram have already been verified by psock_sendtov().
+ *
+ * Parameters:
+ *   psock    A pointer to a NuttX-specific, internal socket structure
+ *   iov      Buffers holding the data to send
+ *   iovcnt   Number of buffers in 'iov'
+ *   flags    Send flags
+ *   to       Address of recipient
+ *
+ * Returned Value:
+ *   On success, returns the number of characters queued.  On error, a
+ *   negated errno value is returned:
+ *
+ *   EAGAIN
+ *     The socket is non-blocking and there is no free write buffer.
+ *   ENOMEM
+ *     No write buffer or callback could be allocated.
+ *
+ * Assumptions:
+ *   Called from user logic with the network unlocked.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_NET_UDP_WRITE_BUFFERS
+struct socket;            /* Forward reference */
+struct iovec;             /* Forward reference */
+#ifdef CONFIG_NET_IPv6
+ssize_t psock_udp_sendtov(FAR struct socket *psock,
+                          FAR const struct iovec *iov, int iovcnt, int flags,
+                          FAR const struct sockaddr_in6 *to);
+#else
+ssize_t psock_udp_sendtov(FAR struct socket *psock,
+                          FAR const struct iovec *iov, int iovcnt, int flags,
+                          FAR const struct sockaddr_in *to);
+#endif
+#endif
+
 #undef EXTERN
 #ifdef __cplusplus
 }
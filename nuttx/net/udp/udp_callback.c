@@ -1,7 +1,7 @@
 /****************************************************************************
  * net/udp/udp_callback.c
  *
- *   Copyright (C) 2007-2009 Gregory Nutt. All rights reserved.
+ *   Copyright (C) 2007-2009, 2014 Gregory Nutt. All rights reserved.
  *   Author: Gregory Nutt <gnutt@nuttx.org>
  *
  * Redistribution and use in source and binary forms, with or without
@@ -41,15 +41,24 @@
 #if defined(CONFIG_NET) && defined(CONFIG_NET_UDP)
 
 #include <stdint.h>
+#include <errno.h>
 #include <debug.h>
 
 #include <nuttx/net/netconfig.h>
 #include <nuttx/net/netdev.h>
+#include <nuttx/net/netstats.h>
+#include <nuttx/net/ip.h>
 #include <nuttx/net/udp.h>
 
 #include "devif/devif.h"
 #include "udp/udp.h"
 
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+#define UDPBUF ((struct udp_iphdr_s *)&dev->d_buf[NET_LL_HDRLEN])
+
 /****************************************************************************
  * Private Data
  ****************************************************************************/
@@ -58,6 +67,49 @@
  * Private Functions
  ****************************************************************************/
 
+/****************************************************************************
+ * Function: udp_data_event
+ *
+ * Description:
+ *   Handle a datagram that is not accepted by the application because there
+ *   is no listener in place ready to receive the data.
+ *
+ * Assumptions:
+ * - The caller has checked that UDP_NEWDATA is set in flags and that is no
+ *   other handler available to process the incoming data.
+ * - This function is called at the interrupt level with interrupts disabled.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_NET_UDP_READAHEAD
+static inline uint16_t
+udp_data_event(FAR struct net_driver_s *dev, FAR struct udp_conn_s *conn,
+               uint16_t flags)
+{
+  uint16_t buflen = dev->d_len;
+
+  /* Save the datagram in the read-ahead buffer.  If that fails, leave the
+   * UDP_NEWDATA flag set so that the caller knows that the datagram was
+   * not consumed.
+   */
+
+  if (udp_datahandler(dev, conn) < buflen)
+    {
+      nllvdbg("Dropped %d bytes\n", dev->d_len);
+
+#ifdef CONFIG_NET_STATISTICS
+      g_netstats.udp.drop++;
+#endif
+      return flags;
+    }
+
+  /* The new data has now been handled */
+
+  dev->d_len = 0;
+  return (flags & ~UDP_NEWDATA);
+}
+#endif /* CONFIG_NET_UDP_READAHEAD */
+
 /****************************************************************************
  * Public Functions
  ****************************************************************************/
@@ -88,9 +140,183 @@ uint16_t udp_callback(FAR struct net_driver_s *dev,
       /* Perform the callback */
 
       flags = devif_callback_execute(dev, conn, flags, conn->list);
+
+#ifdef CONFIG_NET_UDP_READAHEAD
+      /* There may be no recvfrom() in place at the moment that the new
+       * datagram is received.  If the new datagram was not handled, then
+       * put it in the read-ahead buffer.
+       */
+
+      if ((flags & UDP_NEWDATA) != 0)
+        {
+          flags = udp_data_event(dev, conn, flags);
+        }
+#endif
     }
 
   return flags;
 }
 
+/****************************************************************************
+ * Function: udp_datahandler
+ *
+ * Description:
+ *   Handle a datagram that is not accepted by the application because
+ *   there is no recvfrom() in place to receive it:  The datagram and the
+ *   address of its sender are retained in the read-ahead queue.
+ *
+ * Input Parameters:
+ *   dev  - The device driver structure holding the received datagram
+ *   conn - A pointer to the UDP connection structure
+ *
+ * Returned value:
+ *   The number of payload bytes actually buffered is returned.  This will
+ *   be either zero or equal to dev->d_len; partial datagrams are not
+ *   buffered.
+ *
+ * Assumptions:
+ *   This function is called at the interrupt level with interrupts disabled.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_NET_UDP_READAHEAD
+uint16_t udp_datahandler(FAR struct net_driver_s *dev,
+                         FAR struct udp_conn_s *conn)
+{
+  FAR struct iob_s *iob;
+  uint16_t buflen = dev->d_len;
+
+  /* Is there room for another datagram in the read-ahead queue? */
+
+  if (conn->nreadahead >= CONFIG_NET_UDP_READAHEAD_DEPTH)
+    {
+      nllvdbg("Read-ahead queue full\n");
+      return 0;
+    }
+
+  /* Copy the sender address and the datagram into an I/O buffer chain */
+
+  iob = udp_datacopy(dev);
+  if (iob == NULL)
+    {
+      return 0;
+    }
+
+  /* Add the new I/O buffer chain to the tail of the read-ahead queue */
+
+  if (udp_readahead_add(conn, iob) < 0)
+    {
+      (void)iob_free_chain(iob);
+      return 0;
+    }
+
+  nllvdbg("Buffered %d bytes\n", buflen);
+  return buflen;
+}
+
+/****************************************************************************
+ * Function: udp_datacopy
+ *
+ * Description:
+ *   Copy the address of the sender and the received datagram into a new
+ *   I/O buffer chain in the format expected in the read-ahead queue.
+ *
+ * Input Parameters:
+ *   dev  - The device driver structure holding the received datagram
+ *
+ * Returned value:
+ *   The new I/O buffer chain on success; NULL if no I/O buffers are
+ *   available.
+ *
+ * Assumptions:
+ *   This function is called at the interrupt level with interrupts disabled.
+ *
+ ****************************************************************************/
+
+FAR struct iob_s *udp_datacopy(FAR struct net_driver_s *dev)
+{
+  FAR struct udp_iphdr_s *pbuf = UDPBUF;
+  FAR struct iob_s *iob;
+  struct udp_rahdr_s hdr;
+  int ret;
+
+  /* Allocate on I/O buffer to start the chain (throttling as necessary) */
+
+  iob = iob_alloc(true);
+  if (iob == NULL)
+    {
+      nlldbg("ERROR: Failed to create new I/O buffer chain\n");
+      return NULL;
+    }
+
+  /* Copy the sender address and then the new appdata into the I/O buffer
+   * chain.
+   */
+
+  net_ipaddr_hdrcopy(&hdr.srcipaddr, pbuf->srcipaddr);
+  hdr.srcport = pbuf->srcport;
+
+  ret = iob_copyin(iob, (FAR const uint8_t *)&hdr,
+                   sizeof(struct udp_rahdr_s), 0, true);
+  if (ret >= 0 && dev->d_len > 0)
+    {
+      ret = iob_copyin(iob, dev->d_appdata, dev->d_len,
+                       sizeof(struct udp_rahdr_s), true);
+    }
+
+  if (ret < 0)
+    {
+      /* On a failure, iob_copyin return a negated error value but does
+       * not free any I/O buffers.
+       */
+
+      nlldbg("ERROR: Failed to add data to the I/O buffer chain: %d\n", ret);
+      (void)iob_free_chain(iob);
+      return NULL;
+    }
+
+  return iob;
+}
+
+/****************************************************************************
+ * Function: udp_readahead_add
+ *
+ * Description:
+ *   Add an I/O buffer chain created by udp_datacopy() to the tail of the
+ *   read-ahead queue of a connection.
+ *
+ * Input Parameters:
+ *   conn - A pointer to the UDP connection structure
+ *   iob  - The I/O buffer chain holding the datagram
+ *
+ * Returned value:
+ *   OK on success.  On failure, a negated errno value is returned and the
+ *   caller retains ownership of the I/O buffer chain.
+ *
+ * Assumptions:
+ *   This function is called at the interrupt level with interrupts disabled.
+ *
+ ****************************************************************************/
+
+int udp_readahead_add(FAR struct udp_conn_s *conn, FAR struct iob_s *iob)
+{
+  int ret;
+
+  if (conn->nreadahead >= CONFIG_NET_UDP_READAHEAD_DEPTH)
+    {
+      return -ENOBUFS;
+    }
+
+  ret = iob_add_queue(iob, &conn->readahead);
+  if (ret < 0)
+    {
+      nlldbg("ERROR: Failed to queue the I/O buffer chain: %d\n", ret);
+      return ret;
+    }
+
+  conn->nreadahead++;
+  return OK;
+}
+#endif /* CONFIG_NET_UDP_READAHEAD */
+
 #endif /* CONFIG_NET && CONFIG_NET_UDP */
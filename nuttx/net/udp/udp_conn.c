@@ -44,6 +44,7 @@
 #if defined(CONFIG_NET) && defined(CONFIG_NET_UDP)
 
 #include <stdint.h>
+#include <stdbool.h>
 #include <string.h>
 #include <semaphore.h>
 #include <assert.h>
@@ -61,6 +62,19 @@
 #include "devif/devif.h"
 #include "udp/udp.h"
 
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+/* Select the hash bucket for a local port number.  The port number is in
+ * network byte order, but both bytes contribute equally so the byte order
+ * does not matter.
+ */
+
+#ifdef CONFIG_NET_UDP_HASH
+#  define UDP_HASH(p) ((((p) >> 8) ^ (p)) % CONFIG_NET_UDP_CONNS)
+#endif
+
 /****************************************************************************
  * Private Data
  ****************************************************************************/
@@ -82,6 +96,14 @@ static dq_queue_t g_active_udp_connections;
 
 static uint16_t g_last_udp_port;
 
+#ifdef CONFIG_NET_UDP_HASH
+/* The UDP connections bound to a local port, indexed by the hash of that
+ * port number.
+ */
+
+static FAR struct udp_conn_s *g_udp_hash[CONFIG_NET_UDP_CONNS];
+#endif
+
 /****************************************************************************
  * Private Functions
  ****************************************************************************/
@@ -121,6 +143,21 @@ static inline void _udp_semtake(FAR sem_t *sem)
 
 static FAR struct udp_conn_s *udp_find_conn(uint16_t portno)
 {
+#ifdef CONFIG_NET_UDP_HASH
+  FAR struct udp_conn_s *conn;
+
+  /* Only the connections in the port's hash bucket need to be examined */
+
+  for (conn = g_udp_hash[UDP_HASH(portno)]; conn; conn = conn->hnext)
+    {
+      if (conn->lport == portno)
+        {
+          return conn;
+        }
+    }
+
+  return NULL;
+#else
   int i;
 
   /* Now search each connection structure.*/
@@ -134,6 +171,134 @@ static FAR struct udp_conn_s *udp_find_conn(uint16_t portno)
     }
 
   return NULL;
+#endif
+}
+
+/****************************************************************************
+ * Name: udp_port_shareable()
+ *
+ * Description:
+ *   Return true if every UDP connection bound to this local port number
+ *   has agreed to share it (SO_REUSEADDR or SO_REUSEPORT).  Called only
+ *   from user user level code, but with interrupts disabled.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_NET_UDP_REUSEADDR
+static bool udp_port_shareable(uint16_t portno)
+{
+#ifdef CONFIG_NET_UDP_HASH
+  FAR struct udp_conn_s *conn;
+
+  for (conn = g_udp_hash[UDP_HASH(portno)]; conn; conn = conn->hnext)
+    {
+      if (conn->lport == portno && !conn->reuse)
+        {
+          return false;
+        }
+    }
+#else
+  int i;
+
+  for (i = 0; i < CONFIG_NET_UDP_CONNS; i++)
+    {
+      if (g_udp_connections[i].lport == portno &&
+          !g_udp_connections[i].reuse)
+        {
+          return false;
+        }
+    }
+#endif
+
+  return true;
+}
+#endif
+
+/****************************************************************************
+ * Name: udp_setport()
+ *
+ * Description:
+ *   Set the local port number of the connection, moving the connection to
+ *   the hash bucket of the new port number.  A port number of zero leaves
+ *   the connection unbound and out of the hash table.
+ *
+ * Assumptions:
+ *   The network is locked.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_NET_UDP_HASH
+static void udp_setport(FAR struct udp_conn_s *conn, uint16_t portno)
+{
+  FAR struct udp_conn_s **pprev;
+
+  /* Remove the connection from the bucket of its current port number */
+
+  if (conn->lport != 0)
+    {
+      for (pprev = &g_udp_hash[UDP_HASH(conn->lport)];
+           *pprev;
+           pprev = &(*pprev)->hnext)
+        {
+          if (*pprev == conn)
+            {
+              *pprev = conn->hnext;
+              break;
+            }
+        }
+    }
+
+  conn->lport = portno;
+  conn->hnext = NULL;
+
+  /* Then add it to the end of the bucket of the new port number so that
+   * connections sharing a port are still visited in the order bound.
+   */
+
+  if (portno != 0)
+    {
+      pprev = &g_udp_hash[UDP_HASH(portno)];
+      while (*pprev)
+        {
+          pprev = &(*pprev)->hnext;
+        }
+
+      *pprev = conn;
+    }
+}
+#else
+#  define udp_setport(c,p) ((c)->lport = (p))
+#endif
+
+/****************************************************************************
+ * Name: udp_match()
+ *
+ * Description:
+ *   Return true if the connection should receive the UDP packet described
+ *   by the provided header.
+ *
+ * Assumptions:
+ *   This function is called from UIP logic at interrupt level
+ *
+ ****************************************************************************/
+
+static inline bool udp_match(FAR struct udp_conn_s *conn,
+                             FAR struct udp_iphdr_s *buf)
+{
+  /* If the local UDP port is non-zero, the connection is considered
+   * to be used. If so, the local port number is checked against the
+   * destination port number in the received packet. If the two port
+   * numbers match, the remote port number is checked if the
+   * connection is bound to a remote port. Finally, if the
+   * connection is bound to a remote IP address, the source IP
+   * address of the packet is checked.
+   */
+
+  return (conn->lport != 0 && buf->destport == conn->lport &&
+          (conn->rport == 0 || buf->srcport == conn->rport) &&
+            (net_ipaddr_cmp(conn->ripaddr, g_allzeroaddr) ||
+             net_ipaddr_cmp(conn->ripaddr, g_alloneaddr) ||
+             net_ipaddr_hdrcmp(buf->srcipaddr, &conn->ripaddr)));
 }
 
 /****************************************************************************
@@ -250,6 +415,25 @@ FAR struct udp_conn_s *udp_alloc(void)
       /* Make sure that the connection is marked as uninitialized */
 
       conn->lport = 0;
+#ifdef CONFIG_NET_UDP_HASH
+      conn->hnext = NULL;
+#endif
+#ifdef CONFIG_NET_UDP_REUSEADDR
+      conn->reuse = 0;
+#endif
+
+#ifdef CONFIG_NET_UDP_READAHEAD
+      /* Initialize the read-ahead buffer queue */
+
+      IOB_QINIT(&conn->readahead);
+      conn->nreadahead = 0;
+#endif
+
+#ifdef CONFIG_NET_UDP_WRITE_BUFFERS
+      /* Initialize the write buffer list */
+
+      sq_init(&conn->write_q);
+#endif
 
       /* Enqueue the connection into the active list */
 
@@ -271,6 +455,13 @@ FAR struct udp_conn_s *udp_alloc(void)
 
 void udp_free(FAR struct udp_conn_s *conn)
 {
+#ifdef CONFIG_NET_UDP_WRITE_BUFFERS
+  FAR struct udp_wrbuffer_s *wrb;
+#endif
+#if defined(CONFIG_NET_UDP_HASH) || defined(CONFIG_NET_UDP_WRITE_BUFFERS)
+  net_lock_t flags;
+#endif
+
   /* The free list is only accessed from user, non-interrupt level and
    * is protected by a semaphore (that behaves like a mutex).
    */
@@ -278,7 +469,44 @@ void udp_free(FAR struct udp_conn_s *conn)
   DEBUGASSERT(conn->crefs == 0);
 
   _udp_semtake(&g_free_sem);
+
+#ifdef CONFIG_NET_UDP_HASH
+  /* Unbind the local port and remove the connection from the hash table */
+
+  flags = net_lock();
+  udp_setport(conn, 0);
+  net_unlock(flags);
+#else
   conn->lport = 0;
+#endif
+
+#ifdef CONFIG_NET_UDP_READAHEAD
+  /* Release any read-ahead buffers attached to the connection */
+
+  iob_free_queue(&conn->readahead);
+  conn->nreadahead = 0;
+#endif
+
+#ifdef CONFIG_NET_UDP_WRITE_BUFFERS
+  /* Discard any datagrams that were not sent while the socket lingered in
+   * close() and release the write buffer callbacks.  There may be more
+   * than one if the socket was dup'ed.
+   */
+
+  flags = net_lock();
+  while ((wrb = (FAR struct udp_wrbuffer_s *)
+                sq_remfirst(&conn->write_q)) != NULL)
+    {
+      udp_wrbuffer_release(wrb);
+    }
+
+  while (conn->list)
+    {
+      udp_callback_free(conn, conn->list);
+    }
+
+  net_unlock(flags);
+#endif
 
   /* Remove the connection from the active list */
 
@@ -304,25 +532,20 @@ void udp_free(FAR struct udp_conn_s *conn)
 
 FAR struct udp_conn_s *udp_active(FAR struct udp_iphdr_s *buf)
 {
+#ifdef CONFIG_NET_UDP_HASH
+  /* Only the connections bound to a port in the same hash bucket as the
+   * destination port can match.
+   */
+
+  FAR struct udp_conn_s *conn = g_udp_hash[UDP_HASH(buf->destport)];
+#else
   FAR struct udp_conn_s *conn =
     (FAR struct udp_conn_s *)g_active_udp_connections.head;
+#endif
 
   while (conn)
     {
-      /* If the local UDP port is non-zero, the connection is considered
-       * to be used. If so, the local port number is checked against the
-       * destination port number in the received packet. If the two port
-       * numbers match, the remote port number is checked if the
-       * connection is bound to a remote port. Finally, if the
-       * connection is bound to a remote IP address, the source IP
-       * address of the packet is checked.
-       */
-
-      if (conn->lport != 0 && buf->destport == conn->lport &&
-          (conn->rport == 0 || buf->srcport == conn->rport) &&
-            (net_ipaddr_cmp(conn->ripaddr, g_allzeroaddr) ||
-             net_ipaddr_cmp(conn->ripaddr, g_alloneaddr) ||
-             net_ipaddr_hdrcmp(buf->srcipaddr, &conn->ripaddr)))
+      if (udp_match(conn, buf))
         {
           /* Matching connection found.. return a reference to it */
 
@@ -331,11 +554,51 @@ FAR struct udp_conn_s *udp_active(FAR struct udp_iphdr_s *buf)
 
       /* Look at the next active connection */
 
+#ifdef CONFIG_NET_UDP_HASH
+      conn = conn->hnext;
+#else
       conn = (FAR struct udp_conn_s *)conn->node.flink;
+#endif
+    }
+
+  return conn;
+}
+
+/****************************************************************************
+ * Name: udp_nextactive()
+ *
+ * Description:
+ *   Find the next connection structure after 'conn' that should also
+ *   receive the UDP packet described by the provided header.  This is
+ *   used to deliver broadcast and multicast datagrams to every socket
+ *   sharing the local port.
+ *
+ * Assumptions:
+ *   This function is called from UIP logic at interrupt level
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_NET_UDP_REUSEADDR
+FAR struct udp_conn_s *udp_nextactive(FAR struct udp_iphdr_s *buf,
+                                      FAR struct udp_conn_s *conn)
+{
+#ifdef CONFIG_NET_UDP_HASH
+  for (conn = conn->hnext; conn; conn = conn->hnext)
+#else
+  for (conn = (FAR struct udp_conn_s *)conn->node.flink;
+       conn;
+       conn = (FAR struct udp_conn_s *)conn->node.flink)
+#endif
+    {
+      if (udp_match(conn, buf))
+        {
+          break;
+        }
     }
 
   return conn;
 }
+#endif
 
 /****************************************************************************
  * Name: udp_nextconn()
@@ -380,6 +643,7 @@ int udp_bind(FAR struct udp_conn_s *conn, FAR const struct sockaddr_in *addr)
 #endif
 {
   int ret = -EADDRINUSE;
+  uint16_t portno;
   net_lock_t flags;
 
   /* Is the user requesting to bind to any port? */
@@ -388,8 +652,13 @@ int udp_bind(FAR struct udp_conn_s *conn, FAR const struct sockaddr_in *addr)
     {
       /* Yes.. Find an unused local port number */
 
-      conn->lport = htons(udp_select_port());
-      ret         = OK;
+      portno = htons(udp_select_port());
+
+      flags = net_lock();
+      udp_setport(conn, portno);
+      net_unlock(flags);
+
+      ret = OK;
     }
   else
     {
@@ -397,14 +666,21 @@ int udp_bind(FAR struct udp_conn_s *conn, FAR const struct sockaddr_in *addr)
 
       flags = net_lock();
 
-      /* Is any other UDP connection bound to this port? */
+      /* Is any other UDP connection bound to this port?  If so, the port
+       * may still be shared if all of the connections agree to that.
+       */
 
+#ifdef CONFIG_NET_UDP_REUSEADDR
+      if (!udp_find_conn(addr->sin_port) ||
+          (conn->reuse && udp_port_shareable(addr->sin_port)))
+#else
       if (!udp_find_conn(addr->sin_port))
+#endif
         {
           /* No.. then bind the socket to the port */
 
-          conn->lport = addr->sin_port;
-          ret         = OK;
+          udp_setport(conn, addr->sin_port);
+          ret = OK;
         }
 
       net_unlock(flags);
@@ -443,6 +719,9 @@ int udp_connect(FAR struct udp_conn_s *conn,
                 FAR const struct sockaddr_in *addr)
 #endif
 {
+  uint16_t portno;
+  net_lock_t flags;
+
   /* Has this address already been bound to a local port (lport)? */
 
   if (!conn->lport)
@@ -451,7 +730,11 @@ int udp_connect(FAR struct udp_conn_s *conn,
        * connection structure.
        */
 
-      conn->lport = htons(udp_select_port());
+      portno = htons(udp_select_port());
+
+      flags = net_lock();
+      udp_setport(conn, portno);
+      net_unlock(flags);
     }
 
   /* Is there a remote port (rport) */
@@ -47,6 +47,8 @@
 
 #include <debug.h>
 
+#include <nuttx/net/iob.h>
+#include <nuttx/net/ip.h>
 #include <nuttx/net/netconfig.h>
 #include <nuttx/net/netdev.h>
 #include <nuttx/net/udp.h>
@@ -62,6 +64,18 @@
 
 #define UDPBUF ((struct udp_iphdr_s *)&dev->d_buf[NET_LL_HDRLEN])
 
+/* Check if the packet was sent to our own unicast address (vs. a broadcast
+ * or multicast address).
+ */
+
+#ifdef CONFIG_NET_IPv6
+#  define UDP_ISUNICAST(dev,pbuf) \
+     net_ipaddr_cmp((pbuf)->destipaddr, (dev)->d_ipaddr)
+#else
+#  define UDP_ISUNICAST(dev,pbuf) \
+     net_ipaddr_cmp(net_ip4addr_conv32((pbuf)->destipaddr), (dev)->d_ipaddr)
+#endif
+
 /****************************************************************************
  * Public Variables
  ****************************************************************************/
@@ -74,6 +88,107 @@
  * Private Functions
  ****************************************************************************/
 
+/****************************************************************************
+ * Name: udp_fanout
+ *
+ * Description:
+ *   Deliver a broadcast or multicast datagram to every UDP connection that
+ *   shares the destination port, starting with 'conn'.  A pending
+ *   recvfrom() receives its copy directly.  All of the other connections
+ *   share a single read-ahead copy of the datagram.
+ *
+ *   Any response that a callback might prepare in d_snddata is discarded;
+ *   there is no single peer to which it could be returned.
+ *
+ * Parameters:
+ *   dev  - The device driver structure containing the received UDP packet
+ *   conn - The first connection that matches the packet
+ *
+ * Return:
+ *   None
+ *
+ * Assumptions:
+ *   Called from the interrupt level or with interrupts disabled.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_NET_UDP_REUSEADDR
+static void udp_fanout(FAR struct net_driver_s *dev,
+                       FAR struct udp_conn_s *conn)
+{
+  FAR struct udp_iphdr_s *pbuf = UDPBUF;
+#ifdef CONFIG_NET_UDP_READAHEAD
+  FAR struct iob_s *iob = NULL;
+#endif
+  uint16_t len = dev->d_len;
+  uint16_t flags;
+
+  for (; conn; conn = udp_nextactive(pbuf, conn))
+    {
+      /* Set-up for the application callback.  The previous callback may
+       * have consumed the data.
+       */
+
+      dev->d_len     = len;
+      dev->d_appdata = &dev->d_buf[NET_LL_HDRLEN + IPUDP_HDRLEN];
+      dev->d_snddata = &dev->d_buf[NET_LL_HDRLEN + IPUDP_HDRLEN];
+      dev->d_sndlen  = 0;
+
+      /* Perform the application callback (without read-ahead buffering) */
+
+      flags = devif_callback_execute(dev, conn, UDP_NEWDATA, conn->list);
+
+#ifdef CONFIG_NET_UDP_READAHEAD
+      /* If there was no recvfrom() in place, then give the connection a
+       * reference to the shared read-ahead copy, creating it on first use.
+       */
+
+      if ((flags & UDP_NEWDATA) != 0)
+        {
+          dev->d_len = len;
+
+          if (iob == NULL)
+            {
+              iob = udp_datacopy(dev);
+            }
+
+          if (iob != NULL)
+            {
+              iob_addref(iob);
+              if (udp_readahead_add(conn, iob) >= 0)
+                {
+                  continue;
+                }
+
+              (void)iob_free_chain(iob);
+            }
+
+          nllvdbg("Dropped %d bytes\n", len);
+#ifdef CONFIG_NET_STATISTICS
+          g_netstats.udp.drop++;
+#endif
+        }
+#else
+      UNUSED(flags);
+#endif
+    }
+
+#ifdef CONFIG_NET_UDP_READAHEAD
+  /* Release the reference held by udp_datacopy() */
+
+  if (iob != NULL)
+    {
+      (void)iob_free_chain(iob);
+    }
+#endif
+
+  /* The datagram has been handled and there is nothing to send */
+
+  dev->d_len    = 0;
+  dev->d_sndlen = 0;
+}
+#endif /* CONFIG_NET_UDP_REUSEADDR */
+
 /****************************************************************************
  * Public Functions
  ****************************************************************************/
@@ -130,6 +245,18 @@ int udp_input(FAR struct net_driver_s *dev)
       /* Demultiplex this UDP packet between the UDP "connections". */
 
       conn = udp_active(pbuf);
+#ifdef CONFIG_NET_UDP_REUSEADDR
+      /* Broadcast and multicast datagrams go to every socket that shares
+       * the port.
+       */
+
+      if (conn && !UDP_ISUNICAST(dev, pbuf) &&
+          udp_nextactive(pbuf, conn) != NULL)
+        {
+          udp_fanout(dev, conn);
+        }
+      else
+#endif
       if (conn)
         {
           uint16_t flags;
@@ -0,0 +1,289 @@
+/****************************************************************************
+ * net/udp/udp_sendto_buffered.c
+ *
+ *   Copyright (C) 2014 Gregory Nutt. All rights reserved.
+ *   Author: Gregory Nutt <gnutt@nuttx.org>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name NuttX nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#if defined(CONFIG_NET) && defined(CONFIG_NET_UDP) && \
+    defined(CONFIG_NET_UDP_WRITE_BUFFERS)
+
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <queue.h>
+#include <errno.h>
+#include <debug.h>
+
+#include <arch/irq.h>
+#include <netinet/in.h>
+
+#include <nuttx/net/net.h>
+#include <nuttx/net/iob.h>
+#include <nuttx/net/netdev.h>
+#include <nuttx/net/udp.h>
+
+#include "socket/socket.h"
+#include "netdev/netdev.h"
+#include "devif/devif.h"
+#include "udp/udp.h"
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Function: sendto_interrupt
+ *
+ * Description:
+ *   This function is called from the interrupt level to send the datagram
+ *   at the head of the connection's write queue when polled by the lower,
+ *   device interfacing layer.
+ *
+ * Parameters:
+ *   dev      The structure of the network driver that caused the interrupt
+ *   pvconn   An instance of the UDP connection structure cast to void *
+ *   pvpriv   An instance of struct socket cast to void*
+ *   flags    Set of events describing why the callback was invoked
+ *
+ * Returned Value:
+ *   Modified value of the input flags
+ *
+ * Assumptions:
+ *   Running at the interrupt level
+ *
+ ****************************************************************************/
+
+static uint16_t sendto_interrupt(FAR struct net_driver_s *dev,
+                                 FAR void *pvconn, FAR void *pvpriv,
+                                 uint16_t flags)
+{
+  FAR struct udp_conn_s *conn = (FAR struct udp_conn_s *)pvconn;
+  FAR struct udp_wrbuffer_s *wrb;
+
+  nllvdbg("flags: %04x\n", flags);
+
+  /* Check if the outgoing packet is available.  It may have been claimed
+   * by another sendto callback -OR- the output buffer may currently
+   * contain unprocessed incoming data.  In these cases we will just have
+   * to wait for the next polling cycle.
+   */
+
+  if ((flags & UDP_POLL) == 0 || dev->d_sndlen > 0 ||
+      (flags & UDP_NEWDATA) != 0)
+    {
+      return flags;
+    }
+
+  /* Take the oldest buffered datagram */
+
+  wrb = (FAR struct udp_wrbuffer_s *)sq_remfirst(&conn->write_q);
+  if (wrb)
+    {
+      /* udp_send() takes the destination from the connection structure */
+
+      conn->rport = wrb->wb_rport;
+      net_ipaddr_copy(conn->ripaddr, wrb->wb_ripaddr);
+
+      /* Copy the datagram into d_snddata and release the write buffer */
+
+      devif_iob_send(dev, wrb->wb_iob, wrb->wb_iob->io_pktlen, 0);
+      udp_wrbuffer_release(wrb);
+    }
+
+  return flags;
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Function: psock_udp_sendtov
+ *
+ * Description:
+ *   Gather a UDP datagram from the 'iovcnt' buffers in 'iov', queue it for
+ *   transmission to the address in 'to', and return without waiting for
+ *   the network driver to send it.  The address and the size of the
+ *   datagram have already been verified by psock_sendtov().
+ *
+ * Parameters:
+ *   psock    A pointer to a NuttX-specific, internal socket structure
+ *   iov      Buffers holding the data to send
+ *   iovcnt   Number of buffers in 'iov'
+ *   flags    Send flags
+ *   to       Address of recipient
+ *
+ * Returned Value:
+ *   On success, returns the number of characters queued.  On error, a
+ *   negated errno value is returned:
+ *
+ *   EAGAIN
+ *     The socket is non-blocking and there is no free write buffer.
+ *   ENOMEM
+ *     No write buffer or callback could be allocated.
+ *
+ * Assumptions:
+ *   Called from user logic with the network unlocked.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_NET_IPv6
+ssize_t psock_udp_sendtov(FAR struct socket *psock,
+                          FAR const struct iovec *iov, int iovcnt, int flags,
+                          FAR const struct sockaddr_in6 *to)
+#else
+ssize_t psock_udp_sendtov(FAR struct socket *psock,
+                          FAR const struct iovec *iov, int iovcnt, int flags,
+                          FAR const struct sockaddr_in *to)
+#endif
+{
+  FAR struct udp_conn_s *conn = (FAR struct udp_conn_s *)psock->s_conn;
+  FAR struct udp_wrbuffer_s *wrb;
+  net_lock_t save;
+  size_t len;
+  bool nonblock;
+  int ret;
+  int i;
+
+  /* Get the size of the datagram.  There is nothing to queue if it is empty */
+
+  for (i = 0, len = 0; i < iovcnt; i++)
+    {
+      len += iov[i].iov_len;
+    }
+
+  if (len == 0)
+    {
+      return 0;
+    }
+
+  /* Allocate a write buffer and copy the datagram into it.  This is done
+   * before locking the network so that the driver is not held off while
+   * we wait for buffers or copy the data.
+   */
+
+  nonblock = (_SS_ISNONBLOCK(psock->s_flags) || (flags & MSG_DONTWAIT) != 0);
+
+  wrb = udp_wrbuffer_alloc(nonblock);
+  if (!wrb)
+    {
+      ndbg("ERROR: Failed to allocate write buffer\n");
+      return nonblock ? -EAGAIN : -ENOMEM;
+    }
+
+  for (i = 0, len = 0; i < iovcnt; i++)
+    {
+      ret = iob_copyin(wrb->wb_iob, (FAR const uint8_t *)iov[i].iov_base,
+                       iov[i].iov_len, len, false);
+      if (ret < 0)
+        {
+          ndbg("ERROR: iob_copyin failed: %d\n", ret);
+          udp_wrbuffer_release(wrb);
+          return ret;
+        }
+
+      len += iov[i].iov_len;
+    }
+
+  wrb->wb_rport = to->sin_port;
+  net_ipaddr_copy(wrb->wb_ripaddr, to->sin_addr.s_addr);
+
+  /* Set the socket state to sending */
+
+  psock->s_flags = _SS_SETSTATE(psock->s_flags, _SF_SEND);
+
+  save = net_lock();
+
+  /* Make sure that the socket is bound to a local port.  This also sets
+   * the default remote address just as an unbuffered sendto() would.
+   */
+
+  ret = udp_connect(conn, to);
+  if (ret < 0)
+    {
+      goto errout_with_lock;
+    }
+
+  /* Allocate resources to receive a callback */
+
+  if (!psock->s_sndcb)
+    {
+      psock->s_sndcb = udp_callback_alloc(conn);
+      if (!psock->s_sndcb)
+        {
+          ndbg("ERROR: Failed to allocate callback\n");
+          ret = -ENOMEM;
+          goto errout_with_lock;
+        }
+
+      psock->s_sndcb->flags = UDP_POLL;
+      psock->s_sndcb->priv  = (FAR void *)psock;
+      psock->s_sndcb->event = sendto_interrupt;
+    }
+
+  /* sendto_interrupt() will send the datagrams in FIFO order from
+   * conn->write_q
+   */
+
+  sq_addlast(&wrb->wb_node, &conn->write_q);
+  nllvdbg("Queued WRB=%p pktlen=%u write_q(%p,%p)\n",
+          wrb, wrb->wb_iob->io_pktlen, conn->write_q.head,
+          conn->write_q.tail);
+
+  /* Notify the device driver of the availability of TX data */
+
+  netdev_txnotify(wrb->wb_ripaddr);
+  net_unlock(save);
+
+  /* Set the socket state to idle */
+
+  psock->s_flags = _SS_SETSTATE(psock->s_flags, _SF_IDLE);
+  return len;
+
+errout_with_lock:
+  net_unlock(save);
+  udp_wrbuffer_release(wrb);
+  psock->s_flags = _SS_SETSTATE(psock->s_flags, _SF_IDLE);
+  return ret;
+}
+
+#endif /* CONFIG_NET && CONFIG_NET_UDP && CONFIG_NET_UDP_WRITE_BUFFERS */
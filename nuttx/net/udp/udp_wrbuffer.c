@@ -0,0 +1,332 @@
+/****************************************************************************
+ * net/udp/udp_wrbuffer.c
+ *
+ *   Copyright (C) 2014 Gregory Nutt. All rights reserved.
+ *   Author: Gregory Nutt <gnutt@nuttx.org>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name NuttX nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/net/netconfig.h>
+#if defined(CONFIG_NET) && defined(CONFIG_NET_UDP) && defined(CONFIG_NET_UDP_WRITE_BUFFERS)
+
+#include <stdbool.h>
+#include <queue.h>
+#include <semaphore.h>
+#include <string.h>
+#include <poll.h>
+#include <errno.h>
+#include <assert.h>
+#include <debug.h>
+
+#include <arch/irq.h>
+#include <netinet/in.h>
+
+#include <nuttx/net/ip.h>
+#include <nuttx/net/iob.h>
+
+#include "udp/udp.h"
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+/* Maximum number of threads than can be waiting in poll() for a write
+ * buffer to become free
+ */
+
+#ifndef CONFIG_NET_UDP_NPOLLWAITERS
+#  define CONFIG_NET_UDP_NPOLLWAITERS 2
+#endif
+
+/****************************************************************************
+ * Private Types
+ ****************************************************************************/
+
+/* Package all globals used by this logic into a structure */
+
+struct wrbuffer_s
+{
+  /* The semaphore to protect the buffers */
+
+  sem_t sem;
+
+  /* This is the list of available write buffers */
+
+  sq_queue_t freebuffers;
+
+  /* These are the pre-allocated write buffers */
+
+  struct udp_wrbuffer_s buffers[CONFIG_NET_UDP_NWRBCHAINS];
+
+#ifndef CONFIG_DISABLE_POLL
+  /* The poll() structures of threads waiting for a free write buffer */
+
+  FAR struct pollfd *fds[CONFIG_NET_UDP_NPOLLWAITERS];
+#endif
+};
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+/* This is the state of the global write buffer resource */
+
+static struct wrbuffer_s g_wrbuffer;
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Function: udp_wrbuffer_initialize
+ *
+ * Description:
+ *   Initialize the list of free write buffers
+ *
+ * Assumptions:
+ *   Called once early initialization.
+ *
+ ****************************************************************************/
+
+void udp_wrbuffer_initialize(void)
+{
+  int i;
+
+  sq_init(&g_wrbuffer.freebuffers);
+
+  for (i = 0; i < CONFIG_NET_UDP_NWRBCHAINS; i++)
+    {
+      sq_addfirst(&g_wrbuffer.buffers[i].wb_node, &g_wrbuffer.freebuffers);
+    }
+
+  sem_init(&g_wrbuffer.sem, 0, CONFIG_NET_UDP_NWRBCHAINS);
+}
+
+/****************************************************************************
+ * Function: udp_wrbuffer_alloc
+ *
+ * Description:
+ *   Allocate a UDP write buffer by taking a pre-allocated buffer from
+ *   the free list.  This function is called from UDP logic when a datagram
+ *   is about to be sent.  If 'nonblock' is false, this function will wait
+ *   for a write buffer to become available; otherwise, it returns NULL
+ *   immediately if there is none.
+ *
+ * Input parameters:
+ *   nonblock - True: Do not wait for a write buffer to become free.
+ *
+ * Assumptions:
+ *   Called from user logic with the network unlocked.
+ *
+ ****************************************************************************/
+
+FAR struct udp_wrbuffer_s *udp_wrbuffer_alloc(bool nonblock)
+{
+  FAR struct udp_wrbuffer_s *wrb;
+  irqstate_t flags;
+
+  /* We need to allocate two things:  (1) A write buffer structure and (2)
+   * at least one I/O buffer to start the chain.
+   *
+   * Allocate the write buffer structure first then the IOB.  In order to
+   * avoid deadlocks, we will need to free the IOB first, then the write
+   * buffer
+   */
+
+  if (nonblock)
+    {
+      if (sem_trywait(&g_wrbuffer.sem) < 0)
+        {
+          return NULL;
+        }
+    }
+  else
+    {
+      DEBUGVERIFY(sem_wait(&g_wrbuffer.sem));
+    }
+
+  /* Now, we are guaranteed to have a write buffer structure reserved
+   * for us in the free list.  The free list is also modified from the
+   * interrupt level when a datagram has been sent.
+   */
+
+  flags = irqsave();
+  wrb = (FAR struct udp_wrbuffer_s *)sq_remfirst(&g_wrbuffer.freebuffers);
+  irqrestore(flags);
+
+  DEBUGASSERT(wrb);
+  memset(wrb, 0, sizeof(struct udp_wrbuffer_s));
+
+  /* Now get the first I/O buffer for the write buffer structure */
+
+  wrb->wb_iob = iob_alloc(false);
+  if (!wrb->wb_iob)
+    {
+      ndbg("ERROR: Failed to allocate I/O buffer\n");
+
+      flags = irqsave();
+      sq_addlast(&wrb->wb_node, &g_wrbuffer.freebuffers);
+      irqrestore(flags);
+
+      sem_post(&g_wrbuffer.sem);
+      return NULL;
+    }
+
+  return wrb;
+}
+
+/****************************************************************************
+ * Function: udp_wrbuffer_release
+ *
+ * Description:
+ *   Release a UDP write buffer by returning the buffer to the free list.
+ *   This function is called from UDP logic after it is consumed the
+ *   buffered data.
+ *
+ * Assumptions:
+ *   Called from interrupt level with interrupts disabled.
+ *
+ ****************************************************************************/
+
+void udp_wrbuffer_release(FAR struct udp_wrbuffer_s *wrb)
+{
+  irqstate_t flags;
+#ifndef CONFIG_DISABLE_POLL
+  FAR struct pollfd *fds;
+  int i;
+#endif
+
+  DEBUGASSERT(wrb && wrb->wb_iob);
+
+  /* To avoid deadlocks, we must following this ordering:  Release the I/O
+   * buffer chain first, then the write buffer structure.
+   */
+
+  iob_free_chain(wrb->wb_iob);
+
+  /* Then free the write buffer structure */
+
+  flags = irqsave();
+  sq_addlast(&wrb->wb_node, &g_wrbuffer.freebuffers);
+  irqrestore(flags);
+
+  sem_post(&g_wrbuffer.sem);
+
+#ifndef CONFIG_DISABLE_POLL
+  /* Let any thread waiting in poll() know that sendto() will not block now,
+   * unless a blocked sendto() has already taken the buffer.
+   */
+
+  if (udp_wrbuffer_test() == OK)
+    {
+      flags = irqsave();
+      for (i = 0; i < CONFIG_NET_UDP_NPOLLWAITERS; i++)
+        {
+          fds = g_wrbuffer.fds[i];
+          if (fds && (fds->events & POLLOUT) != 0)
+            {
+              fds->revents |= (fds->events & POLLOUT);
+              sem_post(fds->sem);
+            }
+        }
+
+      irqrestore(flags);
+    }
+#endif
+}
+
+/****************************************************************************
+ * Function: udp_wrbuffer_test
+ *
+ * Description:
+ *   Check if a write buffer is free, i.e., if udp_wrbuffer_alloc() would
+ *   return a buffer without waiting.
+ *
+ * Returned Value:
+ *   OK if a write buffer is free; -ENOSPC otherwise.
+ *
+ ****************************************************************************/
+
+int udp_wrbuffer_test(void)
+{
+  int val = 0;
+
+  (void)sem_getvalue(&g_wrbuffer.sem, &val);
+  return val > 0 ? OK : -ENOSPC;
+}
+
+/****************************************************************************
+ * Function: udp_wrbuffer_pollsetup
+ *
+ * Description:
+ *   Add 'fds' to (setup == true) or remove it from (setup == false) the
+ *   list of poll() structures that are notified with POLLOUT when a write
+ *   buffer is released.
+ *
+ * Returned Value:
+ *   OK on success; -EBUSY if there is no free slot for another waiter.
+ *
+ ****************************************************************************/
+
+#ifndef CONFIG_DISABLE_POLL
+int udp_wrbuffer_pollsetup(FAR struct pollfd *fds, bool setup)
+{
+  irqstate_t flags;
+  int ret = -EBUSY;
+  int i;
+
+  flags = irqsave();
+  for (i = 0; i < CONFIG_NET_UDP_NPOLLWAITERS; i++)
+    {
+      if (setup && g_wrbuffer.fds[i] == NULL)
+        {
+          g_wrbuffer.fds[i] = fds;
+          ret = OK;
+          break;
+        }
+      else if (!setup && g_wrbuffer.fds[i] == fds)
+        {
+          g_wrbuffer.fds[i] = NULL;
+          ret = OK;
+          break;
+        }
+    }
+
+  irqrestore(flags);
+  return ret;
+}
+#endif
+
+#endif /* CONFIG_NET && CONFIG_NET_UDP && CONFIG_NET_UDP_WRITE_BUFFERS */
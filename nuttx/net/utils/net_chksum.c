@@ -41,8 +41,10 @@
 #ifdef CONFIG_NET
 
 #include <stdint.h>
+#include <stdbool.h>
 #include <debug.h>
 
+#include <nuttx/compiler.h>
 #include <nuttx/net/netconfig.h>
 #include <nuttx/net/netdev.h>
 #include <nuttx/net/ip.h>
@@ -57,6 +59,32 @@
 #define BUF ((struct net_iphdr_s *)&dev->d_buf[NET_LL_HDRLEN])
 #define ICMPBUF ((struct icmp_iphdr_s *)&dev->d_buf[NET_LL_HDRLEN])
 
+/* The word-at-a-time checksum loads 64-bit words on 64-bit platforms (such
+ * as the simulator on a 64-bit host) and 32-bit words otherwise.  Each word
+ * is split into 32-bit halves before it is added to the 64-bit accumulator
+ * so that no carry can be lost and carries need to be folded only once at
+ * the end.
+ */
+
+#ifdef CONFIG_NET_CHKSUM_WORDS
+#  if UINTPTR_MAX > 0xffffffff
+typedef uint64_t chksum_word_t;
+#    define CHKSUM_ADDWORD(a,w) \
+       ((a) += (uint64_t)(uint32_t)(w) + (uint64_t)((w) >> 32))
+#  else
+typedef uint32_t chksum_word_t;
+#    define CHKSUM_ADDWORD(a,w)  ((a) += (uint64_t)(w))
+#  endif
+#  define CHKSUM_WORDSIZE        sizeof(chksum_word_t)
+#  define CHKSUM_WORDMASK        (CHKSUM_WORDSIZE - 1)
+#endif
+
+/* Add two 16-bit values with end-around carry */
+
+#define CHKSUM_ADD16(a,b) \
+  ((uint16_t)((((uint32_t)(a) + (b)) & 0xffff) + \
+              (((uint32_t)(a) + (b)) >> 16)))
+
 /****************************************************************************
  * Private Data
  ****************************************************************************/
@@ -65,50 +93,6 @@
  * Private Functions
  ****************************************************************************/
 
-/****************************************************************************
- * Name: chksum
- ****************************************************************************/
-
-#if !CONFIG_NET_ARCH_CHKSUM
-static uint16_t chksum(uint16_t sum, FAR const uint8_t *data, uint16_t len)
-{
-  uint16_t t;
-  const uint8_t *dataptr;
-  const uint8_t *last_byte;
-
-  dataptr = data;
-  last_byte = data + len - 1;
-
-  while (dataptr < last_byte)
-    {
-      /* At least two more bytes */
-
-      t = (dataptr[0] << 8) + dataptr[1];
-      sum += t;
-      if (sum < t)
-        {
-          sum++; /* carry */
-        }
-
-      dataptr += 2;
-    }
-
-  if (dataptr == last_byte)
-    {
-      t = (dataptr[0] << 8) + 0;
-      sum += t;
-      if (sum < t)
-        {
-          sum++; /* carry */
-        }
-    }
-
-  /* Return sum in host byte order. */
-
-  return sum;
-}
-#endif /* CONFIG_NET_ARCH_CHKSUM */
-
 /****************************************************************************
  * Name: upper_layer_chksum
  ****************************************************************************/
@@ -203,6 +187,172 @@ static inline void net_carry32(FAR uint8_t *sum, uint16_t op16)
  * Public Functions
  ****************************************************************************/
 
+/****************************************************************************
+ * Name: chksum
+ *
+ * Description:
+ *   Add the 16-bit big-endian words of a buffer to a running one's
+ *   complement sum.  An odd trailing byte is treated as if it were padded
+ *   with a zero byte.
+ *
+ *   This is the inner loop of all of the Internet checksum calculations.
+ *   It is a weak function:  An architecture may provide an optimized (e.g.,
+ *   assembly language) version with the same prototype that will be used
+ *   in its place.
+ *
+ * Input Parameters:
+ *   sum  - The running sum in host byte order
+ *   data - The data to be added to the sum.  There are no alignment
+ *          requirements.
+ *   len  - The length of the data in bytes
+ *
+ * Returned Value:
+ *   The new running sum in host byte order.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_NET_CHKSUM_WORDS
+uint16_t weak_function chksum(uint16_t sum, FAR const uint8_t *data,
+                              uint16_t len)
+{
+  FAR const chksum_word_t *wptr;
+  union
+  {
+    uint8_t  b[2];
+    uint16_t h;
+  } u;
+  uint64_t acc = 0;
+  bool odd = false;
+  uint16_t result;
+
+  if (len == 0)
+    {
+      return sum;
+    }
+
+  /* If the data begins at an odd address, add the first byte as the second
+   * byte of a 16-bit word so that all remaining loads are aligned.  This
+   * sums the data with its bytes swapped within each 16-bit word, which is
+   * corrected for below.
+   */
+
+  if (((uintptr_t)data & 1) != 0)
+    {
+      u.b[0] = 0;
+      u.b[1] = *data++;
+      acc   += u.h;
+      len--;
+      odd    = true;
+    }
+
+  /* Add 16-bit words until the data is word aligned */
+
+  while (((uintptr_t)data & CHKSUM_WORDMASK) != 0 && len >= 2)
+    {
+      acc  += *(FAR const uint16_t *)data;
+      data += 2;
+      len  -= 2;
+    }
+
+  /* The main loop:  Add four words per iteration */
+
+  wptr = (FAR const chksum_word_t *)data;
+  while (len >= 4 * CHKSUM_WORDSIZE)
+    {
+      CHKSUM_ADDWORD(acc, wptr[0]);
+      CHKSUM_ADDWORD(acc, wptr[1]);
+      CHKSUM_ADDWORD(acc, wptr[2]);
+      CHKSUM_ADDWORD(acc, wptr[3]);
+      wptr += 4;
+      len  -= 4 * CHKSUM_WORDSIZE;
+    }
+
+  while (len >= CHKSUM_WORDSIZE)
+    {
+      CHKSUM_ADDWORD(acc, *wptr);
+      wptr++;
+      len -= CHKSUM_WORDSIZE;
+    }
+
+  /* Then any remaining 16-bit words and the odd trailing byte */
+
+  data = (FAR const uint8_t *)wptr;
+  while (len >= 2)
+    {
+      acc  += *(FAR const uint16_t *)data;
+      data += 2;
+      len  -= 2;
+    }
+
+  if (len > 0)
+    {
+      u.b[0] = *data;
+      u.b[1] = 0;
+      acc   += u.h;
+    }
+
+  /* Fold the 64-bit accumulator down to 16 bits */
+
+  acc = (acc & 0xffffffff) + (acc >> 32);
+  acc = (acc & 0xffffffff) + (acc >> 32);
+  acc = (acc & 0xffff) + (acc >> 16);
+  acc = (acc & 0xffff) + (acc >> 16);
+  result = (uint16_t)acc;
+
+  /* Undo the byte swap caused by an odd starting address */
+
+  if (odd)
+    {
+      result = (uint16_t)((result << 8) | (result >> 8));
+    }
+
+  /* The words were summed in memory order; convert the sum to host order
+   * and add it to the running sum.
+   */
+
+  return CHKSUM_ADD16(sum, ntohs(result));
+}
+#else
+uint16_t weak_function chksum(uint16_t sum, FAR const uint8_t *data,
+                              uint16_t len)
+{
+  uint16_t t;
+  const uint8_t *dataptr;
+  const uint8_t *last_byte;
+
+  dataptr = data;
+  last_byte = data + len - 1;
+
+  while (dataptr < last_byte)
+    {
+      /* At least two more bytes */
+
+      t = (dataptr[0] << 8) + dataptr[1];
+      sum += t;
+      if (sum < t)
+        {
+          sum++; /* carry */
+        }
+
+      dataptr += 2;
+    }
+
+  if (dataptr == last_byte)
+    {
+      t = (dataptr[0] << 8) + 0;
+      sum += t;
+      if (sum < t)
+        {
+          sum++; /* carry */
+        }
+    }
+
+  /* Return sum in host byte order. */
+
+  return sum;
+}
+#endif /* CONFIG_NET_CHKSUM_WORDS */
+
 /****************************************************************************
  * Name: net_incr32
  *
@@ -138,6 +138,26 @@ unsigned int net_dsec2tick(int dsec);
 
 unsigned int net_timeval2dsec(FAR struct timeval *tv);
 
+/****************************************************************************
+ * Name: chksum
+ *
+ * Description:
+ *   Add the 16-bit big-endian words of a buffer to a running one's
+ *   complement sum.  This is a weak function that an architecture may
+ *   replace with an optimized version.
+ *
+ * Input Parameters:
+ *   sum  - The running sum in host byte order
+ *   data - The data to be added to the sum
+ *   len  - The length of the data in bytes
+ *
+ * Returned Value:
+ *   The new running sum in host byte order.
+ *
+ ****************************************************************************/
+
+uint16_t chksum(uint16_t sum, FAR const uint8_t *data, uint16_t len);
+
 /****************************************************************************
  * Name: tcp_chksum
  *
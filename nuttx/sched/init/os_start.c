@@ -53,6 +53,7 @@
 #include  <nuttx/mm/shm.h>
 #include  <nuttx/kmalloc.h>
 #include  <nuttx/init.h>
+#include  <nuttx/sched_note.h>
 
 #include  "sched/sched.h"
 #include  "signal/signal.h"
@@ -89,8 +90,8 @@
  * and by a series of task lists.  All of these tasks lists are declared
  * below. Although it is not always necessary, most of these lists are
  * prioritized so that common list handling logic can be used (only the
- * g_readytorun, the g_pendingtasks, and the g_waitingforsemaphore lists need
- * to be prioritized).
+ * g_readytorun, the g_pendingtasks, and the semaphore wait lists need to be
+ * prioritized).
  */
 
 /* This is the list of all tasks that are ready to run.  The head of this
@@ -108,10 +109,6 @@ volatile dq_queue_t g_readytorun;
 
 volatile dq_queue_t g_pendingtasks;
 
-/* This is the list of all tasks that are blocked waiting for a semaphore */
-
-volatile dq_queue_t g_waitingforsemaphore;
-
 /* This is the list of all tasks that are blocked waiting for a signal */
 
 #ifndef CONFIG_DISABLE_SIGNALS
@@ -189,7 +186,7 @@ const struct tasklist_s g_tasklisttable[NUM_TASK_STATES] =
   { &g_readytorun,           true  },  /* TSTATE_TASK_READYTORUN */
   { &g_readytorun,           true  },  /* TSTATE_TASK_RUNNING */
   { &g_inactivetasks,        false },  /* TSTATE_TASK_INACTIVE */
-  { &g_waitingforsemaphore,  true  }   /* TSTATE_WAIT_SEM */
+  { NULL,                    true  }   /* TSTATE_WAIT_SEM (sem->waitlist) */
 #ifndef CONFIG_DISABLE_SIGNALS
   ,
   { &g_waitingforsignal,     false }  /* TSTATE_WAIT_SIG */
@@ -259,7 +256,6 @@ void os_start(void)
 
   dq_init(&g_readytorun);
   dq_init(&g_pendingtasks);
-  dq_init(&g_waitingforsemaphore);
 #ifndef CONFIG_DISABLE_SIGNALS
   dq_init(&g_waitingforsignal);
 #endif
@@ -328,7 +324,12 @@ void os_start(void)
 
   /* Then add the idle task's TCB to the head of the ready to run list */
 
+#ifdef CONFIG_SCHED_PRIOBITMAP
+  (void)sched_addindexed(&g_idletcb.cmn, (FAR dq_queue_t*)&g_readytorun,
+                         &g_readytorunndx);
+#else
   dq_addfirst((FAR dq_entry_t*)&g_idletcb, (FAR dq_queue_t*)&g_readytorun);
+#endif
 
   /* Initialize the processor-specific portion of the TCB */
 
@@ -476,6 +477,20 @@ void os_start(void)
 
   up_initialize();
 
+#ifdef CONFIG_SCHED_CPUTIME
+  /* Start the CPU accounting of the IDLE thread now that the high-
+   * resolution counter is available.
+   */
+
+  g_idletcb.cmn.run_stamp = up_perf_gettime();
+#endif
+
+#ifdef CONFIG_DRIVER_NOTE
+  /* Register /dev/note so that buffered scheduler notes can be read */
+
+  devnote_register();
+#endif
+
 #ifdef CONFIG_MM_SHM
   /* Initialize shared memory support */
 
@@ -39,6 +39,7 @@
 
 #include <nuttx/config.h>
 
+#include <sched.h>
 #include <debug.h>
 #include <nuttx/arch.h>
 #include <nuttx/irq.h>
@@ -100,6 +101,8 @@ void irq_dispatch(int irq, FAR void *context)
 
   /* Then dispatch to the interrupt handler */
 
+  sched_note_irqhandler(irq, vector, true);
   vector(irq, context);
+  sched_note_irqhandler(irq, vector, false);
 }
 
@@ -0,0 +1,160 @@
+/****************************************************************************
+ * sched/mqueue/mq_bufpool.c
+ *
+ *   Copyright (C) 2014 Gregory Nutt. All rights reserved.
+ *   Author: Gregory Nutt <gnutt@nuttx.org>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name NuttX nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <sys/types.h>
+#include <mqueue.h>
+#include <sched.h>
+#include <errno.h>
+#include <assert.h>
+
+#include <nuttx/arch.h>
+#include <nuttx/mqueue.h>
+#include <nuttx/mm/mempool.h>
+
+#include "mqueue/mqueue.h"
+
+#ifdef CONFIG_MQ_ZEROCOPY
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: mq_setpool
+ *
+ * Description:
+ *   Make the message queue pass buffers from 'pool' by reference.  See
+ *   include/nuttx/mqueue.h.
+ *
+ ****************************************************************************/
+
+int mq_setpool(mqd_t mqdes, FAR struct mempool_s *pool)
+{
+  FAR struct mqueue_inode_s *msgq;
+  int errcode = OK;
+
+  if (!mqdes || !pool || pool->blocksize <= MQ_BUF_HDRSIZE)
+    {
+      set_errno(EINVAL);
+      return ERROR;
+    }
+
+  /* The message queue must not change while we check it */
+
+  sched_lock();
+  msgq = mqdes->msgq;
+
+  if (msgq->pool != NULL || msgq->nmsgs > 0)
+    {
+      errcode = EBUSY;
+    }
+  else
+    {
+      msgq->pool = pool;
+    }
+
+  sched_unlock();
+
+  if (errcode != OK)
+    {
+      set_errno(errcode);
+      return ERROR;
+    }
+
+  return OK;
+}
+
+/****************************************************************************
+ * Name: mq_bufalloc
+ *
+ * Description:
+ *   Allocate a message buffer from the pool of the message queue.
+ *
+ ****************************************************************************/
+
+FAR void *mq_bufalloc(mqd_t mqdes)
+{
+  FAR struct mqueue_buf_s *mqbuf;
+
+  if (!mqdes || !mqdes->msgq->pool)
+    {
+      set_errno(EINVAL);
+      return NULL;
+    }
+
+  if (up_interrupt_context())
+    {
+      mqbuf = (FAR struct mqueue_buf_s *)mempool_tryalloc(mqdes->msgq->pool);
+    }
+  else
+    {
+      mqbuf = (FAR struct mqueue_buf_s *)mempool_alloc(mqdes->msgq->pool);
+    }
+
+  if (!mqbuf)
+    {
+      set_errno(ENOMEM);
+      return NULL;
+    }
+
+  mqbuf->type = MQ_ALLOC_POOL;
+  return MQ_BUF_DATA(mqbuf);
+}
+
+/****************************************************************************
+ * Name: mq_buffree
+ *
+ * Description:
+ *   Return a message buffer to the pool of the message queue.
+ *
+ ****************************************************************************/
+
+void mq_buffree(mqd_t mqdes, FAR void *buf)
+{
+  DEBUGASSERT(mqdes && mqdes->msgq->pool);
+
+  if (buf)
+    {
+      mempool_free(mqdes->msgq->pool, MQ_BUF_HDR(buf));
+    }
+}
+
+#endif /* CONFIG_MQ_ZEROCOPY */
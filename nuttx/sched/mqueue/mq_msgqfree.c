@@ -41,6 +41,7 @@
 
 #include <debug.h>
 #include <nuttx/kmalloc.h>
+#include <nuttx/mm/mempool.h>
 #include "mqueue/mqueue.h"
 
 /************************************************************************
@@ -98,7 +99,17 @@ void mq_msgqfree(FAR struct mqueue_inode_s *msgq)
       /* Deallocate the message structure. */
 
       next = curr->next;
-      mq_msgfree(curr);
+#ifdef CONFIG_MQ_ZEROCOPY
+      if (curr->type == MQ_ALLOC_POOL)
+        {
+          mempool_free(msgq->pool, curr);
+        }
+      else
+#endif
+        {
+          mq_msgfree(curr);
+        }
+
       curr = next;
     }
 
@@ -0,0 +1,198 @@
+/****************************************************************************
+ * sched/mqueue/mq_prioindex.c
+ *
+ *   Copyright (C) 2014 Gregory Nutt. All rights reserved.
+ *   Author: Gregory Nutt <gnutt@nuttx.org>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name NuttX nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <stdint.h>
+#include <queue.h>
+#include <assert.h>
+
+#include <nuttx/mqueue.h>
+
+#include "mqueue/mqueue.h"
+
+#ifdef CONFIG_MQ_PRIOINDEX
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+#define PRIOINDEX_WORD(p)  ((p) >> 5)
+#define PRIOINDEX_BIT(p)   ((uint32_t)1 << ((p) & 31))
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: mq_ctz
+ *
+ * Description:
+ *   Return the index of the least significant set bit of a non-zero word.
+ *
+ ****************************************************************************/
+
+static inline unsigned int mq_ctz(uint32_t word)
+{
+#ifdef CONFIG_HAVE_BUILTIN_CLZ
+  return __builtin_ctz(word);
+#else
+  unsigned int ndx = 0;
+
+  if ((word & 0x0000ffff) == 0)
+    {
+      word >>= 16;
+      ndx   += 16;
+    }
+
+  if ((word & 0x000000ff) == 0)
+    {
+      word >>= 8;
+      ndx   += 8;
+    }
+
+  if ((word & 0x0000000f) == 0)
+    {
+      word >>= 4;
+      ndx   += 4;
+    }
+
+  if ((word & 0x00000003) == 0)
+    {
+      word >>= 2;
+      ndx   += 2;
+    }
+
+  if ((word & 0x00000001) == 0)
+    {
+      ndx   += 1;
+    }
+
+  return ndx;
+#endif
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: mq_prioinsert
+ *
+ * Description:
+ *   Record 'mqmsg' as the last message of its priority and return the
+ *   message that it must follow in the message list:  The last message of
+ *   the lowest priority present that is the same or higher than the
+ *   priority of 'mqmsg'.
+ *
+ * Inputs:
+ *   msgq  - The message queue
+ *   mqmsg - The message being added (its priority must be set)
+ *
+ * Return Value:
+ *   The message to add 'mqmsg' after or NULL if 'mqmsg' becomes the head
+ *   of the message list.
+ *
+ * Assumptions:
+ *   Interrupts are disabled.
+ *
+ ****************************************************************************/
+
+FAR struct mqueue_msg_s *mq_prioinsert(FAR struct mqueue_inode_s *msgq,
+                                       FAR struct mqueue_msg_s *mqmsg)
+{
+  FAR struct mqueue_msg_s *prev = NULL;
+  uint8_t priority = mqmsg->priority;
+  unsigned int word = PRIOINDEX_WORD(priority);
+  uint32_t bits;
+
+  bits = msgq->prioset[word] & ~(PRIOINDEX_BIT(priority) - 1);
+  while (bits == 0 && ++word < MQ_PRIOINDEX_NWORDS)
+    {
+      bits = msgq->prioset[word];
+    }
+
+  if (bits != 0)
+    {
+      prev = msgq->priotail[(word << 5) + mq_ctz(bits)];
+      DEBUGASSERT(prev != NULL);
+    }
+
+  msgq->priotail[priority] = mqmsg;
+  msgq->prioset[PRIOINDEX_WORD(priority)] |= PRIOINDEX_BIT(priority);
+  return prev;
+}
+
+/****************************************************************************
+ * Name: mq_prioremove
+ *
+ * Description:
+ *   Update the priority index after 'mqmsg' has been removed from the head
+ *   of the message list.
+ *
+ * Inputs:
+ *   msgq  - The message queue
+ *   mqmsg - The message that was at the head of the message list
+ *
+ * Return Value:
+ *   None
+ *
+ * Assumptions:
+ *   Interrupts are disabled.
+ *
+ ****************************************************************************/
+
+void mq_prioremove(FAR struct mqueue_inode_s *msgq,
+                   FAR struct mqueue_msg_s *mqmsg)
+{
+  uint8_t priority = mqmsg->priority;
+
+  /* The head is the first message of the highest priority present.  If it
+   * was also the last one, then there are no more messages of its
+   * priority.
+   */
+
+  if (msgq->priotail[priority] == mqmsg)
+    {
+      msgq->priotail[priority] = NULL;
+      msgq->prioset[PRIOINDEX_WORD(priority)] &= ~PRIOINDEX_BIT(priority);
+    }
+}
+
+#endif /* CONFIG_MQ_PRIOINDEX */
@@ -94,7 +94,8 @@
  *   One success, 0 (OK) is returned. On failure, -1 (ERROR) is returned and
  *   the errno is set appropriately:
  *
- *   EPERM    Message queue opened not opened for reading.
+ *   EPERM    Message queue opened not opened for reading or the message
+ *            queue passes buffers by reference (see mq_setpool()).
  *   EMSGSIZE 'msglen' was less than the maxmsgsize attribute of the message
  *            queue.
  *   EINVAL   Invalid 'msg' or 'mqdes'
@@ -119,6 +120,14 @@ int mq_verifyreceive(mqd_t mqdes, void *msg, size_t msglen)
       return ERROR;
     }
 
+#ifdef CONFIG_MQ_ZEROCOPY
+  if (mqdes->msgq->pool != NULL)
+    {
+      set_errno(EPERM);
+      return ERROR;
+    }
+#endif
+
   if (msglen < (size_t)mqdes->msgq->maxmsgsize)
     {
       set_errno(EMSGSIZE);
@@ -212,6 +221,9 @@ FAR struct mqueue_msg_s *mq_waitreceive(mqd_t mqdes)
   if (rcvmsg)
     {
       msgq->nmsgs--;
+#ifdef CONFIG_MQ_PRIOINDEX
+      mq_prioremove(msgq, rcvmsg);
+#endif
     }
 
   return rcvmsg;
@@ -227,6 +239,10 @@ FAR struct mqueue_msg_s *mq_waitreceive(mqd_t mqdes)
  *   threads that were waiting for the message queue to become non-full,
  *   and disposes of the message structure
  *
+ *   If mqmsg is a buffer of a zero-copy message queue, then the address of
+ *   the message data is returned in *(FAR void **)ubuffer instead and the
+ *   buffer now belongs to the caller.
+ *
  * Parameters:
  *   mqdes - Message queue descriptor
  *   mqmsg   - The message obtained by mq_waitmsg()
@@ -253,24 +269,36 @@ ssize_t mq_doreceive(mqd_t mqdes, FAR struct mqueue_msg_s *mqmsg,
   FAR struct mqueue_inode_s *msgq;
   ssize_t rcvmsglen;
 
-  /* Get the length of the message (also the return value) */
-
-  rcvmsglen = mqmsg->msglen;
-
-  /* Copy the message into the caller's buffer */
-
-  memcpy(ubuffer, (const void*)mqmsg->mail, rcvmsglen);
-
-  /* Copy the message priority as well (if a buffer is provided) */
+  /* Copy the message priority (if a buffer is provided) */
 
   if (prio)
     {
       *prio = mqmsg->priority;
     }
 
-  /* We are done with the message.  Deallocate it now. */
+#ifdef CONFIG_MQ_ZEROCOPY
+  if (mqmsg->type == MQ_ALLOC_POOL)
+    {
+      /* Pass the buffer itself to the caller */
+
+      rcvmsglen = ((FAR struct mqueue_buf_s *)mqmsg)->msglen;
+      *(FAR void **)ubuffer = MQ_BUF_DATA(mqmsg);
+    }
+  else
+#endif
+    {
+      /* Get the length of the message (also the return value) */
+
+      rcvmsglen = mqmsg->msglen;
 
-  mq_msgfree(mqmsg);
+      /* Copy the message into the caller's buffer */
+
+      memcpy(ubuffer, (const void*)mqmsg->mail, rcvmsglen);
+
+      /* We are done with the message.  Deallocate it now. */
+
+      mq_msgfree(mqmsg);
+    }
 
   /* Check if any tasks are waiting for the MQ not full event. */
 
@@ -0,0 +1,107 @@
+/****************************************************************************
+ * sched/mqueue/mq_receivebuf.c
+ *
+ *   Copyright (C) 2014 Gregory Nutt. All rights reserved.
+ *   Author: Gregory Nutt <gnutt@nuttx.org>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name NuttX nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <sys/types.h>
+#include <fcntl.h>
+#include <mqueue.h>
+#include <sched.h>
+#include <errno.h>
+#include <assert.h>
+
+#include <nuttx/arch.h>
+#include <nuttx/mqueue.h>
+
+#include "mqueue/mqueue.h"
+
+#ifdef CONFIG_MQ_ZEROCOPY
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: mq_receivebuf
+ *
+ * Description:
+ *   Remove the next message from the message queue and return its buffer
+ *   without copying it.  See include/nuttx/mqueue.h.
+ *
+ ****************************************************************************/
+
+ssize_t mq_receivebuf(mqd_t mqdes, FAR void **buf, FAR int *prio)
+{
+  FAR struct mqueue_msg_s *mqmsg;
+  irqstate_t saved_state;
+  ssize_t ret = ERROR;
+
+  DEBUGASSERT(up_interrupt_context() == false);
+
+  /* Verify the input parameters */
+
+  if (!buf || !mqdes || !mqdes->msgq->pool)
+    {
+      set_errno(EINVAL);
+      return ERROR;
+    }
+
+  if ((mqdes->oflags & O_RDOK) == 0)
+    {
+      set_errno(EPERM);
+      return ERROR;
+    }
+
+  /* Get the next message as mq_receive() does */
+
+  sched_lock();
+  saved_state = irqsave();
+  mqmsg = mq_waitreceive(mqdes);
+  irqrestore(saved_state);
+
+  if (mqmsg)
+    {
+      ret = mq_doreceive(mqdes, mqmsg, (FAR void *)buf, prio);
+    }
+
+  sched_unlock();
+  return ret;
+}
+
+#endif /* CONFIG_MQ_ZEROCOPY */
@@ -0,0 +1,125 @@
+/****************************************************************************
+ * sched/mqueue/mq_sendbuf.c
+ *
+ *   Copyright (C) 2014 Gregory Nutt. All rights reserved.
+ *   Author: Gregory Nutt <gnutt@nuttx.org>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name NuttX nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <sys/types.h>
+#include <fcntl.h>
+#include <mqueue.h>
+#include <sched.h>
+#include <errno.h>
+#include <assert.h>
+
+#include <nuttx/arch.h>
+#include <nuttx/mqueue.h>
+#include <nuttx/mm/mempool.h>
+
+#include "mqueue/mqueue.h"
+
+#ifdef CONFIG_MQ_ZEROCOPY
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: mq_sendbuf
+ *
+ * Description:
+ *   Queue a buffer from mq_bufalloc() without copying it.  See
+ *   include/nuttx/mqueue.h.
+ *
+ ****************************************************************************/
+
+int mq_sendbuf(mqd_t mqdes, FAR void *buf, size_t buflen, int prio)
+{
+  FAR struct mqueue_inode_s *msgq;
+  irqstate_t saved_state;
+  int ret = ERROR;
+
+  /* Verify the input parameters */
+
+  if (!buf || !mqdes || prio < 0 || prio > MQ_PRIO_MAX ||
+      !mqdes->msgq->pool)
+    {
+      set_errno(EINVAL);
+      return ERROR;
+    }
+
+  if ((mqdes->oflags & O_WROK) == 0)
+    {
+      set_errno(EPERM);
+      return ERROR;
+    }
+
+  if (buflen > mqdes->msgq->pool->blocksize - MQ_BUF_HDRSIZE)
+    {
+      set_errno(EMSGSIZE);
+      return ERROR;
+    }
+
+  DEBUGASSERT(MQ_BUF_HDR(buf)->type == MQ_ALLOC_POOL);
+
+  /* Wait for room in the message queue as mq_send() does */
+
+  sched_lock();
+  msgq = mqdes->msgq;
+
+  saved_state = irqsave();
+  if (up_interrupt_context()      || /* In an interrupt handler */
+      msgq->nmsgs < msgq->maxmsgs || /* OR Message queue not full */
+      mq_waitsend(mqdes) == OK)      /* OR Successfully waited for mq not full */
+    {
+      irqrestore(saved_state);
+
+      /* The buffer is the message */
+
+      ret = mq_dosend(mqdes, (FAR struct mqueue_msg_s *)MQ_BUF_HDR(buf),
+                      NULL, buflen, prio);
+    }
+  else
+    {
+      irqrestore(saved_state);
+    }
+
+  sched_unlock();
+  return ret;
+}
+
+#endif /* CONFIG_MQ_ZEROCOPY */
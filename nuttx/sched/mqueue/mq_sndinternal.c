@@ -100,7 +100,8 @@
  *   the errno is set appropriately:
  *
  *   EINVAL   Either msg or mqdes is NULL or the value of prio is invalid.
- *   EPERM    Message queue opened not opened for writing.
+ *   EPERM    Message queue opened not opened for writing or the message
+ *            queue passes buffers by reference (see mq_setpool()).
  *   EMSGSIZE 'msglen' was greater than the maxmsgsize attribute of the
  *             message queue.
  *
@@ -124,6 +125,14 @@ int mq_verifysend(mqd_t mqdes, const void *msg, size_t msglen, int prio)
       return ERROR;
     }
 
+#ifdef CONFIG_MQ_ZEROCOPY
+  if (mqdes->msgq->pool != NULL)
+    {
+      set_errno(EPERM);
+      return ERROR;
+    }
+#endif
+
   if (msglen > (size_t)mqdes->msgq->maxmsgsize)
     {
       set_errno(EMSGSIZE);
@@ -311,6 +320,9 @@ int mq_waitsend(mqd_t mqdes)
  *   queue notifications setup by mq_notify.  And, finally, it awakens any
  *   tasks that were waiting for the message not empty event.
  *
+ *   If mqmsg is a buffer of a zero-copy message queue, then it already
+ *   holds the message data and msg is not used.
+ *
  * Parameters:
  *   mqdes - Message queue descriptor
  *   msg - Message to send
@@ -329,7 +341,9 @@ int mq_dosend(mqd_t mqdes, FAR struct mqueue_msg_s *mqmsg, FAR const void *msg,
 {
   FAR struct tcb_s *btcb;
   FAR struct mqueue_inode_s *msgq;
+#ifndef CONFIG_MQ_PRIOINDEX
   FAR struct mqueue_msg_s *next;
+#endif
   FAR struct mqueue_msg_s *prev;
   irqstate_t saved_state;
 
@@ -341,16 +355,33 @@ int mq_dosend(mqd_t mqdes, FAR struct mqueue_msg_s *mqmsg, FAR const void *msg,
   /* Construct the message header info */
 
   mqmsg->priority = prio;
-  mqmsg->msglen   = msglen;
 
-  /* Copy the message data into the message */
+#ifdef CONFIG_MQ_ZEROCOPY
+  if (mqmsg->type == MQ_ALLOC_POOL)
+    {
+      ((FAR struct mqueue_buf_s *)mqmsg)->msglen = msglen;
+    }
+  else
+#endif
+    {
+      mqmsg->msglen = msglen;
 
-  memcpy((void*)mqmsg->mail, (const void*)msg, msglen);
+      /* Copy the message data into the message */
+
+      memcpy((void*)mqmsg->mail, (const void*)msg, msglen);
+    }
 
   /* Insert the new message in the message queue */
 
   saved_state = irqsave();
 
+#ifdef CONFIG_MQ_PRIOINDEX
+  /* The priority index gives the last message with the same or higher
+   * priority directly.
+   */
+
+  prev = mq_prioinsert(msgq, mqmsg);
+#else
   /* Search the message list to find the location to insert the new
    * message. Each is list is maintained in ascending priority order.
    */
@@ -358,6 +389,7 @@ int mq_dosend(mqd_t mqdes, FAR struct mqueue_msg_s *mqmsg, FAR const void *msg,
   for (prev = NULL, next = (FAR struct mqueue_msg_s*)msgq->msglist.head;
        next && prio <= next->priority;
        prev = next, next = next->next);
+#endif
 
   /* Add the message at the right place */
 
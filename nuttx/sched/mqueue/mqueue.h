@@ -75,6 +75,17 @@
 
 #define NUM_INTERRUPT_MSGS   8
 
+#ifdef CONFIG_MQ_ZEROCOPY
+/* Each pool buffer begins with a struct mqueue_buf_s header.  The message
+ * data follows the header at an 8-byte aligned offset.
+ */
+
+#  define MQ_BUF_HDRSIZE     ((sizeof(struct mqueue_buf_s) + 7) & ~7)
+#  define MQ_BUF_DATA(b)     ((FAR void *)((FAR uint8_t *)(b) + MQ_BUF_HDRSIZE))
+#  define MQ_BUF_HDR(d) \
+     ((FAR struct mqueue_buf_s *)((FAR uint8_t *)(d) - MQ_BUF_HDRSIZE))
+#endif
+
 /****************************************************************************
  * Public Type Definitions
  ****************************************************************************/
@@ -83,7 +94,8 @@ enum mqalloc_e
 {
   MQ_ALLOC_FIXED = 0,  /* pre-allocated; never freed */
   MQ_ALLOC_DYN,        /* dynamically allocated; free when unused */
-  MQ_ALLOC_IRQ         /* Preallocated, reserved for interrupt handling */
+  MQ_ALLOC_IRQ,        /* Preallocated, reserved for interrupt handling */
+  MQ_ALLOC_POOL        /* Buffer from the pool of a zero-copy queue */
 };
 
 /* This structure describes one buffered POSIX message. */
@@ -101,6 +113,21 @@ struct mqueue_msg_s
   uint8_t mail[MQ_MAX_BYTES];        /* Message data */
 };
 
+/* This structure is the header of one message of a zero-copy message
+ * queue.  The first three fields must match struct mqueue_msg_s so that
+ * both kinds of messages can be kept in the same prioritized list.
+ */
+
+#ifdef CONFIG_MQ_ZEROCOPY
+struct mqueue_buf_s
+{
+  FAR struct mqueue_buf_s  *next;    /* Forward link to next message */
+  uint8_t type;                      /* Always MQ_ALLOC_POOL */
+  uint8_t priority;                  /* priority of message */
+  size_t msglen;                     /* Message data length */
+};
+#endif
+
 /****************************************************************************
  * Public Variables
  ****************************************************************************/
@@ -163,6 +190,15 @@ int mq_waitsend(mqd_t mqdes);
 int mq_dosend(mqd_t mqdes, FAR struct mqueue_msg_s *mqmsg,
               FAR const void *msg, size_t msglen, int prio);
 
+/* mq_prioindex.c **********************************************************/
+
+#ifdef CONFIG_MQ_PRIOINDEX
+FAR struct mqueue_msg_s *mq_prioinsert(FAR struct mqueue_inode_s *msgq,
+                                       FAR struct mqueue_msg_s *mqmsg);
+void mq_prioremove(FAR struct mqueue_inode_s *msgq,
+                   FAR struct mqueue_msg_s *mqmsg);
+#endif
+
 /* mq_release.c ************************************************************/
 
 struct task_group_s; /* Forward reference */
@@ -109,6 +109,10 @@ void pthread_release(FAR struct task_group_s *group);
 int pthread_givesemaphore(sem_t *sem);
 int pthread_takesemaphore(sem_t *sem);
 
+int pthread_mutex_trytake(FAR pthread_mutex_t *mutex);
+int pthread_mutex_take(FAR pthread_mutex_t *mutex);
+int pthread_mutex_give(FAR pthread_mutex_t *mutex);
+
 #ifdef CONFIG_MUTEX_TYPES
 int pthread_mutexattr_verifytype(int type);
 #endif
@@ -113,8 +113,7 @@ int pthread_cond_wait(FAR pthread_cond_t *cond, FAR pthread_mutex_t *mutex)
       sdbg("Give up mutex / take cond\n");
 
       sched_lock();
-      mutex->pid = 0;
-      ret = pthread_givesemaphore((sem_t*)&mutex->sem);
+      ret = pthread_mutex_give(mutex);
 
       /* Take the semaphore */
 
@@ -124,11 +123,7 @@ int pthread_cond_wait(FAR pthread_cond_t *cond, FAR pthread_mutex_t *mutex)
       /* Reacquire the mutex */
 
       sdbg("Reacquire mutex...\n");
-      ret |= pthread_takesemaphore((sem_t*)&mutex->sem);
-      if (!ret)
-        {
-          mutex->pid = getpid();;
-        }
+      ret |= pthread_mutex_take(mutex);
     }
 
   sdbg("Returning %d\n", ret);
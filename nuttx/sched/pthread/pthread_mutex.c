@@ -0,0 +1,202 @@
+/****************************************************************************
+ * sched/pthread/pthread_mutex.c
+ *
+ *   Copyright (C) 2014 Gregory Nutt. All rights reserved.
+ *   Author: Gregory Nutt <gnutt@nuttx.org>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name NuttX nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <unistd.h>
+#include <pthread.h>
+#include <sched.h>
+#include <errno.h>
+
+#include <arch/irq.h>
+
+#include "sched/sched.h"
+#include "semaphore/semaphore.h"
+#include "pthread/pthread.h"
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: pthread_mutex_trytake
+ *
+ * Description:
+ *   Take the mutex if it is available.  This is the uncontended fast path
+ *   of the mutex:  The count of the underlying semaphore and the owner of
+ *   the mutex are updated in one short critical section without calling
+ *   sem_wait() and without recording the caller as a holder of the
+ *   semaphore for priority inheritance.  The holder is recorded later by
+ *   pthread_mutex_take() only if another thread has to wait for the mutex.
+ *
+ * Parameters:
+ *   mutex - A reference to the mutex to be taken.
+ *
+ * Return Value:
+ *   OK if the mutex was taken or EBUSY if it is held.
+ *
+ * Assumptions:
+ *   Not called from an interrupt handler.
+ *
+ ****************************************************************************/
+
+int pthread_mutex_trytake(FAR pthread_mutex_t *mutex)
+{
+  irqstate_t flags;
+  int ret = EBUSY;
+
+  flags = irqsave();
+  if (mutex->sem.semcount > 0)
+    {
+      mutex->sem.semcount--;
+      mutex->pid = (int)getpid();
+      ret = OK;
+    }
+
+  irqrestore(flags);
+  return ret;
+}
+
+/****************************************************************************
+ * Name: pthread_mutex_take
+ *
+ * Description:
+ *   Take the mutex, waiting for it if it is held by another thread.
+ *
+ *   If the holder took the mutex with pthread_mutex_trytake(), then it has
+ *   not been recorded as a holder of the semaphore.  It is recorded here,
+ *   before waiting, so that sem_wait() can boost its priority.
+ *
+ * Parameters:
+ *   mutex - A reference to the mutex to be taken.
+ *
+ * Return Value:
+ *   OK on success or ERROR with the errno value set to EINVAL (see
+ *   pthread_takesemaphore()).
+ *
+ * Assumptions:
+ *   Not called from an interrupt handler.
+ *
+ ****************************************************************************/
+
+int pthread_mutex_take(FAR pthread_mutex_t *mutex)
+{
+#ifdef CONFIG_PRIORITY_INHERITANCE
+  FAR struct tcb_s *htcb;
+#endif
+  irqstate_t flags;
+  int ret;
+
+  flags = irqsave();
+  if (mutex->sem.semcount > 0)
+    {
+      mutex->sem.semcount--;
+      mutex->pid = (int)getpid();
+      irqrestore(flags);
+      return OK;
+    }
+
+#ifdef CONFIG_PRIORITY_INHERITANCE
+  if (mutex->pid > 0 && !sem_hasholders(&mutex->sem))
+    {
+      htcb = sched_gettcb(mutex->pid);
+      if (htcb)
+        {
+          sem_addholder_tcb(htcb, &mutex->sem);
+        }
+    }
+#endif
+
+  irqrestore(flags);
+
+  ret = pthread_takesemaphore((sem_t*)&mutex->sem);
+  if (ret == OK)
+    {
+      mutex->pid = (int)getpid();
+    }
+
+  return ret;
+}
+
+/****************************************************************************
+ * Name: pthread_mutex_give
+ *
+ * Description:
+ *   Release the mutex.  If no thread is waiting for the mutex and the
+ *   caller is not recorded as a holder of the semaphore, then the count is
+ *   simply restored.  Otherwise, the semaphore is posted so that the
+ *   highest priority waiter is awakened and any priority inheritance is
+ *   undone.
+ *
+ * Parameters:
+ *   mutex - A reference to the mutex to be released.
+ *
+ * Return Value:
+ *   OK on success or ERROR with the errno value set to EINVAL (see
+ *   pthread_givesemaphore()).
+ *
+ * Assumptions:
+ *   The caller holds the mutex.
+ *
+ ****************************************************************************/
+
+int pthread_mutex_give(FAR pthread_mutex_t *mutex)
+{
+  irqstate_t flags;
+  int ret;
+
+  flags = irqsave();
+  mutex->pid = 0;
+
+  if (mutex->sem.semcount == 0 && !sem_hasholders(&mutex->sem))
+    {
+      mutex->sem.semcount = 1;
+      irqrestore(flags);
+      return OK;
+    }
+
+  /* Keep the awakened thread from running until sem_post() has completed */
+
+  sched_lock();
+  irqrestore(flags);
+
+  ret = pthread_givesemaphore((sem_t*)&mutex->sem);
+  sched_unlock();
+  return ret;
+}
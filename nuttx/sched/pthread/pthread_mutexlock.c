@@ -127,6 +127,17 @@ int pthread_mutex_lock(FAR pthread_mutex_t *mutex)
     {
       ret = EINVAL;
     }
+
+  /* Most mutexes are not contended.  Try to take the mutex without locking
+   * the scheduler or going through sem_wait().
+   */
+
+  else if (pthread_mutex_trytake(mutex) == OK)
+    {
+#ifdef CONFIG_MUTEX_TYPES
+      mutex->nlocks = 1;
+#endif
+    }
   else
     {
       /* Make sure the semaphore is stable while we make the following
@@ -161,21 +172,16 @@ int pthread_mutex_lock(FAR pthread_mutex_t *mutex)
         }
       else
         {
-          /* Take the semaphore */
+          /* Wait for the mutex.  This also makes us the owner. */
 
-          ret = pthread_takesemaphore((sem_t*)&mutex->sem);
-
-          /* If we succussfully obtained the semaphore, then indicate
-           * that we own it.
-           */
+          ret = pthread_mutex_take(mutex);
 
+#ifdef CONFIG_MUTEX_TYPES
           if (!ret)
             {
-              mutex->pid    = mypid;
-#ifdef CONFIG_MUTEX_TYPES
               mutex->nlocks = 1;
-#endif
             }
+#endif
         }
 
       sched_unlock();
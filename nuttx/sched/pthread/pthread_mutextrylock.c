@@ -108,35 +108,18 @@ int pthread_mutex_trylock(FAR pthread_mutex_t *mutex)
     }
   else
     {
-      /* Make sure the semaphore is stable while we make the following
-       * checks.  This all needs to be one atomic action.
+      /* Try to get the mutex.  If we succeed, this also makes us the
+       * owner.
        */
 
-      sched_lock();
+      ret = pthread_mutex_trytake(mutex);
 
-      /* Try to get the semaphore. */
-
-      if (sem_trywait((sem_t*)&mutex->sem) == OK)
+#ifdef CONFIG_MUTEX_TYPES
+      if (ret == OK)
         {
-          /* If we succussfully obtained the semaphore, then indicate
-           * that we own it.
-           */
-
-          mutex->pid = (int)getpid();
+          mutex->nlocks = 1;
         }
-
-      /* Was it not available? */
-
-      else if (get_errno() == EAGAIN)
-        {
-          ret = EBUSY;
-        }
-      else
-        {
-          ret = EINVAL;
-        }
-
-      sched_unlock();
+#endif
     }
 
   sdbg("Returning %d\n", ret);
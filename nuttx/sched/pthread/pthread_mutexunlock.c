@@ -110,14 +110,11 @@ int pthread_mutex_unlock(FAR pthread_mutex_t *mutex)
     }
   else
     {
-      /* Make sure the semaphore is stable while we make the following
-       * checks.  This all needs to be one atomic action.
+      /* Does the calling thread own the semaphore?  Only the owner can
+       * change the owner of a held mutex so the following checks do not
+       * need to lock the scheduler.
        */
 
-      sched_lock();
-
-      /* Does the calling thread own the semaphore? */
-
       if (mutex->pid != (int)getpid())
         {
           /* No... return an error (default behavior is like PTHREAD_MUTEX_ERRORCHECK) */
@@ -146,15 +143,13 @@ int pthread_mutex_unlock(FAR pthread_mutex_t *mutex)
 
       else
         {
-          /* Nullify the pid and lock count then post the semaphore */
+          /* Nullify the lock count then release the mutex */
 
-          mutex->pid    = 0;
 #ifdef CONFIG_MUTEX_TYPES
           mutex->nlocks = 0;
 #endif
-          ret = pthread_givesemaphore((sem_t*)&mutex->sem);
+          ret = pthread_mutex_give(mutex);
         }
-      sched_unlock();
     }
 
   sdbg("Returning %d\n", ret);
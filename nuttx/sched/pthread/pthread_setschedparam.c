@@ -83,18 +83,19 @@
  *   is given by 'thread' to the policy and associated parameters provided
  *   in 'policy' and 'param', respectively.
  *
- *   The policy parameter may have the value SCHED_FIFO, or SCHED_RR
- *   (SCHED_OTHER and SCHED_SPORADIC, in particular, are not supported).
- *   The SCHED_FIFO and SCHED_RR policies will have a single scheduling
- *   parameter, sched_priority.
+ *   The policy parameter may have the value SCHED_FIFO, SCHED_RR or, if
+ *   CONFIG_SCHED_SPORADIC is selected, SCHED_SPORADIC (SCHED_OTHER, in
+ *   particular, is not supported).  The SCHED_FIFO and SCHED_RR policies
+ *   will have a single scheduling parameter, sched_priority.  The
+ *   SCHED_SPORADIC policy also uses the sched_ss_* parameters.
  *
  *   If the pthread_setschedparam() function fails, the scheduling parameters
  *   will not be changed for the target thread.
  *
  * Parameters:
  *   thread - The ID of thread whose scheduling parameters will be modified.
- *   policy - The new scheduling policy of the thread.  Either SCHED_FIFO or
- *            SCHED_RR. SCHED_OTHER and SCHED_SPORADIC are not supported.
+ *   policy - The new scheduling policy of the thread.  Either SCHED_FIFO,
+ *            SCHED_RR or SCHED_SPORADIC.  SCHED_OTHER is not supported.
  *   param  - Provides the new priority of the thread.
  *
  * Return Value:
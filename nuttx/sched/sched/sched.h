@@ -43,11 +43,13 @@
 #include <nuttx/config.h>
 
 #include <sys/types.h>
+#include <stdint.h>
 #include <stdbool.h>
 #include <queue.h>
 #include <sched.h>
 
 #include <nuttx/kmalloc.h>
+#include <nuttx/wdog.h>
 
 /****************************************************************************
  * Pre-processor Definitions
@@ -64,6 +66,30 @@
 #define MAX_TASKS_MASK      (CONFIG_MAX_TASKS-1)
 #define PIDHASH(pid)        ((pid) & MAX_TASKS_MASK)
 
+/* The task list that holds a task in the given state.  A task that is
+ * waiting for a semaphore is held in the wait list of that semaphore
+ * rather than in a global list, so tcb->waitsem must be valid whenever
+ * the task is in the TSTATE_WAIT_SEM state.
+ */
+
+#define TLIST_HEAD(t,s) \
+  ((s) == TSTATE_WAIT_SEM ? &(t)->waitsem->waitlist : \
+   (FAR dq_queue_t *)g_tasklisttable[s].list)
+
+/* The priority index of a task list or NULL if the list is not indexed */
+
+#ifdef CONFIG_SCHED_PRIOBITMAP
+#  define PRIOINDEX_NWORDS ((SCHED_PRIORITY_MAX + 32) >> 5)
+#  define sched_prioindex(l) \
+     ((FAR dq_queue_t *)(l) == (FAR dq_queue_t *)&g_readytorun ? \
+      &g_readytorunndx : \
+      (FAR dq_queue_t *)(l) == (FAR dq_queue_t *)&g_pendingtasks ? \
+      &g_pendingndx : NULL)
+#else
+#  define sched_removelist(t,l) \
+     dq_rem((FAR dq_entry_t*)(t), (FAR dq_queue_t*)(l))
+#endif
+
 /****************************************************************************
  * Public Type Definitions
  ****************************************************************************/
@@ -99,6 +125,56 @@ struct tasklist_s
   bool prioritized;               /* true if the list is prioritized */
 };
 
+/* This structure indexes a prioritized task list by priority so that a
+ * TCB can be inserted without searching the list.  Each priority that is
+ * present in the list has its bit set in the bitmap and tail[] points to
+ * the last TCB of that priority.
+ */
+
+#ifdef CONFIG_SCHED_PRIOBITMAP
+struct prioindex_s
+{
+  uint32_t bitmap[PRIOINDEX_NWORDS];              /* Priorities present */
+  FAR struct tcb_s *tail[SCHED_PRIORITY_MAX + 1]; /* Last TCB of each */
+};
+#endif
+
+#ifdef CONFIG_SCHED_SPORADIC
+/* This structure describes one replenishment of a sporadic server.  The
+ * budget consumed during one activation of the thread is returned to it
+ * when the timer expires one replenishment period after the activation.
+ */
+
+struct replenishment_s
+{
+  FAR struct sporadic_s *sporadic; /* The sporadic server to replenish */
+  WDOG_ID  timer;                  /* Expires at the replenishment time */
+  uint32_t budget;                 /* Budget consumed (ticks) */
+  bool     active;                 /* True: Replenishment is pending */
+};
+
+/* This structure holds the state of one thread that uses the
+ * SCHED_SPORADIC policy.  It is allocated when the policy is selected and
+ * is referenced by tcb->sporadic.
+ */
+
+struct sporadic_s
+{
+  FAR struct tcb_s *tcb;           /* The sporadic thread */
+  uint8_t  hi_priority;            /* Priority while budget remains */
+  uint8_t  low_priority;           /* Priority when the budget is exhausted */
+  uint8_t  max_repl;               /* Maximum number of replenishments */
+  uint8_t  nrepl;                  /* Number of pending replenishments */
+  bool     lowprio;                /* True: Running at low_priority */
+  uint32_t repl_period;            /* Replenishment period (ticks) */
+  uint32_t init_budget;            /* Initial budget (ticks) */
+  uint32_t budget;                 /* Remaining budget (ticks) */
+  uint32_t lastrun;                /* Time of the last tick charged */
+  FAR struct replenishment_s *current; /* Replenishment of this activation */
+  struct replenishment_s repl[CONFIG_SCHED_SPORADIC_MAXREPL];
+};
+#endif
+
 /****************************************************************************
  * Global Variables
  ****************************************************************************/
@@ -109,8 +185,9 @@ struct tasklist_s
  * and by a series of task lists.  All of these tasks lists are declared
  * below. Although it is not always necessary, most of these lists are
  * prioritized so that common list handling logic can be used (only the
- * g_readytorun, the g_pendingtasks, and the g_waitingforsemaphore lists need
- * to be prioritized).
+ * g_readytorun, the g_pendingtasks, and the semaphore wait lists need to be
+ * prioritized).  Tasks waiting for a semaphore are held in the waitlist of
+ * the semaphore (see TLIST_HEAD()).
  */
 
 /* This is the list of all tasks that are ready to run.  The head of this
@@ -128,10 +205,6 @@ extern volatile dq_queue_t g_readytorun;
 
 extern volatile dq_queue_t g_pendingtasks;
 
-/* This is the list of all tasks that are blocked waiting for a semaphore */
-
-extern volatile dq_queue_t g_waitingforsemaphore;
-
 /* This is the list of all tasks that are blocked waiting for a signal */
 
 #ifndef CONFIG_DISABLE_SIGNALS
@@ -203,6 +276,15 @@ extern struct pidhash_s g_pidhash[CONFIG_MAX_TASKS];
 
 extern const struct tasklist_s g_tasklisttable[NUM_TASK_STATES];
 
+/* Declared in sched_prioindex.c ********************************************/
+
+/* The priority indices of the g_readytorun and g_pendingtasks lists */
+
+#ifdef CONFIG_SCHED_PRIOBITMAP
+extern struct prioindex_s g_readytorunndx;
+extern struct prioindex_s g_pendingndx;
+#endif
+
 #ifdef CONFIG_SCHED_CPULOAD
 /* This is the total number of clock tick counts.  Essentially the
  * 'denominator' for all CPU load calculations.
@@ -211,6 +293,25 @@ extern const struct tasklist_s g_tasklisttable[NUM_TASK_STATES];
 extern volatile uint32_t g_cpuload_total;
 #endif
 
+#ifdef CONFIG_SCHED_SPORADIC
+/* Declared in sched_sporadic.c *********************************************/
+
+/* The number of threads that use the SCHED_SPORADIC policy */
+
+extern uint16_t g_nsporadic;
+#endif
+
+#ifdef CONFIG_SCHED_CPUTIME
+/* Declared in sched_cputime.c **********************************************/
+
+/* Set by the callers of up_reprioritize_rtr() that pre-empt the running
+ * task, so that sched_removereadytorun() accounts the resulting context
+ * switch as involuntary.  Cleared again by sched_removereadytorun().
+ */
+
+extern bool g_cputime_preempt;
+#endif
+
 /****************************************************************************
  * Public Function Prototypes
  ****************************************************************************/
@@ -219,6 +320,11 @@ bool sched_addreadytorun(FAR struct tcb_s *rtrtcb);
 bool sched_removereadytorun(FAR struct tcb_s *rtrtcb);
 bool sched_addprioritized(FAR struct tcb_s *newTcb, DSEG dq_queue_t *list);
 bool sched_mergepending(void);
+#ifdef CONFIG_SCHED_PRIOBITMAP
+bool sched_addindexed(FAR struct tcb_s *tcb, DSEG dq_queue_t *list,
+                      FAR struct prioindex_s *ndx);
+void sched_removelist(FAR struct tcb_s *tcb, DSEG dq_queue_t *list);
+#endif
 void sched_addblocked(FAR struct tcb_s *btcb, tstate_t task_state);
 void sched_removeblocked(FAR struct tcb_s *btcb);
 int  sched_setpriority(FAR struct tcb_s *tcb, int sched_priority);
@@ -245,6 +351,27 @@ void sched_timer_reassess(void);
 void weak_function sched_process_cpuload(void);
 #endif
 
+#ifdef CONFIG_SCHED_CPUTIME
+void sched_cputime_switch(FAR struct tcb_s *from, FAR struct tcb_s *to,
+                          bool voluntary);
+void sched_cputime_update(void);
+#  define sched_cputime_preempt(p) (g_cputime_preempt = (p))
+#else
+#  define sched_cputime_switch(f,t,v)
+#  define sched_cputime_update()
+#  define sched_cputime_preempt(p)
+#endif
+
+#ifdef CONFIG_SCHED_SPORADIC
+int  sched_sporadic_initialize(FAR struct tcb_s *tcb,
+                               FAR const struct sched_param *param);
+void sched_sporadic_stop(FAR struct tcb_s *tcb);
+void sched_sporadic_getparam(FAR struct tcb_s *tcb,
+                             FAR struct sched_param *param);
+unsigned int sched_sporadic_process(FAR struct tcb_s *tcb,
+                                    unsigned int ticks, bool noswitches);
+#endif
+
 bool sched_verifytcb(FAR struct tcb_s *tcb);
 int  sched_releasetcb(FAR struct tcb_s *tcb, uint8_t ttype);
 
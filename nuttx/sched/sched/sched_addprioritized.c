@@ -101,11 +101,26 @@ bool sched_addprioritized(FAR struct tcb_s *tcb, DSEG dq_queue_t *list)
   FAR struct tcb_s *prev;
   uint8_t sched_priority = tcb->sched_priority;
   bool ret = false;
+#ifdef CONFIG_SCHED_PRIOBITMAP
+  FAR struct prioindex_s *ndx;
+#endif
 
   /* Lets do a sanity check before we get started. */
 
   ASSERT(sched_priority >= SCHED_PRIORITY_MIN);
 
+#ifdef CONFIG_SCHED_PRIOBITMAP
+  /* If the list has a priority index, then the position can be found
+   * without searching.
+   */
+
+  ndx = sched_prioindex(list);
+  if (ndx)
+    {
+      return sched_addindexed(tcb, list, ndx);
+    }
+#endif
+
   /* Search the list to find the location to insert the new Tcb.
    * Each is list is maintained in ascending sched_priority order.
    */
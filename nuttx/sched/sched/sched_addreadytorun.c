@@ -126,6 +126,7 @@ bool sched_addreadytorun(FAR struct tcb_s *btcb)
       /* Inform the instrumentation logic that we are switching tasks */
 
       sched_note_switch(rtcb, btcb);
+      sched_cputime_switch(rtcb, btcb, false);
 
       /* The new btcb was added at the head of the ready-to-run list.  It
        * is now to new active task!
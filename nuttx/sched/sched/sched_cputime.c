@@ -0,0 +1,237 @@
+/****************************************************************************
+ * sched/sched/sched_cputime.c
+ *
+ *   Copyright (C) 2014 Gregory Nutt. All rights reserved.
+ *   Author: Gregory Nutt <gnutt@nuttx.org>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name NuttX nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <errno.h>
+#include <assert.h>
+
+#include <nuttx/arch.h>
+#include <nuttx/clock.h>
+#include <arch/irq.h>
+
+#include "sched/sched.h"
+
+#ifdef CONFIG_SCHED_CPUTIME
+
+/****************************************************************************
+ * Public Data
+ ****************************************************************************/
+
+/* True if the next removal of the running task from the ready-to-run list
+ * is a pre-emption (see sched_cputime_preempt()).
+ */
+
+bool g_cputime_preempt;
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: sched_cputime_charge
+ *
+ * Description:
+ *   Charge the time since the thread was last accounted to the thread.
+ *
+ ****************************************************************************/
+
+static inline void sched_cputime_charge(FAR struct tcb_s *tcb, uint32_t now)
+{
+  uint32_t elapsed = now - tcb->run_stamp;
+
+  tcb->run_time  += elapsed;
+  tcb->run_slice += elapsed;
+  tcb->run_stamp  = now;
+
+  if (tcb->run_slice > tcb->run_max)
+    {
+      tcb->run_max = tcb->run_slice;
+    }
+}
+
+/****************************************************************************
+ * Name: sched_cputime_usec
+ *
+ * Description:
+ *   Convert a count of the high-resolution counter to microseconds.
+ *
+ ****************************************************************************/
+
+static uint64_t sched_cputime_usec(uint64_t counts, uint32_t freq)
+{
+  return (counts / freq) * USEC_PER_SEC +
+         ((counts % freq) * USEC_PER_SEC) / freq;
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: sched_cputime_switch
+ *
+ * Description:
+ *   Account for a context switch:  Charge the run that just ended to the
+ *   thread being suspended and start a new run for the thread being
+ *   resumed.  This is called from the same places as sched_note_switch().
+ *
+ * Input Parameters:
+ *   from      - The TCB of the thread being suspended
+ *   to        - The TCB of the thread being resumed
+ *   voluntary - True if the suspended thread gave up the CPU (by blocking,
+ *               exiting or yielding); false if it was pre-empted.
+ *
+ * Returned Value:
+ *   None
+ *
+ * Assumptions:
+ *   Called with interrupts disabled.
+ *
+ ****************************************************************************/
+
+void sched_cputime_switch(FAR struct tcb_s *from, FAR struct tcb_s *to,
+                          bool voluntary)
+{
+  uint32_t now = up_perf_gettime();
+
+  sched_cputime_charge(from, now);
+
+  if (voluntary)
+    {
+      from->nvcsw++;
+    }
+  else
+    {
+      from->nivcsw++;
+    }
+
+  to->run_stamp = now;
+  to->run_slice = 0;
+}
+
+/****************************************************************************
+ * Name: sched_cputime_update
+ *
+ * Description:
+ *   Charge the time since the last context switch to the running thread.
+ *   This is called on each timer interrupt so that the counter cannot wrap
+ *   around between two accountings of a thread that runs for a long time.
+ *
+ * Assumptions:
+ *   Called from the timer interrupt handler with interrupts disabled.
+ *
+ ****************************************************************************/
+
+void sched_cputime_update(void)
+{
+  sched_cputime_charge((FAR struct tcb_s *)g_readytorun.head,
+                       up_perf_gettime());
+}
+
+/****************************************************************************
+ * Function:  clock_cputime
+ *
+ * Description:
+ *   Return the CPU accounting of the selected PID.  The execution time
+ *   includes the current run if the thread is running.
+ *
+ * Parameters:
+ *   pid - The task ID of the thread of interest.  pid == 0 is the IDLE thread.
+ *   cputime - The location to return the CPU accounting
+ *
+ * Return Value:
+ *   OK (0) on success; a negated errno value on failure.  The only reason
+ *   that this function can fail is if 'pid' no longer refers to a valid
+ *   thread.
+ *
+ ****************************************************************************/
+
+int clock_cputime(int pid, FAR struct cputime_s *cputime)
+{
+  FAR struct tcb_s *tcb;
+  irqstate_t flags;
+  uint64_t runtime;
+  uint32_t maxrun;
+  uint32_t freq;
+  int ret = -ESRCH;
+
+  DEBUGASSERT(cputime);
+
+  /* Momentarily disable interrupts.  We need (1) the task to stay valid
+   * while we are doing these operations and (2) the counts to be
+   * synchronized when read.
+   */
+
+  freq  = up_perf_getfreq();
+  flags = irqsave();
+
+  tcb = sched_gettcb(pid);
+  if (tcb != NULL)
+    {
+      /* Bring the running thread up to date */
+
+      if (tcb == (FAR struct tcb_s *)g_readytorun.head)
+        {
+          sched_cputime_charge(tcb, up_perf_gettime());
+        }
+
+      runtime          = tcb->run_time;
+      maxrun           = tcb->run_max;
+      cputime->nvcsw   = tcb->nvcsw;
+      cputime->nivcsw  = tcb->nivcsw;
+      ret              = OK;
+    }
+
+  irqrestore(flags);
+
+  /* Convert to microseconds outside of the critical section */
+
+  if (ret == OK)
+    {
+      cputime->runtime = sched_cputime_usec(runtime, freq);
+      cputime->maxrun  = (uint32_t)sched_cputime_usec(maxrun, freq);
+    }
+
+  return ret;
+}
+
+#endif /* CONFIG_SCHED_CPUTIME */
@@ -115,6 +115,9 @@ int sched_getparam (pid_t pid, struct sched_param * param)
        /* Return the priority if the calling task. */
 
        param->sched_priority = (int)rtcb->sched_priority;
+#ifdef CONFIG_SCHED_SPORADIC
+       sched_sporadic_getparam(rtcb, param);
+#endif
     }
 
   /* Ths pid is not for the calling task, we will have to look it up */
@@ -136,6 +139,9 @@ int sched_getparam (pid_t pid, struct sched_param * param)
           /* Return the priority of the task */
 
           param->sched_priority = (int)tcb->sched_priority;
+#ifdef CONFIG_SCHED_SPORADIC
+          sched_sporadic_getparam(tcb, param);
+#endif
         }
 
       sched_unlock();
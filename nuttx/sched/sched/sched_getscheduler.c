@@ -118,6 +118,12 @@ int sched_getscheduler(pid_t pid)
       set_errno(ESRCH);
       return ERROR;
     }
+#ifdef CONFIG_SCHED_SPORADIC
+  else if ((tcb->flags & TCB_FLAG_SPORADIC) != 0)
+    {
+      return SCHED_SPORADIC;
+    }
+#endif
 #if CONFIG_RR_INTERVAL > 0
   else if ((tcb->flags & TCB_FLAG_ROUND_ROBIN) != 0)
     {
@@ -40,6 +40,7 @@
 #include <nuttx/config.h>
 
 #include <stdbool.h>
+#include <string.h>
 #include <sched.h>
 #include <queue.h>
 #include <assert.h>
@@ -92,6 +93,48 @@
  *
  ************************************************************************/
 
+#ifdef CONFIG_SCHED_PRIOBITMAP
+bool sched_mergepending(void)
+{
+  FAR struct tcb_s *rtrhead = (FAR struct tcb_s*)g_readytorun.head;
+  FAR struct tcb_s *pndtcb;
+
+  /* Move every TCB from the g_pendingtasks list, highest priority first.
+   * The priority index finds the location of each in the g_readytorun
+   * list without searching.
+   */
+
+  while ((pndtcb = (FAR struct tcb_s*)
+          dq_remfirst((FAR dq_queue_t*)&g_pendingtasks)) != NULL)
+    {
+      g_pendingndx.tail[pndtcb->sched_priority] = NULL;
+      (void)sched_addindexed(pndtcb, (FAR dq_queue_t*)&g_readytorun,
+                             &g_readytorunndx);
+      pndtcb->task_state = TSTATE_TASK_READYTORUN;
+    }
+
+  /* The g_pendingtasks list is now empty */
+
+  memset(g_pendingndx.bitmap, 0, sizeof(g_pendingndx.bitmap));
+
+  /* Check if a pending task is now at the head of the list */
+
+  pndtcb = (FAR struct tcb_s*)g_readytorun.head;
+  if (pndtcb != rtrhead)
+    {
+      /* Inform the instrumentation layer that we are switching tasks */
+
+      sched_note_switch(rtrhead, pndtcb);
+      sched_cputime_switch(rtrhead, pndtcb, false);
+
+      rtrhead->task_state = TSTATE_TASK_READYTORUN;
+      pndtcb->task_state  = TSTATE_TASK_RUNNING;
+      return true;
+    }
+
+  return false;
+}
+#else
 bool sched_mergepending(void)
 {
   FAR struct tcb_s *pndtcb;
@@ -136,6 +179,7 @@ bool sched_mergepending(void)
           /* Inform the instrumentation layer that we are switching tasks */
 
           sched_note_switch(rtrtcb, pndtcb);
+          sched_cputime_switch(rtrtcb, pndtcb, false);
 
           /* Then insert at the head of the list */
 
@@ -170,3 +214,4 @@ bool sched_mergepending(void)
 
   return ret;
 }
+#endif /* CONFIG_SCHED_PRIOBITMAP */
@@ -0,0 +1,447 @@
+/****************************************************************************
+ * sched/sched/sched_note.c
+ *
+ *   Copyright (C) 2014 Gregory Nutt. All rights reserved.
+ *   Author: Gregory Nutt <gnutt@nuttx.org>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name NuttX nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <sys/types.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <sched.h>
+#include <time.h>
+#include <errno.h>
+#include <assert.h>
+
+#include <nuttx/arch.h>
+#include <nuttx/clock.h>
+#include <nuttx/sched_note.h>
+
+#include "sched/sched.h"
+
+#ifdef CONFIG_SCHED_INSTRUMENTATION_BUFFER
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+/* The length of a note is held in a uint8_t */
+
+#if CONFIG_TASK_NAME_SIZE > (255 - 9)
+#  define NOTE_NAME_MAX (255 - 9)
+#else
+#  define NOTE_NAME_MAX CONFIG_TASK_NAME_SIZE
+#endif
+
+/****************************************************************************
+ * Private Types
+ ****************************************************************************/
+
+/* The circular note buffer.  ni_head is the index where the next note will
+ * be written; ni_tail is the index of the oldest note.  One byte is always
+ * left unused so that a full buffer can be distinguished from an empty one.
+ */
+
+struct note_info_s
+{
+  volatile unsigned int ni_head;
+  volatile unsigned int ni_tail;
+  uint8_t ni_buffer[CONFIG_SCHED_NOTE_BUFSIZE];
+};
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+static struct note_info_s g_note_info;
+
+#if !defined(CONFIG_SCHED_TICKLESS) && defined(CONFIG_SCHED_CPUTIME)
+/* The performance counter wraps quickly, so its elapsed counts are folded
+ * into a running microsecond time stamp each time a note is taken.
+ */
+
+static uint32_t g_note_perflast;  /* Counter value at the last note */
+static uint32_t g_note_perfrem;   /* Sub-microsecond remainder (counts) */
+static uint32_t g_note_usec;      /* Time stamp of the last note */
+#endif
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: note_next
+ *
+ * Description:
+ *   Return the buffer index that follows ndx by offset bytes.
+ *
+ ****************************************************************************/
+
+static inline unsigned int note_next(unsigned int ndx, unsigned int offset)
+{
+  ndx += offset;
+  if (ndx >= CONFIG_SCHED_NOTE_BUFSIZE)
+    {
+      ndx -= CONFIG_SCHED_NOTE_BUFSIZE;
+    }
+
+  return ndx;
+}
+
+/****************************************************************************
+ * Name: note_length
+ *
+ * Description:
+ *   Return the number of bytes held in the note buffer.  Interrupts must be
+ *   disabled by the caller.
+ *
+ ****************************************************************************/
+
+static inline unsigned int note_length(void)
+{
+  unsigned int head = g_note_info.ni_head;
+  unsigned int tail = g_note_info.ni_tail;
+
+  if (head >= tail)
+    {
+      return head - tail;
+    }
+
+  return CONFIG_SCHED_NOTE_BUFSIZE - (tail - head);
+}
+
+/****************************************************************************
+ * Name: note_systime
+ *
+ * Description:
+ *   Return the time stamp for a new note in microseconds.  The tickless
+ *   timer or the performance counter is used when available; otherwise
+ *   the time stamp has only the resolution of the system timer tick.
+ *
+ *   When the performance counter is used, notes must be taken at least
+ *   once per counter wrap-around period for the time stamps to remain
+ *   monotonic.
+ *
+ ****************************************************************************/
+
+static inline uint32_t note_systime(void)
+{
+#if defined(CONFIG_SCHED_TICKLESS)
+  struct timespec ts;
+
+  (void)up_timer_gettime(&ts);
+  return (uint32_t)ts.tv_sec * USEC_PER_SEC +
+         (uint32_t)ts.tv_nsec / NSEC_PER_USEC;
+#elif defined(CONFIG_SCHED_CPUTIME)
+  irqstate_t flags;
+  uint64_t counts;
+  uint32_t freq;
+  uint32_t now;
+  uint32_t usec;
+
+  flags  = irqsave();
+  freq   = up_perf_getfreq();
+  now    = up_perf_gettime();
+
+  counts = (uint64_t)(now - g_note_perflast) * USEC_PER_SEC +
+           g_note_perfrem;
+
+  g_note_perflast = now;
+  g_note_perfrem  = (uint32_t)(counts % freq);
+  g_note_usec    += (uint32_t)(counts / freq);
+  usec            = g_note_usec;
+
+  irqrestore(flags);
+  return usec;
+#else
+  return (uint32_t)clock_systimer() * USEC_PER_TICK;
+#endif
+}
+
+/****************************************************************************
+ * Name: note_common
+ *
+ * Description:
+ *   Fill in the common header of a note.
+ *
+ ****************************************************************************/
+
+static void note_common(FAR struct tcb_s *tcb,
+                        FAR struct note_common_s *note,
+                        uint8_t length, uint8_t type)
+{
+  uint32_t systime = note_systime();
+
+  note->nc_length      = length;
+  note->nc_type        = type;
+  note->nc_priority    = tcb->sched_priority;
+  note->nc_pid[0]      = (uint8_t)(tcb->pid & 0xff);
+  note->nc_pid[1]      = (uint8_t)((tcb->pid >> 8) & 0xff);
+  note->nc_systime[0]  = (uint8_t)(systime & 0xff);
+  note->nc_systime[1]  = (uint8_t)((systime >> 8) & 0xff);
+  note->nc_systime[2]  = (uint8_t)((systime >> 16) & 0xff);
+  note->nc_systime[3]  = (uint8_t)((systime >> 24) & 0xff);
+}
+
+/****************************************************************************
+ * Name: note_add
+ *
+ * Description:
+ *   Add a note to the circular buffer, discarding the oldest notes if
+ *   necessary to make room.  This may be called from interrupt handlers.
+ *
+ ****************************************************************************/
+
+static void note_add(FAR const uint8_t *note, unsigned int notelen)
+{
+  irqstate_t flags;
+  unsigned int head;
+
+  if (notelen >= CONFIG_SCHED_NOTE_BUFSIZE)
+    {
+      return;
+    }
+
+  flags = irqsave();
+
+  /* Discard the oldest notes until the new note fits */
+
+  while (note_length() + notelen >= CONFIG_SCHED_NOTE_BUFSIZE)
+    {
+      unsigned int tail = g_note_info.ni_tail;
+      unsigned int len  = g_note_info.ni_buffer[tail];
+
+      DEBUGASSERT(len >= sizeof(struct note_common_s));
+      g_note_info.ni_tail = note_next(tail, len);
+    }
+
+  /* Then copy the note into the buffer */
+
+  head = g_note_info.ni_head;
+  while (notelen-- > 0)
+    {
+      g_note_info.ni_buffer[head] = *note++;
+      head = note_next(head, 1);
+    }
+
+  g_note_info.ni_head = head;
+  irqrestore(flags);
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: sched_note_start, sched_note_stop, sched_note_switch,
+ *       sched_note_irqhandler, sched_note_semwait
+ *
+ * Description:
+ *   Hooks to scheduler monitor
+ *
+ * Input Parameters:
+ *   Varies
+ *
+ * Returned Value:
+ *   None
+ *
+ ****************************************************************************/
+
+void sched_note_start(FAR struct tcb_s *tcb)
+{
+  struct note_start_s note;
+  unsigned int length;
+#if CONFIG_TASK_NAME_SIZE > 0
+  unsigned int namelen;
+
+  /* The task name is not NUL terminated in the note */
+
+  namelen = strnlen(tcb->name, NOTE_NAME_MAX);
+  memcpy(note.nst_name, tcb->name, namelen);
+  length = sizeof(struct note_common_s) + namelen;
+#else
+  length = sizeof(struct note_common_s);
+#endif
+
+  note_common(tcb, &note.nst_cmn, length, NOTE_START);
+  note_add((FAR const uint8_t *)&note, length);
+}
+
+void sched_note_stop(FAR struct tcb_s *tcb)
+{
+  struct note_stop_s note;
+
+  note_common(tcb, &note.nsp_cmn, sizeof(struct note_stop_s), NOTE_STOP);
+  note_add((FAR const uint8_t *)&note, sizeof(struct note_stop_s));
+}
+
+void sched_note_switch(FAR struct tcb_s *pFromTcb, FAR struct tcb_s *pToTcb)
+{
+  struct note_switch_s note;
+
+  note_common(pFromTcb, &note.nsw_cmn, sizeof(struct note_switch_s),
+              NOTE_SWITCH);
+
+  note.nsw_pid[0]   = (uint8_t)(pToTcb->pid & 0xff);
+  note.nsw_pid[1]   = (uint8_t)((pToTcb->pid >> 8) & 0xff);
+  note.nsw_priority = pToTcb->sched_priority;
+
+  note_add((FAR const uint8_t *)&note, sizeof(struct note_switch_s));
+}
+
+#ifdef CONFIG_SCHED_INSTRUMENTATION_IRQHANDLER
+void sched_note_irqhandler(int irq, FAR void *handler, bool enter)
+{
+  FAR struct tcb_s *tcb = (FAR struct tcb_s *)g_readytorun.head;
+  struct note_irqhandler_s note;
+
+  note_common(tcb, &note.nih_cmn, sizeof(struct note_irqhandler_s),
+              enter ? NOTE_IRQ_ENTER : NOTE_IRQ_LEAVE);
+
+  note.nih_irq[0] = (uint8_t)(irq & 0xff);
+  note.nih_irq[1] = (uint8_t)((irq >> 8) & 0xff);
+
+  note_add((FAR const uint8_t *)&note, sizeof(struct note_irqhandler_s));
+}
+#endif
+
+#ifdef CONFIG_SCHED_INSTRUMENTATION_SEMAPHORE
+void sched_note_semwait(FAR struct tcb_s *tcb, FAR sem_t *sem)
+{
+  struct note_semwait_s note;
+  uintptr_t addr = (uintptr_t)sem;
+  int i;
+
+  note_common(tcb, &note.nsm_cmn, sizeof(struct note_semwait_s),
+              NOTE_SEMWAIT);
+
+  for (i = 0; i < sizeof(uintptr_t); i++)
+    {
+      note.nsm_sem[i] = (uint8_t)(addr & 0xff);
+      addr >>= 8;
+    }
+
+  note_add((FAR const uint8_t *)&note, sizeof(struct note_semwait_s));
+}
+#endif
+
+/****************************************************************************
+ * Name: sched_note_get
+ *
+ * Description:
+ *   Remove buffered notes from the circular note buffer.  Only complete
+ *   notes are returned.  Interrupts are disabled only while each single
+ *   note is copied.
+ *
+ * Input Parameters:
+ *   buffer - Location to return the notes
+ *   buflen - The size of the user buffer
+ *
+ * Returned Value:
+ *   On success, the number of bytes returned is returned; zero means that
+ *   the note buffer is empty.  -EFBIG is returned if buflen is too small
+ *   to hold even the first note.
+ *
+ ****************************************************************************/
+
+ssize_t sched_note_get(FAR uint8_t *buffer, size_t buflen)
+{
+  irqstate_t flags;
+  unsigned int tail;
+  unsigned int notelen;
+  size_t nread = 0;
+
+  for (; ; )
+    {
+      flags = irqsave();
+
+      tail = g_note_info.ni_tail;
+      if (tail == g_note_info.ni_head)
+        {
+          irqrestore(flags);
+          break;
+        }
+
+      notelen = g_note_info.ni_buffer[tail];
+      DEBUGASSERT(notelen >= sizeof(struct note_common_s));
+
+      if (nread + notelen > buflen)
+        {
+          irqrestore(flags);
+          if (nread == 0)
+            {
+              return -EFBIG;
+            }
+
+          break;
+        }
+
+      while (notelen-- > 0)
+        {
+          buffer[nread++] = g_note_info.ni_buffer[tail];
+          tail = note_next(tail, 1);
+        }
+
+      g_note_info.ni_tail = tail;
+      irqrestore(flags);
+    }
+
+  return (ssize_t)nread;
+}
+
+/****************************************************************************
+ * Name: sched_note_size
+ *
+ * Description:
+ *   Return the number of bytes currently held in the note buffer.
+ *
+ ****************************************************************************/
+
+size_t sched_note_size(void)
+{
+  irqstate_t flags;
+  size_t size;
+
+  flags = irqsave();
+  size  = note_length();
+  irqrestore(flags);
+
+  return size;
+}
+
+#endif /* CONFIG_SCHED_INSTRUMENTATION_BUFFER */
@@ -0,0 +1,242 @@
+/****************************************************************************
+ * sched/sched/sched_prioindex.c
+ *
+ *   Copyright (C) 2014 Gregory Nutt. All rights reserved.
+ *   Author: Gregory Nutt <gnutt@nuttx.org>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name NuttX nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <queue.h>
+#include <assert.h>
+
+#include "sched/sched.h"
+
+#ifdef CONFIG_SCHED_PRIOBITMAP
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+#define PRIOINDEX_WORD(p)  ((p) >> 5)
+#define PRIOINDEX_BIT(p)   ((uint32_t)1 << ((p) & 31))
+
+/****************************************************************************
+ * Global Variables
+ ****************************************************************************/
+
+/* The priority indices of the g_readytorun and g_pendingtasks lists */
+
+struct prioindex_s g_readytorunndx;
+struct prioindex_s g_pendingndx;
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: sched_ctz
+ *
+ * Description:
+ *   Return the index of the least significant set bit of a non-zero word.
+ *
+ ****************************************************************************/
+
+static inline unsigned int sched_ctz(uint32_t word)
+{
+#ifdef CONFIG_HAVE_BUILTIN_CLZ
+  return __builtin_ctz(word);
+#else
+  unsigned int ndx = 0;
+
+  if ((word & 0x0000ffff) == 0)
+    {
+      word >>= 16;
+      ndx   += 16;
+    }
+
+  if ((word & 0x000000ff) == 0)
+    {
+      word >>= 8;
+      ndx   += 8;
+    }
+
+  if ((word & 0x0000000f) == 0)
+    {
+      word >>= 4;
+      ndx   += 4;
+    }
+
+  if ((word & 0x00000003) == 0)
+    {
+      word >>= 2;
+      ndx   += 2;
+    }
+
+  if ((word & 0x00000001) == 0)
+    {
+      ndx   += 1;
+    }
+
+  return ndx;
+#endif
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: sched_addindexed
+ *
+ * Description:
+ *   Add a TCB to a prioritized list that has a priority index.  The TCB is
+ *   placed after every TCB of the same or higher priority.  The position
+ *   is found from the index in constant time rather than by searching the
+ *   list.
+ *
+ * Inputs:
+ *   tcb  - Points to the TCB to add to the prioritized list
+ *   list - Points to the prioritized list to add tcb to
+ *   ndx  - The priority index of list
+ *
+ * Return Value:
+ *   true if the head of the list has changed.
+ *
+ * Assumptions:
+ *   Same as for sched_addprioritized().
+ *
+ ****************************************************************************/
+
+bool sched_addindexed(FAR struct tcb_s *tcb, DSEG dq_queue_t *list,
+                      FAR struct prioindex_s *ndx)
+{
+  FAR struct tcb_s *prev = NULL;
+  uint8_t sched_priority = tcb->sched_priority;
+  unsigned int word = PRIOINDEX_WORD(sched_priority);
+  uint32_t bits;
+
+  /* Find the lowest priority present that is the same or higher than the
+   * priority of the new TCB.  The new TCB goes after the last TCB with
+   * that priority.
+   */
+
+  bits = ndx->bitmap[word] & ~(PRIOINDEX_BIT(sched_priority) - 1);
+  while (bits == 0 && ++word < PRIOINDEX_NWORDS)
+    {
+      bits = ndx->bitmap[word];
+    }
+
+  if (bits != 0)
+    {
+      prev = ndx->tail[(word << 5) + sched_ctz(bits)];
+      DEBUGASSERT(prev != NULL);
+    }
+
+  /* The new TCB is now the last TCB at its priority */
+
+  ndx->tail[sched_priority] = tcb;
+  ndx->bitmap[PRIOINDEX_WORD(sched_priority)] |=
+    PRIOINDEX_BIT(sched_priority);
+
+  if (prev)
+    {
+      dq_addafter((FAR dq_entry_t*)prev, (FAR dq_entry_t*)tcb,
+                  (FAR dq_queue_t*)list);
+      return false;
+    }
+
+  /* There are no TCBs of the same or higher priority */
+
+  dq_addfirst((FAR dq_entry_t*)tcb, (FAR dq_queue_t*)list);
+  return true;
+}
+
+/****************************************************************************
+ * Name: sched_removelist
+ *
+ * Description:
+ *   Remove a TCB from a task list, keeping the priority index of the list
+ *   current if it has one.
+ *
+ * Inputs:
+ *   tcb  - Points to the TCB to remove
+ *   list - Points to the task list that holds tcb
+ *
+ * Return Value:
+ *   None
+ *
+ * Assumptions:
+ * - The caller has established a critical section before calling this
+ *   function.
+ *
+ ****************************************************************************/
+
+void sched_removelist(FAR struct tcb_s *tcb, DSEG dq_queue_t *list)
+{
+  FAR struct prioindex_s *ndx = sched_prioindex(list);
+  FAR struct tcb_s *prev;
+  uint8_t sched_priority;
+
+  if (ndx)
+    {
+      sched_priority = tcb->sched_priority;
+      if (ndx->tail[sched_priority] == tcb)
+        {
+          /* The TCB before this one becomes the last TCB at this priority
+           * unless there is no other TCB at this priority.
+           */
+
+          prev = tcb->blink;
+          if (prev && prev->sched_priority == sched_priority)
+            {
+              ndx->tail[sched_priority] = prev;
+            }
+          else
+            {
+              ndx->tail[sched_priority] = NULL;
+              ndx->bitmap[PRIOINDEX_WORD(sched_priority)] &=
+                ~PRIOINDEX_BIT(sched_priority);
+            }
+        }
+    }
+
+  dq_rem((FAR dq_entry_t*)tcb, (FAR dq_queue_t*)list);
+}
+
+#endif /* CONFIG_SCHED_PRIOBITMAP */
@@ -134,6 +134,7 @@ static inline void sched_process_timeslice(void)
                    * priority.
                    */
 
+                  sched_cputime_preempt(true);
                   up_reprioritize_rtr(rtcb, rtcb->sched_priority);
                 }
             }
@@ -150,6 +151,35 @@ static inline void sched_process_timeslice(void)
 #  define sched_process_timeslice()
 #endif
 
+/************************************************************************
+ * Name:  sched_process_sporadic
+ *
+ * Description:
+ *   Charge the elapsed tick to the budget of the currently executing
+ *   task if it uses the sporadic server scheduling policy.
+ *
+ * Inputs:
+ *   None
+ *
+ * Return Value:
+ *   None
+ *
+ ************************************************************************/
+
+#ifdef CONFIG_SCHED_SPORADIC
+static inline void sched_process_sporadic(void)
+{
+  FAR struct tcb_s *rtcb  = (FAR struct tcb_s*)g_readytorun.head;
+
+  if ((rtcb->flags & TCB_FLAG_SPORADIC) != 0)
+    {
+      (void)sched_sporadic_process(rtcb, 1, false);
+    }
+}
+#else
+#  define sched_process_sporadic()
+#endif
+
 /************************************************************************
  * Public Functions
  ************************************************************************/
@@ -204,6 +234,18 @@ void sched_process_timer(void)
     }
 #endif
 
+#ifdef CONFIG_SCHED_CPUTIME
+  /* Keep the high-resolution CPU accounting of the running task current */
+
+  sched_cputime_update();
+#endif
+
+  /* Charge the elapsed tick to the budget of a sporadic task (before
+   * any replenishments are processed by the watchdog logic)
+   */
+
+  sched_process_sporadic();
+
   /* Process watchdogs */
 
   wd_timer();
@@ -131,6 +131,17 @@ int sched_releasetcb(FAR struct tcb_s *tcb, uint8_t ttype)
         }
 #endif
 
+#ifdef CONFIG_SCHED_SPORADIC
+      /* Cancel any pending replenishments and release the sporadic server
+       * state.
+       */
+
+      if (tcb->sporadic != NULL)
+        {
+          sched_sporadic_stop(tcb);
+        }
+#endif
+
       /* Release the task's process ID if one was assigned.  PID
        * zero is reserved for the IDLE task.  The TCB of the IDLE
        * task is never release so a value of zero simply means that
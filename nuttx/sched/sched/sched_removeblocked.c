@@ -100,7 +100,17 @@ void sched_removeblocked(FAR struct tcb_s *btcb)
    * with this state
    */
 
-  dq_rem((FAR dq_entry_t*)btcb, (dq_queue_t*)g_tasklisttable[task_state].list);
+  dq_rem((FAR dq_entry_t*)btcb, TLIST_HEAD(btcb, task_state));
+
+  /* A task that was waiting for a semaphore is no longer in the
+   * semaphore's wait list.  This must be cleared here, before the task
+   * can run again, and not by the caller afterward.
+   */
+
+  if (task_state == TSTATE_WAIT_SEM)
+    {
+      btcb->waitsem = NULL;
+    }
 
   /* Make sure the TCB's state corresponds to not being in
    * any list
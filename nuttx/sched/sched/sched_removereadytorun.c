@@ -106,19 +106,24 @@ bool sched_removereadytorun(FAR struct tcb_s *rtcb)
       ntcb = (FAR struct tcb_s *)rtcb->flink;
       DEBUGASSERT(ntcb != NULL);
 
-      /* Inform the instrumentation layer that we are switching tasks */
+      /* Inform the instrumentation layer that we are switching tasks.  The
+       * running task gave up the CPU unless the caller of
+       * up_reprioritize_rtr() marked this as a pre-emption.
+       */
 
       sched_note_switch(rtcb, ntcb);
+      sched_cputime_switch(rtcb, ntcb, !g_cputime_preempt);
       ntcb->task_state = TSTATE_TASK_RUNNING;
       ret = true;
     }
 
   /* Remove the TCB from the ready-to-run list */
 
-  dq_rem((FAR dq_entry_t *)rtcb, (FAR dq_queue_t *)&g_readytorun);
+  sched_removelist(rtcb, (FAR dq_queue_t*)&g_readytorun);
 
   /* Since the TCB is not in any list, it is now invalid */
 
   rtcb->task_state = TSTATE_TASK_INVALID;
+  sched_cputime_preempt(false);
   return ret;
 }
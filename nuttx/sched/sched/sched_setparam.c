@@ -148,6 +148,24 @@ int sched_setparam(pid_t pid, const struct sched_param *param)
         }
     }
 
+#ifdef CONFIG_SCHED_SPORADIC
+  /* The parameters of a sporadic thread include its budget and its
+   * replenishment period.  Restart the sporadic server with the new
+   * parameters.
+   */
+
+  if ((tcb->flags & TCB_FLAG_SPORADIC) != 0)
+    {
+      ret = sched_sporadic_initialize(tcb, param);
+      if (ret < 0)
+        {
+          set_errno(-ret);
+          sched_unlock();
+          return ERROR;
+        }
+    }
+#endif
+
  /* Then perform the reprioritization */
 
  ret = sched_reprioritize(tcb, param->sched_priority);
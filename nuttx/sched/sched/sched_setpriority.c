@@ -140,8 +140,12 @@ int sched_setpriority(FAR struct tcb_s *tcb, int sched_priority)
 
         if (sched_priority <= tcb->flink->sched_priority)
           {
-            /* A context switch will occur. */
+            /* A context switch will occur.  Lowering the priority of the
+             * running task pre-empts it; setting the same priority is a
+             * sched_yield().
+             */
 
+            sched_cputime_preempt(sched_priority != tcb->sched_priority);
             up_reprioritize_rtr(tcb, (uint8_t)sched_priority);
           }
 
@@ -149,9 +153,19 @@ int sched_setpriority(FAR struct tcb_s *tcb, int sched_priority)
 
         else
           {
+#ifdef CONFIG_SCHED_PRIOBITMAP
+            /* Change the task priority.  The task stays at the head of
+             * the list but must be re-indexed at its new priority.
+             */
+
+            sched_removelist(tcb, (FAR dq_queue_t*)&g_readytorun);
+            tcb->sched_priority = (uint8_t)sched_priority;
+            (void)sched_addprioritized(tcb, (FAR dq_queue_t*)&g_readytorun);
+#else
             /* Change the task priority */
 
             tcb->sched_priority = (uint8_t)sched_priority;
+#endif
           }
         break;
 
@@ -204,7 +218,7 @@ int sched_setpriority(FAR struct tcb_s *tcb, int sched_priority)
           {
             /* Remove the TCB from the prioritized task list */
 
-            dq_rem((FAR dq_entry_t*)tcb, (FAR dq_queue_t*)g_tasklisttable[task_state].list);
+            sched_removelist(tcb, TLIST_HEAD(tcb, task_state));
 
             /* Change the task priority */
 
@@ -214,7 +228,7 @@ int sched_setpriority(FAR struct tcb_s *tcb, int sched_priority)
              * position
              */
 
-            sched_addprioritized(tcb, (FAR dq_queue_t*)g_tasklisttable[task_state].list);
+            sched_addprioritized(tcb, TLIST_HEAD(tcb, task_state));
           }
 
         /* CASE 3b. The task resides in a non-prioritized list. */
@@ -89,16 +89,22 @@
  * Inputs:
  *   pid - the task ID of the task to modify.  If pid is zero, the calling
  *      task is modified.
- *   policy - Scheduling policy requested (either SCHED_FIFO or SCHED_RR)
+ *   policy - Scheduling policy requested (SCHED_FIFO, SCHED_RR or
+ *      SCHED_SPORADIC)
  *   param - A structure whose member sched_priority is the new priority.
  *      The range of valid priority numbers is from SCHED_PRIORITY_MIN
- *      through SCHED_PRIORITY_MAX.
+ *      through SCHED_PRIORITY_MAX.  For SCHED_SPORADIC, sched_priority is
+ *      the high priority and the sched_ss_* members provide the low
+ *      priority, the replenishment period, the initial budget and the
+ *      maximum number of pending replenishments.
  *
  * Return Value:
  *   On success, sched_setscheduler() returns OK (zero).  On error, ERROR
  *   (-1) is returned, and errno is set appropriately:
  *
- *   EINVAL The scheduling policy is not one of the recognized policies.
+ *   EINVAL The scheduling policy is not one of the recognized policies
+ *          or the sporadic scheduling parameters are not valid.
+ *   ENOMEM The sporadic server state could not be allocated.
  *   ESRCH  The task whose ID is pid could not be found.
  *
  * Assumptions:
@@ -116,11 +122,14 @@ int sched_setscheduler(pid_t pid, int policy,
 
   /* Check for supported scheduling policy */
 
+  if (policy != SCHED_FIFO
 #if CONFIG_RR_INTERVAL > 0
-  if (policy != SCHED_FIFO && policy != SCHED_RR)
-#else
-  if (policy != SCHED_FIFO)
+      && policy != SCHED_RR
 #endif
+#ifdef CONFIG_SCHED_SPORADIC
+      && policy != SCHED_SPORADIC
+#endif
+     )
     {
       set_errno(EINVAL);
       return ERROR;
@@ -148,6 +157,27 @@ int sched_setscheduler(pid_t pid, int policy,
 
   sched_lock();
 
+#ifdef CONFIG_SCHED_SPORADIC
+  /* Set up (or discard) the sporadic server state.  This also validates
+   * the sporadic scheduling parameters.
+   */
+
+  if (policy == SCHED_SPORADIC)
+    {
+      ret = sched_sporadic_initialize(tcb, param);
+      if (ret < 0)
+        {
+          sched_unlock();
+          set_errno(-ret);
+          return ERROR;
+        }
+    }
+  else if ((tcb->flags & TCB_FLAG_SPORADIC) != 0)
+    {
+      sched_sporadic_stop(tcb);
+    }
+#endif
+
 #if CONFIG_RR_INTERVAL > 0
   /* Further, disable timer interrupts while we set up scheduling policy. */
 
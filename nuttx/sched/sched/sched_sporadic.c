@@ -0,0 +1,525 @@
+/****************************************************************************
+ * sched/sched/sched_sporadic.c
+ *
+ *   Copyright (C) 2014 Gregory Nutt. All rights reserved.
+ *   Author: Gregory Nutt <gnutt@nuttx.org>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name NuttX nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <sched.h>
+#include <assert.h>
+#include <errno.h>
+
+#include <nuttx/clock.h>
+#include <nuttx/kmalloc.h>
+#include <nuttx/wdog.h>
+
+#include <arch/irq.h>
+
+#include "sched/sched.h"
+#include "clock/clock.h"
+
+#ifdef CONFIG_SCHED_SPORADIC
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+#ifndef MIN
+#  define MIN(a,b) (((a) < (b)) ? (a) : (b))
+#endif
+
+/****************************************************************************
+ * Global Variables
+ ****************************************************************************/
+
+/* The number of threads that use the SCHED_SPORADIC policy */
+
+uint16_t g_nsporadic;
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: sporadic_setpriority
+ *
+ * Description:
+ *   Switch a sporadic thread between its high and low priorities.  If the
+ *   thread currently holds a higher priority because of priority
+ *   inheritance, only its base priority is changed; the new priority then
+ *   takes effect when the inherited priority is released.
+ *
+ ****************************************************************************/
+
+static void sporadic_setpriority(FAR struct tcb_s *tcb, uint8_t priority)
+{
+#ifdef CONFIG_PRIORITY_INHERITANCE
+  bool boosted = (tcb->sched_priority != tcb->base_priority);
+
+  tcb->base_priority = priority;
+  if (boosted && tcb->sched_priority > priority)
+    {
+      return;
+    }
+#endif
+
+  (void)sched_setpriority(tcb, priority);
+}
+
+/****************************************************************************
+ * Name: sporadic_replenish
+ *
+ * Description:
+ *   Watchdog handler that returns the budget consumed during one activation
+ *   of the thread.  Runs in the timer interrupt context.
+ *
+ ****************************************************************************/
+
+static void sporadic_replenish(int argc, uint32_t arg1)
+{
+  FAR struct sporadic_s *sporadic;
+
+  /* On many small machines, pointers are encoded and cannot be simply cast
+   * from uint32_t to struct replenishment_s*.  The following union works
+   * around this (see wdparm_t).
+   */
+
+  union
+    {
+      FAR struct replenishment_s *repl;
+      uint32_t arg;
+    } u;
+
+  u.arg    = arg1;
+  sporadic = u.repl->sporadic;
+  DEBUGASSERT(u.repl->active && sporadic->nrepl > 0);
+
+  /* Return the consumed budget */
+
+  sporadic->budget += u.repl->budget;
+  if (sporadic->budget > sporadic->init_budget)
+    {
+      sporadic->budget = sporadic->init_budget;
+    }
+
+  u.repl->budget = 0;
+  u.repl->active = false;
+  sporadic->nrepl--;
+
+  /* If this was the replenishment of the current activation, then any
+   * further execution starts a new activation.
+   */
+
+  if (sporadic->current == u.repl)
+    {
+      sporadic->current = NULL;
+    }
+
+  /* Resume the high priority if the thread fell back to the low priority
+   * because its budget was exhausted or because all replenishments were
+   * pending.
+   */
+
+  if (sporadic->lowprio && sporadic->budget > 0)
+    {
+      sporadic->lowprio = false;
+      sporadic_setpriority(sporadic->tcb, sporadic->hi_priority);
+    }
+}
+
+/****************************************************************************
+ * Name: sporadic_activate
+ *
+ * Description:
+ *   Start a new activation of the thread:  Claim a free replenishment and
+ *   start its timer so that the budget consumed from now on is returned
+ *   one replenishment period from now.
+ *
+ * Returned Value:
+ *   The replenishment or NULL if sched_ss_max_repl replenishments are
+ *   already pending.
+ *
+ ****************************************************************************/
+
+static FAR struct replenishment_s *
+sporadic_activate(FAR struct sporadic_s *sporadic)
+{
+  FAR struct replenishment_s *repl;
+  wdparm_t wdparm;
+  int i;
+
+  for (i = 0; i < sporadic->max_repl; i++)
+    {
+      repl = &sporadic->repl[i];
+      if (!repl->active)
+        {
+          repl->active = true;
+          repl->budget = 0;
+          sporadic->nrepl++;
+
+          wdparm.pvarg = (FAR void *)repl;
+          (void)wd_start(repl->timer, sporadic->repl_period,
+                         (wdentry_t)sporadic_replenish, 1, wdparm.dwarg);
+          return repl;
+        }
+    }
+
+  return NULL;
+}
+
+/****************************************************************************
+ * Name: sporadic_release
+ *
+ * Description:
+ *   Cancel all pending replenishments and free the sporadic server state.
+ *
+ ****************************************************************************/
+
+static void sporadic_release(FAR struct sporadic_s *sporadic)
+{
+  int i;
+
+  for (i = 0; i < sporadic->max_repl; i++)
+    {
+      if (sporadic->repl[i].timer != NULL)
+        {
+          (void)wd_delete(sporadic->repl[i].timer);
+        }
+    }
+
+  kmm_free(sporadic);
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: sched_sporadic_initialize
+ *
+ * Description:
+ *   Select the SCHED_SPORADIC policy for a thread or change its sporadic
+ *   parameters.  The thread starts with its full budget.  The caller is
+ *   responsible for setting the high priority, param->sched_priority.
+ *
+ * Input Parameters:
+ *   tcb   - The TCB of the thread
+ *   param - The sporadic scheduling parameters
+ *
+ * Returned Value:
+ *   OK on success; a negated errno value on failure:
+ *
+ *   EINVAL - The parameters are not valid
+ *   ENOMEM - The sporadic server state could not be allocated
+ *
+ ****************************************************************************/
+
+int sched_sporadic_initialize(FAR struct tcb_s *tcb,
+                              FAR const struct sched_param *param)
+{
+  FAR struct sporadic_s *sporadic;
+  FAR struct sporadic_s *old;
+  irqstate_t flags;
+  int budget;
+  int period;
+  int i;
+
+  DEBUGASSERT(tcb != NULL && param != NULL);
+
+  /* Verify the parameters */
+
+  if (param->sched_priority < SCHED_PRIORITY_MIN ||
+      param->sched_priority > SCHED_PRIORITY_MAX ||
+      param->sched_ss_low_priority < SCHED_PRIORITY_MIN ||
+      param->sched_ss_low_priority > param->sched_priority ||
+      param->sched_ss_max_repl < 1 ||
+      param->sched_ss_max_repl > CONFIG_SCHED_SPORADIC_MAXREPL)
+    {
+      return -EINVAL;
+    }
+
+  (void)clock_time2ticks(&param->sched_ss_repl_period, &period);
+  (void)clock_time2ticks(&param->sched_ss_init_budget, &budget);
+
+  if (budget <= 0 || period <= 0 || budget > period)
+    {
+      return -EINVAL;
+    }
+
+  /* Allocate and initialize the new state, including one watchdog for
+   * each possible replenishment.
+   */
+
+  sporadic = (FAR struct sporadic_s *)kmm_zalloc(sizeof(struct sporadic_s));
+  if (sporadic == NULL)
+    {
+      return -ENOMEM;
+    }
+
+  sporadic->tcb          = tcb;
+  sporadic->hi_priority  = (uint8_t)param->sched_priority;
+  sporadic->low_priority = (uint8_t)param->sched_ss_low_priority;
+  sporadic->max_repl     = (uint8_t)param->sched_ss_max_repl;
+  sporadic->repl_period  = (uint32_t)period;
+  sporadic->init_budget  = (uint32_t)budget;
+  sporadic->budget       = (uint32_t)budget;
+
+  for (i = 0; i < sporadic->max_repl; i++)
+    {
+      sporadic->repl[i].sporadic = sporadic;
+      sporadic->repl[i].timer    = wd_create();
+      if (sporadic->repl[i].timer == NULL)
+        {
+          sporadic_release(sporadic);
+          return -ENOMEM;
+        }
+    }
+
+  /* Install the new state.  Interrupts are disabled because the timer
+   * logic uses the state of the running thread.
+   */
+
+  flags = irqsave();
+  old   = tcb->sporadic;
+  tcb->sporadic = sporadic;
+  tcb->flags   |= TCB_FLAG_SPORADIC;
+
+  if (old == NULL)
+    {
+      g_nsporadic++;
+    }
+
+  irqrestore(flags);
+
+  /* Discard any previous state and its pending replenishments */
+
+  if (old != NULL)
+    {
+      sporadic_release(old);
+    }
+
+  return OK;
+}
+
+/****************************************************************************
+ * Name: sched_sporadic_stop
+ *
+ * Description:
+ *   Stop sporadic scheduling of a thread and free its sporadic server
+ *   state.  This is called when the thread selects a different policy and
+ *   when the TCB is released.  The caller is responsible for setting the
+ *   new priority of the thread.
+ *
+ * Input Parameters:
+ *   tcb - The TCB of the thread
+ *
+ * Returned Value:
+ *   None
+ *
+ ****************************************************************************/
+
+void sched_sporadic_stop(FAR struct tcb_s *tcb)
+{
+  FAR struct sporadic_s *sporadic;
+  irqstate_t flags;
+
+  flags    = irqsave();
+  sporadic = tcb->sporadic;
+  if (sporadic != NULL)
+    {
+      tcb->sporadic = NULL;
+      g_nsporadic--;
+    }
+
+  tcb->flags &= ~TCB_FLAG_SPORADIC;
+  irqrestore(flags);
+
+  if (sporadic != NULL)
+    {
+      sporadic_release(sporadic);
+    }
+}
+
+/****************************************************************************
+ * Name: sched_sporadic_getparam
+ *
+ * Description:
+ *   Return the sporadic scheduling parameters of a thread.  The high
+ *   priority is returned as sched_priority, even while the thread runs at
+ *   its low priority.
+ *
+ * Input Parameters:
+ *   tcb   - The TCB of the thread
+ *   param - The location to return the parameters
+ *
+ * Returned Value:
+ *   None
+ *
+ ****************************************************************************/
+
+void sched_sporadic_getparam(FAR struct tcb_s *tcb,
+                             FAR struct sched_param *param)
+{
+  FAR struct sporadic_s *sporadic;
+  irqstate_t flags;
+
+  flags    = irqsave();
+  sporadic = tcb->sporadic;
+  if (sporadic != NULL)
+    {
+      param->sched_priority        = sporadic->hi_priority;
+      param->sched_ss_low_priority = sporadic->low_priority;
+      param->sched_ss_max_repl     = sporadic->max_repl;
+
+      param->sched_ss_repl_period.tv_sec   =
+        sporadic->repl_period / TICK_PER_SEC;
+      param->sched_ss_repl_period.tv_nsec  =
+        TICK2NSEC(sporadic->repl_period % TICK_PER_SEC);
+
+      param->sched_ss_init_budget.tv_sec   =
+        sporadic->init_budget / TICK_PER_SEC;
+      param->sched_ss_init_budget.tv_nsec  =
+        TICK2NSEC(sporadic->init_budget % TICK_PER_SEC);
+    }
+
+  irqrestore(flags);
+}
+
+/****************************************************************************
+ * Name: sched_sporadic_process
+ *
+ * Description:
+ *   Charge elapsed time to the budget of the running sporadic thread.
+ *   This is called from the timer interrupt logic with interrupts
+ *   disabled.  Time is only charged while the thread runs at its high
+ *   priority.
+ *
+ *   The thread is considered to begin a new activation if it was not
+ *   charged for the preceding tick.  The budget consumed during each
+ *   activation is returned one replenishment period after the activation
+ *   began.  If sched_ss_max_repl replenishments are already pending, or if
+ *   the budget is exhausted, the thread drops to its low priority until
+ *   the next replenishment.
+ *
+ * Input Parameters:
+ *   tcb        - The TCB of the running thread
+ *   ticks      - The number of ticks that have elapsed.  Zero may be used
+ *                to re-check a deferred transition to the low priority.
+ *   noswitches - True: Context switches are not possible now
+ *
+ * Returned Value:
+ *   The number of ticks of budget remaining.  Zero is returned if the
+ *   thread runs at its low priority.  One is returned if the thread must
+ *   drop to its low priority but cannot do so now because it has disabled
+ *   pre-emption or because noswitches is true.
+ *
+ ****************************************************************************/
+
+unsigned int sched_sporadic_process(FAR struct tcb_s *tcb,
+                                    unsigned int ticks, bool noswitches)
+{
+  FAR struct sporadic_s *sporadic = tcb->sporadic;
+  FAR struct replenishment_s *repl;
+  uint32_t charge;
+  uint32_t now;
+  bool drop;
+
+  DEBUGASSERT(sporadic != NULL);
+
+  /* Time at the low priority is not charged to the budget */
+
+  if (sporadic->lowprio)
+    {
+      return 0;
+    }
+
+  drop = (sporadic->budget == 0);
+  if (ticks > 0 && !drop)
+    {
+      /* Was the thread charged for the time just before this interval?  If
+       * not, it was not running and this is a new activation.
+       */
+
+      now  = clock_systimer();
+      repl = sporadic->current;
+
+      if (repl == NULL || (int32_t)(sporadic->lastrun - (now - ticks)) < 0)
+        {
+          repl = sporadic_activate(sporadic);
+          sporadic->current = repl;
+        }
+
+      if (repl != NULL)
+        {
+          charge            = MIN(ticks, sporadic->budget);
+          sporadic->budget -= charge;
+          repl->budget     += charge;
+          sporadic->lastrun = now;
+          drop              = (sporadic->budget == 0);
+        }
+      else
+        {
+          /* All replenishments are pending */
+
+          drop = true;
+        }
+    }
+
+  if (drop)
+    {
+      /* If pre-emption is disabled or context switches are not possible
+       * now, then stay at the high priority but ask to be called again as
+       * soon as possible.
+       */
+
+      if (noswitches || tcb->lockcount > 0)
+        {
+          return 1;
+        }
+
+      sporadic->current = NULL;
+      sporadic->lowprio = true;
+      sporadic_setpriority(tcb, sporadic->low_priority);
+      return 0;
+    }
+
+  return sporadic->budget;
+}
+
+#endif /* CONFIG_SCHED_SPORADIC */
@@ -75,6 +75,20 @@
 #  define KEEP_ALIVE_HACK 1
 #endif
 
+/* The same applies to sporadic tasks:  The budget of a sporadic task must
+ * be charged when it runs, but the timer is not reassessed when the task
+ * becomes the head of the ready-to-run list.  The timer is kept running
+ * with an interval of no more than CONFIG_SCHED_SPORADIC_KEEPALIVE while
+ * there are sporadic tasks.
+ */
+
+#ifdef CONFIG_SCHED_SPORADIC
+#  ifndef CONFIG_SCHED_SPORADIC_KEEPALIVE
+#    define CONFIG_SCHED_SPORADIC_KEEPALIVE 10
+#  endif
+#  define SPORADIC_KEEPALIVE MAX(MSEC2TICK(CONFIG_SCHED_SPORADIC_KEEPALIVE), 1)
+#endif
+
 #ifndef MIN
 #  define MIN(a,b) (((a) < (b)) ? (a) : (b))
 #endif
@@ -306,6 +320,7 @@ sched_process_timeslice(unsigned int ticks, bool noswitches)
                    * priority.
                    */
 
+                  sched_cputime_preempt(true);
                   up_reprioritize_rtr(rtcb, rtcb->sched_priority);
 
                   /* We will then need to return timeslice remaining for
@@ -348,6 +363,82 @@ sched_process_timeslice(unsigned int ticks, bool noswitches)
 }
 #endif
 
+/************************************************************************
+ * Name:  sched_charge_sporadic
+ *
+ * Description:
+ *   Charge the elapsed time to the budget of the currently executing
+ *   task if it uses the sporadic server scheduling policy.
+ *
+ * Inputs:
+ *   ticks - The number of ticks that have elapsed on the interval timer.
+ *   noswitches - True: Can't do context switches now.
+ *
+ * Return Value:
+ *   None
+ *
+ ************************************************************************/
+
+#ifdef CONFIG_SCHED_SPORADIC
+static inline void sched_charge_sporadic(unsigned int ticks, bool noswitches)
+{
+  FAR struct tcb_s *rtcb  = (FAR struct tcb_s*)g_readytorun.head;
+
+  if (ticks > 0 && (rtcb->flags & TCB_FLAG_SPORADIC) != 0)
+    {
+      (void)sched_sporadic_process(rtcb, ticks, noswitches);
+    }
+}
+#endif
+
+/************************************************************************
+ * Name:  sched_process_sporadic
+ *
+ * Description:
+ *   Determine the interval until the next sporadic event of interest:
+ *   The exhaustion of the budget of the task at the head of the
+ *   ready-to-run list or, if there is no such task, the keep-alive
+ *   interval.
+ *
+ * Inputs:
+ *   noswitches - True: Can't do context switches now.
+ *
+ * Return Value:
+ *   The number of ticks until the next sporadic event.  Zero is returned
+ *   if there are no sporadic tasks.
+ *
+ ************************************************************************/
+
+#ifdef CONFIG_SCHED_SPORADIC
+static unsigned int sched_process_sporadic(bool noswitches)
+{
+  FAR struct tcb_s *rtcb  = (FAR struct tcb_s*)g_readytorun.head;
+  unsigned int ret;
+  unsigned int budget;
+
+  if (g_nsporadic == 0)
+    {
+      return 0;
+    }
+
+  ret = SPORADIC_KEEPALIVE;
+  if ((rtcb->flags & TCB_FLAG_SPORADIC) != 0)
+    {
+      /* Processing zero ticks will drop the task to its low priority if
+       * its budget is exhausted.
+       */
+
+      budget = sched_sporadic_process(rtcb, 0, noswitches);
+      if (budget > 0 && budget < ret)
+        {
+          ret = budget;
+        }
+    }
+
+  return ret;
+}
+#endif
+
 /****************************************************************************
  * Name:  sched_timer_process
  *
@@ -366,18 +457,32 @@ sched_process_timeslice(unsigned int ticks, bool noswitches)
 
 static unsigned int sched_timer_process(unsigned int ticks, bool noswitches)
 {
-#if CONFIG_RR_INTERVAL > 0
+#if CONFIG_RR_INTERVAL > 0 || defined(CONFIG_SCHED_SPORADIC)
   unsigned int cmptime = UINT_MAX;
 #endif
   unsigned int rettime  = 0;
   unsigned int tmp;
 
+#ifdef CONFIG_SCHED_CPUTIME
+  /* Keep the high-resolution CPU accounting of the running task current */
+
+  sched_cputime_update();
+#endif
+
+#ifdef CONFIG_SCHED_SPORADIC
+  /* Charge the elapsed time to the budget of a sporadic task (before any
+   * replenishments are processed by the watchdog logic)
+   */
+
+  sched_charge_sporadic(ticks, noswitches);
+#endif
+
   /* Process watchdogs */
 
   tmp = wd_timer(ticks);
   if (tmp > 0)
     {
-#if CONFIG_RR_INTERVAL > 0
+#if CONFIG_RR_INTERVAL > 0 || defined(CONFIG_SCHED_SPORADIC)
       cmptime = tmp;
 #endif
       rettime  = tmp;
@@ -389,6 +494,19 @@ static unsigned int sched_timer_process(unsigned int ticks, bool noswitches)
    */
 
   tmp = sched_process_timeslice(ticks, noswitches);
+  if (tmp > 0 && tmp < cmptime)
+    {
+#ifdef CONFIG_SCHED_SPORADIC
+      cmptime = tmp;
+#endif
+      rettime  = tmp;
+    }
+#endif
+
+#ifdef CONFIG_SCHED_SPORADIC
+  /* Check when the budget of a sporadic task will be exhausted */
+
+  tmp = sched_process_sporadic(noswitches);
   if (tmp > 0 && tmp < cmptime)
     {
       rettime  = tmp;
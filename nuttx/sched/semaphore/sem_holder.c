@@ -44,6 +44,7 @@
 #include <assert.h>
 #include <debug.h>
 #include <nuttx/arch.h>
+#include <nuttx/semaphore.h>
 
 #include "sched/sched.h"
 #include "semaphore/semaphore.h"
@@ -75,13 +76,24 @@ typedef int (*holderhandler_t)(FAR struct semholder_s *pholder,
  * Private Variables
  ****************************************************************************/
 
-/* Preallocated holder structures */
+/* Preallocated holder structures.  These are used for the second and
+ * later holders of a semaphore; the first holder is kept in the holder
+ * structure built into the semaphore.
+ */
 
 #if CONFIG_SEM_PREALLOCHOLDERS > 0
 static struct semholder_s g_holderalloc[CONFIG_SEM_PREALLOCHOLDERS];
 static FAR struct semholder_s *g_freeholders;
+static uint16_t g_nfreeholders;          /* Number of free holders */
+static uint16_t g_minfreeholders;        /* Low-water mark of g_nfreeholders */
 #endif
 
+/* The number of times that a holder could not be recorded.  Priority
+ * inheritance does not work for such a holder.
+ */
+
+static uint32_t g_nholderfails;
+
 /****************************************************************************
  * Private Functions
  ****************************************************************************/
@@ -96,17 +108,23 @@ static inline FAR struct semholder_s *sem_allocholder(sem_t *sem)
 
   /* Check if the "built-in" holder is being used.  We have this built-in
    * holder to optimize for the simplest case where semaphores are only
-   * used to implement mutexes.
+   * used to implement mutexes:  Such semaphores never need a holder from
+   * the pool.
    */
 
+  if (!sem->holder.htcb)
+    {
+      pholder          = &sem->holder;
+      pholder->counts  = 0;
+    }
 #if CONFIG_SEM_PREALLOCHOLDERS > 0
-  pholder = g_freeholders;
-  if (pholder)
+  else if (g_freeholders)
     {
       /* Remove the holder from the free list an put it into the semaphore's
        * holder list
        */
 
+      pholder          = g_freeholders;
       g_freeholders    = pholder->flink;
       pholder->flink   = sem->hhead;
       sem->hhead       = pholder;
@@ -114,17 +132,23 @@ static inline FAR struct semholder_s *sem_allocholder(sem_t *sem)
       /* Make sure the initial count is zero */
 
       pholder->counts  = 0;
-    }
-#else
-  if (!sem->holder.htcb)
-    {
-      pholder          = &sem->holder;
-      pholder->counts  = 0;
+
+      /* Keep track of the pool usage */
+
+      if (--g_nfreeholders < g_minfreeholders)
+        {
+          g_minfreeholders = g_nfreeholders;
+        }
     }
 #endif
   else
     {
+      /* Priority inheritance will not work for this holder.  Count the
+       * failure so that it can be reported by sem_holderstats().
+       */
+
       sdbg("Insufficient pre-allocated holders\n");
+      g_nholderfails++;
       pholder = NULL;
     }
 
@@ -138,17 +162,25 @@ static inline FAR struct semholder_s *sem_allocholder(sem_t *sem)
 static FAR struct semholder_s *sem_findholder(sem_t *sem,
                                               FAR struct tcb_s *htcb)
 {
+#if CONFIG_SEM_PREALLOCHOLDERS > 0
   FAR struct semholder_s *pholder;
+#endif
 
-  /* Try to find the holder in the list of holders associated with this
-   * semaphore
+  /* Check the built-in holder first.  This is the only holder of a
+   * semaphore that is used as a mutex.
+   */
+
+  if (sem->holder.htcb == htcb)
+    {
+      return &sem->holder;
+    }
+
+  /* Then try to find the holder in the list of additional holders
+   * associated with this semaphore
    */
 
 #if CONFIG_SEM_PREALLOCHOLDERS > 0
   for (pholder = sem->hhead; pholder; pholder = pholder->flink)
-#else
-  pholder = &sem->holder;
-#endif
     {
       if (pholder->htcb == htcb)
         {
@@ -157,6 +189,7 @@ static FAR struct semholder_s *sem_findholder(sem_t *sem,
           return pholder;
         }
     }
+#endif
 
   /* The holder does not appear in the list */
 
@@ -196,6 +229,13 @@ static inline void sem_freeholder(sem_t *sem, FAR struct semholder_s *pholder)
   pholder->counts = 0;
 
 #if CONFIG_SEM_PREALLOCHOLDERS > 0
+  /* The built-in holder is not in the list */
+
+  if (pholder == &sem->holder)
+    {
+      return;
+    }
+
   /* Search the list for the matching holder */
 
   for (prev = NULL, curr = sem->hhead;
@@ -219,6 +259,7 @@ static inline void sem_freeholder(sem_t *sem, FAR struct semholder_s *pholder)
 
       pholder->flink = g_freeholders;
       g_freeholders  = pholder;
+      g_nfreeholders++;
     }
 #endif
 }
@@ -236,26 +277,30 @@ static int sem_foreachholder(FAR sem_t *sem, holderhandler_t handler,
 #endif
   int ret = 0;
 
-#if CONFIG_SEM_PREALLOCHOLDERS > 0
-  for (pholder = sem->hhead; pholder && ret == 0; pholder = next)
-#else
+  /* The "built-in" container may hold a NULL holder */
+
   pholder = &sem->holder;
-#endif
+  if (pholder->htcb)
     {
+      /* Call the handler */
+
+      ret = handler(pholder, sem, arg);
+    }
+
 #if CONFIG_SEM_PREALLOCHOLDERS > 0
+  /* Then visit each additional holder */
+
+  for (pholder = sem->hhead; pholder && ret == 0; pholder = next)
+    {
       /* In case this holder gets deleted */
 
       next = pholder->flink;
-#endif
-      /* The initial "built-in" container may hold a NULL holder */
 
-      if (pholder->htcb)
-        {
-          /* Call the handler */
+      /* Call the handler */
 
-          ret = handler(pholder, sem, arg);
-        }
+      ret = handler(pholder, sem, arg);
     }
+#endif
 
   return ret;
 }
@@ -264,14 +309,12 @@ static int sem_foreachholder(FAR sem_t *sem, holderhandler_t handler,
  * Name: sem_recoverholders
  ****************************************************************************/
 
-#if CONFIG_SEM_PREALLOCHOLDERS > 0
 static int sem_recoverholders(FAR struct semholder_s *pholder,
                               FAR sem_t *sem, FAR void *arg)
 {
   sem_freeholder(sem, pholder);
   return 0;
 }
-#endif
 
 /****************************************************************************
  * Name: sem_boostholderprio
@@ -791,6 +834,8 @@ void sem_initholders(void)
     }
 
   g_holderalloc[CONFIG_SEM_PREALLOCHOLDERS-1].flink = NULL;
+  g_nfreeholders   = CONFIG_SEM_PREALLOCHOLDERS;
+  g_minfreeholders = CONFIG_SEM_PREALLOCHOLDERS;
 #endif
 }
 
@@ -824,20 +869,11 @@ void sem_destroyholder(FAR sem_t *sem)
    * doing.
    */
 
-#if CONFIG_SEM_PREALLOCHOLDERS > 0
-  if (sem->hhead)
+  if (sem_hasholders(sem))
     {
       sdbg("Semaphore destroyed with holders\n");
       (void)sem_foreachholder(sem, sem_recoverholders, NULL);
     }
-#else
-  if (sem->holder.htcb)
-    {
-      sdbg("Semaphore destroyed with holder\n");
-    }
-
-  sem->holder.htcb = NULL;
-#endif
 }
 
 /****************************************************************************
@@ -858,19 +894,43 @@ void sem_destroyholder(FAR sem_t *sem)
 
 void sem_addholder(FAR sem_t *sem)
 {
-  FAR struct tcb_s *rtcb = (FAR struct tcb_s*)g_readytorun.head;
+  sem_addholder_tcb((FAR struct tcb_s*)g_readytorun.head, sem);
+}
+
+/****************************************************************************
+ * Name: sem_addholder_tcb
+ *
+ * Description:
+ *   Record that the thread 'htcb' holds a count on the semaphore.  This is
+ *   used when a count was taken without going through sem_wait(), as by the
+ *   pthread mutex fast path, and another thread is about to wait for it.
+ *
+ * Parameters:
+ *   htcb - The TCB of the thread holding the count
+ *   sem - A reference to the semaphore
+ *
+ * Return Value:
+ *   None
+ *
+ * Assumptions:
+ *   Interrupts are disabled.
+ *
+ ****************************************************************************/
+
+void sem_addholder_tcb(FAR struct tcb_s *htcb, FAR sem_t *sem)
+{
   FAR struct semholder_s *pholder;
 
   /* Find or allocate a container for this new holder */
 
-  pholder = sem_findorallocateholder(sem, rtcb);
+  pholder = sem_findorallocateholder(sem, htcb);
   if (pholder)
     {
       /* Then set the holder and increment the number of counts held by this
        * holder
        */
 
-      pholder->htcb = rtcb;
+      pholder->htcb = htcb;
       pholder->counts++;
     }
 }
@@ -1072,15 +1132,46 @@ void sem_enumholders(FAR sem_t *sem)
 int sem_nfreeholders(void)
 {
 #if CONFIG_SEM_PREALLOCHOLDERS > 0
-  FAR struct semholder_s *pholder;
-  int n;
-
-  for (pholder = g_freeholders, n = 0; pholder; pholder = pholder->flink) n++;
-  return n;
+  return g_nfreeholders;
 #else
   return 0;
 #endif
 }
 #endif
 
+/****************************************************************************
+ * Name: sem_holderstats
+ *
+ * Description:
+ *   Return statistics about the pool of pre-allocated holders.  A non-zero
+ *   number of failures means that CONFIG_SEM_PREALLOCHOLDERS is too small:
+ *   Priority inheritance did not work for some holders.
+ *
+ * Parameters:
+ *   stats - The location to return the statistics
+ *
+ * Return Value:
+ *   None
+ *
+ ****************************************************************************/
+
+void sem_holderstats(FAR struct semholder_stats_s *stats)
+{
+  irqstate_t flags;
+
+  DEBUGASSERT(stats);
+
+  flags = irqsave();
+  stats->npool   = CONFIG_SEM_PREALLOCHOLDERS;
+#if CONFIG_SEM_PREALLOCHOLDERS > 0
+  stats->nfree   = g_nfreeholders;
+  stats->minfree = g_minfreeholders;
+#else
+  stats->nfree   = 0;
+  stats->minfree = 0;
+#endif
+  stats->nfails  = g_nholderfails;
+  irqrestore(flags);
+}
+
 #endif /* CONFIG_PRIORITY_INHERITANCE */
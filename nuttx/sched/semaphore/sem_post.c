@@ -40,6 +40,7 @@
 #include <nuttx/config.h>
 
 #include <limits.h>
+#include <assert.h>
 #include <semaphore.h>
 #include <sched.h>
 #include <nuttx/arch.h>
@@ -138,24 +139,18 @@ int sem_post(FAR sem_t *sem)
 
       if (sem->semcount <= 0)
         {
-          /* Check if there are any tasks in the waiting for semaphore
-           * task list that are waiting for this semaphore. This is a
-           * prioritized list so the first one we encounter is the one
-           * that we want.
+          /* The semaphore's wait list is prioritized so the task at the
+           * head is the one that we want.
            */
 
-          for (stcb = (FAR struct tcb_s*)g_waitingforsemaphore.head;
-               (stcb && stcb->waitsem != sem);
-               stcb = stcb->flink);
-
+          stcb = (FAR struct tcb_s*)dq_peek(&sem->waitlist);
           if (stcb)
             {
-              /* It is, let the task take the semaphore */
-
-              stcb->waitsem = NULL;
-
-              /* Restart the waiting task. */
+              /* Let the task take the semaphore and restart it.  Removing
+               * it from the wait list also clears stcb->waitsem.
+               */
 
+              DEBUGASSERT(stcb->waitsem == sem);
               up_unblock_task(stcb);
             }
         }
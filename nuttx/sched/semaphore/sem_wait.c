@@ -40,6 +40,7 @@
 #include <nuttx/config.h>
 
 #include <stdbool.h>
+#include <sched.h>
 #include <semaphore.h>
 #include <errno.h>
 #include <assert.h>
@@ -168,6 +169,7 @@ int sem_wait(FAR sem_t *sem)
 #endif
           /* Add the TCB to the prioritized semaphore wait queue */
 
+          sched_note_semwait(rtcb, sem);
           set_errno(0);
           up_block_task(rtcb, TSTATE_WAIT_SEM);
 
@@ -53,6 +53,19 @@
  * Pre-processor Definitions
  ****************************************************************************/
 
+/* True if any thread is recorded as holding a count on the semaphore */
+
+#ifdef CONFIG_PRIORITY_INHERITANCE
+#  if CONFIG_SEM_PREALLOCHOLDERS > 0
+#    define sem_hasholders(sem) \
+       ((sem)->holder.htcb != NULL || (sem)->hhead != NULL)
+#  else
+#    define sem_hasholders(sem) ((sem)->holder.htcb != NULL)
+#  endif
+#else
+#  define sem_hasholders(sem) (false)
+#endif
+
 /****************************************************************************
  * Public Type Declarations
  ****************************************************************************/
@@ -93,6 +106,7 @@ void sem_waitirq(FAR struct tcb_s *wtcb, int errcode);
 void sem_initholders(void);
 void sem_destroyholder(FAR sem_t *sem);
 void sem_addholder(FAR sem_t *sem);
+void sem_addholder_tcb(FAR struct tcb_s *htcb, FAR sem_t *sem);
 void sem_boostpriority(FAR sem_t *sem);
 void sem_releaseholder(FAR sem_t *sem);
 void sem_restorebaseprio(FAR struct tcb_s *stcb, FAR sem_t *sem);
@@ -105,6 +119,7 @@ void sem_canceled(FAR struct tcb_s *stcb, FAR sem_t *sem);
 #  define sem_initholders()
 #  define sem_destroyholder(sem)
 #  define sem_addholder(sem)
+#  define sem_addholder_tcb(htcb, sem)
 #  define sem_boostpriority(sem)
 #  define sem_releaseholder(sem)
 #  define sem_restorebaseprio(stcb,sem)
@@ -91,8 +91,12 @@
 
 int wd_cancel(WDOG_ID wdog)
 {
+#ifndef CONFIG_WDOG_TIMERWHEEL
   FAR struct wdog_s *curr;
   FAR struct wdog_s *prev;
+#elif defined(CONFIG_SCHED_TICKLESS)
+  int next;
+#endif
   irqstate_t state;
   int ret = ERROR;
 
@@ -108,6 +112,25 @@ int wd_cancel(WDOG_ID wdog)
 
   if (wdog && WDOG_ISACTIVE(wdog))
     {
+#ifdef CONFIG_WDOG_TIMERWHEEL
+      /* Remove the watchdog from its slot of the timer wheel.  This is
+       * constant time.
+       */
+
+#ifdef CONFIG_SCHED_TICKLESS
+      next = wd_wheel_next();
+#endif
+      wd_wheel_remove(wdog);
+
+#ifdef CONFIG_SCHED_TICKLESS
+      /* Reassess the interval timer if the next event has changed */
+
+      if (wd_wheel_next() != next)
+        {
+          sched_timer_reassess();
+        }
+#endif
+#else
       /* Search the g_wdactivelist for the target FCB.  We can't use sq_rem
        * to do this because there are additional operations that need to be
        * done.
@@ -157,6 +180,7 @@ int wd_cancel(WDOG_ID wdog)
 
           sched_timer_reassess();
         }
+#endif /* CONFIG_WDOG_TIMERWHEEL */
 
       /* Mark the watchdog inactive */
 
@@ -94,6 +94,16 @@ int wd_gettime(WDOG_ID wdog)
   flags = irqsave();
   if (wdog && WDOG_ISACTIVE(wdog))
     {
+#ifdef CONFIG_WDOG_TIMERWHEEL
+      /* The watchdog holds its expiration tick.  It expires when that tick
+       * is processed.
+       */
+
+      int delay = (int)((uint32_t)wdog->lag - g_wdbase) + 1;
+
+      irqrestore(flags);
+      return delay > 0 ? delay : 1;
+#else
       /* Traverse the watchdog list accumulating lag times until we find the wdog
        * that we are looking for
        */
@@ -110,6 +120,7 @@ int wd_gettime(WDOG_ID wdog)
               return delay;
             }
         }
+#endif
     }
 
   irqrestore(flags);
@@ -113,6 +113,7 @@ typedef void (*wdentry4_t)(int argc, uint32_t arg1, uint32_t arg2,
  *
  ****************************************************************************/
 
+#ifndef CONFIG_WDOG_TIMERWHEEL
 static inline void wd_expiration(void)
 {
   FAR struct wdog_s *wdog;
@@ -147,51 +148,76 @@ static inline void wd_expiration(void)
 
           /* Execute the watchdog function */
 
-          up_setpicbase(wdog->picbase);
-          switch (wdog->argc)
-            {
-              default:
-                DEBUGPANIC();
-                break;
+          wd_dispatch(wdog);
+        }
+    }
+}
+#endif
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: wd_dispatch
+ *
+ * Description:
+ *   Execute the function of an expired watchdog.
+ *
+ * Parameters:
+ *   wdog - The expired watchdog
+ *
+ * Return Value:
+ *   None
+ *
+ * Assumptions:
+ *   Called from interrupt handler logic with interrupts disabled.  The
+ *   watchdog has already been removed from the active watchdogs and
+ *   marked inactive.
+ *
+ ****************************************************************************/
 
-              case 0:
-                (*((wdentry0_t)(wdog->func)))(0);
-                break;
+void wd_dispatch(FAR struct wdog_s *wdog)
+{
+  up_setpicbase(wdog->picbase);
+  switch (wdog->argc)
+    {
+      default:
+        DEBUGPANIC();
+        break;
+
+      case 0:
+        (*((wdentry0_t)(wdog->func)))(0);
+        break;
 
 #if CONFIG_MAX_WDOGPARMS > 0
-              case 1:
-                (*((wdentry1_t)(wdog->func)))(1, wdog->parm[0]);
-                break;
+      case 1:
+        (*((wdentry1_t)(wdog->func)))(1, wdog->parm[0]);
+        break;
 #endif
 #if CONFIG_MAX_WDOGPARMS > 1
-              case 2:
-                (*((wdentry2_t)(wdog->func)))(2,
-                                wdog->parm[0], wdog->parm[1]);
-                break;
+      case 2:
+        (*((wdentry2_t)(wdog->func)))(2,
+                        wdog->parm[0], wdog->parm[1]);
+        break;
 #endif
 #if CONFIG_MAX_WDOGPARMS > 2
-              case 3:
-                (*((wdentry3_t)(wdog->func)))(3,
-                                wdog->parm[0], wdog->parm[1],
-                                wdog->parm[2]);
-                break;
+      case 3:
+        (*((wdentry3_t)(wdog->func)))(3,
+                        wdog->parm[0], wdog->parm[1],
+                        wdog->parm[2]);
+        break;
 #endif
 #if CONFIG_MAX_WDOGPARMS > 3
-              case 4:
-                (*((wdentry4_t)(wdog->func)))(4,
-                                wdog->parm[0], wdog->parm[1],
-                                wdog->parm[2] ,wdog->parm[3]);
-                break;
+      case 4:
+        (*((wdentry4_t)(wdog->func)))(4,
+                        wdog->parm[0], wdog->parm[1],
+                        wdog->parm[2] ,wdog->parm[3]);
+        break;
 #endif
-            }
-        }
     }
 }
 
-/****************************************************************************
- * Public Functions
- ****************************************************************************/
-
 /****************************************************************************
  * Name: wd_start
  *
@@ -228,10 +254,12 @@ static inline void wd_expiration(void)
 int wd_start(WDOG_ID wdog, int delay, wdentry_t wdentry,  int argc, ...)
 {
   va_list ap;
+#ifndef CONFIG_WDOG_TIMERWHEEL
   FAR struct wdog_s *curr;
   FAR struct wdog_s *prev;
   FAR struct wdog_s *next;
   int32_t now;
+#endif
   irqstate_t state;
   int i;
 
@@ -295,6 +323,11 @@ int wd_start(WDOG_ID wdog, int delay, wdentry_t wdentry,  int argc, ...)
   (void)sched_timer_cancel();
 #endif
 
+#ifdef CONFIG_WDOG_TIMERWHEEL
+  /* File the watchdog in the timer wheel.  This is constant time. */
+
+  wd_wheel_insert(wdog, delay);
+#else
   /* Do the easy case first -- when the watchdog timer queue is empty. */
 
   if (g_wdactivelist.head == NULL)
@@ -380,9 +413,13 @@ int wd_start(WDOG_ID wdog, int delay, wdentry_t wdentry,  int argc, ...)
         }
     }
 
-  /* Put the lag into the watchdog structure and mark it as active. */
+  /* Put the lag into the watchdog structure */
 
   wdog->lag = delay;
+#endif /* CONFIG_WDOG_TIMERWHEEL */
+
+  /* Mark the watchdog as active. */
+
   WDOG_SETACTIVE(wdog);
 
 #ifdef CONFIG_SCHED_TICKLESS
@@ -423,6 +460,7 @@ int wd_start(WDOG_ID wdog, int delay, wdentry_t wdentry,  int argc, ...)
  *
  ****************************************************************************/
 
+#ifndef CONFIG_WDOG_TIMERWHEEL
 #ifdef CONFIG_SCHED_TICKLESS
 unsigned int wd_timer(int ticks)
 {
@@ -482,3 +520,4 @@ void wd_timer(void)
     }
 }
 #endif /* CONFIG_SCHED_TICKLESS */
+#endif /* !CONFIG_WDOG_TIMERWHEEL */
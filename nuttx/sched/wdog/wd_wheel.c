@@ -0,0 +1,648 @@
+/****************************************************************************
+ * sched/wdog/wd_wheel.c
+ *
+ *   Copyright (C) 2014 Gregory Nutt. All rights reserved.
+ *   Author: Gregory Nutt <gnutt@nuttx.org>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name NuttX nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <queue.h>
+#include <assert.h>
+
+#include <nuttx/wdog.h>
+
+#include "wdog/wdog.h"
+
+#ifdef CONFIG_WDOG_TIMERWHEEL
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+/* Configuration ************************************************************/
+
+#ifndef CONFIG_WDOG_WHEEL_BITS
+#  define CONFIG_WDOG_WHEEL_BITS 6
+#endif
+
+#ifndef CONFIG_WDOG_WHEEL_LEVELS
+#  define CONFIG_WDOG_WHEEL_LEVELS 4
+#endif
+
+/* Wheel geometry.  A watchdog whose expiration is less than
+ * WHEEL_SPAN(n+1) ticks away is kept in level n, in the slot selected by
+ * bits [n*WHEEL_BITS, (n+1)*WHEEL_BITS) of its expiration tick.  Each
+ * time that the slot index of level 0 wraps to zero, the current slot of
+ * level 1 is cascaded (re-filed) into level 0, and so on up the levels.
+ */
+
+#define WHEEL_BITS         CONFIG_WDOG_WHEEL_BITS
+#define WHEEL_LEVELS       CONFIG_WDOG_WHEEL_LEVELS
+#define WHEEL_SLOTS        (1 << WHEEL_BITS)
+#define WHEEL_MASK         (WHEEL_SLOTS - 1)
+#define WHEEL_NWORDS       ((WHEEL_SLOTS + 31) >> 5)
+#define WHEEL_SHIFT(l)     ((l) * WHEEL_BITS)
+#define WHEEL_SPAN(l)      ((uint32_t)1 << WHEEL_SHIFT(l))
+
+/* Delays beyond WHEEL_RANGE are filed as if they expire at the end of the
+ * range and re-filed when their top-level slot is cascaded.
+ */
+
+#if (WHEEL_BITS * WHEEL_LEVELS) > 30
+#  define WHEEL_RANGE      ((uint32_t)1 << 30)
+#else
+#  define WHEEL_RANGE      WHEEL_SPAN(WHEEL_LEVELS)
+#endif
+
+/* Level value of watchdogs that have expired but whose functions have not
+ * yet been called.
+ */
+
+#define WHEEL_EXPIRED      0xff
+
+/****************************************************************************
+ * Global Variables
+ ****************************************************************************/
+
+/* The next clock tick to be processed */
+
+uint32_t g_wdbase;
+
+/****************************************************************************
+ * Private Variables
+ ****************************************************************************/
+
+/* The slots of each level of the wheel and a bitmap of the slots that are
+ * not empty.
+ */
+
+static sq_queue_t g_wdwheel[WHEEL_LEVELS][WHEEL_SLOTS];
+static uint32_t   g_wdbitmap[WHEEL_LEVELS][WHEEL_NWORDS];
+
+/* Watchdogs that expired on the tick being processed.  They are kept here
+ * until their functions are called so that wd_cancel() can still find them.
+ */
+
+static sq_queue_t g_wdexpired;
+
+/* The number of watchdogs in the wheel (not counting g_wdexpired) */
+
+static unsigned int g_wdnactive;
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: wd_ctz
+ *
+ * Description:
+ *   Return the index of the least significant set bit of a non-zero word.
+ *
+ ****************************************************************************/
+
+static inline unsigned int wd_ctz(uint32_t word)
+{
+#ifdef CONFIG_HAVE_BUILTIN_CLZ
+  return __builtin_ctz(word);
+#else
+  unsigned int ndx = 0;
+
+  if ((word & 0x0000ffff) == 0)
+    {
+      word >>= 16;
+      ndx   += 16;
+    }
+
+  if ((word & 0x000000ff) == 0)
+    {
+      word >>= 8;
+      ndx   += 8;
+    }
+
+  if ((word & 0x0000000f) == 0)
+    {
+      word >>= 4;
+      ndx   += 4;
+    }
+
+  if ((word & 0x00000003) == 0)
+    {
+      word >>= 2;
+      ndx   += 2;
+    }
+
+  if ((word & 0x00000001) == 0)
+    {
+      ndx   += 1;
+    }
+
+  return ndx;
+#endif
+}
+
+/****************************************************************************
+ * Name: wd_findslot
+ *
+ * Description:
+ *   Search the occupied slots of one level, circularly starting at slot
+ *   'start', and return the distance to the first occupied slot or -1 if
+ *   the level is empty.
+ *
+ ****************************************************************************/
+
+static int wd_findslot(FAR const uint32_t *bitmap, unsigned int start)
+{
+  unsigned int word = start >> 5;
+  uint32_t bits     = bitmap[word] & (0xffffffff << (start & 31));
+  int i;
+
+  /* The last pass revisits the starting word to pick up the slots before
+   * 'start'.
+   */
+
+  for (i = 0; i <= WHEEL_NWORDS; i++)
+    {
+      if (bits != 0)
+        {
+          unsigned int slot = (word << 5) + wd_ctz(bits);
+          return (int)((slot - start) & WHEEL_MASK);
+        }
+
+      if (++word >= WHEEL_NWORDS)
+        {
+          word = 0;
+        }
+
+      bits = bitmap[word];
+    }
+
+  return -1;
+}
+
+/****************************************************************************
+ * Name: wd_link
+ *
+ * Description:
+ *   File a watchdog in the wheel according to its expiration tick
+ *   (wdog->lag) relative to g_wdbase.
+ *
+ ****************************************************************************/
+
+static void wd_link(FAR struct wdog_s *wdog)
+{
+  FAR sq_queue_t *slot;
+  uint32_t expire = (uint32_t)wdog->lag;
+  int32_t delta   = (int32_t)(expire - g_wdbase);
+  unsigned int level;
+  unsigned int ndx;
+
+  if (delta < 0)
+    {
+      /* Already due:  Expire on the tick that is processed next */
+
+      delta  = 0;
+      expire = g_wdbase;
+    }
+  else if ((uint32_t)delta >= WHEEL_RANGE)
+    {
+      delta  = WHEEL_RANGE - 1;
+      expire = g_wdbase + WHEEL_RANGE - 1;
+    }
+
+  /* Select the level and the slot within the level */
+
+  for (level = 0;
+       level < WHEEL_LEVELS - 1 && (uint32_t)delta >= WHEEL_SPAN(level + 1);
+       level++);
+
+  ndx  = (expire >> WHEEL_SHIFT(level)) & WHEEL_MASK;
+  slot = &g_wdwheel[level][ndx];
+
+  /* Add the watchdog to the tail of the slot so that watchdogs with the
+   * same expiration run in the order that they were started.
+   */
+
+  wdog->next = NULL;
+  wdog->prev = (FAR struct wdog_s *)slot->tail;
+  if (slot->tail)
+    {
+      ((FAR struct wdog_s *)slot->tail)->next = wdog;
+    }
+  else
+    {
+      slot->head = (FAR sq_entry_t *)wdog;
+      g_wdbitmap[level][ndx >> 5] |= (uint32_t)1 << (ndx & 31);
+    }
+
+  slot->tail  = (FAR sq_entry_t *)wdog;
+  wdog->level = level;
+  wdog->slot  = ndx;
+  g_wdnactive++;
+}
+
+/****************************************************************************
+ * Name: wd_detach
+ *
+ * Description:
+ *   Remove all watchdogs from one slot and return them in 'list'.
+ *
+ ****************************************************************************/
+
+static void wd_detach(unsigned int level, unsigned int ndx,
+                      FAR sq_queue_t *list)
+{
+  FAR sq_queue_t *slot = &g_wdwheel[level][ndx];
+
+  list->head = slot->head;
+  list->tail = slot->tail;
+  sq_init(slot);
+
+  g_wdbitmap[level][ndx >> 5] &= ~((uint32_t)1 << (ndx & 31));
+}
+
+/****************************************************************************
+ * Name: wd_cascade
+ *
+ * Description:
+ *   Re-file all watchdogs of one slot into the lower levels of the wheel.
+ *
+ ****************************************************************************/
+
+static void wd_cascade(unsigned int level, unsigned int ndx)
+{
+  FAR struct wdog_s *wdog;
+  FAR struct wdog_s *next;
+  sq_queue_t list;
+
+  wd_detach(level, ndx, &list);
+  for (wdog = (FAR struct wdog_s *)list.head; wdog; wdog = next)
+    {
+      next = wdog->next;
+      g_wdnactive--;
+      wd_link(wdog);
+    }
+}
+
+/****************************************************************************
+ * Name: wd_tick
+ *
+ * Description:
+ *   Process the clock tick g_wdbase:  Cascade the upper levels if the
+ *   level 0 index wraps, then run all watchdogs that expire on this tick.
+ *
+ ****************************************************************************/
+
+static void wd_tick(void)
+{
+  FAR struct wdog_s *wdog;
+  unsigned int ndx = g_wdbase & WHEEL_MASK;
+  unsigned int level;
+
+  if (ndx == 0)
+    {
+      for (level = 1; level < WHEEL_LEVELS; level++)
+        {
+          unsigned int lndx = (g_wdbase >> WHEEL_SHIFT(level)) & WHEEL_MASK;
+
+          if (g_wdwheel[level][lndx].head)
+            {
+              wd_cascade(level, lndx);
+            }
+
+          if (lndx != 0)
+            {
+              break;
+            }
+        }
+    }
+
+  /* Move the expired watchdogs out of the wheel.  Watchdogs started by
+   * the expiring functions are filed relative to the next tick.  They are
+   * appended because g_wdexpired may still hold watchdogs of an outer
+   * wd_tick() if an expiring function caused wd_timer() to be re-entered.
+   */
+
+  if (g_wdwheel[0][ndx].head)
+    {
+      sq_queue_t list;
+
+      wd_detach(0, ndx, &list);
+      for (wdog = (FAR struct wdog_s *)list.head; wdog; wdog = wdog->next)
+        {
+          wdog->level = WHEEL_EXPIRED;
+          g_wdnactive--;
+        }
+
+      if (g_wdexpired.tail)
+        {
+          wdog = (FAR struct wdog_s *)list.head;
+          wdog->prev = (FAR struct wdog_s *)g_wdexpired.tail;
+          ((FAR struct wdog_s *)g_wdexpired.tail)->next = wdog;
+        }
+      else
+        {
+          g_wdexpired.head = list.head;
+        }
+
+      g_wdexpired.tail = list.tail;
+    }
+
+  g_wdbase++;
+
+  /* Then execute the watchdog functions */
+
+  while ((wdog = (FAR struct wdog_s *)g_wdexpired.head) != NULL)
+    {
+      g_wdexpired.head = (FAR sq_entry_t *)wdog->next;
+      if (wdog->next)
+        {
+          wdog->next->prev = NULL;
+        }
+      else
+        {
+          g_wdexpired.tail = NULL;
+        }
+
+      wdog->next = NULL;
+      WDOG_CLRACTIVE(wdog);
+      wd_dispatch(wdog);
+    }
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: wd_wheel_initialize
+ *
+ * Description:
+ *   Initialize the timer wheel.
+ *
+ ****************************************************************************/
+
+void wd_wheel_initialize(void)
+{
+  unsigned int level;
+  unsigned int ndx;
+
+  for (level = 0; level < WHEEL_LEVELS; level++)
+    {
+      for (ndx = 0; ndx < WHEEL_SLOTS; ndx++)
+        {
+          sq_init(&g_wdwheel[level][ndx]);
+        }
+
+      for (ndx = 0; ndx < WHEEL_NWORDS; ndx++)
+        {
+          g_wdbitmap[level][ndx] = 0;
+        }
+    }
+
+  sq_init(&g_wdexpired);
+  g_wdbase    = 0;
+  g_wdnactive = 0;
+}
+
+/****************************************************************************
+ * Name: wd_wheel_insert
+ *
+ * Description:
+ *   Add a watchdog to the timer wheel so that it expires when wd_timer()
+ *   has processed 'delay' more clock ticks.  Constant time.
+ *
+ * Assumptions:
+ *   Interrupts are disabled.  delay > 0.
+ *
+ ****************************************************************************/
+
+void wd_wheel_insert(FAR struct wdog_s *wdog, int delay)
+{
+  DEBUGASSERT(delay > 0);
+
+  wdog->lag = (int)(g_wdbase + (uint32_t)delay - 1);
+  wd_link(wdog);
+}
+
+/****************************************************************************
+ * Name: wd_wheel_remove
+ *
+ * Description:
+ *   Remove an active watchdog from the timer wheel.  Constant time.
+ *
+ * Assumptions:
+ *   Interrupts are disabled.
+ *
+ ****************************************************************************/
+
+void wd_wheel_remove(FAR struct wdog_s *wdog)
+{
+  FAR sq_queue_t *slot;
+
+  if (wdog->level == WHEEL_EXPIRED)
+    {
+      slot = &g_wdexpired;
+    }
+  else
+    {
+      DEBUGASSERT(wdog->level < WHEEL_LEVELS);
+      slot = &g_wdwheel[wdog->level][wdog->slot];
+      g_wdnactive--;
+    }
+
+  if (wdog->prev)
+    {
+      wdog->prev->next = wdog->next;
+    }
+  else
+    {
+      slot->head = (FAR sq_entry_t *)wdog->next;
+    }
+
+  if (wdog->next)
+    {
+      wdog->next->prev = wdog->prev;
+    }
+  else
+    {
+      slot->tail = (FAR sq_entry_t *)wdog->prev;
+    }
+
+  if (slot->head == NULL && wdog->level != WHEEL_EXPIRED)
+    {
+      g_wdbitmap[wdog->level][wdog->slot >> 5] &=
+        ~((uint32_t)1 << (wdog->slot & 31));
+    }
+
+  wdog->next = NULL;
+  wdog->prev = NULL;
+}
+
+/****************************************************************************
+ * Name: wd_wheel_next
+ *
+ * Description:
+ *   Return the number of clock ticks after g_wdbase at which wd_timer()
+ *   must next do some work (an expiration or a cascade), or -1 if there
+ *   are no active watchdogs.
+ *
+ *   The watchdogs in level 0 expire exactly on the tick of their slot.
+ *   The watchdogs in a higher level are not sorted within their slot, so
+ *   the time returned for them is that of the cascade into the lower
+ *   levels.  That costs at most one extra timer event for each level.
+ *
+ * Assumptions:
+ *   Interrupts are disabled.
+ *
+ ****************************************************************************/
+
+int wd_wheel_next(void)
+{
+  uint32_t best = UINT32_MAX;
+  unsigned int level;
+  int dist;
+
+  if (g_wdnactive == 0)
+    {
+      return -1;
+    }
+
+  dist = wd_findslot(g_wdbitmap[0], g_wdbase & WHEEL_MASK);
+  if (dist >= 0)
+    {
+      best = (uint32_t)dist;
+    }
+
+  for (level = 1; level < WHEEL_LEVELS; level++)
+    {
+      uint32_t block = g_wdbase >> WHEEL_SHIFT(level);
+      uint32_t low   = g_wdbase & (WHEEL_SPAN(level) - 1);
+      uint32_t tick;
+
+      /* The current slot of this level is cascaded on the tick g_wdbase
+       * if that is the start of a block.  Otherwise, the current slot has
+       * been cascaded already and the next candidate is the next slot.
+       */
+
+      if (low != 0)
+        {
+          block++;
+        }
+
+      dist = wd_findslot(g_wdbitmap[level], block & WHEEL_MASK);
+      if (dist >= 0)
+        {
+          tick = (block + (uint32_t)dist) << WHEEL_SHIFT(level);
+          if (tick - g_wdbase < best)
+            {
+              best = tick - g_wdbase;
+            }
+        }
+    }
+
+  DEBUGASSERT(best != UINT32_MAX);
+  return (int)best;
+}
+
+/****************************************************************************
+ * Name: wd_timer
+ *
+ * Description:
+ *   This function is called from the timer interrupt handler to determine
+ *   if it is time to execute a watchdog function.  If so, the watchdog
+ *   function will be executed in the context of the timer interrupt
+ *   handler.
+ *
+ * Parameters:
+ *   ticks - If CONFIG_SCHED_TICKLESS is defined then the number of ticks
+ *     in the the interval that just expired is provided.  Otherwise,
+ *     this function is called on each timer interrupt and a value of one
+ *     is implicit.
+ *
+ * Return Value:
+ *   If CONFIG_SCHED_TICKLESS is defined then the number of ticks for the
+ *   next delay is provided (zero if no delay).  Otherwise, this function
+ *   has no returned value.
+ *
+ * Assumptions:
+ *   Called from interrupt handler logic with interrupts disabled.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_SCHED_TICKLESS
+unsigned int wd_timer(int ticks)
+{
+  int next;
+
+  /* Skip directly over the ticks on which there is nothing to do */
+
+  while (ticks > 0)
+    {
+      next = wd_wheel_next();
+      if (next < 0 || next >= ticks)
+        {
+          g_wdbase += ticks;
+          break;
+        }
+
+      g_wdbase += next;
+      ticks    -= next + 1;
+      wd_tick();
+    }
+
+  /* Return the delay until the next tick on which there is work to do */
+
+  next = wd_wheel_next();
+  return next < 0 ? 0 : (unsigned int)next + 1;
+}
+
+#else
+void wd_timer(void)
+{
+  if (g_wdnactive == 0)
+    {
+      g_wdbase++;
+    }
+  else
+    {
+      wd_tick();
+    }
+}
+#endif /* CONFIG_SCHED_TICKLESS */
+#endif /* CONFIG_WDOG_TIMERWHEEL */
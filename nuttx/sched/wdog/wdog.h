@@ -74,12 +74,18 @@ extern "C"
 
 extern sq_queue_t g_wdfreelist;
 
+#ifdef CONFIG_WDOG_TIMERWHEEL
+/* g_wdbase is the next clock tick to be processed by the timer wheel */
+
+extern uint32_t g_wdbase;
+#else
 /* The g_wdactivelist data structure is a singly linked list ordered by
  * watchdog expiration time. When watchdog timers expire,the functions on
  * this linked list are removed and the function is called.
  */
 
 extern sq_queue_t g_wdactivelist;
+#endif
 
 /* This is the number of free, pre-allocated watchdog structures in the
  * g_wdfreelist.  This value is used to enforce a reserve for interrupt
@@ -144,6 +150,75 @@ unsigned int wd_timer(int ticks);
 void wd_timer(void);
 #endif
 
+/****************************************************************************
+ * Name: wd_dispatch
+ *
+ * Description:
+ *   Execute the function of an expired watchdog.
+ *
+ * Assumptions:
+ *   Called from interrupt handler logic with interrupts disabled.  The
+ *   watchdog has already been removed from the active watchdogs and
+ *   marked inactive.
+ *
+ ****************************************************************************/
+
+void wd_dispatch(FAR struct wdog_s *wdog);
+
+#ifdef CONFIG_WDOG_TIMERWHEEL
+/****************************************************************************
+ * Name: wd_wheel_initialize
+ *
+ * Description:
+ *   Initialize the timer wheel.
+ *
+ ****************************************************************************/
+
+void wd_wheel_initialize(void);
+
+/****************************************************************************
+ * Name: wd_wheel_insert
+ *
+ * Description:
+ *   Add a watchdog to the timer wheel so that it expires when wd_timer()
+ *   has processed 'delay' more clock ticks.  Constant time.
+ *
+ * Assumptions:
+ *   Interrupts are disabled.  delay > 0.
+ *
+ ****************************************************************************/
+
+void wd_wheel_insert(FAR struct wdog_s *wdog, int delay);
+
+/****************************************************************************
+ * Name: wd_wheel_remove
+ *
+ * Description:
+ *   Remove an active watchdog from the timer wheel.  Constant time.
+ *
+ * Assumptions:
+ *   Interrupts are disabled.
+ *
+ ****************************************************************************/
+
+void wd_wheel_remove(FAR struct wdog_s *wdog);
+
+/****************************************************************************
+ * Name: wd_wheel_next
+ *
+ * Description:
+ *   Return the number of clock ticks after g_wdbase at which wd_timer()
+ *   must next do some work (an expiration or a cascade), or -1 if there
+ *   are no active watchdogs.
+ *
+ * Assumptions:
+ *   Interrupts are disabled.
+ *
+ ****************************************************************************/
+
+int wd_wheel_next(void);
+#endif
+
 #undef EXTERN
 #ifdef __cplusplus
 }
@@ -118,6 +118,9 @@ static int work_qcancel(FAR struct kwork_wqueue_s *wqueue,
 
       dq_rem((FAR dq_entry_t *)work, &wqueue->q);
       work->worker = NULL;
+#ifdef CONFIG_SCHED_WORKSTATS
+      wqueue->stats.depth--;
+#endif
       ret = OK;
     }
 
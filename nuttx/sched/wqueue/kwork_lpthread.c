@@ -196,7 +196,7 @@ int work_lpstart(void)
 
   /* Initialize work queue data structures */
 
-  memset(&g_lpwork, 0, sizeof(struct kwork_wqueue_s));
+  memset(&g_lpwork, 0, sizeof(struct lp_wqueue_s));
 
   g_lpwork.delay = CONFIG_SCHED_LPWORKPERIOD / USEC_PER_TICK;
   dq_init(&g_lpwork.q);
@@ -42,9 +42,11 @@
 #include <stdint.h>
 #include <unistd.h>
 #include <signal.h>
+#include <time.h>
 #include <assert.h>
 #include <queue.h>
 
+#include <nuttx/arch.h>
 #include <nuttx/clock.h>
 #include <nuttx/wqueue.h>
 
@@ -88,6 +90,29 @@
  * Private Functions
  ****************************************************************************/
 
+/****************************************************************************
+ * Name: work_systime
+ *
+ * Description:
+ *   Return the current time in microseconds for the work queue statistics.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_SCHED_WORKSTATS
+static inline uint32_t work_systime(void)
+{
+#ifdef CONFIG_SCHED_TICKLESS
+  struct timespec ts;
+
+  (void)up_timer_gettime(&ts);
+  return (uint32_t)ts.tv_sec * USEC_PER_SEC +
+         (uint32_t)ts.tv_nsec / NSEC_PER_USEC;
+#else
+  return (uint32_t)clock_systimer() * USEC_PER_TICK;
+#endif
+}
+#endif
+
 /****************************************************************************
  * Public Functions
  ****************************************************************************/
@@ -120,6 +145,11 @@ void work_process(FAR struct kwork_wqueue_s *wqueue, uint32_t period, int wndx)
   uint32_t stick;
   uint32_t ctick;
   uint32_t next;
+#ifdef CONFIG_SCHED_WORKSTATS
+  uint32_t start;
+  uint32_t runtime;
+  uint32_t latency;
+#endif
 
   /* Then process queued work.  We need to keep interrupts disabled while
    * we process items in the work list.
@@ -153,6 +183,9 @@ void work_process(FAR struct kwork_wqueue_s *wqueue, uint32_t period, int wndx)
           /* Remove the ready-to-execute work from the list */
 
           (void)dq_rem((struct dq_entry_s *)work, &wqueue->q);
+#ifdef CONFIG_SCHED_WORKSTATS
+          wqueue->stats.depth--;
+#endif
 
           /* Extract the work description from the entry (in case the work
            * instance by the re-used after it has been de-queued).
@@ -170,6 +203,25 @@ void work_process(FAR struct kwork_wqueue_s *wqueue, uint32_t period, int wndx)
 
               arg = work->arg;
 
+#ifdef CONFIG_SCHED_WORKSTATS
+              /* Latency is measured from the time that the work became
+               * ready so that the requested delay is not counted.
+               */
+
+              latency = TICK2USEC(elapsed - work->delay);
+              if (latency > wqueue->stats.maxlatency)
+                {
+                  wqueue->stats.maxlatency = latency;
+                }
+
+#ifdef CONFIG_SCHED_WORKPRIORITY
+              if (work->deadline != 0 && elapsed > work->deadline)
+                {
+                  wqueue->stats.nmissed++;
+                }
+#endif
+#endif
+
               /* Mark the work as no longer being queued */
 
               work->worker = NULL;
@@ -179,7 +231,13 @@ void work_process(FAR struct kwork_wqueue_s *wqueue, uint32_t period, int wndx)
                */
 
               irqrestore(flags);
+#ifdef CONFIG_SCHED_WORKSTATS
+              start = work_systime();
+              worker(arg);
+              runtime = work_systime() - start;
+#else
               worker(arg);
+#endif
 
               /* Now, unfortunately, since we re-enabled interrupts we don't
                * know the state of the work list and we will have to start
@@ -188,6 +246,15 @@ void work_process(FAR struct kwork_wqueue_s *wqueue, uint32_t period, int wndx)
 
               flags = irqsave();
               work  = (FAR struct work_s *)wqueue->q.head;
+
+#ifdef CONFIG_SCHED_WORKSTATS
+              wqueue->stats.nrun++;
+              wqueue->stats.runtime += runtime;
+              if (runtime > wqueue->stats.maxrun)
+                {
+                  wqueue->stats.maxrun = runtime;
+                }
+#endif
             }
           else
             {
@@ -203,13 +270,11 @@ void work_process(FAR struct kwork_wqueue_s *wqueue, uint32_t period, int wndx)
           /* This one is not ready.. will it be ready before the next
            * scheduled wakeup interval?
            *
-           * NOTE that elapsed is relative to the the current time,
-           * not the time of beginning of this queue processing pass.
-           * So it may need an adjustment.
+           * NOTE that elapsed is relative to the the current time, so
+           * remaining is the time from now until the work is ready.
            */
 
-          elapsed  += (ctick - stick);
-          remaining = elapsed - work->delay;
+          remaining = work->delay - elapsed;
           if (remaining < next)
             {
               /* Yes.. Then schedule to wake up when the work is ready */
@@ -0,0 +1,344 @@
+/****************************************************************************
+ * sched/wqueue/kwork_procfs.c
+ *
+ *   Copyright (C) 2014 Gregory Nutt. All rights reserved.
+ *   Author: Gregory Nutt <gnutt@nuttx.org>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name NuttX nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <sys/types.h>
+#include <sys/stat.h>
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <fcntl.h>
+#include <assert.h>
+#include <errno.h>
+#include <debug.h>
+
+#include <nuttx/kmalloc.h>
+#include <nuttx/wqueue.h>
+#include <nuttx/fs/fs.h>
+#include <nuttx/fs/procfs.h>
+
+#include <arch/irq.h>
+
+#include "wqueue/wqueue.h"
+
+#if defined(CONFIG_SCHED_WORKSTATS) && defined(CONFIG_FS_PROCFS) && \
+   !defined(CONFIG_FS_PROCFS_EXCLUDE_WORK)
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+/* Determines the size of the buffer that must be large enough to hold the
+ * header and one line for each kernel work queue.
+ */
+
+#define WORK_BUFSIZE 256
+
+/****************************************************************************
+ * Private Types
+ ****************************************************************************/
+/* This structure describes one open "file" */
+
+struct work_file_s
+{
+  struct procfs_file_s base;   /* Base open file structure */
+  unsigned int linesize;       /* Number of valid characters in line[] */
+  char line[WORK_BUFSIZE];     /* Formatted statistics */
+};
+
+/****************************************************************************
+ * Private Function Prototypes
+ ****************************************************************************/
+/* File system methods */
+
+static int     work_open(FAR struct file *filep, FAR const char *relpath,
+                 int oflags, mode_t mode);
+static int     work_close(FAR struct file *filep);
+static ssize_t work_read(FAR struct file *filep, FAR char *buffer,
+                 size_t buflen);
+
+static int     work_dup(FAR const struct file *oldp,
+                 FAR struct file *newp);
+
+static int     work_stat(FAR const char *relpath, FAR struct stat *buf);
+
+/****************************************************************************
+ * Public Variables
+ ****************************************************************************/
+
+/* See fs/procfs/fs_procfs.c -- this structure is explicitly externed there.
+ * We use the old-fashioned kind of initializers so that this will compile
+ * with any compiler.
+ */
+
+const struct procfs_operations work_procfsoperations =
+{
+  work_open,      /* open */
+  work_close,     /* close */
+  work_read,      /* read */
+  NULL,           /* write */
+
+  work_dup,       /* dup */
+
+  NULL,           /* opendir */
+  NULL,           /* closedir */
+  NULL,           /* readdir */
+  NULL,           /* rewinddir */
+
+  work_stat       /* stat */
+};
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: work_line
+ *
+ * Description:
+ *   Format the statistics of one work queue.  The statistics are sampled
+ *   with interrupts disabled so that the line is self-consistent.
+ *
+ ****************************************************************************/
+
+static int work_line(FAR char *buffer, size_t buflen, FAR const char *name,
+                     FAR struct kwork_wqueue_s *wqueue)
+{
+  struct kwork_stats_s stats;
+  irqstate_t flags;
+
+  flags = irqsave();
+  memcpy(&stats, &wqueue->stats, sizeof(struct kwork_stats_s));
+  irqrestore(flags);
+
+#ifdef CONFIG_SCHED_WORKPRIORITY
+  return snprintf(buffer, buflen, "%-8s %5u %5u %8lu %6lu %8lu %10lu %8lu\n",
+                  name, stats.depth, stats.maxdepth,
+                  (unsigned long)stats.nrun, (unsigned long)stats.nmissed,
+                  (unsigned long)stats.maxlatency,
+                  (unsigned long)stats.runtime,
+                  (unsigned long)stats.maxrun);
+#else
+  return snprintf(buffer, buflen, "%-8s %5u %5u %8lu %6s %8lu %10lu %8lu\n",
+                  name, stats.depth, stats.maxdepth,
+                  (unsigned long)stats.nrun, "-",
+                  (unsigned long)stats.maxlatency,
+                  (unsigned long)stats.runtime,
+                  (unsigned long)stats.maxrun);
+#endif
+}
+
+/****************************************************************************
+ * Name: work_open
+ ****************************************************************************/
+
+static int work_open(FAR struct file *filep, FAR const char *relpath,
+                     int oflags, mode_t mode)
+{
+  FAR struct work_file_s *attr;
+
+  fvdbg("Open '%s'\n", relpath);
+
+  /* PROCFS is read-only.  Any attempt to open with any kind of write
+   * access is not permitted.
+   */
+
+  if ((oflags & O_WRONLY) != 0 || (oflags & O_RDONLY) == 0)
+    {
+      fdbg("ERROR: Only O_RDONLY supported\n");
+      return -EACCES;
+    }
+
+  /* Allocate a context structure */
+
+  attr = (FAR struct work_file_s *)kmm_zalloc(sizeof(struct work_file_s));
+  if (!attr)
+    {
+      fdbg("ERROR: Failed to allocate file attributes\n");
+      return -ENOMEM;
+    }
+
+  /* Save the context as the open-specific state in filep->f_priv */
+
+  filep->f_priv = (FAR void *)attr;
+  return OK;
+}
+
+/****************************************************************************
+ * Name: work_close
+ ****************************************************************************/
+
+static int work_close(FAR struct file *filep)
+{
+  FAR struct work_file_s *attr;
+
+  /* Recover our private data from the struct file instance */
+
+  attr = (FAR struct work_file_s *)filep->f_priv;
+  DEBUGASSERT(attr);
+
+  /* Release the file attributes structure */
+
+  kmm_free(attr);
+  filep->f_priv = NULL;
+  return OK;
+}
+
+/****************************************************************************
+ * Name: work_read
+ ****************************************************************************/
+
+static ssize_t work_read(FAR struct file *filep, FAR char *buffer,
+                         size_t buflen)
+{
+  FAR struct work_file_s *attr;
+  size_t linesize;
+  off_t offset;
+  ssize_t ret;
+
+  fvdbg("buffer=%p buflen=%d\n", buffer, (int)buflen);
+
+  /* Recover our private data from the struct file instance */
+
+  attr = (FAR struct work_file_s *)filep->f_priv;
+  DEBUGASSERT(attr);
+
+  /* If f_pos is zero, then sample the statistics.  Otherwise, use the
+   * text formatted by the first read() so that the output remains stable
+   * if the user reads it in small pieces.
+   */
+
+  if (filep->f_pos == 0)
+    {
+      linesize = snprintf(attr->line, WORK_BUFSIZE,
+                          "%-8s %5s %5s %8s %6s %8s %10s %8s\n",
+                          "Queue", "Depth", "Max", "Run", "Missed",
+                          "MaxLat", "Runtime", "MaxRun");
+
+#ifdef CONFIG_SCHED_HPWORK
+      linesize += work_line(&attr->line[linesize], WORK_BUFSIZE - linesize,
+                            HPWORKNAME,
+                            (FAR struct kwork_wqueue_s *)&g_hpwork);
+#endif
+#ifdef CONFIG_SCHED_LPWORK
+      linesize += work_line(&attr->line[linesize], WORK_BUFSIZE - linesize,
+                            LPWORKNAME,
+                            (FAR struct kwork_wqueue_s *)&g_lpwork);
+#endif
+
+      /* Save the linesize in case we are re-entered with f_pos > 0 */
+
+      attr->linesize = linesize;
+    }
+
+  /* Transfer the statistics to user receive buffer */
+
+  offset = filep->f_pos;
+  ret    = procfs_memcpy(attr->line, attr->linesize, buffer, buflen, &offset);
+
+  /* Update the file offset */
+
+  if (ret > 0)
+    {
+      filep->f_pos += ret;
+    }
+
+  return ret;
+}
+
+/****************************************************************************
+ * Name: work_dup
+ *
+ * Description:
+ *   Duplicate open file data in the new file structure.
+ *
+ ****************************************************************************/
+
+static int work_dup(FAR const struct file *oldp, FAR struct file *newp)
+{
+  FAR struct work_file_s *oldattr;
+  FAR struct work_file_s *newattr;
+
+  fvdbg("Dup %p->%p\n", oldp, newp);
+
+  /* Recover our private data from the old struct file instance */
+
+  oldattr = (FAR struct work_file_s *)oldp->f_priv;
+  DEBUGASSERT(oldattr);
+
+  /* Allocate a new container to hold the task and attribute selection */
+
+  newattr = (FAR struct work_file_s *)kmm_malloc(sizeof(struct work_file_s));
+  if (!newattr)
+    {
+      fdbg("ERROR: Failed to allocate file attributes\n");
+      return -ENOMEM;
+    }
+
+  /* The copy the file attributes from the old attributes to the new */
+
+  memcpy(newattr, oldattr, sizeof(struct work_file_s));
+
+  /* Save the new attributes in the new file structure */
+
+  newp->f_priv = (FAR void *)newattr;
+  return OK;
+}
+
+/****************************************************************************
+ * Name: work_stat
+ *
+ * Description: Return information about a file or directory
+ *
+ ****************************************************************************/
+
+static int work_stat(const char *relpath, struct stat *buf)
+{
+  /* File/directory size, access block size */
+
+  buf->st_mode    = S_IFREG|S_IROTH|S_IRGRP|S_IRUSR;
+  buf->st_size    = 0;
+  buf->st_blksize = 0;
+  buf->st_blocks  = 0;
+  return OK;
+}
+
+#endif /* CONFIG_SCHED_WORKSTATS && CONFIG_FS_PROCFS */
@@ -40,6 +40,7 @@
 #include <nuttx/config.h>
 
 #include <stdint.h>
+#include <stdbool.h>
 #include <queue.h>
 #include <assert.h>
 #include <errno.h>
@@ -72,6 +73,45 @@
  * Private Functions
  ****************************************************************************/
 
+/****************************************************************************
+ * Name: work_before
+ *
+ * Description:
+ *   Return true if 'work' should be performed before 'queued'.  Higher
+ *   priority work goes first.  Within the same priority, work with the
+ *   earlier deadline goes first and work with a deadline goes before work
+ *   without one.  Otherwise, the order is FIFO.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_SCHED_WORKPRIORITY
+static inline bool work_before(FAR struct work_s *work,
+                               FAR struct work_s *queued)
+{
+  if (work->priority != queued->priority)
+    {
+      return work->priority > queued->priority;
+    }
+
+  if (work->deadline == 0)
+    {
+      return false;
+    }
+
+  if (queued->deadline == 0)
+    {
+      return true;
+    }
+
+  /* Compare the absolute deadlines.  The signed difference handles
+   * wrap-around of the system timer.
+   */
+
+  return (int32_t)((work->qtime + work->deadline) -
+                   (queued->qtime + queued->deadline)) < 0;
+}
+#endif
+
 /****************************************************************************
  * Name: work_qqueue
  *
@@ -87,14 +127,16 @@
  *   and remove it from the work queue.
  *
  * Input parameters:
- *   qid    - The work queue ID (index)
- *   work   - The work structure to queue
- *   worker - The worker callback to be invoked.  The callback will invoked
- *            on the worker thread of execution.
- *   arg    - The argument that will be passed to the workder callback when
- *            int is invoked.
- *   delay  - Delay (in clock ticks) from the time queue until the worker
- *            is invoked. Zero means to perform the work immediately.
+ *   qid      - The work queue ID (index)
+ *   work     - The work structure to queue
+ *   worker   - The worker callback to be invoked.  The callback will invoked
+ *              on the worker thread of execution.
+ *   arg      - The argument that will be passed to the workder callback
+ *              when int is invoked.
+ *   delay    - Delay (in clock ticks) from the time queue until the worker
+ *              is invoked. Zero means to perform the work immediately.
+ *   priority - The work priority (CONFIG_SCHED_WORKPRIORITY only)
+ *   deadline - The start deadline (CONFIG_SCHED_WORKPRIORITY only)
  *
  * Returned Value:
  *   None
@@ -103,31 +145,106 @@
 
 static void work_qqueue(FAR struct kwork_wqueue_s *wqueue,
                         FAR struct work_s *work, worker_t worker,
-                        FAR void *arg, uint32_t delay)
+                        FAR void *arg, uint32_t delay, uint8_t priority,
+                        uint32_t deadline)
 {
+#ifdef CONFIG_SCHED_WORKPRIORITY
+  FAR struct work_s *prev;
+#endif
   irqstate_t flags;
 
   DEBUGASSERT(work != NULL);
 
   /* First, initialize the work structure */
 
-  work->worker = worker;           /* Work callback */
-  work->arg    = arg;              /* Callback argument */
-  work->delay  = delay;            /* Delay until work performed */
+  work->worker   = worker;         /* Work callback */
+  work->arg      = arg;            /* Callback argument */
+  work->delay    = delay;          /* Delay until work performed */
+#ifdef CONFIG_SCHED_WORKPRIORITY
+  work->priority = priority;       /* Work priority */
+  work->deadline = deadline;       /* Start deadline */
+#endif
 
   /* Now, time-tag that entry and put it in the work queue.  This must be
    * done with interrupts disabled.  This permits this function to be called
    * from with task logic or interrupt handlers.
    */
 
-  flags        = irqsave();
-  work->qtime  = clock_systimer(); /* Time work queued */
+  flags          = irqsave();
+  work->qtime    = clock_systimer(); /* Time work queued */
+
+#ifdef CONFIG_SCHED_WORKPRIORITY
+  /* Search backward from the tail for the last entry that is not
+   * performed after this one.  Most work uses the default priority and
+   * no deadline, so the search normally ends at the tail.
+   */
 
+  for (prev = (FAR struct work_s *)wqueue->q.tail;
+       prev != NULL && work_before(work, prev);
+       prev = (FAR struct work_s *)prev->dq.blink);
+
+  if (prev != NULL)
+    {
+      dq_addafter((FAR dq_entry_t *)prev, (FAR dq_entry_t *)work,
+                  &wqueue->q);
+    }
+  else
+    {
+      dq_addfirst((FAR dq_entry_t *)work, &wqueue->q);
+    }
+#else
   dq_addlast((FAR dq_entry_t *)work, &wqueue->q);
+#endif
+
+#ifdef CONFIG_SCHED_WORKSTATS
+  if (++wqueue->stats.depth > wqueue->stats.maxdepth)
+    {
+      wqueue->stats.maxdepth = wqueue->stats.depth;
+    }
+#endif
 
   irqrestore(flags);
 }
 
+/****************************************************************************
+ * Name: work_qselect
+ *
+ * Description:
+ *   Queue work on the selected work queue and signal a worker thread.
+ *
+ ****************************************************************************/
+
+static int work_qselect(int qid, FAR struct work_s *work, worker_t worker,
+                        FAR void *arg, uint32_t delay, uint8_t priority,
+                        uint32_t deadline)
+{
+#ifdef CONFIG_SCHED_HPWORK
+  if (qid == HPWORK)
+    {
+      /* Queue high priority work */
+
+      work_qqueue((FAR struct kwork_wqueue_s *)&g_hpwork, work, worker, arg,
+                  delay, priority, deadline);
+      return work_signal(HPWORK);
+    }
+  else
+#endif
+#ifdef CONFIG_SCHED_LPWORK
+  if (qid == LPWORK)
+    {
+      /* Queue low priority work */
+
+      work_qqueue((FAR struct kwork_wqueue_s *)&g_lpwork, work, worker, arg,
+                  delay, priority, deadline);
+      return work_signal(LPWORK);
+    }
+  else
+#endif
+    {
+      return -EINVAL;
+    }
+}
+
 /****************************************************************************
  * Public Functions
  ****************************************************************************/
@@ -164,29 +281,46 @@ static void work_qqueue(FAR struct kwork_wqueue_s *wqueue,
 int work_queue(int qid, FAR struct work_s *work, worker_t worker,
                FAR void *arg, uint32_t delay)
 {
-#ifdef CONFIG_SCHED_HPWORK
-  if (qid == HPWORK)
-    {
-      /* Cancel high priority work */
-
-      work_qqueue((FAR struct kwork_wqueue_s *)&g_hpwork, work, worker, arg, delay);
-      return work_signal(HPWORK);
-    }
-  else
+#ifdef CONFIG_SCHED_WORKPRIORITY
+  return work_qselect(qid, work, worker, arg, delay,
+                      WORK_PRIORITY_DEFAULT, 0);
+#else
+  return work_qselect(qid, work, worker, arg, delay, 0, 0);
 #endif
-#ifdef CONFIG_SCHED_LPWORK
-  if (qid == LPWORK)
-    {
-      /* Cancel low priority work */
+}
 
-      work_qqueue((FAR struct kwork_wqueue_s *)&g_lpwork, work, worker, arg, delay);
-      return work_signal(LPWORK);
-    }
-  else
-#endif
-    {
-      return -EINVAL;
-    }
+/****************************************************************************
+ * Name: work_queuepriority
+ *
+ * Description:
+ *   Queue kernel-mode work with an explicit priority and deadline.  This is
+ *   the same as work_queue() except that the work is inserted ahead of all
+ *   queued work of lower priority and, among work of the same priority,
+ *   ahead of work with a later deadline.
+ *
+ * Input parameters:
+ *   qid      - The work queue ID (index)
+ *   work     - The work structure to queue
+ *   worker   - The worker callback to be invoked.
+ *   arg      - The argument that will be passed to the worker callback.
+ *   delay    - Delay (in clock ticks) from the time queue until the worker
+ *              is invoked. Zero means to perform the work immediately.
+ *   priority - The work priority, WORK_PRIORITY_MIN to WORK_PRIORITY_MAX
+ *   deadline - Time (in clock ticks) from the time queued by which the
+ *              worker should be started.  Zero means no deadline.
+ *
+ * Returned Value:
+ *   Zero on success, a negated errno on failure
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_SCHED_WORKPRIORITY
+int work_queuepriority(int qid, FAR struct work_s *work, worker_t worker,
+                       FAR void *arg, uint32_t delay, uint8_t priority,
+                       uint32_t deadline)
+{
+  return work_qselect(qid, work, worker, arg, delay, priority, deadline);
 }
+#endif
 
 #endif /* CONFIG_SCHED_WORKQUEUE */
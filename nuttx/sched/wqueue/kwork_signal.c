@@ -44,6 +44,8 @@
 
 #include <nuttx/wqueue.h>
 
+#include <arch/irq.h>
+
 #include "wqueue/wqueue.h"
 
 #ifdef CONFIG_SCHED_WORKQUEUE
@@ -104,15 +106,21 @@ int work_signal(int qid)
 #ifdef CONFIG_SCHED_LPWORK
   if (qid == LPWORK)
     {
+      irqstate_t flags;
       int wndx;
       int i;
 
-      /* Find an IDLE worker thread */
+      /* Find an IDLE worker thread.  Mark it busy so that the next signal
+       * wakes a different worker, even if this one has not yet run.  The
+       * worker clears the flag again when it next waits.
+       */
 
+      flags = irqsave();
       for (wndx = 0, i = 0; i < CONFIG_SCHED_LPNTHREADS; i++)
         {
-          if (g_lpwork.worker[i].busy)
+          if (!g_lpwork.worker[i].busy)
             {
+              g_lpwork.worker[i].busy = true;
               wndx = i;
               break;
             }
@@ -123,6 +131,7 @@ int work_signal(int qid)
        */
 
       pid = g_lpwork.worker[wndx].pid;
+      irqrestore(flags);
     }
   else
 #endif
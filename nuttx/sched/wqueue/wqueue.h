@@ -68,12 +68,32 @@ struct kworker_s
   volatile bool     busy;   /* True: Worker is not available */
 };
 
+/* Statistics for one kernel-mode work queue.  Times are in microseconds. */
+
+#ifdef CONFIG_SCHED_WORKSTATS
+struct kwork_stats_s
+{
+  uint16_t          depth;      /* Number of queued work items */
+  uint16_t          maxdepth;   /* Largest value of depth */
+  uint32_t          nrun;       /* Number of work items performed */
+#ifdef CONFIG_SCHED_WORKPRIORITY
+  uint32_t          nmissed;    /* Number started after their deadline */
+#endif
+  uint32_t          maxlatency; /* Longest time from ready until started */
+  uint32_t          runtime;    /* Total time in worker callbacks */
+  uint32_t          maxrun;     /* Longest time in one worker callback */
+};
+#endif
+
 /* This structure defines the state of one kernel-mode work queue */
 
 struct kwork_wqueue_s
 {
   uint32_t          delay;     /* Delay between polling cycles (ticks) */
   struct dq_queue_s q;         /* The queue of pending work */
+#ifdef CONFIG_SCHED_WORKSTATS
+  struct kwork_stats_s stats;  /* Work queue statistics */
+#endif
   struct kworker_s  worker[1]; /* Describes a worker thread */
 };
 
@@ -86,6 +106,9 @@ struct hp_wqueue_s
 {
   uint32_t          delay;     /* Delay between polling cycles (ticks) */
   struct dq_queue_s q;         /* The queue of pending work */
+#ifdef CONFIG_SCHED_WORKSTATS
+  struct kwork_stats_s stats;  /* Work queue statistics */
+#endif
   struct kworker_s  worker[1]; /* Describes the single high priority worker */
 };
 #endif
@@ -99,6 +122,9 @@ struct lp_wqueue_s
 {
   uint32_t          delay;  /* Delay between polling cycles (ticks) */
   struct dq_queue_s q;      /* The queue of pending work */
+#ifdef CONFIG_SCHED_WORKSTATS
+  struct kwork_stats_s stats; /* Work queue statistics */
+#endif
 
   /* Describes each thread in the low priority queue's thread pool */
 
@@ -297,7 +297,11 @@ SYSCALL_LOOKUP(up_assert,                 2, STUB_up_assert)
   SYSCALL_LOOKUP(listen,                  2, STUB_listen)
   SYSCALL_LOOKUP(recv,                    4, STUB_recv)
   SYSCALL_LOOKUP(recvfrom,                6, STUB_recvfrom)
+  SYSCALL_LOOKUP(recvmmsg,                5, STUB_recvmmsg)
+  SYSCALL_LOOKUP(recvmsg,                 3, STUB_recvmsg)
   SYSCALL_LOOKUP(send,                    4, STUB_send)
+  SYSCALL_LOOKUP(sendmmsg,                4, STUB_sendmmsg)
+  SYSCALL_LOOKUP(sendmsg,                 3, STUB_sendmsg)
   SYSCALL_LOOKUP(sendto,                  6, STUB_sendto)
   SYSCALL_LOOKUP(setsockopt,              5, STUB_setsockopt)
   SYSCALL_LOOKUP(socket,                  3, STUB_socket)
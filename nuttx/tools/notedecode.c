@@ -0,0 +1,536 @@
+/****************************************************************************
+ * tools/notedecode.c
+ *
+ *   Copyright (C) 2014 Gregory Nutt. All rights reserved.
+ *   Author: Gregory Nutt <gnutt@nuttx.org>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name NuttX nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <unistd.h>
+#include <errno.h>
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+/* The note format must agree with include/nuttx/sched_note.h.  That header
+ * cannot be included here because it depends on the target configuration.
+ */
+
+#define NOTE_START         0
+#define NOTE_STOP          1
+#define NOTE_SWITCH        2
+#define NOTE_IRQ_ENTER     3
+#define NOTE_IRQ_LEAVE     4
+#define NOTE_SEMWAIT       5
+
+#define NOTE_COMMON_SIZE   9    /* length, type, priority, pid[2], time[4] */
+
+#define MAX_PID            65536
+#define IRQ_TID_BASE       MAX_PID
+#define MAX_IRQ            65536
+#define MAX_NAME           256
+
+/****************************************************************************
+ * Private Types
+ ****************************************************************************/
+
+struct thread_s
+{
+  char *name;                   /* Name from the NOTE_START note */
+  bool running;                 /* An open "B" event exists */
+  bool named;                   /* Metadata event has been emitted */
+};
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+static struct thread_s g_threads[MAX_PID];
+static uint8_t g_irqactive[MAX_IRQ];
+static bool g_text;
+static bool g_first = true;
+static FILE *g_out;
+
+/* Timestamp unwrapping */
+
+static uint32_t g_lasttime;
+static uint64_t g_timebase;
+static bool g_havetime;
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+static void show_usage(const char *progname, int exitcode)
+{
+  fprintf(stderr, "USAGE: %s [-t] [-o <outfile>] <notefile>\n", progname);
+  fprintf(stderr, "       %s -h\n\n", progname);
+  fprintf(stderr, "Convert a dump of /dev/note into Chrome trace (JSON) "
+                  "format.  The output may\n");
+  fprintf(stderr, "be loaded into chrome://tracing or ui.perfetto.dev\n\n");
+  fprintf(stderr, "Where:\n");
+  fprintf(stderr, "  -t            Print the notes as text instead\n");
+  fprintf(stderr, "  -o <outfile>  Write output to <outfile> (default: "
+                  "stdout)\n");
+  fprintf(stderr, "  -h            Show this message and exit\n");
+  exit(exitcode);
+}
+
+static unsigned int get16(const uint8_t *ptr)
+{
+  return (unsigned int)ptr[0] | ((unsigned int)ptr[1] << 8);
+}
+
+static uint32_t get32(const uint8_t *ptr)
+{
+  return (uint32_t)ptr[0] | ((uint32_t)ptr[1] << 8) |
+         ((uint32_t)ptr[2] << 16) | ((uint32_t)ptr[3] << 24);
+}
+
+/* The target time stamp is a 32-bit microsecond count that wraps after
+ * about 71 minutes.  Notes are in time order, so a decrease means a wrap.
+ */
+
+static uint64_t unwrap_time(uint32_t systime)
+{
+  if (g_havetime && systime < g_lasttime)
+    {
+      g_timebase += (uint64_t)1 << 32;
+    }
+
+  g_havetime = true;
+  g_lasttime = systime;
+  return g_timebase + systime;
+}
+
+static const char *thread_name(unsigned int pid, char *buffer)
+{
+  if (g_threads[pid].name)
+    {
+      return g_threads[pid].name;
+    }
+
+  snprintf(buffer, MAX_NAME, "pid %u", pid);
+  return buffer;
+}
+
+/* Print a string as a JSON string literal */
+
+static void json_string(const char *str)
+{
+  fputc('"', g_out);
+  for (; *str; str++)
+    {
+      if (*str == '"' || *str == '\\')
+        {
+          fprintf(g_out, "\\%c", *str);
+        }
+      else if ((unsigned char)*str < 0x20)
+        {
+          fprintf(g_out, "\\u%04x", (unsigned char)*str);
+        }
+      else
+        {
+          fputc(*str, g_out);
+        }
+    }
+
+  fputc('"', g_out);
+}
+
+static void json_begin(void)
+{
+  fprintf(g_out, g_first ? "\n  {" : ",\n  {");
+  g_first = false;
+}
+
+static void json_thread_name(unsigned int tid, const char *name)
+{
+  json_begin();
+  fprintf(g_out, "\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,"
+                 "\"tid\":%u,\"args\":{\"name\":", tid);
+  json_string(name);
+  fprintf(g_out, "}}");
+}
+
+static void json_event(const char *name, char ph, unsigned int tid,
+                       uint64_t usec, const char *args)
+{
+  json_begin();
+  fprintf(g_out, "\"name\":");
+  json_string(name);
+  fprintf(g_out, ",\"ph\":\"%c\",\"pid\":0,\"tid\":%u,\"ts\":%llu",
+          ph, tid, (unsigned long long)usec);
+
+  if (ph == 'i')
+    {
+      fprintf(g_out, ",\"s\":\"t\"");
+    }
+
+  if (args)
+    {
+      fprintf(g_out, ",\"args\":{%s}", args);
+    }
+
+  fprintf(g_out, "}");
+}
+
+static void name_thread(unsigned int pid)
+{
+  char buffer[MAX_NAME];
+
+  if (!g_threads[pid].named)
+    {
+      json_thread_name(pid, thread_name(pid, buffer));
+      g_threads[pid].named = true;
+    }
+}
+
+static void thread_resume(unsigned int pid, unsigned int priority,
+                          uint64_t usec)
+{
+  char buffer[MAX_NAME];
+  char args[64];
+
+  name_thread(pid);
+  if (!g_threads[pid].running)
+    {
+      snprintf(args, sizeof(args), "\"priority\":%u", priority);
+      json_event(thread_name(pid, buffer), 'B', pid, usec, args);
+      g_threads[pid].running = true;
+    }
+}
+
+static void thread_suspend(unsigned int pid, uint64_t usec)
+{
+  char buffer[MAX_NAME];
+
+  name_thread(pid);
+  if (g_threads[pid].running)
+    {
+      json_event(thread_name(pid, buffer), 'E', pid, usec, NULL);
+      g_threads[pid].running = false;
+    }
+}
+
+static void decode_note(const uint8_t *note, unsigned int length)
+{
+  char buffer[MAX_NAME];
+  char args[64];
+  unsigned int type     = note[1];
+  unsigned int priority = note[2];
+  unsigned int pid      = get16(&note[3]);
+  uint32_t systime      = get32(&note[5]);
+  uint64_t usec         = unwrap_time(systime);
+  unsigned int irq;
+  unsigned int i;
+
+  switch (type)
+    {
+      case NOTE_START:
+        {
+          unsigned int namelen = length - NOTE_COMMON_SIZE;
+
+          free(g_threads[pid].name);
+          g_threads[pid].name = NULL;
+          g_threads[pid].named = false;
+
+          if (namelen > 0)
+            {
+              g_threads[pid].name = malloc(namelen + 1);
+              if (g_threads[pid].name)
+                {
+                  memcpy(g_threads[pid].name, &note[NOTE_COMMON_SIZE],
+                         namelen);
+                  g_threads[pid].name[namelen] = '\0';
+                }
+            }
+
+          if (g_text)
+            {
+              fprintf(g_out, "%12llu START  pid %u prio %u \"%s\"\n",
+                      (unsigned long long)usec, pid, priority,
+                      thread_name(pid, buffer));
+            }
+          else
+            {
+              name_thread(pid);
+              json_event("start", 'i', pid, usec, NULL);
+            }
+        }
+        break;
+
+      case NOTE_STOP:
+        if (g_text)
+          {
+            fprintf(g_out, "%12llu STOP   pid %u\n",
+                    (unsigned long long)usec, pid);
+          }
+        else
+          {
+            thread_suspend(pid, usec);
+            json_event("stop", 'i', pid, usec, NULL);
+          }
+        break;
+
+      case NOTE_SWITCH:
+        {
+          unsigned int topid;
+          unsigned int toprio;
+
+          if (length < NOTE_COMMON_SIZE + 3)
+            {
+              break;
+            }
+
+          topid  = get16(&note[NOTE_COMMON_SIZE]);
+          toprio = note[NOTE_COMMON_SIZE + 2];
+
+          if (g_text)
+            {
+              fprintf(g_out, "%12llu SWITCH pid %u (prio %u) -> "
+                      "pid %u (prio %u)\n", (unsigned long long)usec,
+                      pid, priority, topid, toprio);
+            }
+          else
+            {
+              thread_suspend(pid, usec);
+              thread_resume(topid, toprio, usec);
+            }
+        }
+        break;
+
+      case NOTE_IRQ_ENTER:
+      case NOTE_IRQ_LEAVE:
+        if (length < NOTE_COMMON_SIZE + 2)
+          {
+            break;
+          }
+
+        irq = get16(&note[NOTE_COMMON_SIZE]);
+        if (g_text)
+          {
+            fprintf(g_out, "%12llu IRQ%s %u (pid %u)\n",
+                    (unsigned long long)usec,
+                    type == NOTE_IRQ_ENTER ? "+  " : "-  ", irq, pid);
+          }
+        else
+          {
+            snprintf(buffer, sizeof(buffer), "IRQ %u", irq);
+            if (!g_irqactive[irq])
+              {
+                json_thread_name(IRQ_TID_BASE + irq, buffer);
+                g_irqactive[irq] = 1;
+              }
+
+            if (type == NOTE_IRQ_ENTER && g_irqactive[irq] == 1)
+              {
+                json_event(buffer, 'B', IRQ_TID_BASE + irq, usec, NULL);
+                g_irqactive[irq] = 2;
+              }
+            else if (type == NOTE_IRQ_LEAVE && g_irqactive[irq] == 2)
+              {
+                json_event(buffer, 'E', IRQ_TID_BASE + irq, usec, NULL);
+                g_irqactive[irq] = 1;
+              }
+          }
+        break;
+
+      case NOTE_SEMWAIT:
+        {
+          unsigned long long addr = 0;
+
+          for (i = length; i > NOTE_COMMON_SIZE; i--)
+            {
+              addr = (addr << 8) | note[i - 1];
+            }
+
+          if (g_text)
+            {
+              fprintf(g_out, "%12llu SEMWAIT pid %u sem 0x%llx\n",
+                      (unsigned long long)usec, pid, addr);
+            }
+          else
+            {
+              snprintf(args, sizeof(args), "\"sem\":\"0x%llx\"", addr);
+              name_thread(pid);
+              json_event("semwait", 'i', pid, usec, args);
+            }
+        }
+        break;
+
+      default:
+        fprintf(stderr, "Unrecognized note type %u\n", type);
+        break;
+    }
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+int main(int argc, char **argv, char **envp)
+{
+  const char *outfile = NULL;
+  uint8_t note[256];
+  FILE *in;
+  int length;
+  int ch;
+  int i;
+
+  while ((ch = getopt(argc, argv, ":tho:")) > 0)
+    {
+      switch (ch)
+        {
+          case 't':
+            g_text = true;
+            break;
+
+          case 'o':
+            outfile = optarg;
+            break;
+
+          case 'h':
+            show_usage(argv[0], EXIT_SUCCESS);
+            break;
+
+          case '?':
+            fprintf(stderr, "Unrecognized option: %c\n", optopt);
+            show_usage(argv[0], EXIT_FAILURE);
+            break;
+
+          case ':':
+            fprintf(stderr, "Missing option argument, option: %c\n", optopt);
+            show_usage(argv[0], EXIT_FAILURE);
+            break;
+        }
+    }
+
+  if (optind != argc - 1)
+    {
+      fprintf(stderr, "Missing <notefile>\n");
+      show_usage(argv[0], EXIT_FAILURE);
+    }
+
+  in = fopen(argv[optind], "rb");
+  if (!in)
+    {
+      fprintf(stderr, "Failed to open %s: %s\n", argv[optind],
+              strerror(errno));
+      return EXIT_FAILURE;
+    }
+
+  g_out = stdout;
+  if (outfile)
+    {
+      g_out = fopen(outfile, "w");
+      if (!g_out)
+        {
+          fprintf(stderr, "Failed to open %s: %s\n", outfile,
+                  strerror(errno));
+          fclose(in);
+          return EXIT_FAILURE;
+        }
+    }
+
+  if (!g_text)
+    {
+      fprintf(g_out, "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[");
+    }
+
+  while ((length = fgetc(in)) != EOF)
+    {
+      if (length < NOTE_COMMON_SIZE)
+        {
+          fprintf(stderr, "Bad note length %d at offset %ld\n",
+                  length, ftell(in) - 1);
+          break;
+        }
+
+      note[0] = (uint8_t)length;
+      if (fread(&note[1], 1, length - 1, in) != (size_t)(length - 1))
+        {
+          fprintf(stderr, "Truncated note at end of file\n");
+          break;
+        }
+
+      decode_note(note, length);
+    }
+
+  /* Close any slices that are still open at the end of the dump */
+
+  if (!g_text)
+    {
+      for (i = 0; i < MAX_PID; i++)
+        {
+          if (g_threads[i].running)
+            {
+              thread_suspend(i, g_timebase + g_lasttime);
+            }
+        }
+
+      for (i = 0; i < MAX_IRQ; i++)
+        {
+          if (g_irqactive[i] == 2)
+            {
+              char buffer[32];
+
+              snprintf(buffer, sizeof(buffer), "IRQ %d", i);
+              json_event(buffer, 'E', IRQ_TID_BASE + i,
+                         g_timebase + g_lasttime, NULL);
+            }
+        }
+
+      fprintf(g_out, "\n]}\n");
+    }
+
+  for (i = 0; i < MAX_PID; i++)
+    {
+      free(g_threads[i].name);
+    }
+
+  fclose(in);
+  if (outfile)
+    {
+      fclose(g_out);
+    }
+
+  return EXIT_SUCCESS;
+}